@@ -0,0 +1,79 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <array>
+#include <chrono>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+/**
+ * @brief The kinds of routes admission control tells apart, from the most to
+ * the least protected.
+ */
+enum class RouteClass { Read, Write, Auth };
+
+/**
+ * @brief Snapshot of one route class, as reported by /status/admission.
+ */
+struct AdmissionStatus {
+  std::string routeClass;
+  int inFlight = 0;
+  int maxInFlight = 0;
+  long long admitted = 0;
+  long long shedBusy = 0;
+  long long shedOverloaded = 0;
+};
+
+/**
+ * @brief Decides which requests are let in when the server is overloaded.
+ *
+ * Each route class has a cap on requests admitted but not yet finished;
+ * past it, requests of that class are turned away with 429 while other
+ * classes carry on. Independently, the controller watches how long
+ * admitted requests wait for a handler thread. The estimate is the
+ * smallest wait seen in the last interval, so a short burst does not count
+ * but a standing queue does. Once it passes the target delay, Auth requests
+ * (bcrypt-heavy registration and login) are shed with 503; at twice the
+ * target writes are shed too, and reads only at four times the target,
+ * when the server could not answer them in time anyway.
+ */
+class AdmissionController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Decision { Admit, Busy, Overloaded };
+
+  AdmissionController(Clock::duration targetDelay, int maxRead, int maxWrite,
+                      int maxAuth);
+
+  Decision admit(RouteClass routeClass, Clock::time_point now);
+  void started(Clock::duration queued, Clock::time_point now);
+  void finished(RouteClass routeClass);
+
+  Clock::duration queueDelay(Clock::time_point now);
+  int retryAfterSeconds(Clock::time_point now);
+  std::vector<AdmissionStatus> snapshot() const;
+
+  static const char* name(RouteClass routeClass);
+
+ private:
+  struct ClassState {
+    int inFlight = 0;
+    int maxInFlight = 0;
+    long long admitted = 0;
+    long long shedBusy = 0;
+    long long shedOverloaded = 0;
+  };
+
+  Clock::duration targetDelay;
+  Clock::duration interval;
+
+  mutable std::mutex mutex;
+  std::array<ClassState, 3> classes;
+  Clock::time_point intervalStart;
+  Clock::duration intervalMin = Clock::duration::max();
+  Clock::duration delay = Clock::duration::zero();
+
+  void roll(Clock::time_point now);
+};
@@ -0,0 +1,73 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <stdexcept>
+#include <thread>  // NOLINT(build/c++11)
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A fixed pool of threads with a bounded queue, for work that blocks
+ * on I/O.
+ *
+ * Route handlers hand their blocking part (Mongo, bcrypt, SMTP, curl) to
+ * the pool and return, leaving the Crow worker free to read and route the
+ * next request; the task completes the crow::response from a pool thread.
+ * The queue is bounded so that a burst is turned away with 503 instead of
+ * building an unbounded backlog. stop() refuses new tasks and runs every
+ * queued one before joining the threads, so no response is left
+ * unfinished; the destructor calls it, but an owner whose tasks use
+ * objects that die first must call it before they do.
+ */
+class AsyncExecutor {
+ public:
+  AsyncExecutor(size_t threads, size_t maxQueued);
+  ~AsyncExecutor();
+  AsyncExecutor(const AsyncExecutor&) = delete;
+  AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+  bool post(std::function<void()> task);
+  void stop();
+
+  /**
+   * @brief Queues a task and returns a future for its result. If the queue
+   * is full the future holds a std::runtime_error.
+   */
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F&& function) {
+    using T = std::invoke_result_t<F>;
+    auto task =
+        std::make_shared<std::packaged_task<T()>>(std::forward<F>(function));
+    std::future<T> result = task->get_future();
+    if (!post([task] { (*task)(); })) {
+      std::promise<T> rejected;
+      rejected.set_exception(
+          std::make_exception_ptr(std::runtime_error("Executor is full.")));
+      return rejected.get_future();
+    }
+    return result;
+  }
+
+  size_t threadCount() const { return workers.size(); }
+  size_t pending() const;
+
+ private:
+  size_t maxQueued;
+  std::vector<std::thread> workers;
+  mutable std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::function<void()>> queue;
+  bool stopping = false;
+  std::once_flag stopped;
+
+  void run();
+};
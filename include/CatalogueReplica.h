@@ -0,0 +1,144 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ChangeStreamWatcher.h"
+#include "DatabaseManager.h"
+#include "ListingFilter.h"
+#include "ResponseFormat.h"
+
+/**
+ * @brief Per-collection counters, as reported by /status/catalogue.
+ */
+struct CatalogueStatus {
+  std::string collection;
+  bool loaded = false;
+  uint64_t documents = 0;
+  uint64_t cities = 0;
+  uint64_t targetUsers = 0;
+  uint64_t orgs = 0;
+  uint64_t snapshots = 0;
+  uint64_t reads = 0;
+};
+
+/**
+ * @brief In-memory copy of the resource collections that getAll listings
+ * are served from instead of MongoDB.
+ *
+ * Each collection is held as an immutable snapshot: its documents in _id order
+ * with their JSON already rendered, plus one column for each field its
+ * ListingFilterSpec names. The columns hold small integer codes into per-field
+ * dictionaries, so a filtered listing compares 4-byte codes in contiguous
+ * arrays instead of strings in documents. The compare loops are branch-free
+ * over fixed-size blocks so the compiler vectorizes them.
+ *
+ * Readers take the current snapshot with one atomic load and never lock or
+ * wait for writers. A change builds a new snapshot next to the old one and
+ * publishes it with an atomic store (read-copy-update); readers still on
+ * the old one keep it alive until they are done. A snapshot's rows and
+ * columns are split into chunks of a few hundred rows, and snapshots share
+ * the chunks, documents and dictionaries they have in common, so a change
+ * copies the chunk pointers and the one chunk it lands in, not the whole
+ * collection.
+ *
+ * Changes arrive from the collection's change stream, a moment after they
+ * are written, so listings are served from here only while the stream is
+ * being followed, and their ETags come from the snapshot's own version.
+ */
+class CatalogueReplica {
+ public:
+  CatalogueReplica(
+      DatabaseManager& dbManager,
+      const std::vector<std::pair<std::string, ListingFilterSpec>>&
+          collections,
+      int pageSize = 20);
+
+  void load(const std::string& collection);
+  void restore(const std::string& collection,
+               const std::vector<bsoncxx::document::view>& documents);
+  void apply(const ChangeEvent& event);
+  bool loaded(const std::string& collection) const;
+  std::string listingETag(const std::string& collection, int start,
+                          ResponseFormat::Format format,
+                          const ListingFilter& filter) const;
+  std::string listing(const std::string& collection, int start,
+                      ResponseFormat::Format format,
+                      const ListingFilter& filter);
+  std::vector<CatalogueStatus> status() const;
+  bool scan(const std::string& collection,
+            const std::function<void(const bsoncxx::document::view&)>&
+                visitor) const;
+
+ private:
+  struct Row {
+    std::string id;
+    bsoncxx::document::value document;
+    std::string json;
+  };
+
+  // Values of one field, interned: code 0 means the field is missing and
+  // code i > 0 stands for values[i - 1]. Only ever grows, so a snapshot can
+  // share its predecessor's dictionary until a new value turns up.
+  struct Dictionary {
+    std::vector<std::string> values;
+    std::unordered_map<std::string, uint32_t> codes;
+
+    uint32_t find(const std::string& value) const;
+  };
+
+  enum Field { kCity, kTargetUser, kOrg, kFields };
+
+  // A run of consecutive rows, in _id order, with their codes. Never
+  // changed once published; a change copies the chunk it lands in.
+  struct Chunk {
+    std::vector<std::shared_ptr<const Row>> rows;
+    std::vector<uint32_t> columns[kFields];
+  };
+
+  struct Snapshot {
+    uint64_t version = 0;
+    size_t size = 0;
+    // In _id order; none of them is empty.
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+    std::shared_ptr<const Dictionary> dictionaries[kFields];
+  };
+
+  struct Slot {
+    std::string collection;
+    // The field each column is read from; empty if the collection has none.
+    std::string fields[kFields];
+    // Read and replaced with std::atomic_load and std::atomic_store only.
+    std::shared_ptr<const Snapshot> current;
+    // Serializes writers; readers never take it.
+    std::mutex writing;
+    std::atomic<uint64_t> reads{0};
+  };
+
+  DatabaseManager& dbManager;
+  size_t pageSize;
+  std::map<std::string, std::unique_ptr<Slot>> slots;
+
+  Slot* slotFor(const std::string& collection) const;
+  void replace(Slot& slot, std::vector<std::shared_ptr<const Row>> rows);
+  void publish(Slot& slot, std::shared_ptr<Snapshot> next);
+  std::vector<const Row*> page(const Snapshot& snapshot, size_t start,
+                               const ListingFilter& filter) const;
+
+  static std::string versionKey(const std::string& collection);
+  static std::shared_ptr<const Row> makeRow(
+      const bsoncxx::document::view& document);
+  static void encodeRow(const Slot& slot, Snapshot& snapshot, Chunk& chunk,
+                        size_t index, const Row& row);
+  static void append(Chunk& chunk, const Chunk& rows);
+  static std::shared_ptr<const Chunk> splitOff(Chunk& chunk);
+};
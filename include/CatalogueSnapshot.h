@@ -0,0 +1,109 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <atomic>
+#include <bsoncxx/document/view.hpp>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A snapshot file of in-memory state, mapped read-only.
+ *
+ * The file holds named sections of BSON documents: one per resource
+ * collection in the catalogue replica, and one for the subscriber index. It
+ * starts with a fixed header carrying a magic number, the format version,
+ * when it was written, and the length and CRC-32 of everything after the
+ * header, so a truncated, foreign or corrupt file is refused as a whole.
+ * Integers in the header and section framing are in host byte order; the
+ * documents are plain BSON.
+ *
+ * open() maps the file and validates it, and the documents are then read in
+ * place: each section is a list of views into the mapping, with nothing
+ * parsed or copied. They stay valid while the CatalogueSnapshot lives.
+ *
+ * write() writes to a temporary file next to the target, syncs it,
+ * renames it over the target and syncs the directory, so a reader sees the
+ * old file or the new one and never half of one, and a crash after write()
+ * returns keeps the new one.
+ */
+class CatalogueSnapshot {
+ public:
+  using Visitor = std::function<void(const bsoncxx::document::view&)>;
+  // Visits a section's documents; returns false, having visited nothing, to
+  // leave the section out.
+  using Source = std::function<bool(const Visitor&)>;
+
+  struct Section {
+    std::string name;
+    std::vector<bsoncxx::document::view> documents;
+  };
+
+  static constexpr uint32_t kFormatVersion = 1;
+
+  ~CatalogueSnapshot();
+  CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+  CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+  static std::unique_ptr<CatalogueSnapshot> open(const std::string& path);
+  static uint64_t write(
+      const std::string& path,
+      const std::vector<std::pair<std::string, Source>>& sections);
+
+  const Section* section(const std::string& name) const;
+  const std::vector<Section>& sections() const { return parsed; }
+  std::chrono::system_clock::time_point writtenAt() const { return written; }
+  size_t size() const { return length; }
+
+ private:
+  CatalogueSnapshot(const uint8_t* data, size_t length);
+
+  const uint8_t* data;
+  size_t length;
+  std::chrono::system_clock::time_point written;
+  std::vector<Section> parsed;
+
+  void parse();
+};
+
+/**
+ * @brief Writes a snapshot file every interval on a background thread.
+ *
+ * A failed write is logged and leaves the previous file in place.
+ */
+class SnapshotWriter {
+ public:
+  using Sections =
+      std::vector<std::pair<std::string, CatalogueSnapshot::Source>>;
+
+  SnapshotWriter(std::string path, std::chrono::milliseconds interval,
+                 Sections sections);
+  ~SnapshotWriter();
+
+  void start();
+  void stop();
+  bool writeNow();
+  uint64_t writes() const { return written; }
+  uint64_t failures() const { return failed; }
+
+ private:
+  std::string path;
+  std::chrono::milliseconds interval;
+  Sections sections;
+  std::atomic<uint64_t> written{0};
+  std::atomic<uint64_t> failed{0};
+
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+
+  void run();
+};
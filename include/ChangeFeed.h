@@ -0,0 +1,117 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One add, update or delete of a resource, as pushed to live feeds.
+ */
+struct ResourceChange {
+  std::string resource;  // "shelter", "food", ...
+  std::string action;    // "add", "update" or "delete"
+  std::string id;
+  std::string city;  // Empty if unknown, as for deletes.
+
+  std::string json() const;
+  std::string jsonFields() const;
+};
+
+/**
+ * @brief Counters, as reported by /status/feed.
+ */
+struct ChangeFeedStats {
+  uint64_t connections = 0;
+  uint64_t published = 0;
+  uint64_t delivered = 0;
+  uint64_t evicted = 0;
+};
+
+/**
+ * @brief Fans resource changes out to live connections.
+ *
+ * Each connection subscribes with a resource and a city, either of which
+ * may be the wildcard "*". Connections are indexed by that pair like
+ * SubscriberIndex, so a change visits only the connections it matches and
+ * idle connections cost nothing but their entry. A change whose city is
+ * unknown goes to every connection on its resource, so a client filtering
+ * by city still learns of deletes.
+ *
+ * publish() never blocks on a client: it renders the change once and
+ * appends it to each matching connection's queue, and a single sender
+ * thread writes queued frames out in order. A connection whose queue
+ * reaches maxQueued frames is not keeping up; it is dropped from the feed
+ * and closed rather than left to grow without bound.
+ */
+class ChangeFeed {
+ public:
+  using Send = std::function<void(const std::string& frame)>;
+  using Close = std::function<void(const std::string& reason)>;
+
+  ChangeFeed(size_t maxQueued, size_t maxConnections);
+  ~ChangeFeed();
+  ChangeFeed(const ChangeFeed&) = delete;
+  ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+  std::optional<uint64_t> subscribe(const std::string& resource,
+                                    const std::string& city, Send send,
+                                    Close close);
+  void unsubscribe(uint64_t id);
+  void publish(const ResourceChange& change);
+  ChangeFeedStats stats() const;
+
+ private:
+  using Frame = std::shared_ptr<const std::string>;
+  using Ids = std::unordered_set<uint64_t>;
+
+  struct Connection {
+    std::string resource;
+    std::string city;
+    Send send;
+    Close close;
+    std::vector<Frame> queued;
+  };
+
+  struct Outgoing {
+    Send send;
+    std::vector<Frame> frames;
+  };
+
+  size_t maxQueued;
+  size_t maxConnections;
+
+  mutable std::mutex mutex;
+  std::condition_variable wake;
+  std::unordered_map<uint64_t, Connection> connections;
+  // resource -> city -> connection ids
+  std::unordered_map<std::string, std::unordered_map<std::string, Ids>>
+      buckets;
+  std::vector<uint64_t> ready;
+  std::vector<std::pair<Close, std::string>> closing;
+  uint64_t nextId = 1;
+  uint64_t published = 0;
+  uint64_t delivered = 0;
+  uint64_t evicted = 0;
+  bool stopping = false;
+
+  // Held while frames are written, so unsubscribe() can wait out a write
+  // to the connection it removes.
+  std::mutex sending;
+  std::thread sender;
+
+  void enqueue(const Ids& ids, const Frame& frame,
+               std::vector<uint64_t>& overflowing);
+  void remove(uint64_t id);
+  void run();
+};
@@ -0,0 +1,78 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "ChangeFeed.h"
+
+/**
+ * @brief One journaled change. The document is the JSON body that was
+ * written, empty for deletes.
+ */
+struct JournalEntry {
+  uint64_t sequence = 0;
+  ResourceChange change;
+  std::string document;
+
+  std::string json() const;
+};
+
+/**
+ * @brief Counters, as reported by /status/journal.
+ */
+struct ChangeJournalStats {
+  uint64_t entries = 0;
+  uint64_t latest = 0;
+  uint64_t floor = 0;
+  uint64_t compactions = 0;
+};
+
+/**
+ * @brief Append-only, sequenced log of resource changes, so mirrors can
+ * sync by fetching the changes after the last sequence they saw instead of
+ * every page of every listing.
+ *
+ * Sequence numbers only ever grow. They start at the server's start time in
+ * microseconds, so sequences from an earlier run are always lower than any
+ * of this run's and are answered as compacted rather than misread.
+ *
+ * Adds and updates carry the resource's whole document, so only the latest
+ * entry for a resource matters: once the journal holds maxEntries, it is
+ * compacted by dropping every entry superseded by a later one for the same
+ * resource. If that leaves it more than half full, the oldest entries are
+ * dropped too and the floor rises to the last of them. A client whose
+ * sequence is below the floor has missed changes and must reload.
+ */
+class ChangeJournal {
+ public:
+  struct Page {
+    std::vector<JournalEntry> entries;
+    uint64_t next = 0;  // The sequence to ask from next time.
+    bool more = false;
+  };
+
+  ChangeJournal(size_t maxEntries, uint64_t firstSequence);
+
+  uint64_t append(const ResourceChange& change, std::string document);
+  std::optional<Page> since(uint64_t sequence, size_t limit) const;
+  uint64_t latest() const;
+  ChangeJournalStats stats() const;
+
+  static uint64_t startingSequence();
+
+ private:
+  size_t maxEntries;
+  mutable std::shared_mutex mutex;
+  std::deque<JournalEntry> entries;
+  uint64_t nextSequence;
+  uint64_t floor;
+  uint64_t compactions = 0;
+
+  void compact();
+};
@@ -0,0 +1,113 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "DatabaseManager.h"
+
+/**
+ * @brief A write to a watched collection, by this or any other instance.
+ *
+ * Reset means changes may have been missed (the stream could not be
+ * resumed, or the collection was dropped or renamed) and anything derived
+ * from the collection must be rebuilt.
+ */
+struct ChangeEvent {
+  enum class Operation { Insert, Update, Delete, Reset };
+
+  std::string collection;
+  Operation operation = Operation::Reset;
+  std::string id;
+  // The document as written, for inserts and for updates unless it was
+  // deleted again before the event was read.
+  std::optional<bsoncxx::document::value> document;
+
+  static std::optional<ChangeEvent> fromStream(
+      const std::string& collection, const bsoncxx::document::view& event);
+};
+
+/**
+ * @brief Per-collection counters, as reported by /status/watchers.
+ */
+struct WatcherStatus {
+  std::string collection;
+  bool running = false;
+  bool following = false;
+  uint64_t events = 0;
+  uint64_t resets = 0;
+  uint64_t errors = 0;
+};
+
+/**
+ * @brief Follows the change streams of the collections this instance caches
+ * things from, so that writes made through other instances behind the load
+ * balancer invalidate them here too.
+ *
+ * Each collection is watched on its own thread, which hands every change to
+ * the collection's handler. The resume token is saved in the
+ * ChangeStreamTokens collection under this node's name at most every
+ * tokenInterval, and a restarted node resumes from it, so no change is
+ * missed across restarts; the few replayed since the last save must be
+ * harmless to apply twice. When there is no token, or the server no longer
+ * has the history to resume from, the handler gets a Reset instead.
+ *
+ * Change streams need a replica set. On a standalone server the watcher
+ * logs that and stops, and each instance only sees its own writes.
+ */
+class ChangeStreamWatcher {
+ public:
+  using Handler = std::function<void(const ChangeEvent&)>;
+
+  ChangeStreamWatcher(DatabaseManager& dbManager, std::string node,
+                      std::chrono::milliseconds tokenInterval);
+  ~ChangeStreamWatcher();
+
+  void watch(const std::string& collection, Handler handler);
+  void start();
+  void stop();
+  std::vector<WatcherStatus> status() const;
+  bool isFollowing(const std::string& collection) const;
+
+  static std::string defaultNode();
+
+ private:
+  struct Watch {
+    std::string collection;
+    Handler handler;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> following{false};
+    std::atomic<uint64_t> events{0};
+    std::atomic<uint64_t> resets{0};
+    std::atomic<uint64_t> errors{0};
+  };
+
+  DatabaseManager& dbManager;
+  std::string node;
+  std::chrono::milliseconds tokenInterval;
+  std::list<Watch> watches;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+
+  void run(Watch& watch);
+  bool follow(Watch& watch, bool useToken);
+  void reset(Watch& watch);
+  std::optional<bsoncxx::document::value> loadToken(
+      const std::string& collection);
+  void saveToken(const std::string& collection,
+                 const bsoncxx::document::view& token);
+  bool isStopping();
+  bool sleepFor(std::chrono::milliseconds delay);
+};
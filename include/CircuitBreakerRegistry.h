@@ -0,0 +1,84 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Snapshot of one destination host, as reported by /status/webhooks.
+ */
+struct HostStatus {
+  std::string host;
+  std::string state;
+  int inFlight = 0;
+  int consecutiveFailures = 0;
+  double latencyMs = 0;
+  long long successes = 0;
+  long long failures = 0;
+  long long rejected = 0;
+};
+
+/**
+ * @brief Per-host circuit breakers and concurrency caps for outbound calls.
+ *
+ * A host starts closed. After failureThreshold consecutive failures its
+ * breaker opens and every call is rejected without touching the network
+ * until the cooldown has passed; then a single probe is let through
+ * (half-open). A successful probe closes the breaker, a failed one reopens
+ * it for another cooldown. Independently, at most maxInFlight calls to the
+ * same host may run at once, so one slow host cannot occupy every worker.
+ */
+class CircuitBreakerRegistry {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief What tryAcquire() granted; hand it back to release().
+   *
+   * Only the call marked as the half-open probe decides whether the breaker
+   * closes or reopens. Calls admitted before the breaker opened can still
+   * finish while it is half-open, and their outcome must not count as the
+   * probe's.
+   */
+  struct Permit {
+    bool granted = false;
+    bool probe = false;
+
+    explicit operator bool() const { return granted; }
+  };
+
+  CircuitBreakerRegistry(int maxInFlight, int failureThreshold,
+                         Clock::duration cooldown);
+
+  Permit tryAcquire(const std::string& host, Clock::time_point now);
+  void release(const std::string& host, Permit permit, bool success,
+               Clock::duration latency, Clock::time_point now);
+  std::vector<HostStatus> snapshot() const;
+
+  static std::string hostOf(const std::string& url);
+
+ private:
+  enum class State { Closed, Open, HalfOpen };
+
+  struct Breaker {
+    State state = State::Closed;
+    Clock::time_point openUntil;
+    bool probeInFlight = false;
+    int inFlight = 0;
+    int consecutiveFailures = 0;
+    double latencyMs = 0;
+    long long successes = 0;
+    long long failures = 0;
+    long long rejected = 0;
+  };
+
+  int maxInFlight;
+  int failureThreshold;
+  Clock::duration cooldown;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, Breaker> breakers;
+};
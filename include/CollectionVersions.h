@@ -0,0 +1,30 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Per-collection version counters for conditional GETs.
+ *
+ * Services bump a collection's version after every add, update and delete,
+ * and list endpoints tag their responses with an ETag made of the version
+ * and the page (and filter) requested. A client that sends the ETag back in
+ * If-None-Match gets 304 while the version is unchanged, without a query or
+ * any serialization. The version is read before the query, so a write that
+ * races with a listing can at worst make the next poll a full response.
+ *
+ * Counters live in this process and start again at zero on restart; the
+ * ETag includes a per-process epoch so that tags from a previous run never
+ * match. Writes made by other processes are seen through
+ * ChangeStreamWatcher, which bumps the version for them.
+ */
+class CollectionVersions {
+ public:
+  static uint64_t bump(const std::string& collection);
+  static uint64_t current(const std::string& collection);
+  static std::string etag(const std::string& collection,
+                          std::string_view variant);
+  static bool matches(std::string_view ifNoneMatch, std::string_view etag);
+};
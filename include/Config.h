@@ -0,0 +1,41 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief Tuning knobs read from the environment, with built-in defaults.
+ */
+namespace config {
+
+/**
+ * @brief Reads an integer setting.
+ *
+ * @param name The environment variable, e.g. "GITGUD_WEBHOOK_TIMEOUT_MS".
+ * @param fallback The value used when the variable is unset or malformed.
+ * @return long long The configured value.
+ */
+inline long long getInt(const char* name, long long fallback) {
+  const char* value = std::getenv(name);
+  if (value == nullptr || *value == '\0') {
+    return fallback;
+  }
+  char* end = nullptr;
+  long long parsed = std::strtoll(value, &end, 10);
+  return *end == '\0' ? parsed : fallback;
+}
+
+/**
+ * @brief Reads a string setting.
+ *
+ * @param name The environment variable.
+ * @param fallback The value used when the variable is unset.
+ * @return std::string The configured value.
+ */
+inline std::string getString(const char* name, const std::string& fallback) {
+  const char* value = std::getenv(name);
+  return value == nullptr ? fallback : std::string(value);
+}
+
+}  // namespace config
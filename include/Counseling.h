@@ -2,29 +2,51 @@
 #define COUNSELING_H
 
 #include <bsoncxx/document/value.hpp>
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "ListingFilter.h"
+#include "RequestBody.h"
+#include "ResponseFormat.h"
+#include "Result.h"
+
 class DatabaseManager;
 
 class Counseling {
  public:
+  using Fields = std::map<std::string, std::string, std::less<>>;
+
+  static const ListingFilterSpec kFilterSpec;
+
   Counseling(DatabaseManager& dbManager, const std::string& collection_name);
-  void cleanCache();
-  std::string checkInputFormat(std::string content, std::string request_auth);
-  virtual std::string addCounselor(std::string request_body, std::string request_auth);
-  virtual std::string deleteCounselor(const std::string& counselorId, std::string request_auth);
+  Fields emptyFields() const;
+  Result<std::string> checkInputFormat(const RequestBody& body,
+                                       std::string_view request_auth,
+                                       Fields& fields) const;
+  virtual Result<std::string> addCounselor(const RequestBody& request_body,
+                                           std::string_view request_auth);
+  virtual std::string deleteCounselor(const std::string& counselorId,
+                                      const std::string& request_auth);
   virtual std::string searchCounselorsAll(int start = 0);
-  virtual std::string updateCounselor(std::string request_body, std::string request_auth);
-  std::vector<std::pair<std::string, std::string>> createDBContent();
+  std::string listingETag(
+      int start = 0,
+      ResponseFormat::Format format = ResponseFormat::Format::Json,
+      const ListingFilter& filter = {}) const;
+  std::string encodedListing(int start, ResponseFormat::Format format,
+                             const ListingFilter& filter = {});
+  virtual Result<std::string> updateCounselor(const RequestBody& request_body,
+                                              std::string_view request_auth);
+  std::vector<std::pair<std::string, std::string>> createDBContent(
+      Fields fields) const;
 
  private:
   DatabaseManager& dbManager;
   std::string collection_name;
   std::vector<std::string> cols;
-  std::unordered_map<std::string, std::string> format;
 
   std::string getCounselorID(const bsoncxx::document::view& counselor);
   std::string printCounselors(
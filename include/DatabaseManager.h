@@ -4,11 +4,21 @@
 #include <bsoncxx/json.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pool.hpp>
 #include <mongocxx/uri.hpp>
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "AsyncExecutor.h"
+#include "InsertBatcher.h"
+
 class DatabaseManager {
  public:
   DatabaseManager(const std::string& uri, bool skipInitialization = false);
@@ -21,6 +31,9 @@ class DatabaseManager {
       int start, const std::string& collectionName,
       const std::vector<std::pair<std::string, std::string>>& keyValues,
       std::vector<bsoncxx::document::value>& result);
+  virtual void scanCollection(
+      const std::string& collectionName,
+      const std::function<void(const bsoncxx::document::view&)>& visitor);
   virtual std::string insertResource(
       const std::string& collectionName,
       const std::vector<std::pair<std::string, std::string>>& keyValues);
@@ -36,14 +49,83 @@ class DatabaseManager {
   virtual bsoncxx::document::value getResources(
       const std::string& resourceType);
 
+  // Document-level primitives for internal collections whose fields are not
+  // all strings (e.g. the notification outbox).
+  virtual std::string insertDocument(const std::string& collectionName,
+                                     const bsoncxx::document::view& document);
+  virtual std::optional<bsoncxx::document::value> findOneAndUpdate(
+      const std::string& collectionName, const bsoncxx::document::view& filter,
+      const bsoncxx::document::view& update);
+  virtual bool updateDocument(const std::string& collectionName,
+                              const bsoncxx::document::view& filter,
+                              const bsoncxx::document::view& update,
+                              bool upsert);
+  virtual bool deleteDocument(const std::string& collectionName,
+                              const bsoncxx::document::view& filter);
+  virtual void createIndex(const std::string& collectionName,
+                           const bsoncxx::document::view& keys);
+  virtual std::optional<bsoncxx::document::value> findDocument(
+      const std::string& collectionName, const bsoncxx::document::view& filter);
+
+  // Follows a collection's change stream on the calling thread. onEvent is
+  // called for each change and onBatch with the resume token after each
+  // batch, which arrives at least every maxAwait while the collection is
+  // idle; either returning false ends the watch. Throws a std::system_error
+  // carrying the server's error code if the stream cannot be opened or
+  // resumed.
+  virtual void watchCollection(
+      const std::string& collectionName,
+      const std::optional<bsoncxx::document::value>& resumeAfter,
+      std::chrono::milliseconds maxAwait,
+      const std::function<bool(const bsoncxx::document::view&)>& onEvent,
+      const std::function<bool(const bsoncxx::document::view&)>& onBatch);
+
+  // Non-blocking variants of the resource operations. Each runs the
+  // blocking operation above on a dedicated I/O executor, so a caller can
+  // start independent queries and wait for them together. Arguments are
+  // taken by value because the operation may start after the caller's
+  // variables are gone. Wait for every future before destroying the manager.
+  virtual std::future<std::vector<bsoncxx::document::value>>
+  findCollectionAsync(
+      int start, std::string collectionName,
+      std::vector<std::pair<std::string, std::string>> keyValues);
+  virtual std::future<std::string> insertResourceAsync(
+      std::string collectionName,
+      std::vector<std::pair<std::string, std::string>> keyValues);
+  virtual std::future<void> updateResourceAsync(
+      std::string collectionName, std::string resourceId,
+      std::vector<std::pair<std::string, std::string>> updates);
+  virtual std::future<bool> deleteResourceAsync(std::string collectionName,
+                                                std::string resourceId,
+                                                std::string authToken);
+
+  void enableInsertBatching(std::chrono::microseconds window,
+                            size_t maxBatch);
+  InsertBatcher::Stats insertBatchStats() const;
+
   static DatabaseManager& getInstance() {
     static DatabaseManager instance("mongodb://localhost:27017");
     return instance;
   }
 
  protected:
-  std::optional<mongocxx::client> conn;
+  // Clients are checked out per operation, because a mongocxx::client must
+  // not be used by two threads at once.
+  std::unique_ptr<mongocxx::pool> pool;
+
+  AsyncExecutor& ioExecutor();
+  std::vector<std::string> insertBatch(
+      const std::string& collectionName,
+      const std::vector<const InsertBatcher::KeyValues*>& documents);
 
   bsoncxx::document::value createDocument(
       const std::vector<std::pair<std::string, std::string>>& keyValues);
+
+ private:
+  // Members are destroyed in reverse order: io drains and joins its
+  // workers, whose inserts may still be waiting on batcher, before batcher
+  // goes.
+  std::unique_ptr<InsertBatcher> batcher;
+  std::once_flag ioStarted;
+  std::unique_ptr<AsyncExecutor> io;
 };
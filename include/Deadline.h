@@ -0,0 +1,57 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Thrown when a request runs out of time. stage() names the step
+ * that was running or about to start, e.g. "mongo.find" or "queue".
+ */
+class DeadlineExceeded : public std::runtime_error {
+ public:
+  explicit DeadlineExceeded(const std::string& stage)
+      : std::runtime_error("Deadline exceeded during " + stage + "."),
+        stageName(stage) {}
+
+  const std::string& stage() const { return stageName; }
+
+ private:
+  std::string stageName;
+};
+
+/**
+ * @brief The deadline of the request the current thread is working on.
+ *
+ * A Scope sets it for the current thread; the routing layer opens one per
+ * request, and AsyncExecutor carries it over to the threads that run work
+ * on the request's behalf. Code that may block (Mongo, SMTP, curl) asks for
+ * remaining() to bound its own timeouts and calls check() before starting,
+ * so a request that has run out of time fails fast instead of holding a
+ * thread. Without a Scope there is no deadline and nothing is bounded.
+ */
+class Deadline {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  class Scope {
+   public:
+    // A nested scope can only shorten the deadline, never extend it.
+    explicit Scope(Clock::duration budget);
+    explicit Scope(std::optional<Clock::time_point> at);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    std::optional<Clock::time_point> previous;
+  };
+
+  static std::optional<Clock::time_point> current();
+  static std::optional<std::chrono::milliseconds> remaining();
+  static long long clampMs(long long timeoutMs);
+  static bool expired();
+  static void check(const std::string& stage);
+};
@@ -1,12 +1,18 @@
 #ifndef FOOD_RESOURCE_H
 #define FOOD_RESOURCE_H
 
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "DatabaseManager.h"
+#include "ListingFilter.h"
+#include "RequestBody.h"
+#include "ResponseFormat.h"
+#include "Result.h"
 
 class Food {
  private:
@@ -15,17 +21,32 @@ class Food {
   std::vector<std::string> cols;
 
  public:
+  using Fields = std::map<std::string, std::string, std::less<>>;
+
+  static const ListingFilterSpec kFilterSpec;
+
   Food(DatabaseManager& db, const std::string& collection_name);
-  void cleanCache();
-  std::string checkInputFormat(std::string content, std::string request_auth);
-  std::unordered_map<std::string, std::string> format;
-  virtual std::string addFood(std::string request_body, std::string request_auth);
-  std::vector<std::pair<std::string, std::string>> createDBContent();
+  Fields emptyFields() const;
+  Result<std::string> checkInputFormat(const RequestBody& body,
+                                       std::string_view request_auth,
+                                       Fields& fields) const;
+  virtual Result<std::string> addFood(const RequestBody& request_body,
+                                      std::string_view request_auth);
+  std::vector<std::pair<std::string, std::string>> createDBContent(
+      Fields fields) const;
   virtual std::string getAllFood(int start = 0);
+  std::string listingETag(
+      int start = 0,
+      ResponseFormat::Format format = ResponseFormat::Format::Json,
+      const ListingFilter& filter = {}) const;
+  std::string encodedListing(int start, ResponseFormat::Format format,
+                             const ListingFilter& filter = {});
 
-  virtual std::string updateFood(std::string request_body, std::string request_auth);
+  virtual Result<std::string> updateFood(const RequestBody& request_body,
+                                         std::string_view request_auth);
 
-  virtual std::string deleteFood(const std::string& id, std::string request_auth);
+  virtual std::string deleteFood(const std::string& id,
+                                 const std::string& request_auth);
 };
 
 #endif
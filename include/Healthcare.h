@@ -1,34 +1,55 @@
 #ifndef HEALTHCARE_H
 #define HEALTHCARE_H
 
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 #include "DatabaseManager.h"
+#include "ListingFilter.h"
+#include "RequestBody.h"
+#include "ResponseFormat.h"
+#include "Result.h"
 
 class Healthcare {
  public:
+  using Fields = std::map<std::string, std::string, std::less<>>;
+
+  static const ListingFilterSpec kFilterSpec;
+
   std::string collection_name;
 
   Healthcare(DatabaseManager& dbManager, const std::string& collection_name);
-  void cleanCache();
-  std::string checkInputFormat(std::string content, std::string authToken);
-  virtual std::string addHealthcareService(std::string request_body, std::string request_auth);
+  Fields emptyFields() const;
+  Result<std::string> checkInputFormat(const RequestBody& body,
+                                       std::string_view authToken,
+                                       Fields& fields) const;
+  virtual Result<std::string> addHealthcareService(
+      const RequestBody& request_body, std::string_view request_auth);
 
   virtual std::string getAllHealthcareServices(int start = 0);
-
-  virtual std::string deleteHealthcare(std::string id, std::string request_auth);
-  virtual std::string updateHealthcare(std::string request_body, std::string request_auth);
+  std::string listingETag(
+      int start = 0,
+      ResponseFormat::Format format = ResponseFormat::Format::Json,
+      const ListingFilter& filter = {}) const;
+  std::string encodedListing(int start, ResponseFormat::Format format,
+                             const ListingFilter& filter = {});
+
+  virtual std::string deleteHealthcare(const std::string& id,
+                                       const std::string& request_auth);
+  virtual Result<std::string> updateHealthcare(const RequestBody& request_body,
+                                               std::string_view request_auth);
 
   //   virtual std::string validateHealthcareServiceInput(
   //       const std::map<std::string, std::string>& content);
 
-  std::vector<std::pair<std::string, std::string>> createDBContent();
+  std::vector<std::pair<std::string, std::string>> createDBContent(
+      Fields fields) const;
 
   std::string printHealthcareServices(
       std::vector<bsoncxx::document::value>& services) const;
-  std::unordered_map<std::string, std::string> format;
 
  private:
   DatabaseManager& dbManager;
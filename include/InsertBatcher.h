@@ -0,0 +1,96 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Group commit for inserts: concurrent inserts into the same
+ * collection are collected and written with one call.
+ *
+ * The first insert into a collection opens a batch and waits up to the
+ * window for others to join; it then writes the batch for everyone. A batch
+ * that reaches maxBatch documents is written at once by the insert that
+ * filled it. Each caller blocks until its batch has been written and gets
+ * the id of its own document back, so the interface is the same as a
+ * single insert. If the write fails, every caller in the batch sees the
+ * exception; if it fails for some documents only, as an unordered
+ * insert_many can, only their callers see an error.
+ *
+ * The documents are not copied: the batch holds pointers to the callers'
+ * key/value vectors, which stay alive because the callers are waiting.
+ */
+class InsertBatcher {
+ public:
+  using KeyValues = std::vector<std::pair<std::string, std::string>>;
+  // Writes the documents and returns their ids, in order. Throws
+  // PartialWrite if only some of them were written.
+  using Flush = std::function<std::vector<std::string>(
+      const std::string& collectionName,
+      const std::vector<const KeyValues*>& documents)>;
+
+  /**
+   * @brief Thrown by a flush that wrote some documents of the batch but not
+   * others.
+   */
+  class PartialWrite : public std::runtime_error {
+   public:
+    // ids of every document, in order, and the error message of each one
+    // that was not written, by index.
+    PartialWrite(std::vector<std::string> ids,
+                 std::map<size_t, std::string> errors);
+
+    std::vector<std::string> ids;
+    std::map<size_t, std::string> errors;
+  };
+
+  struct Stats {
+    uint64_t batches = 0;
+    uint64_t documents = 0;
+  };
+
+  InsertBatcher(std::chrono::microseconds window, size_t maxBatch,
+                Flush flush);
+
+  std::string insert(const std::string& collectionName,
+                     const KeyValues& keyValues);
+  Stats stats() const;
+
+ private:
+  struct Written {
+    std::vector<std::string> ids;
+    std::map<size_t, std::string> errors;
+  };
+
+  struct Batch {
+    std::vector<const KeyValues*> documents;
+    std::promise<Written> written;
+    std::shared_future<Written> result = written.get_future().share();
+  };
+
+  std::chrono::microseconds window;
+  size_t maxBatch;
+  Flush flush;
+
+  std::mutex mutex;
+  std::condition_variable batchClosed;
+  std::unordered_map<std::string, std::shared_ptr<Batch>> open;
+
+  std::atomic<uint64_t> batchCount{0};
+  std::atomic<uint64_t> documentCount{0};
+
+  void write(const std::string& collectionName, Batch& batch);
+};
@@ -0,0 +1,34 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Single-pass parser for the flat JSON objects the API accepts.
+ *
+ * Every request body is an object whose values are all strings, so there is
+ * no need to build a BSON document just to walk it once: the scanner copies
+ * each key and value straight into (key, value) pairs. Runs of ordinary
+ * string characters are skipped 16 bytes at a time with SSE2 where it is
+ * available, which is where almost all of the time goes on large bodies.
+ *
+ * Non-string values, unknown fields (when a list of allowed keys is given)
+ * and malformed JSON are all reported from the same pass. Keys and values
+ * are allocated from the memory resource of the fields vector, so a vector
+ * built on the request arena keeps the whole parse off the global heap.
+ */
+class JsonScanner {
+ public:
+  using Fields =
+      std::pmr::vector<std::pair<std::pmr::string, std::pmr::string>>;
+
+  static bool scanObject(const std::string& text, Fields& fields,
+                         std::string& error,
+                         const std::vector<std::string>* allowedKeys = nullptr);
+
+  static size_t findSpecial(const char* data, size_t pos, size_t size);
+};
@@ -0,0 +1,36 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The fields of one resource collection that the city, targetUser
+ * and org query parameters are matched against. An empty name means the
+ * collection has no such field, and listings of it cannot be filtered on
+ * that parameter.
+ */
+struct ListingFilterSpec {
+  std::string city;
+  std::string targetUser;
+  std::string org;
+};
+
+/**
+ * @brief The optional city, targetUser and org query parameters of the
+ * getAll endpoints. Each one set must equal the resource's field for it
+ * exactly, as named by the collection's ListingFilterSpec; an empty filter
+ * matches everything.
+ */
+struct ListingFilter {
+  std::string city;
+  std::string targetUser;
+  std::string org;
+
+  bool empty() const;
+  bool supportedBy(const ListingFilterSpec& spec) const;
+  std::string variant() const;
+  std::vector<std::pair<std::string, std::string>> keyValues(
+      const ListingFilterSpec& spec) const;
+};
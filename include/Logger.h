@@ -7,8 +7,10 @@
 #include <filesystem>
 #include <iomanip>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 class TradingError : public std::runtime_error {
  public:
@@ -37,6 +39,8 @@ class JSONParseError : public TradingError {
 class Logger {
  private:
   std::unordered_map<std::string, std::shared_ptr<spdlog::logger>> loggers;
+  // Handlers run on every Crow worker thread, so lookups must be guarded.
+  std::mutex loggersMutex;
 
   Logger() = default;  // Private constructor
 
@@ -50,6 +54,7 @@ class Logger {
   }
 
   std::shared_ptr<spdlog::logger> getLogger(const std::string& log_name) {
+    std::lock_guard<std::mutex> lock(loggersMutex);
     auto it = loggers.find(log_name);
     if (it == loggers.end()) {
       std::string log_path = "logs/" + log_name + ".log";
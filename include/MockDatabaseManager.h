@@ -6,6 +6,9 @@
 
 #include "DatabaseManager.h"
 
+// The *Async operations are inherited: they run the mocked blocking methods
+// below on the I/O executor, so service tests can set expectations as usual
+// and still exercise concurrent calls.
 class MockDatabaseManager : public DatabaseManager {
  public:
   MockDatabaseManager() : DatabaseManager("mongodb://localhost:27017", true) {}
@@ -17,6 +20,12 @@ class MockDatabaseManager : public DatabaseManager {
        (std::vector<bsoncxx::document::value> & result)),
       (override));
 
+  MOCK_METHOD(
+      void, scanCollection,
+      (const std::string &collectionName,
+       (const std::function<void(const bsoncxx::document::view &)> &visitor)),
+      (override));
+
   MOCK_METHOD(
       std::string, insertResource,
       (const std::string &collectionName,
@@ -33,6 +42,73 @@ class MockDatabaseManager : public DatabaseManager {
               (const std::string &collectionName, (const std::string &id), 
               (const std::string &authToken)),
               (override));
+
+  MOCK_METHOD(std::string, insertDocument,
+              (const std::string &collectionName,
+               (const bsoncxx::document::view &document)),
+              (override));
+
+  MOCK_METHOD(std::optional<bsoncxx::document::value>, findOneAndUpdate,
+              (const std::string &collectionName,
+               (const bsoncxx::document::view &filter),
+               (const bsoncxx::document::view &update)),
+              (override));
+
+  MOCK_METHOD(bool, updateDocument,
+              (const std::string &collectionName,
+               (const bsoncxx::document::view &filter),
+               (const bsoncxx::document::view &update), bool upsert),
+              (override));
+
+  MOCK_METHOD(bool, deleteDocument,
+              (const std::string &collectionName,
+               (const bsoncxx::document::view &filter)),
+              (override));
+
+  MOCK_METHOD(void, createIndex,
+              (const std::string &collectionName,
+               (const bsoncxx::document::view &keys)),
+              (override));
+
+  MOCK_METHOD(std::optional<bsoncxx::document::value>, findDocument,
+              (const std::string &collectionName,
+               (const bsoncxx::document::view &filter)),
+              (override));
+
+  MOCK_METHOD(
+      void, watchCollection,
+      (const std::string &collectionName,
+       (const std::optional<bsoncxx::document::value> &resumeAfter),
+       std::chrono::milliseconds maxAwait,
+       (const std::function<bool(const bsoncxx::document::view &)> &onEvent),
+       (const std::function<bool(const bsoncxx::document::view &)> &onBatch)),
+      (override));
+
+  // Answers findCollection from these documents, keeping the ones whose
+  // fields equal every given value, as the query would.
+  void findIn(std::vector<bsoncxx::document::value> documents) {
+    ON_CALL(*this, findCollection(::testing::_, ::testing::_, ::testing::_,
+                                  ::testing::_))
+        .WillByDefault(
+            [documents = std::move(documents)](
+                int, const std::string &,
+                const std::vector<std::pair<std::string, std::string>>
+                    &keyValues,
+                std::vector<bsoncxx::document::value> &result) {
+              for (const auto &document : documents) {
+                bool matches = true;
+                for (const auto &[key, value] : keyValues) {
+                  auto element = document.view()[key];
+                  matches = matches && element &&
+                            element.type() == bsoncxx::type::k_utf8 &&
+                            element.get_utf8().value.to_string() == value;
+                }
+                if (matches) {
+                  result.push_back(document);
+                }
+              }
+            });
+  }
 };
 
 #endif  // MOCK_DATABASE_MANAGER_H
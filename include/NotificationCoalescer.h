@@ -0,0 +1,75 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief How often a subscriber wants to hear about updates.
+ */
+enum class DeliveryMode { Immediate, Hourly, Daily };
+
+/**
+ * @brief A merged notification for a single subscriber.
+ *
+ * Each (resource, city) pair appears once, with the number of updates that
+ * were folded into it.
+ */
+struct NotificationDigest {
+  std::string subscriberId;
+  std::string contact;
+  std::map<std::pair<std::string, std::string>, int> updates;
+
+  std::string text() const;
+  std::string json() const;
+};
+
+/**
+ * @brief Merges resource updates per subscriber, keyed by (resource, city),
+ * and knows how long each subscriber's digests are held before sending.
+ *
+ * The dispatcher adds the updates of a batch of outbox events and drains
+ * the digests into the outbox, where each subscriber's pending delivery
+ * keeps merging them until it is due, one window after it was created. A
+ * window is never extended, so a subscriber hears about an update at most
+ * one window of its delivery mode after it happened. The immediate window
+ * is zero unless configured otherwise: immediate digests only merge what
+ * arrives before the next dispatcher pass.
+ */
+class NotificationCoalescer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit NotificationCoalescer(
+      Clock::duration immediateWindow = Clock::duration::zero(),
+      Clock::duration hourlyWindow = std::chrono::hours(1),
+      Clock::duration dailyWindow = std::chrono::hours(24));
+
+  void setDelivery(const std::string& subscriberId, DeliveryMode mode);
+  void forget(const std::string& subscriberId);
+  void add(const std::string& subscriberId, const std::string& contact,
+           const std::string& resource, const std::string& city);
+  std::vector<NotificationDigest> drainAll();
+  size_t pending() const;
+  Clock::duration windowOf(const std::string& subscriberId) const;
+  bool deliveryOf(const std::string& subscriberId, DeliveryMode& mode) const;
+
+  static bool parseDeliveryMode(const std::string& value, DeliveryMode& mode);
+  static const char* deliveryModeName(DeliveryMode mode);
+
+ private:
+  Clock::duration windowFor(DeliveryMode mode) const;
+
+  Clock::duration immediateWindow;
+  Clock::duration hourlyWindow;
+  Clock::duration dailyWindow;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, DeliveryMode> deliveryModes;
+  std::unordered_map<std::string, NotificationDigest> pendingBySubscriber;
+};
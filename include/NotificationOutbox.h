@@ -0,0 +1,89 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+
+#include "DatabaseManager.h"
+#include "NotificationCoalescer.h"
+
+/**
+ * @brief A resource update waiting to be matched against subscribers.
+ */
+struct OutboxEvent {
+  std::string id;
+  std::string resource;
+  std::string city;
+};
+
+/**
+ * @brief A subscriber's merged digest waiting to be sent.
+ */
+struct OutboxDelivery {
+  std::string id;
+  int attempts = 0;
+  NotificationDigest digest;
+  // When the claim on it runs out, to the millisecond stored with it.
+  std::chrono::system_clock::time_point leaseUntil;
+};
+
+/**
+ * @brief Durable notification queue stored in MongoDB.
+ *
+ * The add paths only insert a small "event" record, so notification work
+ * never runs on the request thread and survives restarts. The dispatcher
+ * claims events, matches them against subscribers and merges the result
+ * into one pending "delivery" record per subscriber, which is sent once its
+ * DueAt is reached. Records are claimed with a lease: a dispatcher that
+ * dies mid-batch leaves records that become claimable again once the lease
+ * expires, so delivery is at-least-once. The outcome of a delivery is only
+ * written while its claim's lease is still the one stored, so a dispatcher
+ * whose lease ran out cannot overwrite what the next holder did. Failed
+ * deliveries are retried with exponential backoff and jitter and end up in
+ * the "dead" state after maxAttempts tries.
+ */
+class NotificationOutbox {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  static const char kCollection[];
+
+  NotificationOutbox(DatabaseManager& dbManager, int maxAttempts,
+                     Clock::duration lease, Clock::duration baseBackoff,
+                     Clock::duration maxBackoff);
+
+  void ensureIndexes();
+
+  void enqueue(const std::string& resource, const std::string& city,
+               Clock::time_point now);
+  std::optional<OutboxEvent> claimEvent(Clock::time_point now);
+  void completeEvent(const std::string& id);
+
+  void stage(const NotificationDigest& digest, Clock::time_point dueAt);
+  std::optional<OutboxDelivery> claimDelivery(Clock::time_point now);
+  bool completeDelivery(const OutboxDelivery& delivery);
+  bool retryDelivery(const OutboxDelivery& delivery, Clock::time_point now);
+  bool deferDelivery(const OutboxDelivery& delivery, Clock::time_point now);
+
+  Clock::duration backoff(int attempts, double jitter) const;
+  Clock::duration leaseLength() const { return lease; }
+
+  static std::string encodeKey(const std::string& resource,
+                               const std::string& city);
+  static std::pair<std::string, std::string> decodeKey(const std::string& key);
+
+ private:
+  DatabaseManager& dbManager;
+  int maxAttempts;
+  Clock::duration lease;
+  Clock::duration baseBackoff;
+  Clock::duration maxBackoff;
+
+  Clock::time_point leaseEnd(Clock::time_point now) const;
+  std::optional<bsoncxx::document::value> claim(const std::string& kind,
+                                                const std::string& leasedState,
+                                                Clock::time_point now);
+  bool reschedule(const OutboxDelivery& delivery, const std::string& state,
+                  int attempts, Clock::time_point dueAt);
+};
@@ -4,28 +4,49 @@
 #define OUTREACH_H
 
 #include <iostream>
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "DatabaseManager.h"
+#include "ListingFilter.h"
+#include "RequestBody.h"
+#include "ResponseFormat.h"
+#include "Result.h"
 
 class Outreach {
  public:
+  using Fields = std::map<std::string, std::string, std::less<>>;
+
+  static const ListingFilterSpec kFilterSpec;
+
   Outreach(DatabaseManager& dbManager, const std::string& collection_name);
 
   std::string collection_name;
-  void cleanCache();
-  std::string checkInputFormat(std::string content, std::string request_auth);
-  std::unordered_map<std::string, std::string> format;
-  virtual std::string addOutreachService(std::string request_bod, std::string request_auth);
+  Fields emptyFields() const;
+  Result<std::string> checkInputFormat(const RequestBody& body,
+                                       std::string_view request_auth,
+                                       Fields& fields) const;
+  virtual Result<std::string> addOutreachService(
+      const RequestBody& request_body, std::string_view request_auth);
 
-  std::vector<std::pair<std::string, std::string>> createDBContent();
+  std::vector<std::pair<std::string, std::string>> createDBContent(
+      Fields fields) const;
 
   virtual std::string getAllOutreachServices(int start = 0);
-  virtual std::string deleteOutreach(std::string id, std::string request_auth);
-  virtual std::string updateOutreach(std::string request_body, std::string request_auth);
+  std::string listingETag(
+      int start = 0,
+      ResponseFormat::Format format = ResponseFormat::Format::Json,
+      const ListingFilter& filter = {}) const;
+  std::string encodedListing(int start, ResponseFormat::Format format,
+                             const ListingFilter& filter = {});
+  virtual std::string deleteOutreach(const std::string& id,
+                                     const std::string& request_auth);
+  virtual Result<std::string> updateOutreach(const RequestBody& request_body,
+                                             std::string_view request_auth);
 
   std::string printOutreachServices(
       const std::vector<bsoncxx::document::value>& services) const;
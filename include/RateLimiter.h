@@ -0,0 +1,83 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Token-bucket rate limits per route and per client.
+ *
+ * Each (route, client) pair has its own bucket that refills at
+ * limit.requests per limit.period and holds up to limit.burst tokens. A
+ * bucket is a single atomic "theoretical arrival time" (the GCRA form of
+ * a token bucket), so taking a token is one compare-and-swap and never
+ * blocks. Buckets are spread over shards by key. A shard's lock is only
+ * taken exclusively to add a client seen for the first time, so concurrent
+ * requests from known clients do not contend.
+ *
+ * A shard never holds more than its capacity. Once full, a new client
+ * takes the place of the most refilled of a few buckets picked at random,
+ * and every capacity's worth of new clients the shard drops the buckets
+ * that have refilled completely, so adding a client costs constant time
+ * on average however many clients there are.
+ */
+class RateLimiter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Limit {
+    long long requests = 0;  // 0 means unlimited.
+    Clock::duration period = std::chrono::seconds(1);
+    long long burst = 0;
+
+    static std::optional<Limit> parse(const std::string& spec);
+  };
+
+  struct Decision {
+    bool allowed = true;
+    long long limit = 0;
+    long long remaining = 0;
+    Clock::duration reset = Clock::duration::zero();
+    Clock::duration retryAfter = Clock::duration::zero();
+  };
+
+  explicit RateLimiter(Limit defaultLimit, size_t shards = 64,
+                       size_t maxBucketsPerShard = 4096);
+
+  void setLimit(const std::string& route, Limit limit);
+  bool configure(const std::string& spec);
+  Decision check(const std::string& route, const std::string& client,
+                 Clock::time_point now);
+  long long rejected() const { return rejectedCount.load(); }
+  size_t bucketCount() const;
+
+ private:
+  using Bucket = std::atomic<int64_t>;
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<Bucket>> buckets;
+    // Guarded by the exclusive lock.
+    size_t addedSinceSweep = 0;
+    std::minstd_rand random;
+  };
+
+  Limit defaultLimit;
+  std::unordered_map<std::string, Limit> routeLimits;
+  size_t maxBucketsPerShard;
+  std::vector<Shard> shards;
+  std::atomic<long long> rejectedCount{0};
+
+  Bucket& add(Shard& shard, const std::string& key, int64_t now);
+  static void sweep(Shard& shard, int64_t now);
+  static void evictOne(Shard& shard);
+};
@@ -0,0 +1,49 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+/**
+ * @brief Allocator statistics, as reported by /status/arena.
+ */
+struct ArenaStats {
+  uint64_t requests = 0;
+  uint64_t bytes = 0;
+  uint64_t peakBytes = 0;
+  uint64_t overflows = 0;
+  size_t blockBytes = 0;
+};
+
+/**
+ * @brief A per-thread monotonic arena for the short-lived allocations of one
+ * request.
+ *
+ * Each Crow worker thread owns one block of blockBytes() bytes. While a
+ * Scope is open, resource() hands out memory from that block by bumping a
+ * pointer; nothing is freed individually, and the whole block is reset when
+ * the outermost Scope closes at the end of the request. A request that
+ * outgrows the block continues in memory from the global heap, which is
+ * returned at the same point and counted as an overflow. No locks are taken,
+ * so worker threads never contend on the allocator for this memory.
+ *
+ * Outside a Scope, resource() is the default heap resource, so PMR
+ * containers built by tests and background threads behave as usual. Memory
+ * from the arena must not outlive the Scope; copies of PMR containers use
+ * the default resource, so copying is the way to keep data.
+ */
+class RequestArena {
+ public:
+  class Scope {
+   public:
+    Scope();
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+  static std::pmr::memory_resource* resource();
+  static size_t blockBytes();
+  static ArenaStats stats();
+};
@@ -0,0 +1,52 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "JsonScanner.h"
+
+/**
+ * @brief A JSON request body, parsed once and shared by the route handler,
+ * the service and the notifier.
+ *
+ * Every endpoint takes a flat object of string fields, so the body is
+ * flattened into (key, value) pairs in document order. A body that is not
+ * valid JSON, or has a non-string field, is kept with valid() == false and
+ * the parse error, so the layer that used to parse it can still report it
+ * in the same way. Parsing is done by JsonScanner, without building an
+ * intermediate BSON document.
+ *
+ * The fields are allocated from RequestArena::resource(), so a body parsed
+ * while a request is being handled lives in that request's arena and must
+ * not be kept past it. A copy of the body uses the default heap.
+ */
+class RequestBody {
+ public:
+  // Implicit so that callers holding a raw JSON string keep working. A
+  // body passed as an rvalue is moved in rather than copied.
+  RequestBody(const std::string& json);  // NOLINT(runtime/explicit)
+  RequestBody(std::string&& json);       // NOLINT(runtime/explicit)
+  RequestBody(const char* json);         // NOLINT(runtime/explicit)
+  RequestBody(const std::string& json,
+              const std::vector<std::string>& allowedKeys);
+
+  bool valid() const { return parseError.empty(); }
+  const std::string& error() const { return parseError; }
+  const std::string& raw() const { return text; }
+  const JsonScanner::Fields& fields() const { return values; }
+
+  std::optional<std::string> get(const std::string& key) const;
+
+  friend bool operator==(const RequestBody& a, const RequestBody& b) {
+    return a.text == b.text;
+  }
+
+ private:
+  std::string text;
+  std::string parseError;
+  JsonScanner::Fields values;
+
+  void parse(const std::vector<std::string>* allowedKeys);
+};
@@ -0,0 +1,83 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Counters, as reported by /status/cache.
+ */
+struct ResponseCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t compressions = 0;
+  uint64_t bytes = 0;
+  uint64_t entries = 0;
+};
+
+/**
+ * @brief Recently served listings, each kept as sent and gzip-compressed.
+ *
+ * Entries are keyed by ETag, which already names the collection, its
+ * version and the page, so an entry never goes stale: a write changes the
+ * tag, and the old entry simply stops being asked for and ages out. A
+ * listing is compressed the first time a client that accepts gzip asks for
+ * it, and every later request for that version gets the same bytes, so a
+ * hot page is compressed once rather than per request. The least recently
+ * used entries are dropped once the cache holds more than maxBytes.
+ *
+ * Bodies below minCompressBytes are always sent as they are, since gzip's
+ * framing outweighs the saving. Level 0 turns compression off.
+ */
+class ResponseCache {
+ public:
+  enum class Encoding { Identity, Gzip };
+
+  struct Representation {
+    std::shared_ptr<const std::string> body;
+    Encoding encoding = Encoding::Identity;
+  };
+
+  ResponseCache(size_t maxBytes, size_t minCompressBytes, int level);
+
+  std::optional<Representation> find(const std::string& etag,
+                                     Encoding accepted);
+  Representation store(const std::string& etag, std::string body,
+                       Encoding accepted);
+  ResponseCacheStats stats() const;
+
+  static Encoding negotiate(std::string_view acceptEncoding);
+  static std::string taggedFor(const std::string& etag, Encoding encoding);
+  static std::string gzip(std::string_view body, int level);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const std::string> identity;
+    std::shared_ptr<const std::string> gzip;
+    std::list<std::string>::iterator recency;
+  };
+
+  size_t maxBytes;
+  size_t minCompressBytes;
+  int level;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, Entry> entries;
+  std::list<std::string> recency;
+  size_t bytes = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t compressions = 0;
+
+  bool compresses(const std::string& body, Encoding accepted) const;
+  Representation addGzip(const std::string& etag,
+                         std::shared_ptr<const std::string> identity);
+  void evict();
+};
@@ -0,0 +1,35 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <bsoncxx/document/value.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The encodings a listing can be sent in, chosen by the Accept
+ * header.
+ *
+ * JSON stays the default. Clients that can parse binary ask for one of:
+ * - application/bson: the documents exactly as MongoDB returned them, one
+ *   after another. Each starts with its own length, so a client reads them
+ *   in sequence without any framing of ours.
+ * - application/msgpack (or x-msgpack, vnd.msgpack): an array of maps.
+ * - application/cbor: an array of maps.
+ *
+ * MessagePack and CBOR are written straight from the BSON, without going
+ * through JSON. ObjectIds become their hex strings and dates their
+ * milliseconds since the epoch, so a document reads the same in every
+ * format; binary data stays binary.
+ */
+class ResponseFormat {
+ public:
+  enum class Format { Json, Bson, MessagePack, Cbor };
+
+  static Format negotiate(std::string_view accept);
+  static const char* contentType(Format format);
+  static const char* name(Format format);
+  static std::string variant(int start, Format format);
+  static std::string encode(
+      const std::vector<bsoncxx::document::value>& documents, Format format);
+};
@@ -0,0 +1,81 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+/**
+ * @brief Categories of failure a service can report to the route layer.
+ */
+enum class ErrorCode {
+  InvalidInput,
+  Unauthorized,
+  Forbidden,
+  NotFound,
+  Conflict,
+  Unavailable,
+  Timeout,
+  Internal,
+};
+
+/**
+ * @brief A failure with its category and the message sent to the client.
+ */
+struct Error {
+  ErrorCode code = ErrorCode::Internal;
+  std::string message;
+
+  int httpStatus() const {
+    switch (code) {
+      case ErrorCode::InvalidInput:
+        return 400;
+      case ErrorCode::Unauthorized:
+        return 401;
+      case ErrorCode::Forbidden:
+        return 403;
+      case ErrorCode::NotFound:
+        return 404;
+      case ErrorCode::Conflict:
+        return 409;
+      case ErrorCode::Unavailable:
+        return 503;
+      case ErrorCode::Timeout:
+        return 504;
+      default:
+        return 500;
+    }
+  }
+};
+
+/**
+ * @brief Either a value or an Error, in the spirit of std::expected.
+ *
+ * Validation failures are returned rather than thrown, so rejecting a
+ * malformed request costs no stack unwinding, and the caller branches on
+ * ok() instead of searching the returned text for "Error".
+ */
+template <typename T>
+class Result {
+ public:
+  template <typename U = T,
+            typename = std::enable_if_t<
+                std::is_constructible_v<T, U&&> &&
+                !std::is_same_v<std::decay_t<U>, Error> &&
+                !std::is_same_v<std::decay_t<U>, Result>>>
+  Result(U&& value)  // NOLINT(runtime/explicit)
+      : state(std::in_place_index<0>, std::forward<U>(value)) {}
+  Result(Error error)  // NOLINT(runtime/explicit)
+      : state(std::in_place_index<1>, std::move(error)) {}
+
+  bool ok() const { return state.index() == 0; }
+  explicit operator bool() const { return ok(); }
+
+  const T& value() const { return std::get<0>(state); }
+  T& value() { return std::get<0>(state); }
+  const Error& error() const { return std::get<1>(state); }
+
+ private:
+  std::variant<T, Error> state;
+};
@@ -1,6 +1,7 @@
 #ifndef ROUTECONTROLLER_H
 #define ROUTECONTROLLER_H
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <exception>
 #include <iostream>
 #include <map>
@@ -10,12 +11,22 @@
 #include <string>
 
 #include "../external_libraries/Crow/include/crow.h"
+#include "AdmissionController.h"
+#include "AsyncExecutor.h"
 #include "Auth.h"
+#include "CatalogueReplica.h"
+#include "ChangeFeed.h"
+#include "ChangeJournal.h"
+#include "ChangeStreamWatcher.h"
 #include "Counseling.h"
 #include "DatabaseManager.h"
 #include "Food.h"
 #include "Healthcare.h"
+#include "ListingFilter.h"
 #include "Outreach.h"
+#include "RateLimiter.h"
+#include "ResponseCache.h"
+#include "ResponseFormat.h"
 #include "Shelter.h"
 #include "SubscriptionManager.h"
 
@@ -29,15 +40,58 @@ class RouteController {
   Food& foodManager;
   AuthService& authService;
   SubscriptionManager& subscriptionManager;
+  AsyncExecutor* executor;
+  AdmissionController* admission;
+  RateLimiter* rateLimiter;
+  ResponseCache* responseCache;
+  ChangeFeed* changeFeed;
+  ChangeJournal* changeJournal;
+  ChangeStreamWatcher* watcher;
+  CatalogueReplica* catalogue;
+
+  using Handler = void (RouteController::*)(const crow::request&,
+                                             crow::response&);
 
   bool authenticateToken(const crow::request& req, crow::response& res);
+  void dispatch(Handler handler, const crow::request& req,
+                crow::response& res);
+  void dispatchAsync(RouteClass routeClass, Handler handler,
+                     const crow::request& req, crow::response& res);
+  bool serveListing(const crow::request& req, crow::response& res,
+                    const std::string& etag, ResponseFormat::Format format);
+  void sendListing(const crow::request& req, crow::response& res,
+                   const std::string& etag, const std::string& body);
+  void writeRepresentation(
+      crow::response& res, const std::string& etag,
+      const ResponseCache::Representation& representation);
+  bool withinRateLimit(const crow::request& req, crow::response& res,
+                       std::string& verified);
+  void publishChange(const std::string& resource, const std::string& action,
+                     const std::string& id, const std::string& city,
+                     const std::string& document = "");
+  ListingFilter listingFilter(const crow::request& req);
+  bool acceptsFilter(const ListingFilter& filter,
+                     const ListingFilterSpec& spec, crow::response& res);
+  bool replicates(const std::string& collection);
+  void initFeed(crow::SimpleApp& app);
+  bool admit(RouteClass routeClass, const crow::request& req,
+             crow::response& res, AdmissionController::Clock::time_point now);
+  static std::chrono::milliseconds requestBudget();
 
  public:
   RouteController(DatabaseManager& dbManager, Shelter& shelterManager,
                   Counseling& counselingManager, Healthcare& healthcareManager,
                   Outreach& outreachManager, Food& foodManager,
                   AuthService& authService,
-                  SubscriptionManager& subscriptionManager)
+                  SubscriptionManager& subscriptionManager,
+                  AsyncExecutor* executor = nullptr,
+                  AdmissionController* admission = nullptr,
+                  RateLimiter* rateLimiter = nullptr,
+                  ResponseCache* responseCache = nullptr,
+                  ChangeFeed* changeFeed = nullptr,
+                  ChangeJournal* changeJournal = nullptr,
+                  ChangeStreamWatcher* watcher = nullptr,
+                  CatalogueReplica* catalogue = nullptr)
       : dbManager(dbManager),
         shelterManager(shelterManager),
         counselingManager(counselingManager),
@@ -45,14 +99,35 @@ class RouteController {
         outreachManager(outreachManager),
         foodManager(foodManager),
         authService(authService),
-        subscriptionManager(subscriptionManager) {}
+        subscriptionManager(subscriptionManager),
+        executor(executor),
+        admission(admission),
+        rateLimiter(rateLimiter),
+        responseCache(responseCache),
+        changeFeed(changeFeed),
+        changeJournal(changeJournal),
+        watcher(watcher),
+        catalogue(catalogue) {}
+  ~RouteController();
+  RouteController(const RouteController&) = delete;
+  RouteController& operator=(const RouteController&) = delete;
 
   void initRoutes(crow::SimpleApp& app);
+  void shutdown();
   void index(crow::response& res);
   std::optional<std::string> get_param(
       const std::map<std::string, std::string>& params, const std::string& key);
 
   void subscribeToResources(const crow::request& req, crow::response& res);
+  void getWebhookStatus(const crow::request& req, crow::response& res);
+  void getArenaStatus(const crow::request& req, crow::response& res);
+  void getAdmissionStatus(const crow::request& req, crow::response& res);
+  void getCacheStatus(const crow::request& req, crow::response& res);
+  void getFeedStatus(const crow::request& req, crow::response& res);
+  void getJournalStatus(const crow::request& req, crow::response& res);
+  void getWatcherStatus(const crow::request& req, crow::response& res);
+  void getCatalogueStatus(const crow::request& req, crow::response& res);
+  void getChanges(const crow::request& req, crow::response& res);
 
   // Shelter-related handlers
   void addShelter(const crow::request& req, crow::response& res);
@@ -1,28 +1,49 @@
 // Copyright 2024 Wilson, Liang
 #ifndef SHELTER_H
 #define SHELTER_H
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "DatabaseManager.h"
+#include "ListingFilter.h"
+#include "RequestBody.h"
+#include "ResponseFormat.h"
+#include "Result.h"
 
 class Shelter {
  public:
+  using Fields = std::map<std::string, std::string, std::less<>>;
+
+  static const ListingFilterSpec kFilterSpec;
+
   Shelter(DatabaseManager& dbManager, std::string collection_name);
-  void cleanCache();
-  std::string checkInputFormat(std::string content, std::string request_auth);
-  virtual std::string addShelter(std::string request_body, std::string request_auth);
-  virtual std::string deleteShelter(std::string id, std::string request_auth);
+  Fields emptyFields() const;
+  Result<std::string> checkInputFormat(const RequestBody& body,
+                                       std::string_view request_auth,
+                                       Fields& fields) const;
+  virtual Result<std::string> addShelter(const RequestBody& request_body,
+                                         std::string_view request_auth);
+  virtual std::string deleteShelter(const std::string& id,
+                                    const std::string& request_auth);
   virtual std::string searchShelterAll(int start = 0);
-  virtual std::string updateShelter(std::string request_body, std::string request_auth);
-  std::vector<std::pair<std::string, std::string>> createDBContent();
+  std::string listingETag(
+      int start = 0,
+      ResponseFormat::Format format = ResponseFormat::Format::Json,
+      const ListingFilter& filter = {}) const;
+  std::string encodedListing(int start, ResponseFormat::Format format,
+                             const ListingFilter& filter = {});
+  virtual Result<std::string> updateShelter(const RequestBody& request_body,
+                                            std::string_view request_auth);
+  std::vector<std::pair<std::string, std::string>> createDBContent(
+      Fields fields) const;
   std::string printShelters(
       std::vector<bsoncxx::document::value>& shelters) const;
   // std::string getShelterID(bsoncxx::document::value& shelter);
   std::string collection_name;
-  std::unordered_map<std::string, std::string> format;
 
  private:
   DatabaseManager& dbManager;
@@ -0,0 +1,50 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#pragma once
+
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief In-memory index from (resource, city) to subscriber contacts.
+ *
+ * Either side of a subscription may be the wildcard "*" (or "all"), meaning
+ * every resource or every city. A lookup visits at most four buckets, so
+ * matching costs O(matches) and never touches the database.
+ */
+class SubscriberIndex {
+ public:
+  static const char kWildcard[];
+
+  void add(const std::string& id, const std::string& resource,
+           const std::string& city, const std::string& contact);
+  bool remove(const std::string& id);
+  void clear();
+  std::map<std::string, std::string> match(const std::string& resource,
+                                           const std::string& city) const;
+  size_t size() const;
+  void forEach(const std::function<void(
+                   const std::string& id, const std::string& resource,
+                   const std::string& city, const std::string& contact)>&
+                   visitor) const;
+
+  static std::string normalize(const std::string& value);
+
+ private:
+  struct Entry {
+    std::string resource;
+    std::string city;
+  };
+  using ContactsById = std::unordered_map<std::string, std::string>;
+
+  mutable std::shared_mutex mutex;
+  // resource -> city -> subscriber id -> contact
+  std::unordered_map<std::string, std::unordered_map<std::string, ContactsById>>
+      buckets;
+  std::unordered_map<std::string, Entry> entries;
+
+  void collect(const std::string& resource, const std::string& city,
+               std::map<std::string, std::string>& out) const;
+};
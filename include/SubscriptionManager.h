@@ -1,15 +1,38 @@
 // Copyright 2024 COMSW4156-Git-Gud
 #pragma once
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
+#include "AsyncExecutor.h"
+#include "CircuitBreakerRegistry.h"
 #include "DatabaseManager.h"
+#include "NotificationCoalescer.h"
+#include "NotificationOutbox.h"
+#include "SubscriberIndex.h"
 
 class SubscriptionManager {
  public:
   SubscriptionManager(DatabaseManager& dbManager);
+  virtual ~SubscriptionManager();
+  virtual void loadSubscribers();
+  void reconcileSubscribers();
+  void refreshSubscriber(const bsoncxx::document::view& document);
+  void forgetSubscriber(const std::string& id);
+  void forEachSubscriber(
+      const std::function<void(const bsoncxx::document::view&)>& visitor)
+      const;
+  void startDispatcher();
+  void stopDispatcher();
+  void flushNotifications();
+  std::vector<HostStatus> webhookStatus() const;
   virtual std::string addSubscriber(
       const std::map<std::string, std::string>& subscriberDetails);
   virtual std::string deleteSubscriber(const std::string& id);
@@ -20,8 +43,33 @@ class SubscriptionManager {
 
  private:
   DatabaseManager& dbManager;
+  SubscriberIndex index;
+  NotificationCoalescer coalescer;
+  CircuitBreakerRegistry webhookBreakers;
+  long webhookConnectTimeoutMs;
+  long webhookTimeoutMs;
+  long smtpTimeoutMs;
+  std::chrono::milliseconds deliveryDeadline;
+  int deliveryWorkers;
+  NotificationOutbox outbox;
+  int outboxBatch;
 
-  void sendEmail(const std::string& to, const std::string& subject,
+  std::thread dispatcher;
+  std::mutex dispatcherMutex;
+  std::condition_variable dispatcherWake;
+  bool dispatcherRunning = false;
+  // Runs the dispatcher's sends while it is running.
+  std::unique_ptr<AsyncExecutor> deliveryPool;
+
+  enum class DeliveryOutcome { Delivered, Failed, Deferred };
+
+  void stageEvents(NotificationOutbox::Clock::time_point now);
+  void sendDue(NotificationOutbox::Clock::time_point now);
+  void send(const OutboxDelivery& delivery);
+  DeliveryOutcome deliver(const NotificationDigest& digest);
+  void indexSubscriber(const bsoncxx::document::view& view);
+
+  bool sendEmail(const std::string& to, const std::string& subject,
                  const std::string& content);
-  void sendWebhook(const std::string& url, const std::string& payload);
+  bool sendWebhook(const std::string& url, const std::string& payload);
 };
@@ -0,0 +1,159 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "AdmissionController.h"
+
+#include <algorithm>
+
+namespace {
+
+// Multiples of the target delay at which each class is shed, indexed by
+// RouteClass: reads hold out longest, Auth goes first.
+constexpr std::array<int, 3> kShedAt = {4, 2, 1};
+
+// Shortest interval over which the minimum queueing delay is taken.
+constexpr std::chrono::milliseconds kMinInterval(100);
+
+}  // namespace
+
+/**
+ * @brief Sets up the controller.
+ *
+ * @param targetDelay Queueing delay above which shedding starts.
+ * @param maxRead Cap on read requests in flight.
+ * @param maxWrite Cap on write requests in flight.
+ * @param maxAuth Cap on registration and login requests in flight.
+ */
+AdmissionController::AdmissionController(Clock::duration targetDelay,
+                                         int maxRead, int maxWrite,
+                                         int maxAuth)
+    : targetDelay(targetDelay),
+      interval(std::max<Clock::duration>(kMinInterval, targetDelay * 2)),
+      intervalStart(Clock::now()) {
+  classes[static_cast<int>(RouteClass::Read)].maxInFlight =
+      std::max(1, maxRead);
+  classes[static_cast<int>(RouteClass::Write)].maxInFlight =
+      std::max(1, maxWrite);
+  classes[static_cast<int>(RouteClass::Auth)].maxInFlight =
+      std::max(1, maxAuth);
+}
+
+/**
+ * @brief Decides whether to let a request in.
+ *
+ * Every admitted request must be paired with finished().
+ *
+ * @param routeClass The class of the route being requested.
+ * @param now The current time.
+ * @return Admit; Busy if the class is at its cap (429); Overloaded if the
+ *         queueing delay is too high for the class (503).
+ */
+AdmissionController::Decision AdmissionController::admit(
+    RouteClass routeClass, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex);
+  roll(now);
+  ClassState& state = classes[static_cast<int>(routeClass)];
+  if (delay > targetDelay * kShedAt[static_cast<int>(routeClass)]) {
+    state.shedOverloaded++;
+    return Decision::Overloaded;
+  }
+  if (state.inFlight >= state.maxInFlight) {
+    state.shedBusy++;
+    return Decision::Busy;
+  }
+  state.inFlight++;
+  state.admitted++;
+  return Decision::Admit;
+}
+
+/**
+ * @brief Records how long an admitted request waited for a handler thread.
+ */
+void AdmissionController::started(Clock::duration queued,
+                                  Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex);
+  roll(now);
+  intervalMin = std::min(intervalMin, queued);
+}
+
+/**
+ * @brief Releases the slot taken by an admitted request.
+ */
+void AdmissionController::finished(RouteClass routeClass) {
+  std::lock_guard<std::mutex> lock(mutex);
+  ClassState& state = classes[static_cast<int>(routeClass)];
+  state.inFlight = std::max(0, state.inFlight - 1);
+}
+
+/**
+ * @brief Returns the current queueing delay estimate.
+ */
+AdmissionController::Clock::duration AdmissionController::queueDelay(
+    Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex);
+  roll(now);
+  return delay;
+}
+
+/**
+ * @brief Returns how long a shed client should wait before retrying: the
+ * queueing delay rounded up to whole seconds, and at least 1.
+ */
+int AdmissionController::retryAfterSeconds(Clock::time_point now) {
+  auto seconds = std::chrono::ceil<std::chrono::seconds>(queueDelay(now));
+  return std::max(1, static_cast<int>(seconds.count()));
+}
+
+/**
+ * @brief Returns the counters of every route class.
+ */
+std::vector<AdmissionStatus> AdmissionController::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<AdmissionStatus> result;
+  for (RouteClass routeClass :
+       {RouteClass::Read, RouteClass::Write, RouteClass::Auth}) {
+    const ClassState& state = classes[static_cast<int>(routeClass)];
+    AdmissionStatus status;
+    status.routeClass = name(routeClass);
+    status.inFlight = state.inFlight;
+    status.maxInFlight = state.maxInFlight;
+    status.admitted = state.admitted;
+    status.shedBusy = state.shedBusy;
+    status.shedOverloaded = state.shedOverloaded;
+    result.push_back(status);
+  }
+  return result;
+}
+
+const char* AdmissionController::name(RouteClass routeClass) {
+  switch (routeClass) {
+    case RouteClass::Read:
+      return "read";
+    case RouteClass::Write:
+      return "write";
+    case RouteClass::Auth:
+      return "auth";
+  }
+  return "unknown";
+}
+
+/**
+ * @brief Closes the current interval once it has run its length. Its
+ * minimum becomes the delay estimate. An interval in which no request
+ * started keeps the previous estimate while requests are still in flight,
+ * since they may all be stuck behind slow handlers, and resets it to zero
+ * once the server is idle.
+ */
+void AdmissionController::roll(Clock::time_point now) {
+  if (now - intervalStart < interval) {
+    return;
+  }
+  if (intervalMin != Clock::duration::max()) {
+    delay = intervalMin;
+  } else if (std::none_of(classes.begin(), classes.end(),
+                          [](const ClassState& state) {
+                            return state.inFlight > 0;
+                          })) {
+    delay = Clock::duration::zero();
+  }
+  intervalMin = Clock::duration::max();
+  intervalStart = now;
+}
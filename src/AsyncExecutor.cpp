@@ -0,0 +1,95 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "AsyncExecutor.h"
+
+#include <algorithm>
+
+#include "Deadline.h"
+#include "Logger.h"
+
+/**
+ * @brief Starts the pool.
+ *
+ * @param threads Number of threads (at least 1).
+ * @param maxQueued Tasks that may wait for a thread before post() refuses
+ * more (at least 1).
+ */
+AsyncExecutor::AsyncExecutor(size_t threads, size_t maxQueued)
+    : maxQueued(std::max<size_t>(1, maxQueued)) {
+  threads = std::max<size_t>(1, threads);
+  workers.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([this] { run(); });
+  }
+}
+
+AsyncExecutor::~AsyncExecutor() { stop(); }
+
+/**
+ * @brief Refuses further tasks, runs the ones already queued and joins the
+ * threads. Later calls wait for the first to finish and do nothing else.
+ * Must not be called from a task.
+ */
+void AsyncExecutor::stop() {
+  std::call_once(stopped, [this] {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  });
+}
+
+/**
+ * @brief Queues a task. The task runs under the caller's request deadline,
+ * if it has one.
+ *
+ * @return false if the queue is full or the executor is shutting down; the
+ * task is not run.
+ */
+bool AsyncExecutor::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping || queue.size() >= maxQueued) {
+      return false;
+    }
+    queue.push_back([deadline = Deadline::current(), task = std::move(task)] {
+      Deadline::Scope scope(deadline);
+      task();
+    });
+  }
+  wake.notify_one();
+  return true;
+}
+
+/**
+ * @brief Returns the number of tasks waiting for a thread.
+ */
+size_t AsyncExecutor::pending() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return queue.size();
+}
+
+void AsyncExecutor::run() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      task = std::move(queue.front());
+      queue.pop_front();
+    }
+    try {
+      task();
+    } catch (const std::exception& e) {
+      LOG_ERROR("AsyncExecutor", "Task failed: {}", e.what());
+    } catch (...) {
+      LOG_ERROR("AsyncExecutor", "Task failed with an unknown exception");
+    }
+  }
+}
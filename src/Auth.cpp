@@ -12,6 +12,7 @@
 #include <bsoncxx/json.hpp>
 #include <bcrypt/BCrypt.hpp>
 
+#include "Deadline.h"
 
 // Constructor
 AuthService::AuthService(DatabaseManager& dbManager) : dbManager(dbManager) {}
@@ -31,13 +32,15 @@ std::string AuthService::registerUser(const std::string& email,
     throw AuthException("Password does not meet requirements");
   }
 
-  // Check if user already exists
-  if (findUserByEmail(email)) {
+  // The duplicate check and the bcrypt hash are independent, so the lookup
+  // runs on the database executor while the password is hashed here.
+  auto existing =
+      dbManager.findCollectionAsync(0, collection_name, {{"email", email}});
+  std::string hashedPassword = hashPassword(password);
+  if (!existing.get().empty()) {
     throw UserAlreadyExistsException();
   }
 
-  // Hash password and create user
-  std::string hashedPassword = hashPassword(password);
   auto userDoc = createUserDocument(email, hashedPassword);
 
   try {
@@ -56,6 +59,8 @@ std::string AuthService::registerUser(const std::string& email,
     User newUser(email, hashedPassword, role);
     newUser.id = userView["_id"].get_oid().value.to_string();
     return generateJWT(newUser);
+  } catch (const DeadlineExceeded&) {
+    throw;
   } catch (const std::exception& e) {
     throw AuthException("Failed to create user: " + std::string(e.what()));
   }
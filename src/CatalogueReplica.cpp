@@ -0,0 +1,517 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "CatalogueReplica.h"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/json.hpp>
+#include <utility>
+
+#include "CollectionVersions.h"
+#include "Logger.h"
+
+namespace {
+
+// Rows compared per pass of the filter scan; the mask lives on the stack.
+constexpr size_t kBlock = 256;
+
+// Rows per chunk when a collection is loaded. Inserts split a chunk in two
+// once it reaches twice this, and a chunk that falls under half of it is
+// folded into a neighbour, so a change copies at most a few hundred rows.
+constexpr size_t kChunkRows = 256;
+
+std::string stringField(const bsoncxx::document::view& document,
+                        const std::string& name) {
+  if (name.empty()) {
+    return "";
+  }
+  auto element = document[name];
+  if (!element || element.type() != bsoncxx::type::k_utf8) {
+    return "";
+  }
+  return element.get_utf8().value.to_string();
+}
+
+}  // namespace
+
+uint32_t CatalogueReplica::Dictionary::find(const std::string& value) const {
+  auto found = codes.find(value);
+  return found == codes.end() ? 0 : found->second;
+}
+
+/**
+ * @brief Sets up an empty replica of the given collections. Nothing is
+ * served from a collection until load() has been called for it.
+ *
+ * @param dbManager Where collections are loaded from.
+ * @param collections The collections to hold, each with the fields its
+ * listings are filtered on.
+ * @param pageSize Documents per listing page, as with findCollection.
+ */
+CatalogueReplica::CatalogueReplica(
+    DatabaseManager& dbManager,
+    const std::vector<std::pair<std::string, ListingFilterSpec>>& collections,
+    int pageSize)
+    : dbManager(dbManager), pageSize(std::max(1, pageSize)) {
+  for (const auto& [collection, spec] : collections) {
+    auto slot = std::make_unique<Slot>();
+    slot->collection = collection;
+    slot->fields[kCity] = spec.city;
+    slot->fields[kTargetUser] = spec.targetUser;
+    slot->fields[kOrg] = spec.org;
+    slots.emplace(collection, std::move(slot));
+  }
+}
+
+/**
+ * @brief Reads a whole collection and publishes it as a new snapshot.
+ *
+ * @throws std::exception If the collection cannot be read.
+ */
+void CatalogueReplica::load(const std::string& collection) {
+  Slot* slot = slotFor(collection);
+  if (slot == nullptr) {
+    return;
+  }
+  // Changes wait for the scan, so none is lost between the scan and the
+  // swap; those the scan already saw are applied again, harmlessly.
+  std::lock_guard<std::mutex> lock(slot->writing);
+  std::vector<std::shared_ptr<const Row>> rows;
+  dbManager.scanCollection(collection,
+                           [&rows](const bsoncxx::document::view& document) {
+                             rows.push_back(makeRow(document));
+                           });
+  LOG_INFO("CatalogueReplica", "Loaded {} documents from {}", rows.size(),
+           collection);
+  replace(*slot, std::move(rows));
+}
+
+/**
+ * @brief Publishes documents saved by an earlier run, e.g. from a snapshot
+ * file, so listings can be served before load() has read the collection.
+ *
+ * @param collection The collection the documents belong to.
+ * @param documents Its documents; they are copied.
+ */
+void CatalogueReplica::restore(
+    const std::string& collection,
+    const std::vector<bsoncxx::document::view>& documents) {
+  Slot* slot = slotFor(collection);
+  if (slot == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(slot->writing);
+  std::vector<std::shared_ptr<const Row>> rows;
+  rows.reserve(documents.size());
+  for (const auto& document : documents) {
+    rows.push_back(makeRow(document));
+  }
+  LOG_INFO("CatalogueReplica", "Restored {} documents of {}", rows.size(),
+           collection);
+  replace(*slot, std::move(rows));
+}
+
+/**
+ * @brief Applies a change from the collection's change stream. Inserts and
+ * updates replace the whole document, so a change applied twice leaves the
+ * same result.
+ */
+void CatalogueReplica::apply(const ChangeEvent& event) {
+  if (event.operation == ChangeEvent::Operation::Reset) {
+    load(event.collection);
+    return;
+  }
+  Slot* slot = slotFor(event.collection);
+  if (slot == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(slot->writing);
+  auto current = std::atomic_load(&slot->current);
+  if (!current) {
+    return;  // Not loaded yet; load() will read the change.
+  }
+  std::shared_ptr<const Row> row;
+  std::string id = event.id;
+  if (event.operation != ChangeEvent::Operation::Delete) {
+    if (!event.document) {
+      return;  // Deleted again since; its delete follows.
+    }
+    row = makeRow(event.document->view());
+    id = row->id;
+  }
+
+  auto next = std::make_shared<Snapshot>(*current);
+  auto& chunks = next->chunks;
+  // The chunk the id belongs in: the first one that does not end before
+  // it, or the last one for an id past them all.
+  auto found = std::lower_bound(
+      chunks.begin(), chunks.end(), id,
+      [](const auto& chunk, const std::string& key) {
+        return chunk->rows.back()->id < key;
+      });
+  if (found == chunks.end()) {
+    if (!row) {
+      return;
+    }
+    if (chunks.empty()) {
+      chunks.push_back(std::make_shared<const Chunk>());
+    }
+    found = chunks.end() - 1;
+  }
+  size_t at = found - chunks.begin();
+  auto chunk = std::make_shared<Chunk>(**found);
+  auto position = std::lower_bound(
+      chunk->rows.begin(), chunk->rows.end(), id,
+      [](const auto& existing, const std::string& key) {
+        return existing->id < key;
+      });
+  size_t index = position - chunk->rows.begin();
+  bool exists = position != chunk->rows.end() && (*position)->id == id;
+  if (!row) {
+    if (!exists) {
+      return;
+    }
+    chunk->rows.erase(position);
+    for (auto& column : chunk->columns) {
+      column.erase(column.begin() + index);
+    }
+    next->size--;
+  } else {
+    if (exists) {
+      *position = row;
+    } else {
+      chunk->rows.insert(position, row);
+      for (auto& column : chunk->columns) {
+        column.insert(column.begin() + index, 0);
+      }
+      next->size++;
+    }
+    encodeRow(*slot, *next, *chunk, index, *row);
+  }
+
+  // Fold a chunk that has shrunk into a neighbour, and split one that has
+  // grown, so chunks stay a few hundred rows long.
+  if (chunk->rows.size() < kChunkRows / 2 && chunks.size() > 1) {
+    size_t other = at + 1 < chunks.size() ? at + 1 : at - 1;
+    auto merged = std::make_shared<Chunk>();
+    append(*merged, other < at ? *chunks[other] : *chunk);
+    append(*merged, other < at ? *chunk : *chunks[other]);
+    chunks.erase(chunks.begin() + std::max(at, other));
+    at = std::min(at, other);
+    chunk = std::move(merged);
+  }
+  if (chunk->rows.empty()) {
+    chunks.erase(chunks.begin() + at);
+  } else if (chunk->rows.size() >= 2 * kChunkRows) {
+    auto tail = splitOff(*chunk);
+    chunks[at] = std::move(chunk);
+    chunks.insert(chunks.begin() + at + 1, std::move(tail));
+  } else {
+    chunks[at] = std::move(chunk);
+  }
+  publish(*slot, std::move(next));
+}
+
+/**
+ * @brief Returns true once the collection has been loaded.
+ */
+bool CatalogueReplica::loaded(const std::string& collection) const {
+  Slot* slot = slotFor(collection);
+  return slot != nullptr && std::atomic_load(&slot->current) != nullptr;
+}
+
+/**
+ * @brief Returns the ETag of a listing page served from the replica. It
+ * follows the replica's snapshots rather than the collection's writes, so a
+ * page is never tagged with a write the snapshot does not have yet.
+ */
+std::string CatalogueReplica::listingETag(const std::string& collection,
+                                          int start,
+                                          ResponseFormat::Format format,
+                                          const ListingFilter& filter) const {
+  return CollectionVersions::etag(
+      versionKey(collection),
+      ResponseFormat::variant(start, format) + filter.variant());
+}
+
+/**
+ * @brief Returns a listing page from the current snapshot, with the same
+ * paging as findCollection.
+ *
+ * @param collection The collection to list.
+ * @param start How many matching documents to skip.
+ * @param format The format to write.
+ * @param filter Fields the documents must have.
+ * @return The page, or an empty listing if the collection is not loaded.
+ */
+std::string CatalogueReplica::listing(const std::string& collection,
+                                      int start, ResponseFormat::Format format,
+                                      const ListingFilter& filter) {
+  Slot* slot = slotFor(collection);
+  std::shared_ptr<const Snapshot> snapshot;
+  if (slot != nullptr) {
+    snapshot = std::atomic_load(&slot->current);
+    slot->reads++;
+  }
+  std::vector<const Row*> rows;
+  if (snapshot) {
+    rows = page(*snapshot, std::max(0, start), filter);
+  }
+
+  if (format == ResponseFormat::Format::Json) {
+    if (rows.empty()) {
+      return "[]";
+    }
+    std::string body = "[";
+    for (size_t i = 0; i < rows.size(); ++i) {
+      if (i > 0) {
+        body += ", ";
+      }
+      body += rows[i]->json;
+    }
+    body += "]";
+    return body;
+  }
+  std::vector<bsoncxx::document::value> documents;
+  documents.reserve(rows.size());
+  for (const Row* row : rows) {
+    documents.push_back(row->document);
+  }
+  return ResponseFormat::encode(documents, format);
+}
+
+/**
+ * @brief Returns each collection's size, dictionary sizes and counters.
+ */
+std::vector<CatalogueStatus> CatalogueReplica::status() const {
+  std::vector<CatalogueStatus> result;
+  for (const auto& [collection, slot] : slots) {
+    CatalogueStatus status;
+    status.collection = collection;
+    status.reads = slot->reads;
+    auto snapshot = std::atomic_load(&slot->current);
+    if (snapshot) {
+      status.loaded = true;
+      status.documents = snapshot->size;
+      status.cities = snapshot->dictionaries[kCity]->values.size();
+      status.targetUsers = snapshot->dictionaries[kTargetUser]->values.size();
+      status.orgs = snapshot->dictionaries[kOrg]->values.size();
+      status.snapshots = snapshot->version;
+    }
+    result.push_back(status);
+  }
+  return result;
+}
+
+/**
+ * @brief Visits every document of the collection's current snapshot, in _id
+ * order. Used to write snapshot files.
+ *
+ * @return false, without visiting anything, if the collection is not loaded.
+ */
+bool CatalogueReplica::scan(
+    const std::string& collection,
+    const std::function<void(const bsoncxx::document::view&)>& visitor)
+    const {
+  Slot* slot = slotFor(collection);
+  if (slot == nullptr) {
+    return false;
+  }
+  auto snapshot = std::atomic_load(&slot->current);
+  if (!snapshot) {
+    return false;
+  }
+  for (const auto& chunk : snapshot->chunks) {
+    for (const auto& row : chunk->rows) {
+      visitor(row->document.view());
+    }
+  }
+  return true;
+}
+
+CatalogueReplica::Slot* CatalogueReplica::slotFor(
+    const std::string& collection) const {
+  auto found = slots.find(collection);
+  return found == slots.end() ? nullptr : found->second.get();
+}
+
+// Publishes a snapshot of exactly these rows. The caller holds the slot's
+// writing lock.
+void CatalogueReplica::replace(Slot& slot,
+                               std::vector<std::shared_ptr<const Row>> rows) {
+  std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b) { return a->id < b->id; });
+  auto next = std::make_shared<Snapshot>();
+  next->size = rows.size();
+  for (auto& dictionary : next->dictionaries) {
+    dictionary = std::make_shared<Dictionary>();
+  }
+  for (size_t base = 0; base < rows.size(); base += kChunkRows) {
+    auto chunk = std::make_shared<Chunk>();
+    chunk->rows.assign(rows.begin() + base,
+                       rows.begin() + std::min(rows.size(), base + kChunkRows));
+    for (auto& column : chunk->columns) {
+      column.resize(chunk->rows.size());
+    }
+    for (size_t i = 0; i < chunk->rows.size(); ++i) {
+      encodeRow(slot, *next, *chunk, i, *chunk->rows[i]);
+    }
+    next->chunks.push_back(std::move(chunk));
+  }
+  publish(slot, std::move(next));
+}
+
+// Swaps in the next snapshot, then moves the ETag version on. A reader
+// takes the tag before the snapshot, so it never tags a page with a version
+// newer than the page.
+void CatalogueReplica::publish(Slot& slot, std::shared_ptr<Snapshot> next) {
+  auto current = std::atomic_load(&slot.current);
+  next->version = current ? current->version + 1 : 1;
+  std::atomic_store(&slot.current,
+                    std::shared_ptr<const Snapshot>(std::move(next)));
+  CollectionVersions::bump(versionKey(slot.collection));
+}
+
+// Returns the page's rows: with no filter a slice, and otherwise a scan of
+// the code columns for the filtered fields.
+std::vector<const CatalogueReplica::Row*> CatalogueReplica::page(
+    const Snapshot& snapshot, size_t start,
+    const ListingFilter& filter) const {
+  std::vector<const Row*> rows;
+  if (filter.empty()) {
+    for (const auto& chunk : snapshot.chunks) {
+      size_t count = chunk->rows.size();
+      if (start >= count) {
+        start -= count;
+        continue;
+      }
+      for (size_t i = start; i < count && rows.size() < pageSize; ++i) {
+        rows.push_back(chunk->rows[i].get());
+      }
+      if (rows.size() == pageSize) {
+        break;
+      }
+      start = 0;
+    }
+    return rows;
+  }
+
+  const std::string* wanted[kFields] = {&filter.city, &filter.targetUser,
+                                        &filter.org};
+  std::vector<std::pair<Field, uint32_t>> tests;
+  for (int field = 0; field < kFields; ++field) {
+    if (wanted[field]->empty()) {
+      continue;
+    }
+    uint32_t code = snapshot.dictionaries[field]->find(*wanted[field]);
+    if (code == 0) {
+      return rows;  // No document has this value.
+    }
+    tests.emplace_back(static_cast<Field>(field), code);
+  }
+
+  size_t skipped = 0;
+  uint8_t mask[kBlock];
+  for (const auto& chunk : snapshot.chunks) {
+    size_t total = chunk->rows.size();
+    for (size_t base = 0; base < total; base += kBlock) {
+      size_t count = std::min(kBlock, total - base);
+      std::fill(mask, mask + count, 1);
+      for (const auto& [field, code] : tests) {
+        const uint32_t* codes = chunk->columns[field].data() + base;
+        for (size_t i = 0; i < count; ++i) {
+          mask[i] &= static_cast<uint8_t>(codes[i] == code);
+        }
+      }
+      for (size_t i = 0; i < count; ++i) {
+        if (!mask[i]) {
+          continue;
+        }
+        if (skipped < start) {
+          skipped++;
+          continue;
+        }
+        rows.push_back(chunk->rows[base + i].get());
+        if (rows.size() == pageSize) {
+          return rows;
+        }
+      }
+    }
+  }
+  return rows;
+}
+
+std::string CatalogueReplica::versionKey(const std::string& collection) {
+  return collection + "/replica";
+}
+
+// Copies a document as findCollection would return it, without authToken,
+// and renders its JSON once.
+std::shared_ptr<const CatalogueReplica::Row> CatalogueReplica::makeRow(
+    const bsoncxx::document::view& document) {
+  bsoncxx::builder::basic::document copy;
+  for (const auto& element : document) {
+    if (element.key() != "authToken") {
+      copy.append(bsoncxx::builder::basic::kvp(element.key(),
+                                               element.get_value()));
+    }
+  }
+  std::string id;
+  auto key = document["_id"];
+  if (key && key.type() == bsoncxx::type::k_oid) {
+    id = key.get_oid().value.to_string();
+  } else if (key && key.type() == bsoncxx::type::k_utf8) {
+    id = key.get_utf8().value.to_string();
+  }
+  bsoncxx::document::value value = copy.extract();
+  std::string json = bsoncxx::to_json(value.view());
+  return std::make_shared<const Row>(
+      Row{std::move(id), std::move(value), std::move(json)});
+}
+
+// Sets the row's codes, adding values the dictionaries do not have yet to
+// copies of them, so earlier snapshots are left as they were.
+void CatalogueReplica::encodeRow(const Slot& slot, Snapshot& snapshot,
+                                 Chunk& chunk, size_t index, const Row& row) {
+  for (int field = 0; field < kFields; ++field) {
+    std::string value = stringField(row.document.view(), slot.fields[field]);
+    uint32_t code = 0;
+    if (!value.empty()) {
+      code = snapshot.dictionaries[field]->find(value);
+      if (code == 0) {
+        auto grown =
+            std::make_shared<Dictionary>(*snapshot.dictionaries[field]);
+        grown->values.push_back(value);
+        code = static_cast<uint32_t>(grown->values.size());
+        grown->codes.emplace(value, code);
+        snapshot.dictionaries[field] = std::move(grown);
+      }
+    }
+    chunk.columns[field][index] = code;
+  }
+}
+
+// Adds the rows of one chunk, and their codes, to the end of another.
+void CatalogueReplica::append(Chunk& chunk, const Chunk& rows) {
+  chunk.rows.insert(chunk.rows.end(), rows.rows.begin(), rows.rows.end());
+  for (int field = 0; field < kFields; ++field) {
+    chunk.columns[field].insert(chunk.columns[field].end(),
+                                rows.columns[field].begin(),
+                                rows.columns[field].end());
+  }
+}
+
+// Moves the second half of a chunk's rows into a new chunk.
+std::shared_ptr<const CatalogueReplica::Chunk> CatalogueReplica::splitOff(
+    Chunk& chunk) {
+  size_t half = chunk.rows.size() / 2;
+  auto tail = std::make_shared<Chunk>();
+  tail->rows.assign(chunk.rows.begin() + half, chunk.rows.end());
+  chunk.rows.resize(half);
+  for (int field = 0; field < kFields; ++field) {
+    auto& column = chunk.columns[field];
+    tail->columns[field].assign(column.begin() + half, column.end());
+    column.resize(half);
+  }
+  return tail;
+}
@@ -0,0 +1,397 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "CatalogueSnapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "Logger.h"
+
+namespace {
+
+const char kMagic[8] = {'G', 'I', 'T', 'G', 'U', 'D', 'S', 'N'};
+
+// magic[8], version u32, sections u32, written-at ms i64, payload bytes
+// u64, payload CRC-32 u32, reserved u32.
+constexpr size_t kHeaderBytes = 40;
+constexpr size_t kBufferBytes = 1 << 20;
+// Smallest BSON document: its length and the terminating NUL.
+constexpr int32_t kMinDocumentBytes = 5;
+
+template <typename T>
+T readAt(const uint8_t* at) {
+  T value;
+  std::memcpy(&value, at, sizeof(value));
+  return value;
+}
+
+template <typename T>
+void writeAt(uint8_t* at, T value) {
+  std::memcpy(at, &value, sizeof(value));
+}
+
+uint32_t checksum(uint32_t crc, const uint8_t* data, size_t length) {
+  // zlib takes a 32-bit length.
+  while (length > 0) {
+    uInt chunk = static_cast<uInt>(std::min<size_t>(length, 1u << 30));
+    crc = crc32(crc, data, chunk);
+    data += chunk;
+    length -= chunk;
+  }
+  return crc;
+}
+
+std::runtime_error systemError(const std::string& what,
+                               const std::string& path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void writeFully(int fd, const uint8_t* data, size_t length, off_t offset,
+                const std::string& path) {
+  while (length > 0) {
+    ssize_t count = ::pwrite(fd, data, length, offset);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw systemError("Cannot write", path);
+    }
+    data += count;
+    length -= count;
+    offset += count;
+  }
+}
+
+// Appends the payload after the header through a buffer, checksumming it
+// on the way.
+class PayloadWriter {
+ public:
+  PayloadWriter(int fd, const std::string& path)
+      : fd(fd), path(path), crc(crc32(0, Z_NULL, 0)) {
+    buffer.reserve(kBufferBytes);
+  }
+
+  void append(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + length);
+    if (buffer.size() >= kBufferBytes) {
+      flush();
+    }
+  }
+
+  void flush() {
+    writeFully(fd, buffer.data(), buffer.size(), kHeaderBytes + written,
+               path);
+    crc = checksum(crc, buffer.data(), buffer.size());
+    written += buffer.size();
+    buffer.clear();
+  }
+
+  uint64_t bytes() const { return written; }
+  uint32_t digest() const { return crc; }
+
+ private:
+  int fd;
+  const std::string& path;
+  std::vector<uint8_t> buffer;
+  uint64_t written = 0;
+  uint32_t crc;
+};
+
+// Makes a rename in the directory holding path durable; until the
+// directory is synced, a crash can bring back the old file or none.
+void syncDirectoryOf(const std::string& path) {
+  size_t slash = path.rfind('/');
+  std::string directory = slash == std::string::npos
+                              ? "."
+                              : path.substr(0, std::max<size_t>(slash, 1));
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    throw systemError("Cannot open", directory);
+  }
+  if (::fsync(fd) != 0) {
+    auto error = systemError("Cannot sync", directory);
+    ::close(fd);
+    throw error;
+  }
+  ::close(fd);
+}
+
+}  // namespace
+
+CatalogueSnapshot::CatalogueSnapshot(const uint8_t* data, size_t length)
+    : data(data), length(length) {}
+
+CatalogueSnapshot::~CatalogueSnapshot() {
+  ::munmap(const_cast<uint8_t*>(data), length);
+}
+
+/**
+ * @brief Maps a snapshot file and checks it.
+ *
+ * @param path The file.
+ * @return The snapshot, or nullptr if there is no file.
+ * @throws std::runtime_error If the file cannot be read, or is not a
+ * complete snapshot of this format version.
+ */
+std::unique_ptr<CatalogueSnapshot> CatalogueSnapshot::open(
+    const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return nullptr;
+    }
+    throw systemError("Cannot open", path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    auto error = systemError("Cannot stat", path);
+    ::close(fd);
+    throw error;
+  }
+  size_t length = static_cast<size_t>(info.st_size);
+  if (length < kHeaderBytes) {
+    ::close(fd);
+    throw std::runtime_error(path + " is too short to be a snapshot");
+  }
+  void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapped == MAP_FAILED) {
+    auto error = systemError("Cannot map", path);
+    ::close(fd);
+    throw error;
+  }
+  ::close(fd);
+  // Every page is read straight away to check the CRC.
+  ::madvise(mapped, length, MADV_WILLNEED);
+
+  std::unique_ptr<CatalogueSnapshot> snapshot(
+      new CatalogueSnapshot(static_cast<const uint8_t*>(mapped), length));
+  snapshot->parse();
+  return snapshot;
+}
+
+/**
+ * @brief Writes a snapshot file, replacing any earlier one only once it is
+ * complete, and syncs the file and then its directory so the replacement
+ * survives a crash. The file is readable by its owner only, as it holds
+ * subscriber contacts.
+ *
+ * @param path The file.
+ * @param sections Each section's name and where its documents come from.
+ * @return The size of the file written.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+uint64_t CatalogueSnapshot::write(
+    const std::string& path,
+    const std::vector<std::pair<std::string, Source>>& sections) {
+  std::string temporary = path + ".tmp";
+  int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0600);
+  if (fd < 0) {
+    throw systemError("Cannot create", temporary);
+  }
+  uint64_t payloadBytes = 0;
+  try {
+    PayloadWriter payload(fd, temporary);
+    uint32_t count = 0;
+    for (const auto& [name, source] : sections) {
+      bool started = false;
+      auto begin = [&payload, &started, &name = name]() {
+        if (!started) {
+          uint32_t nameLength = static_cast<uint32_t>(name.size());
+          payload.append(&nameLength, sizeof(nameLength));
+          payload.append(name.data(), name.size());
+          started = true;
+        }
+      };
+      bool available = source([&](const bsoncxx::document::view& document) {
+        begin();
+        payload.append(document.data(), document.length());
+      });
+      if (available || started) {
+        begin();
+        // A zero length, which no document has, ends the section.
+        int32_t end = 0;
+        payload.append(&end, sizeof(end));
+        count++;
+      }
+    }
+    payload.flush();
+    payloadBytes = payload.bytes();
+
+    uint8_t header[kHeaderBytes] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    writeAt<uint32_t>(header + 8, kFormatVersion);
+    writeAt<uint32_t>(header + 12, count);
+    writeAt<int64_t>(header + 16,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count());
+    writeAt<uint64_t>(header + 24, payloadBytes);
+    writeAt<uint32_t>(header + 32, payload.digest());
+    writeFully(fd, header, kHeaderBytes, 0, temporary);
+    if (::fsync(fd) != 0) {
+      throw systemError("Cannot sync", temporary);
+    }
+  } catch (...) {
+    ::close(fd);
+    ::unlink(temporary.c_str());
+    throw;
+  }
+  if (::close(fd) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0) {
+    auto error = systemError("Cannot replace", path);
+    ::unlink(temporary.c_str());
+    throw error;
+  }
+  syncDirectoryOf(path);
+  return kHeaderBytes + payloadBytes;
+}
+
+/**
+ * @brief Returns the named section, or nullptr if the file has none.
+ */
+const CatalogueSnapshot::Section* CatalogueSnapshot::section(
+    const std::string& name) const {
+  for (const Section& section : parsed) {
+    if (section.name == name) {
+      return &section;
+    }
+  }
+  return nullptr;
+}
+
+// Checks the header and the CRC, then indexes the documents in place.
+void CatalogueSnapshot::parse() {
+  if (std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+    throw std::runtime_error("Not a snapshot file");
+  }
+  uint32_t version = readAt<uint32_t>(data + 8);
+  if (version != kFormatVersion) {
+    throw std::runtime_error("Snapshot format " + std::to_string(version) +
+                             " is not " + std::to_string(kFormatVersion));
+  }
+  uint32_t count = readAt<uint32_t>(data + 12);
+  written = std::chrono::system_clock::time_point(
+      std::chrono::milliseconds(readAt<int64_t>(data + 16)));
+  uint64_t payloadBytes = readAt<uint64_t>(data + 24);
+  if (payloadBytes != length - kHeaderBytes) {
+    throw std::runtime_error("Snapshot is truncated");
+  }
+  if (checksum(crc32(0, Z_NULL, 0), data + kHeaderBytes, payloadBytes) !=
+      readAt<uint32_t>(data + 32)) {
+    throw std::runtime_error("Snapshot checksum does not match");
+  }
+
+  const uint8_t* at = data + kHeaderBytes;
+  const uint8_t* end = data + length;
+  auto need = [&at, end](size_t bytes) {
+    if (static_cast<size_t>(end - at) < bytes) {
+      throw std::runtime_error("Snapshot section runs past the end");
+    }
+  };
+  for (uint32_t i = 0; i < count; ++i) {
+    Section section;
+    need(sizeof(uint32_t));
+    uint32_t nameLength = readAt<uint32_t>(at);
+    at += sizeof(uint32_t);
+    need(nameLength);
+    section.name.assign(reinterpret_cast<const char*>(at), nameLength);
+    at += nameLength;
+    while (true) {
+      need(sizeof(int32_t));
+      int32_t documentLength = readAt<int32_t>(at);
+      if (documentLength == 0) {
+        at += sizeof(int32_t);
+        break;
+      }
+      if (documentLength < kMinDocumentBytes) {
+        throw std::runtime_error("Snapshot holds a malformed document");
+      }
+      need(documentLength);
+      if (at[documentLength - 1] != 0) {
+        throw std::runtime_error("Snapshot holds a malformed document");
+      }
+      section.documents.emplace_back(at, documentLength);
+      at += documentLength;
+    }
+    parsed.push_back(std::move(section));
+  }
+  if (at != end) {
+    throw std::runtime_error("Snapshot has bytes after its last section");
+  }
+}
+
+/**
+ * @brief Sets up a writer; nothing is written until start() or writeNow().
+ *
+ * @param path The snapshot file.
+ * @param interval How often to write it.
+ * @param sections Each section's name and where its documents come from.
+ */
+SnapshotWriter::SnapshotWriter(std::string path,
+                               std::chrono::milliseconds interval,
+                               Sections sections)
+    : path(std::move(path)),
+      interval(interval),
+      sections(std::move(sections)) {}
+
+SnapshotWriter::~SnapshotWriter() { stop(); }
+
+/**
+ * @brief Starts writing every interval.
+ */
+void SnapshotWriter::start() {
+  thread = std::thread(&SnapshotWriter::run, this);
+}
+
+/**
+ * @brief Stops the background thread, waiting for a write in progress.
+ */
+void SnapshotWriter::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Writes the snapshot file now, e.g. on shutdown.
+ *
+ * @return false if it could not be written; the previous file is kept.
+ */
+bool SnapshotWriter::writeNow() {
+  auto started = std::chrono::steady_clock::now();
+  try {
+    uint64_t bytes = CatalogueSnapshot::write(path, sections);
+    written++;
+    LOG_INFO("SnapshotWriter", "Wrote {} bytes to {} in {} ms", bytes, path,
+             std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - started)
+                 .count());
+    return true;
+  } catch (const std::exception& e) {
+    failed++;
+    LOG_ERROR("SnapshotWriter", "Could not write {}: {}", path, e.what());
+    return false;
+  }
+}
+
+void SnapshotWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+    lock.unlock();
+    writeNow();
+    lock.lock();
+  }
+}
@@ -0,0 +1,268 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "ChangeFeed.h"
+
+#include <cstdio>
+#include <exception>
+
+#include "SubscriberIndex.h"
+
+namespace {
+
+std::string escapeJson(const std::string& value) {
+  std::string out;
+  out.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[7];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out += escaped;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+// Empty means any, like the wildcard.
+std::string keyOf(const std::string& value) {
+  std::string key = SubscriberIndex::normalize(value);
+  return key.empty() ? SubscriberIndex::kWildcard : key;
+}
+
+}  // namespace
+
+/**
+ * @brief Renders the change as the JSON text frame sent to clients.
+ */
+std::string ResourceChange::json() const { return "{" + jsonFields() + "}"; }
+
+/**
+ * @brief Renders the change's members without the enclosing braces, for
+ * objects that add members of their own.
+ */
+std::string ResourceChange::jsonFields() const {
+  return "\"resource\": \"" + escapeJson(resource) + "\", \"action\": \"" +
+         escapeJson(action) + "\", \"id\": \"" + escapeJson(id) +
+         "\", \"city\": \"" + escapeJson(city) + "\"";
+}
+
+/**
+ * @brief Starts the sender thread.
+ *
+ * @param maxQueued Frames a connection may have waiting before it is
+ * considered too slow and closed.
+ * @param maxConnections Connections accepted at once; further subscriptions
+ * are refused.
+ */
+ChangeFeed::ChangeFeed(size_t maxQueued, size_t maxConnections)
+    : maxQueued(maxQueued == 0 ? 1 : maxQueued),
+      maxConnections(maxConnections),
+      sender(&ChangeFeed::run, this) {}
+
+/**
+ * @brief Writes out the frames still queued, then stops the sender thread.
+ */
+ChangeFeed::~ChangeFeed() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  sender.join();
+}
+
+/**
+ * @brief Adds a connection to the feed.
+ *
+ * @param resource The resource type to follow, or "*" (or empty) for all.
+ * @param city The city to follow, or "*" (or empty) for all.
+ * @param send Writes one frame to the connection. Called from the sender
+ * thread only, never concurrently with itself.
+ * @param close Closes the connection when it is evicted for falling behind.
+ * @return The subscription's id, or nullopt if the feed is full.
+ */
+std::optional<uint64_t> ChangeFeed::subscribe(const std::string& resource,
+                                              const std::string& city,
+                                              Send send, Close close) {
+  std::string resourceKey = keyOf(resource);
+  std::string cityKey = keyOf(city);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (connections.size() >= maxConnections) {
+    return std::nullopt;
+  }
+  uint64_t id = nextId++;
+  buckets[resourceKey][cityKey].insert(id);
+  connections.emplace(
+      id, Connection{resourceKey, cityKey, std::move(send), std::move(close),
+                     {}});
+  return id;
+}
+
+/**
+ * @brief Removes a connection. Once this returns, the connection's send and
+ * close callbacks are no longer called, so it may be destroyed.
+ */
+void ChangeFeed::unsubscribe(uint64_t id) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    remove(id);
+  }
+  if (std::this_thread::get_id() != sender.get_id()) {
+    std::lock_guard<std::mutex> wait(sending);
+  }
+}
+
+/**
+ * @brief Queues a change for every connection that follows it. Never waits
+ * for a client.
+ */
+void ChangeFeed::publish(const ResourceChange& change) {
+  auto frame = std::make_shared<const std::string>(change.json());
+  const std::string wildcard = SubscriberIndex::kWildcard;
+  std::string resourceKey = keyOf(change.resource);
+  std::string cityKey = SubscriberIndex::normalize(change.city);
+  std::vector<uint64_t> overflowing;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    published++;
+    for (const auto& resource : {resourceKey, wildcard}) {
+      auto cities = buckets.find(resource);
+      if (cities == buckets.end()) {
+        continue;
+      }
+      if (cityKey.empty()) {
+        for (const auto& [city, ids] : cities->second) {
+          enqueue(ids, frame, overflowing);
+        }
+      } else {
+        for (const auto& city : {cityKey, wildcard}) {
+          auto ids = cities->second.find(city);
+          if (ids != cities->second.end()) {
+            enqueue(ids->second, frame, overflowing);
+          }
+          if (cityKey == wildcard) {
+            break;
+          }
+        }
+      }
+      if (resourceKey == wildcard) {
+        break;
+      }
+    }
+    for (uint64_t id : overflowing) {
+      auto found = connections.find(id);
+      if (found == connections.end()) {
+        continue;
+      }
+      closing.emplace_back(found->second.close, "Too slow to keep up.");
+      evicted++;
+      remove(id);
+    }
+  }
+  wake.notify_one();
+}
+
+/**
+ * @brief Returns the feed's counters.
+ */
+ChangeFeedStats ChangeFeed::stats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  ChangeFeedStats result;
+  result.connections = connections.size();
+  result.published = published;
+  result.delivered = delivered;
+  result.evicted = evicted;
+  return result;
+}
+
+void ChangeFeed::enqueue(const Ids& ids, const Frame& frame,
+                         std::vector<uint64_t>& overflowing) {
+  for (uint64_t id : ids) {
+    auto& connection = connections.at(id);
+    if (connection.queued.size() >= maxQueued) {
+      overflowing.push_back(id);
+      continue;
+    }
+    if (connection.queued.empty()) {
+      ready.push_back(id);
+    }
+    connection.queued.push_back(frame);
+  }
+}
+
+void ChangeFeed::remove(uint64_t id) {
+  auto found = connections.find(id);
+  if (found == connections.end()) {
+    return;
+  }
+  auto cities = buckets.find(found->second.resource);
+  auto ids = cities->second.find(found->second.city);
+  ids->second.erase(id);
+  if (ids->second.empty()) {
+    cities->second.erase(ids);
+    if (cities->second.empty()) {
+      buckets.erase(cities);
+    }
+  }
+  connections.erase(found);
+}
+
+void ChangeFeed::run() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] {
+        return stopping || !ready.empty() || !closing.empty();
+      });
+      if (ready.empty() && closing.empty()) {
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> writing(sending);
+    std::vector<Outgoing> batch;
+    std::vector<std::pair<Close, std::string>> evictions;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (uint64_t id : ready) {
+        auto found = connections.find(id);
+        if (found == connections.end() || found->second.queued.empty()) {
+          continue;
+        }
+        delivered += found->second.queued.size();
+        batch.push_back(
+            Outgoing{found->second.send, std::move(found->second.queued)});
+        found->second.queued.clear();
+      }
+      ready.clear();
+      evictions.swap(closing);
+    }
+    for (const auto& outgoing : batch) {
+      for (const auto& frame : outgoing.frames) {
+        try {
+          outgoing.send(*frame);
+        } catch (const std::exception&) {
+          // The connection is going away; its close handler unsubscribes it.
+        }
+      }
+    }
+    for (const auto& [close, reason] : evictions) {
+      try {
+        close(reason);
+      } catch (const std::exception&) {
+        // Already closed.
+      }
+    }
+  }
+}
@@ -0,0 +1,137 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "ChangeJournal.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <unordered_set>
+#include <utility>
+
+/**
+ * @brief Renders the entry as one element of a /resources/changes page.
+ */
+std::string JournalEntry::json() const {
+  return "{\"seq\": " + std::to_string(sequence) + ", " + change.jsonFields() +
+         ", \"document\": " + (document.empty() ? "null" : document) + "}";
+}
+
+/**
+ * @brief Sets up an empty journal.
+ *
+ * @param maxEntries Size at which the journal is compacted.
+ * @param firstSequence The sequence of the first change; see
+ * startingSequence().
+ */
+ChangeJournal::ChangeJournal(size_t maxEntries, uint64_t firstSequence)
+    : maxEntries(std::max<size_t>(2, maxEntries)),
+      nextSequence(std::max<uint64_t>(1, firstSequence)),
+      floor(nextSequence - 1) {}
+
+/**
+ * @brief Records a change.
+ *
+ * @param change What changed.
+ * @param document The JSON written for adds and updates; empty for
+ * deletes.
+ * @return The change's sequence number.
+ */
+uint64_t ChangeJournal::append(const ResourceChange& change,
+                               std::string document) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  if (entries.size() >= maxEntries) {
+    compact();
+  }
+  uint64_t sequence = nextSequence++;
+  entries.push_back(JournalEntry{sequence, change, std::move(document)});
+  return sequence;
+}
+
+/**
+ * @brief Returns the changes made after a sequence number.
+ *
+ * @param sequence The last sequence the client has applied.
+ * @param limit The most entries to return.
+ * @return The changes in order, or nullopt if sequence is below the floor
+ * (the client has missed compacted changes) or was never issued.
+ */
+std::optional<ChangeJournal::Page> ChangeJournal::since(uint64_t sequence,
+                                                        size_t limit) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  if (sequence < floor || sequence >= nextSequence) {
+    return std::nullopt;
+  }
+  auto first = std::upper_bound(
+      entries.begin(), entries.end(), sequence,
+      [](uint64_t value, const JournalEntry& entry) {
+        return value < entry.sequence;
+      });
+  Page page;
+  page.next = sequence;
+  for (auto it = first; it != entries.end(); ++it) {
+    if (page.entries.size() == limit) {
+      page.more = true;
+      break;
+    }
+    page.entries.push_back(*it);
+    page.next = it->sequence;
+  }
+  if (!page.more) {
+    // Sequences of superseded entries are gone, so skip past them too.
+    page.next = nextSequence - 1;
+  }
+  return page;
+}
+
+/**
+ * @brief Returns the sequence of the latest change, the cursor a mirror
+ * starts from after loading everything.
+ */
+uint64_t ChangeJournal::latest() const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  return nextSequence - 1;
+}
+
+/**
+ * @brief Returns the journal's counters.
+ */
+ChangeJournalStats ChangeJournal::stats() const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  ChangeJournalStats result;
+  result.entries = entries.size();
+  result.latest = nextSequence - 1;
+  result.floor = floor;
+  result.compactions = compactions;
+  return result;
+}
+
+/**
+ * @brief Returns the first sequence number for a journal started now: the
+ * current time in microseconds, which is above every sequence an earlier
+ * run can have issued unless it averaged more than one change per
+ * microsecond.
+ */
+uint64_t ChangeJournal::startingSequence() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Keeps the latest entry per resource, then drops the oldest down to half
+// of maxEntries. Called with the lock held.
+void ChangeJournal::compact() {
+  std::unordered_set<std::string> seen;
+  std::deque<JournalEntry> kept;
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    if (!it->change.id.empty() &&
+        !seen.insert(it->change.resource + '\n' + it->change.id).second) {
+      continue;
+    }
+    kept.push_front(std::move(*it));
+  }
+  entries.swap(kept);
+  while (entries.size() > maxEntries / 2) {
+    floor = entries.front().sequence;
+    entries.pop_front();
+  }
+  compactions++;
+}
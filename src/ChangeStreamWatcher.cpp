@@ -0,0 +1,340 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "ChangeStreamWatcher.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/types.hpp>
+#include <exception>
+#include <system_error>
+#include <utility>
+
+#include "Logger.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+namespace {
+
+const char kTokens[] = "ChangeStreamTokens";
+
+// How long the server holds an idle getMore, and so how long stop() can
+// take.
+constexpr std::chrono::milliseconds kMaxAwait{1000};
+constexpr std::chrono::milliseconds kFirstBackoff{1000};
+constexpr std::chrono::milliseconds kMaxBackoff{30000};
+
+// Server error codes for a stream that cannot be resumed from its token.
+constexpr int kInvalidResumeToken = 260;
+constexpr int kChangeStreamFatalError = 280;
+constexpr int kChangeStreamHistoryLost = 286;
+// "The $changeStream stage is only supported on replica sets".
+constexpr int kNotReplicaSet = 40573;
+
+bool cannotResume(int code) {
+  return code == kInvalidResumeToken || code == kChangeStreamFatalError ||
+         code == kChangeStreamHistoryLost;
+}
+
+}  // namespace
+
+/**
+ * @brief Translates a change stream event.
+ *
+ * @param collection The collection the event came from.
+ * @param event The event as read from the stream.
+ * @return The change, or nullopt for events that do not change documents
+ * (e.g. index builds).
+ */
+std::optional<ChangeEvent> ChangeEvent::fromStream(
+    const std::string& collection, const bsoncxx::document::view& event) {
+  auto type = event["operationType"];
+  if (!type || type.type() != bsoncxx::type::k_utf8) {
+    return std::nullopt;
+  }
+  std::string operation = type.get_utf8().value.to_string();
+  ChangeEvent change;
+  change.collection = collection;
+  if (operation == "insert") {
+    change.operation = Operation::Insert;
+  } else if (operation == "update" || operation == "replace") {
+    change.operation = Operation::Update;
+  } else if (operation == "delete") {
+    change.operation = Operation::Delete;
+  } else if (operation == "drop" || operation == "rename" ||
+             operation == "dropDatabase" || operation == "invalidate") {
+    change.operation = Operation::Reset;
+    return change;
+  } else {
+    return std::nullopt;
+  }
+
+  auto key = event["documentKey"];
+  if (key && key.type() == bsoncxx::type::k_document) {
+    auto id = key.get_document().value["_id"];
+    if (id && id.type() == bsoncxx::type::k_oid) {
+      change.id = id.get_oid().value.to_string();
+    } else if (id && id.type() == bsoncxx::type::k_utf8) {
+      change.id = id.get_utf8().value.to_string();
+    }
+  }
+  auto document = event["fullDocument"];
+  if (document && document.type() == bsoncxx::type::k_document) {
+    change.document = bsoncxx::document::value(document.get_document().value);
+  }
+  return change;
+}
+
+/**
+ * @brief Sets up a watcher with no collections.
+ *
+ * @param dbManager Where the change streams are opened and the resume
+ * tokens kept.
+ * @param node This instance's name, unique among the instances sharing the
+ * database; see defaultNode().
+ * @param tokenInterval How often each collection's resume token is saved.
+ */
+ChangeStreamWatcher::ChangeStreamWatcher(
+    DatabaseManager& dbManager, std::string node,
+    std::chrono::milliseconds tokenInterval)
+    : dbManager(dbManager),
+      node(std::move(node)),
+      tokenInterval(tokenInterval) {}
+
+ChangeStreamWatcher::~ChangeStreamWatcher() { stop(); }
+
+/**
+ * @brief Adds a collection to watch. Call before start().
+ *
+ * @param collection The collection's name.
+ * @param handler Called on the collection's thread for every change, in
+ * order. It may see a change again after a restart, so it must be
+ * idempotent.
+ */
+void ChangeStreamWatcher::watch(const std::string& collection,
+                                Handler handler) {
+  Watch& added = watches.emplace_back();
+  added.collection = collection;
+  added.handler = std::move(handler);
+}
+
+/**
+ * @brief Starts one thread per watched collection.
+ */
+void ChangeStreamWatcher::start() {
+  for (Watch& watch : watches) {
+    watch.running = true;
+    watch.thread = std::thread(&ChangeStreamWatcher::run, this,
+                               std::ref(watch));
+  }
+}
+
+/**
+ * @brief Saves each collection's resume token and stops the threads. Takes
+ * up to a second, while the server answers the outstanding waits.
+ */
+void ChangeStreamWatcher::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (Watch& watch : watches) {
+    if (watch.thread.joinable()) {
+      watch.thread.join();
+    }
+  }
+}
+
+/**
+ * @brief Returns each collection's counters.
+ */
+std::vector<WatcherStatus> ChangeStreamWatcher::status() const {
+  std::vector<WatcherStatus> result;
+  for (const Watch& watch : watches) {
+    WatcherStatus status;
+    status.collection = watch.collection;
+    status.running = watch.running;
+    status.following = watch.following;
+    status.events = watch.events;
+    status.resets = watch.resets;
+    status.errors = watch.errors;
+    result.push_back(status);
+  }
+  return result;
+}
+
+/**
+ * @brief Returns true while the collection's stream is open, i.e. while
+ * changes to it are seen within a moment.
+ */
+bool ChangeStreamWatcher::isFollowing(const std::string& collection) const {
+  for (const Watch& watch : watches) {
+    if (watch.collection == collection) {
+      return watch.following;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns the host name, the node name used unless GITGUD_NODE_ID
+ * is set. Instances sharing a host must set GITGUD_NODE_ID.
+ */
+std::string ChangeStreamWatcher::defaultNode() {
+  char name[256] = {};
+  if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') {
+    return "gitgud";
+  }
+  return name;
+}
+
+// Follows one collection until stop(), reopening the stream after errors.
+void ChangeStreamWatcher::run(Watch& watch) {
+  std::chrono::milliseconds backoff = kFirstBackoff;
+  bool resume = true;
+  while (!isStopping()) {
+    bool useToken = resume;
+    resume = true;
+    try {
+      bool resumable = follow(watch, useToken);
+      watch.following = false;
+      if (!resumable) {
+        resume = false;
+      }
+      backoff = kFirstBackoff;
+      continue;
+    } catch (const std::system_error& e) {
+      watch.following = false;
+      if (e.code().value() == kNotReplicaSet) {
+        LOG_ERROR("ChangeStreamWatcher",
+                  "Cannot watch {} without a replica set; writes made by "
+                  "other instances will not be seen: {}",
+                  watch.collection, e.what());
+        break;
+      }
+      if (cannotResume(e.code().value())) {
+        LOG_WARNING("ChangeStreamWatcher",
+                    "Cannot resume {}, starting over: {}", watch.collection,
+                    e.what());
+        resume = false;
+        continue;
+      }
+      watch.errors++;
+      LOG_ERROR("ChangeStreamWatcher", "Watching {} failed: {}",
+                watch.collection, e.what());
+    } catch (const std::exception& e) {
+      watch.following = false;
+      watch.errors++;
+      LOG_ERROR("ChangeStreamWatcher", "Watching {} failed: {}",
+                watch.collection, e.what());
+    }
+    if (!sleepFor(backoff)) {
+      break;
+    }
+    backoff = std::min(backoff * 2, kMaxBackoff);
+  }
+  watch.running = false;
+}
+
+// Opens the stream, from the saved token if useToken is set and there is
+// one, and hands changes to the handler until stop(). Returns false if the
+// stream was invalidated and must be opened afresh.
+bool ChangeStreamWatcher::follow(Watch& watch, bool useToken) {
+  std::optional<bsoncxx::document::value> token;
+  if (useToken) {
+    token = loadToken(watch.collection);
+  }
+  bool needsReset = !token;
+  bool invalidated = false;
+  auto lastSaved = std::chrono::steady_clock::now();
+
+  dbManager.watchCollection(
+      watch.collection, token, kMaxAwait,
+      [&](const bsoncxx::document::view& raw) {
+        auto event = ChangeEvent::fromStream(watch.collection, raw);
+        if (!event) {
+          return true;
+        }
+        if (event->operation == ChangeEvent::Operation::Reset) {
+          invalidated = true;
+          return false;
+        }
+        watch.events++;
+        watch.handler(*event);
+        return true;
+      },
+      [&](const bsoncxx::document::view& resumeToken) {
+        watch.following = true;
+        bool stop = isStopping();
+        bool save = stop || needsReset ||
+                    std::chrono::steady_clock::now() - lastSaved >=
+                        tokenInterval;
+        if (needsReset) {
+          // The stream is open, so nothing written from here on is missed.
+          reset(watch);
+          needsReset = false;
+        }
+        if (save && !resumeToken.empty()) {
+          saveToken(watch.collection, resumeToken);
+          lastSaved = std::chrono::steady_clock::now();
+        }
+        return !stop;
+      });
+
+  if (invalidated) {
+    LOG_WARNING("ChangeStreamWatcher", "{} was dropped or renamed",
+                watch.collection);
+    return false;
+  }
+  return true;
+}
+
+void ChangeStreamWatcher::reset(Watch& watch) {
+  watch.resets++;
+  LOG_INFO("ChangeStreamWatcher", "Rebuilding everything derived from {}",
+           watch.collection);
+  ChangeEvent event;
+  event.collection = watch.collection;
+  event.operation = ChangeEvent::Operation::Reset;
+  watch.handler(event);
+}
+
+std::optional<bsoncxx::document::value> ChangeStreamWatcher::loadToken(
+    const std::string& collection) {
+  auto saved = dbManager.findDocument(
+      kTokens, make_document(kvp("_id", node + "/" + collection)));
+  if (!saved) {
+    return std::nullopt;
+  }
+  auto token = saved->view()["Token"];
+  if (!token || token.type() != bsoncxx::type::k_document) {
+    return std::nullopt;
+  }
+  return bsoncxx::document::value(token.get_document().value);
+}
+
+void ChangeStreamWatcher::saveToken(const std::string& collection,
+                                    const bsoncxx::document::view& token) {
+  bsoncxx::types::b_date now{
+      std::chrono::time_point_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now())};
+  auto update = make_document(
+      kvp("$set", make_document(kvp("Token", token), kvp("SavedAt", now))));
+  dbManager.updateDocument(
+      kTokens, make_document(kvp("_id", node + "/" + collection)), update,
+      true);
+}
+
+bool ChangeStreamWatcher::isStopping() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stopping;
+}
+
+// Waits for the delay, or until stop(). Returns false if stopping.
+bool ChangeStreamWatcher::sleepFor(std::chrono::milliseconds delay) {
+  std::unique_lock<std::mutex> lock(mutex);
+  return !wake.wait_for(lock, delay, [this] { return stopping; });
+}
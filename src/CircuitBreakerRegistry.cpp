@@ -0,0 +1,154 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "CircuitBreakerRegistry.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// Weight of the newest sample in the per-host latency average.
+constexpr double kLatencyAlpha = 0.2;
+
+}  // namespace
+
+CircuitBreakerRegistry::CircuitBreakerRegistry(int maxInFlight,
+                                               int failureThreshold,
+                                               Clock::duration cooldown)
+    : maxInFlight(maxInFlight),
+      failureThreshold(failureThreshold),
+      cooldown(cooldown) {}
+
+/**
+ * @brief Extracts the breaker key ("host" or "host:port") from a URL.
+ *
+ * @param url e.g. "https://hooks.example.org:8443/notify".
+ * @return std::string The lowercased authority, without user info.
+ */
+std::string CircuitBreakerRegistry::hostOf(const std::string& url) {
+  size_t start = url.find("://");
+  start = start == std::string::npos ? 0 : start + 3;
+  size_t end = url.find_first_of("/?#", start);
+  std::string host = url.substr(start, end == std::string::npos
+                                           ? std::string::npos
+                                           : end - start);
+  size_t at = host.rfind('@');
+  if (at != std::string::npos) {
+    host = host.substr(at + 1);
+  }
+  std::transform(host.begin(), host.end(), host.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return host;
+}
+
+/**
+ * @brief Asks for permission to call a host.
+ *
+ * Every granted permit must be passed back to release().
+ *
+ * @param host The destination host.
+ * @param now The current time.
+ * @return Permit Not granted if the breaker is open or the host is at its
+ *         concurrency cap; marked as the probe if the breaker is half-open.
+ */
+CircuitBreakerRegistry::Permit CircuitBreakerRegistry::tryAcquire(
+    const std::string& host, Clock::time_point now) {
+  Permit permit;
+  std::lock_guard<std::mutex> lock(mutex);
+  Breaker& breaker = breakers[host];
+  if (breaker.state == State::Open) {
+    if (now < breaker.openUntil) {
+      breaker.rejected++;
+      return permit;
+    }
+    breaker.state = State::HalfOpen;
+  }
+  if (breaker.state == State::HalfOpen) {
+    if (breaker.probeInFlight) {
+      breaker.rejected++;
+      return permit;
+    }
+    breaker.probeInFlight = true;
+    permit.probe = true;
+  } else if (breaker.inFlight >= maxInFlight) {
+    breaker.rejected++;
+    return permit;
+  }
+  breaker.inFlight++;
+  permit.granted = true;
+  return permit;
+}
+
+/**
+ * @brief Records the outcome of a call admitted by tryAcquire().
+ *
+ * While the breaker is open or half-open only the probe changes its state;
+ * calls admitted earlier just update the counters.
+ *
+ * @param host The destination host.
+ * @param permit What tryAcquire() returned for this call.
+ * @param success Whether the call succeeded.
+ * @param latency How long the call took.
+ * @param now The current time.
+ */
+void CircuitBreakerRegistry::release(const std::string& host, Permit permit,
+                                     bool success, Clock::duration latency,
+                                     Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Breaker& breaker = breakers[host];
+  breaker.inFlight = std::max(0, breaker.inFlight - 1);
+  if (permit.probe) {
+    breaker.probeInFlight = false;
+  }
+  bool decides = permit.probe || breaker.state == State::Closed;
+
+  double sampleMs =
+      std::chrono::duration<double, std::milli>(latency).count();
+  breaker.latencyMs =
+      breaker.successes + breaker.failures == 0
+          ? sampleMs
+          : kLatencyAlpha * sampleMs + (1 - kLatencyAlpha) * breaker.latencyMs;
+
+  if (success) {
+    breaker.successes++;
+    breaker.consecutiveFailures = 0;
+    if (decides) {
+      breaker.state = State::Closed;
+    }
+    return;
+  }
+  breaker.failures++;
+  breaker.consecutiveFailures++;
+  if (permit.probe ||
+      (decides && breaker.consecutiveFailures >= failureThreshold)) {
+    breaker.state = State::Open;
+    breaker.openUntil = now + cooldown;
+  }
+}
+
+/**
+ * @brief Returns the state of every host seen so far.
+ */
+std::vector<HostStatus> CircuitBreakerRegistry::snapshot() const {
+  std::vector<HostStatus> hosts;
+  std::lock_guard<std::mutex> lock(mutex);
+  hosts.reserve(breakers.size());
+  for (const auto& [host, breaker] : breakers) {
+    HostStatus status;
+    status.host = host;
+    status.state = breaker.state == State::Closed ? "closed"
+                   : breaker.state == State::Open ? "open"
+                                                  : "half-open";
+    status.inFlight = breaker.inFlight;
+    status.consecutiveFailures = breaker.consecutiveFailures;
+    status.latencyMs = breaker.latencyMs;
+    status.successes = breaker.successes;
+    status.failures = breaker.failures;
+    status.rejected = breaker.rejected;
+    hosts.push_back(status);
+  }
+  std::sort(hosts.begin(), hosts.end(),
+            [](const HostStatus& a, const HostStatus& b) {
+              return a.host < b.host;
+            });
+  return hosts;
+}
@@ -0,0 +1,133 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "CollectionVersions.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <random>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+
+struct Registry {
+  std::shared_mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<std::atomic<uint64_t>>>
+      versions;
+};
+
+Registry& registry() {
+  static Registry instance;
+  return instance;
+}
+
+std::atomic<uint64_t>& counter(const std::string& collection) {
+  Registry& reg = registry();
+  {
+    std::shared_lock<std::shared_mutex> lock(reg.mutex);
+    auto found = reg.versions.find(collection);
+    if (found != reg.versions.end()) {
+      return *found->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(reg.mutex);
+  auto& version = reg.versions[collection];
+  if (!version) {
+    version = std::make_unique<std::atomic<uint64_t>>(0);
+  }
+  return *version;
+}
+
+// Distinguishes this run's tags from those of earlier runs.
+uint64_t epoch() {
+  static const uint64_t value = [] {
+    std::random_device random;
+    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+    return now ^ (static_cast<uint64_t>(random()) << 32);
+  }();
+  return value;
+}
+
+// FNV-1a, to keep the page and filter out of the tag in readable form.
+uint64_t fingerprint(std::string_view text) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::string_view trim(std::string_view text) {
+  size_t start = text.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    return {};
+  }
+  size_t end = text.find_last_not_of(" \t");
+  return text.substr(start, end - start + 1);
+}
+
+}  // namespace
+
+/**
+ * @brief Records a change to a collection.
+ *
+ * @return The new version.
+ */
+uint64_t CollectionVersions::bump(const std::string& collection) {
+  return counter(collection).fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+/**
+ * @brief Returns a collection's version; 0 if it has not changed since
+ * startup.
+ */
+uint64_t CollectionVersions::current(const std::string& collection) {
+  return counter(collection).load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Builds the ETag of one listing of a collection.
+ *
+ * @param collection The collection listed.
+ * @param variant Everything else the response depends on, e.g. "start=20".
+ * @return A quoted strong entity tag.
+ */
+std::string CollectionVersions::etag(const std::string& collection,
+                                     std::string_view variant) {
+  char tag[64];
+  std::snprintf(tag, sizeof(tag), "\"%llx-%llx-%llx\"",
+                static_cast<unsigned long long>(epoch()),
+                static_cast<unsigned long long>(current(collection)),
+                static_cast<unsigned long long>(
+                    fingerprint(collection + '\n' + std::string(variant))));
+  return tag;
+}
+
+/**
+ * @brief Checks an If-None-Match header against an ETag.
+ *
+ * Accepts a comma-separated list, weak tags (W/"...") and "*", as GET
+ * requests may use weak comparison.
+ */
+bool CollectionVersions::matches(std::string_view ifNoneMatch,
+                                 std::string_view etag) {
+  while (!ifNoneMatch.empty()) {
+    size_t comma = ifNoneMatch.find(',');
+    std::string_view candidate = trim(ifNoneMatch.substr(0, comma));
+    ifNoneMatch = comma == std::string_view::npos
+                      ? std::string_view()
+                      : ifNoneMatch.substr(comma + 1);
+    if (candidate.substr(0, 2) == "W/") {
+      candidate.remove_prefix(2);
+    }
+    if (candidate == "*" || candidate == etag) {
+      return true;
+    }
+  }
+  return false;
+}
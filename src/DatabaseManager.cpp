@@ -4,19 +4,69 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <string_view>
+#include <utility>
 
 #include <bsoncxx/builder/stream/array.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
+#include <mongocxx/change_stream.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
+#include <mongocxx/exception/operation_exception.hpp>
+#include <mongocxx/options/change_stream.hpp>
+#include <mongocxx/options/find.hpp>
+#include <mongocxx/options/insert.hpp>
+
+#include "Config.h"
+#include "Deadline.h"
+
+namespace {
+
+// Server error code for an operation that ran past its maxTimeMS.
+constexpr int kMaxTimeMSExpired = 50;
+
+/**
+ * @brief Fails fast if the request deadline has passed, and otherwise lets
+ * the server stop the operation once it does.
+ */
+template <typename Options>
+void limitToDeadline(Options &options, const std::string &stage) {
+  Deadline::check(stage);
+  if (auto remaining = Deadline::remaining()) {
+    options.max_time(*remaining);
+  }
+}
+
+/**
+ * @brief Runs a read, turning a maxTimeMS expiry into DeadlineExceeded.
+ */
+template <typename Operation>
+auto withinDeadline(const std::string &stage, Operation operation) {
+  try {
+    return operation();
+  } catch (const mongocxx::operation_exception &e) {
+    if (e.code().value() == kMaxTimeMSExpired) {
+      throw DeadlineExceeded(stage);
+    }
+    throw;
+  }
+}
+
+}  // namespace
 
 DatabaseManager::DatabaseManager(const std::string &uri,
                                  bool skipInitialization) {
   if (!skipInitialization) {
-    conn = mongocxx::client(mongocxx::uri{uri});
-  } else {
-    // This is only needed for allowing unit-tests
-    conn.reset();
+    pool = std::make_unique<mongocxx::pool>(mongocxx::uri{uri});
+    long long windowUs = config::getInt("GITGUD_INSERT_BATCH_WINDOW_US", 0);
+    if (windowUs > 0) {
+      enableInsertBatching(std::chrono::microseconds(windowUs),
+                           config::getInt("GITGUD_INSERT_BATCH_MAX", 64));
+    }
   }
+  // Otherwise there is no connection, which is only needed for unit tests.
 }
 
 bsoncxx::document::value DatabaseManager::createDocument(
@@ -29,14 +79,15 @@ bsoncxx::document::value DatabaseManager::createDocument(
 }
 
 void DatabaseManager::createCollection(const std::string &collectionName) {
-  (*conn)["GitGud"][collectionName];
+  (*pool->acquire())["GitGud"][collectionName];
 }
 
 void DatabaseManager::findCollection(
     int start, const std::string &collectionName,
     const std::vector<std::pair<std::string, std::string>> &keyValues,
     std::vector<bsoncxx::document::value> &result) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
   mongocxx::options::find options;
   options.limit(20);  // Limit results to 20 documents
   options.skip(start);
@@ -46,17 +97,43 @@ void DatabaseManager::findCollection(
   projectionBuilder << excludeField
                     << 0;  // Exclude the field by setting it to 0
   options.projection(projectionBuilder.view());
+  limitToDeadline(options, "mongo.find");
 
   // Perform the query
-  auto cursor = collection.find(createDocument(keyValues).view(), options);
+  withinDeadline("mongo.find", [&] {
+    auto cursor = collection.find(createDocument(keyValues).view(), options);
+    for (auto &&doc : cursor) {
+      result.push_back(bsoncxx::document::value(doc));
+    }
+  });
+}
 
+/**
+ * @brief Visits every document of a collection without the page limit of
+ * findCollection. Used to load in-memory indexes at startup.
+ *
+ * @param collectionName The collection to scan.
+ * @param visitor Called once per document; authToken is never included.
+ */
+void DatabaseManager::scanCollection(
+    const std::string &collectionName,
+    const std::function<void(const bsoncxx::document::view &)> &visitor) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  mongocxx::options::find options;
+  bsoncxx::builder::stream::document projectionBuilder;
+  projectionBuilder << "authToken" << 0;
+  options.projection(projectionBuilder.view());
+
+  auto cursor = collection.find({}, options);
   for (auto &&doc : cursor) {
-    result.push_back(bsoncxx::document::value(doc));
+    visitor(doc);
   }
 }
 
 void DatabaseManager::printCollection(const std::string &collectionName) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
   if (collection.count_documents({}) == 0) {
     std::cout << "Collection " << collectionName << " is empty." << std::endl;
     return;
@@ -68,19 +145,109 @@ void DatabaseManager::printCollection(const std::string &collectionName) {
   }
 }
 
+/**
+ * @brief Turns on group commit for insertResource: inserts into the same
+ * collection that arrive within the window, up to maxBatch of them, are
+ * written with one unordered insert_many.
+ *
+ * @param window How long the first insert of a batch waits for others.
+ * @param maxBatch The most documents written together.
+ */
+void DatabaseManager::enableInsertBatching(std::chrono::microseconds window,
+                                           size_t maxBatch) {
+  batcher = std::make_unique<InsertBatcher>(
+      window, maxBatch,
+      [this](const std::string &collectionName,
+             const std::vector<const InsertBatcher::KeyValues *> &documents) {
+        return insertBatch(collectionName, documents);
+      });
+}
+
+/**
+ * @brief Returns how many batches and documents group commit has written;
+ * all zero when it is off.
+ */
+InsertBatcher::Stats DatabaseManager::insertBatchStats() const {
+  return batcher ? batcher->stats() : InsertBatcher::Stats{};
+}
+
+/**
+ * @brief Writes a batch of resources with one unordered insert_many. The
+ * ids are generated here so that each caller learns its own.
+ *
+ * An unordered insert_many goes on past a document the server refuses, so
+ * when the server reports write errors for some documents only those are
+ * failed; any other error fails the whole batch.
+ *
+ * @param collectionName The target collection.
+ * @param documents The fields of each document.
+ * @return The ids of the documents, in order.
+ * @throws InsertBatcher::PartialWrite If some documents were not written.
+ */
+std::vector<std::string> DatabaseManager::insertBatch(
+    const std::string &collectionName,
+    const std::vector<const InsertBatcher::KeyValues *> &documents) {
+  std::vector<bsoncxx::document::value> values;
+  std::vector<std::string> ids;
+  values.reserve(documents.size());
+  ids.reserve(documents.size());
+  for (const auto *keyValues : documents) {
+    bsoncxx::oid id;
+    bsoncxx::builder::stream::document document{};
+    document << "_id" << id;
+    for (const auto &keyValue : *keyValues) {
+      document << keyValue.first << keyValue.second;
+    }
+    values.push_back(document << bsoncxx::builder::stream::finalize);
+    ids.push_back(id.to_string());
+  }
+
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  mongocxx::options::insert options;
+  options.ordered(false);
+  try {
+    collection.insert_many(values, options);
+  } catch (const mongocxx::bulk_write_exception &e) {
+    const auto &raw = e.raw_server_error();
+    if (!raw || raw->view()["writeConcernErrors"] ||
+        !raw->view()["writeErrors"]) {
+      throw;
+    }
+    std::map<size_t, std::string> errors;
+    for (const auto &error : raw->view()["writeErrors"].get_array().value) {
+      auto index = static_cast<size_t>(error["index"].get_int32().value);
+      if (index >= ids.size()) {
+        throw;
+      }
+      errors[index] = error["errmsg"].get_utf8().value.to_string();
+    }
+    if (errors.empty()) {
+      throw;
+    }
+    throw InsertBatcher::PartialWrite(std::move(ids), std::move(errors));
+  }
+  return ids;
+}
+
 std::string DatabaseManager::insertResource(
     const std::string &collectionName,
     const std::vector<std::pair<std::string, std::string>> &keyValues) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  Deadline::check("mongo.insert");
+  if (batcher) {
+    return batcher->insert(collectionName, keyValues);
+  }
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
   auto item = collection.insert_one(createDocument(keyValues).view());
-  std::cout << item->inserted_id().get_oid().value.to_string() << std::endl;
   return item->inserted_id().get_oid().value.to_string();
 }
 
 bool DatabaseManager::deleteResource(const std::string &collectionName,
                                      const std::string &resourceId,
                                      const std::string &authToken) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
 
   // Build the filter to find the document by _id
   bsoncxx::builder::stream::document filter_builder;
@@ -88,7 +255,11 @@ bool DatabaseManager::deleteResource(const std::string &collectionName,
   filter_builder << "_id" << oid;
 
   // Retrieve the document first
-  auto document = collection.find_one(filter_builder.view());
+  mongocxx::options::find options;
+  limitToDeadline(options, "mongo.delete");
+  auto document = withinDeadline("mongo.delete", [&] {
+    return collection.find_one(filter_builder.view(), options);
+  });
   if (!document) {
     std::cout << "No document found with the given _id.\n";
     return false;
@@ -97,12 +268,18 @@ bool DatabaseManager::deleteResource(const std::string &collectionName,
   // Check if the document contains the expected auth token
   auto doc_view = document->view();
   auto auth_field = doc_view["authToken"];
-  if (!auth_field || std::string(auth_field.get_utf8().value) != authToken) {
+  bool authorized = false;
+  if (auth_field) {
+    auto stored = auth_field.get_utf8().value;
+    authorized = std::string_view(stored.data(), stored.size()) == authToken;
+  }
+  if (!authorized) {
     std::cout << "Invalid permissions: auth token mismatch.\n";
     return false;
   }
 
   // Proceed with deletion if the auth token matches
+  Deadline::check("mongo.delete");
   auto result = collection.delete_one(filter_builder.view());
   if (result && result->deleted_count() > 0) {
     std::cout << "Document deleted successfully.\n";
@@ -115,14 +292,16 @@ bool DatabaseManager::deleteResource(const std::string &collectionName,
 }
 
 void DatabaseManager::deleteCollection(const std::string &collectionName) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
   collection.drop();
 }
 
 void DatabaseManager::updateResource(
     const std::string &collectionName, const std::string &resourceId,
     const std::vector<std::pair<std::string, std::string>> &updates) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
   bsoncxx::builder::stream::document updateDoc{};
   updateDoc << "$set" << bsoncxx::builder::stream::open_document;
 
@@ -131,13 +310,19 @@ void DatabaseManager::updateResource(
   }
   updateDoc << bsoncxx::builder::stream::close_document;
   bsoncxx::oid oid(resourceId);
-  auto check = collection.find_one(bsoncxx::builder::stream::document{}
+  mongocxx::options::find options;
+  limitToDeadline(options, "mongo.update");
+  auto check = withinDeadline("mongo.update", [&] {
+    return collection.find_one(bsoncxx::builder::stream::document{}
                                    << "_id" << oid
-                                   << bsoncxx::builder::stream::finalize);
+                                   << bsoncxx::builder::stream::finalize,
+                               options);
+  });
   if (!check) {
     throw std::invalid_argument(
         "The request with wrong id or invalid permissions.");
   }
+  Deadline::check("mongo.update");
   auto result = collection.update_one(bsoncxx::builder::stream::document{}
                                           << "_id" << oid
                                           << bsoncxx::builder::stream::finalize,
@@ -146,7 +331,8 @@ void DatabaseManager::updateResource(
 
 void DatabaseManager::findResource(const std::string &collectionName,
                                    const std::string &resourceId) {
-  auto collection = (*conn)["GitGud"][collectionName];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
   auto filter = bsoncxx::builder::stream::document{}
                 << "_id" << resourceId << bsoncxx::builder::stream::finalize;
   auto cursor = collection.find(filter.view());
@@ -158,7 +344,8 @@ void DatabaseManager::findResource(const std::string &collectionName,
 
 bsoncxx::document::value DatabaseManager::getResources(
     const std::string &resourceType) {
-  auto collection = (*conn)["GitGud"]["Resources"];
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"]["Resources"];
   auto filter = bsoncxx::builder::stream::document{}
                 << "type" << resourceType << bsoncxx::builder::stream::finalize;
   auto cursor = collection.find(filter.view());
@@ -179,4 +366,232 @@ bsoncxx::document::value DatabaseManager::getResources(
   result << "resources" << resources_array;
 
   return result << finalize;
-}
\ No newline at end of file
+}
+/**
+ * @brief Inserts a document as-is.
+ *
+ * @param collectionName The target collection.
+ * @param document The document to insert.
+ * @return std::string The id of the inserted document.
+ */
+std::string DatabaseManager::insertDocument(
+    const std::string &collectionName, const bsoncxx::document::view &document) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  auto item = collection.insert_one(document);
+  return item->inserted_id().get_oid().value.to_string();
+}
+
+/**
+ * @brief Atomically updates the first document matching a filter.
+ *
+ * @param collectionName The target collection.
+ * @param filter Selects the document.
+ * @param update The update operators to apply.
+ * @return The document after the update, or nullopt if nothing matched.
+ */
+std::optional<bsoncxx::document::value> DatabaseManager::findOneAndUpdate(
+    const std::string &collectionName, const bsoncxx::document::view &filter,
+    const bsoncxx::document::view &update) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  mongocxx::options::find_one_and_update options;
+  options.return_document(mongocxx::options::return_document::k_after);
+  limitToDeadline(options, "mongo.update");
+  auto result = withinDeadline("mongo.update", [&] {
+    return collection.find_one_and_update(filter, update, options);
+  });
+  if (!result) {
+    return std::nullopt;
+  }
+  return bsoncxx::document::value(result->view());
+}
+
+/**
+ * @brief Applies update operators to the first document matching a filter.
+ *
+ * @param collectionName The target collection.
+ * @param filter Selects the document.
+ * @param update The update operators to apply.
+ * @param upsert Whether to insert a document if none matches.
+ * @return true if a document was modified or inserted.
+ */
+bool DatabaseManager::updateDocument(const std::string &collectionName,
+                                     const bsoncxx::document::view &filter,
+                                     const bsoncxx::document::view &update,
+                                     bool upsert) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  mongocxx::options::update options;
+  options.upsert(upsert);
+  auto result = collection.update_one(filter, update, options);
+  return result &&
+         (result->modified_count() > 0 || result->upserted_id().has_value());
+}
+
+/**
+ * @brief Deletes the first document matching a filter.
+ *
+ * @param collectionName The target collection.
+ * @param filter Selects the document.
+ * @return true if a document was deleted.
+ */
+bool DatabaseManager::deleteDocument(const std::string &collectionName,
+                                     const bsoncxx::document::view &filter) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  auto result = collection.delete_one(filter);
+  return result && result->deleted_count() > 0;
+}
+
+/**
+ * @brief Creates an index if it does not exist yet.
+ *
+ * @param collectionName The target collection.
+ * @param keys The index specification, e.g. {State: 1, DueAt: 1}.
+ */
+void DatabaseManager::createIndex(const std::string &collectionName,
+                                  const bsoncxx::document::view &keys) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  collection.create_index(keys);
+}
+
+/**
+ * @brief Finds the first document matching a filter.
+ *
+ * @param collectionName The target collection.
+ * @param filter Selects the document.
+ * @return The document, or nullopt if nothing matched.
+ */
+std::optional<bsoncxx::document::value> DatabaseManager::findDocument(
+    const std::string &collectionName, const bsoncxx::document::view &filter) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  auto result = collection.find_one(filter);
+  if (!result) {
+    return std::nullopt;
+  }
+  return bsoncxx::document::value(result->view());
+}
+
+/**
+ * @brief Follows a collection's change stream until a callback returns
+ * false. Updates carry the document as it is after the update.
+ *
+ * The pooled client is held for as long as the watch runs.
+ *
+ * @param collectionName The collection to watch.
+ * @param resumeAfter The resume token to continue from, or nullopt to start
+ * with changes made from now on.
+ * @param maxAwait How long the server waits for changes before answering
+ * with an empty batch.
+ * @param onEvent Called with each change event.
+ * @param onBatch Called with the resume token after each batch.
+ * @throws mongocxx::exception (a std::system_error) with the server's error
+ * code if the stream cannot be opened or resumed.
+ */
+void DatabaseManager::watchCollection(
+    const std::string &collectionName,
+    const std::optional<bsoncxx::document::value> &resumeAfter,
+    std::chrono::milliseconds maxAwait,
+    const std::function<bool(const bsoncxx::document::view &)> &onEvent,
+    const std::function<bool(const bsoncxx::document::view &)> &onBatch) {
+  auto client = pool->acquire();
+  auto collection = (*client)["GitGud"][collectionName];
+  mongocxx::options::change_stream options;
+  options.full_document("updateLookup");
+  options.max_await_time(maxAwait);
+  if (resumeAfter) {
+    options.resume_after(resumeAfter->view());
+  }
+  mongocxx::change_stream stream = collection.watch(options);
+  while (true) {
+    for (const auto &event : stream) {
+      if (!onEvent(event)) {
+        return;
+      }
+    }
+    auto token = stream.get_resume_token();
+    if (!onBatch(token ? *token : bsoncxx::document::view{})) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Returns the executor the *Async operations run on, starting it on
+ * first use. Its size (GITGUD_DB_IO_THREADS, default 16) bounds the
+ * operations in flight; up to GITGUD_DB_IO_QUEUE (default 1024) more may
+ * wait, after which the returned futures fail immediately.
+ */
+AsyncExecutor &DatabaseManager::ioExecutor() {
+  std::call_once(ioStarted, [this] {
+    io = std::make_unique<AsyncExecutor>(
+        config::getInt("GITGUD_DB_IO_THREADS", 16),
+        config::getInt("GITGUD_DB_IO_QUEUE", 1024));
+  });
+  return *io;
+}
+
+/**
+ * @brief Runs findCollection on the I/O executor.
+ *
+ * @return A future for the matching documents.
+ */
+std::future<std::vector<bsoncxx::document::value>>
+DatabaseManager::findCollectionAsync(
+    int start, std::string collectionName,
+    std::vector<std::pair<std::string, std::string>> keyValues) {
+  return ioExecutor().submit([this, start,
+                              collectionName = std::move(collectionName),
+                              keyValues = std::move(keyValues)] {
+    std::vector<bsoncxx::document::value> result;
+    findCollection(start, collectionName, keyValues, result);
+    return result;
+  });
+}
+
+/**
+ * @brief Runs insertResource on the I/O executor.
+ *
+ * @return A future for the id of the inserted document.
+ */
+std::future<std::string> DatabaseManager::insertResourceAsync(
+    std::string collectionName,
+    std::vector<std::pair<std::string, std::string>> keyValues) {
+  return ioExecutor().submit([this, collectionName = std::move(collectionName),
+                              keyValues = std::move(keyValues)] {
+    return insertResource(collectionName, keyValues);
+  });
+}
+
+/**
+ * @brief Runs updateResource on the I/O executor.
+ *
+ * @return A future that holds the exception if the update failed.
+ */
+std::future<void> DatabaseManager::updateResourceAsync(
+    std::string collectionName, std::string resourceId,
+    std::vector<std::pair<std::string, std::string>> updates) {
+  return ioExecutor().submit([this, collectionName = std::move(collectionName),
+                              resourceId = std::move(resourceId),
+                              updates = std::move(updates)] {
+    updateResource(collectionName, resourceId, updates);
+  });
+}
+
+/**
+ * @brief Runs deleteResource on the I/O executor.
+ *
+ * @return A future for whether the document was deleted.
+ */
+std::future<bool> DatabaseManager::deleteResourceAsync(
+    std::string collectionName, std::string resourceId,
+    std::string authToken) {
+  return ioExecutor().submit([this, collectionName = std::move(collectionName),
+                              resourceId = std::move(resourceId),
+                              authToken = std::move(authToken)] {
+    return deleteResource(collectionName, resourceId, authToken);
+  });
+}
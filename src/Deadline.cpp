@@ -0,0 +1,82 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "Deadline.h"
+
+#include <algorithm>
+
+namespace {
+
+thread_local std::optional<Deadline::Clock::time_point> active;
+
+}  // namespace
+
+/**
+ * @brief Gives the current thread budget from now, or keeps the existing
+ * deadline if that is sooner.
+ */
+Deadline::Scope::Scope(Clock::duration budget)
+    : Scope(std::optional<Clock::time_point>(Clock::now() + budget)) {}
+
+/**
+ * @brief Sets the current thread's deadline to at, or keeps the existing
+ * deadline if that is sooner. nullopt leaves the deadline unchanged.
+ */
+Deadline::Scope::Scope(std::optional<Clock::time_point> at)
+    : previous(active) {
+  if (at && (!active || *at < *active)) {
+    active = at;
+  }
+}
+
+Deadline::Scope::~Scope() { active = previous; }
+
+/**
+ * @brief Returns the current thread's deadline, if any.
+ */
+std::optional<Deadline::Clock::time_point> Deadline::current() {
+  return active;
+}
+
+/**
+ * @brief Returns the time left, rounded up to at least 1 ms while there is
+ * any, 0 once the deadline has passed, or nullopt without a deadline.
+ */
+std::optional<std::chrono::milliseconds> Deadline::remaining() {
+  if (!active) {
+    return std::nullopt;
+  }
+  auto left = *active - Clock::now();
+  if (left <= Clock::duration::zero()) {
+    return std::chrono::milliseconds(0);
+  }
+  return std::max(std::chrono::milliseconds(1),
+                  std::chrono::duration_cast<std::chrono::milliseconds>(left));
+}
+
+/**
+ * @brief Shortens a timeout so it does not outlast the deadline.
+ *
+ * @param timeoutMs The timeout the caller would use on its own.
+ * @return The smaller of timeoutMs and the time left, and at least 1 so that
+ * libraries which read 0 as "no timeout" still give up.
+ */
+long long Deadline::clampMs(long long timeoutMs) {
+  auto left = remaining();
+  if (!left) {
+    return timeoutMs;
+  }
+  return std::max(1LL, std::min<long long>(timeoutMs, left->count()));
+}
+
+/**
+ * @brief Returns true if the current thread's deadline has passed.
+ */
+bool Deadline::expired() { return active && Clock::now() >= *active; }
+
+/**
+ * @brief Throws DeadlineExceeded for stage if the deadline has passed.
+ */
+void Deadline::check(const std::string& stage) {
+  if (expired()) {
+    throw DeadlineExceeded(stage);
+  }
+}
@@ -0,0 +1,114 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "InsertBatcher.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+InsertBatcher::PartialWrite::PartialWrite(
+    std::vector<std::string> ids, std::map<size_t, std::string> errors)
+    : std::runtime_error("Batch insert wrote " +
+                         std::to_string(ids.size() - errors.size()) + " of " +
+                         std::to_string(ids.size()) + " documents."),
+      ids(std::move(ids)),
+      errors(std::move(errors)) {}
+
+/**
+ * @brief Creates a batcher.
+ *
+ * @param window How long the first insert of a batch waits for others.
+ * @param maxBatch The most documents written in one call (at least 1).
+ * @param flush Writes a batch and returns the ids in order.
+ */
+InsertBatcher::InsertBatcher(std::chrono::microseconds window,
+                             size_t maxBatch, Flush flush)
+    : window(window),
+      maxBatch(std::max<size_t>(1, maxBatch)),
+      flush(std::move(flush)) {}
+
+/**
+ * @brief Inserts a document as part of the current batch for its
+ * collection.
+ *
+ * @param collectionName The target collection.
+ * @param keyValues The document's fields.
+ * @return std::string The id of the inserted document.
+ * @throws std::runtime_error If this document was not written.
+ */
+std::string InsertBatcher::insert(const std::string& collectionName,
+                                  const KeyValues& keyValues) {
+  std::shared_ptr<Batch> batch;
+  size_t index = 0;
+  bool mustWrite = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto& slot = open[collectionName];
+    bool leader = slot == nullptr;
+    if (leader) {
+      slot = std::make_shared<Batch>();
+    }
+    batch = slot;
+    index = batch->documents.size();
+    batch->documents.push_back(&keyValues);
+
+    auto stillOpen = [&] {
+      auto it = open.find(collectionName);
+      return it != open.end() && it->second == batch;
+    };
+    if (batch->documents.size() >= maxBatch) {
+      open.erase(collectionName);
+      mustWrite = true;
+      batchClosed.notify_all();
+    } else if (leader) {
+      batchClosed.wait_for(lock, window, [&] { return !stillOpen(); });
+      if (stillOpen()) {
+        open.erase(collectionName);
+        mustWrite = true;
+      }
+    }
+  }
+  if (mustWrite) {
+    write(collectionName, *batch);
+  }
+  const Written& written = batch->result.get();
+  auto error = written.errors.find(index);
+  if (error != written.errors.end()) {
+    throw std::runtime_error(error->second);
+  }
+  return written.ids[index];
+}
+
+/**
+ * @brief Returns how many batches and documents have been written.
+ */
+InsertBatcher::Stats InsertBatcher::stats() const {
+  Stats stats;
+  stats.batches = batchCount.load(std::memory_order_relaxed);
+  stats.documents = documentCount.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void InsertBatcher::write(const std::string& collectionName, Batch& batch) {
+  try {
+    Written written;
+    try {
+      written.ids = flush(collectionName, batch.documents);
+    } catch (PartialWrite& partial) {
+      written.ids = std::move(partial.ids);
+      written.errors = std::move(partial.errors);
+    }
+    if (written.ids.size() != batch.documents.size()) {
+      throw std::runtime_error("Batch insert returned " +
+                               std::to_string(written.ids.size()) +
+                               " ids for " +
+                               std::to_string(batch.documents.size()) +
+                               " documents.");
+    }
+    batchCount.fetch_add(1, std::memory_order_relaxed);
+    documentCount.fetch_add(written.ids.size() - written.errors.size(),
+                            std::memory_order_relaxed);
+    batch.written.set_value(std::move(written));
+  } catch (...) {
+    batch.written.set_exception(std::current_exception());
+  }
+}
@@ -0,0 +1,280 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "JsonScanner.h"
+
+#include <algorithm>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+class Cursor {
+ public:
+  Cursor(const std::string& text, std::string& error)
+      : data(text.data()), size(text.size()), error(error) {}
+
+  bool atEnd() const { return pos >= size; }
+  char peek() const { return pos < size ? data[pos] : '\0'; }
+
+  void skipWhitespace() {
+    while (pos < size && (data[pos] == ' ' || data[pos] == '\t' ||
+                          data[pos] == '\n' || data[pos] == '\r')) {
+      ++pos;
+    }
+  }
+
+  bool expect(char c) {
+    skipWhitespace();
+    if (peek() != c) {
+      return fail(std::string("Expected '") + c + "' at offset " +
+                  std::to_string(pos) + ".");
+    }
+    ++pos;
+    return true;
+  }
+
+  bool fail(const std::string& message) {
+    error = message;
+    return false;
+  }
+
+  /**
+   * @brief Reads a string starting at the opening quote into out.
+   */
+  bool readString(std::pmr::string& out) {
+    if (peek() != '"') {
+      return fail("Expected a string at offset " + std::to_string(pos) + ".");
+    }
+    ++pos;
+    out.clear();
+    while (true) {
+      size_t special = JsonScanner::findSpecial(data, pos, size);
+      out.append(data + pos, special - pos);
+      pos = special;
+      if (pos >= size) {
+        return fail("Unterminated string.");
+      }
+      char c = data[pos++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        return fail("Invalid control character in string at offset " +
+                    std::to_string(pos - 1) + ".");
+      }
+      if (!readEscape(out)) {
+        return false;
+      }
+    }
+  }
+
+ private:
+  const char* data;
+  size_t size;
+  size_t pos = 0;
+  std::string& error;
+
+  bool readEscape(std::pmr::string& out) {
+    if (pos >= size) {
+      return fail("Unterminated string.");
+    }
+    char c = data[pos++];
+    switch (c) {
+      case '"':
+      case '\\':
+      case '/':
+        out += c;
+        return true;
+      case 'b':
+        out += '\b';
+        return true;
+      case 'f':
+        out += '\f';
+        return true;
+      case 'n':
+        out += '\n';
+        return true;
+      case 'r':
+        out += '\r';
+        return true;
+      case 't':
+        out += '\t';
+        return true;
+      case 'u':
+        return readUnicode(out);
+      default:
+        return fail("Invalid escape sequence at offset " +
+                    std::to_string(pos - 2) + ".");
+    }
+  }
+
+  bool readHex4(unsigned& value) {
+    if (size - pos < 4) {
+      return fail("Truncated \\u escape.");
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      char c = data[pos++];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        return fail("Invalid \\u escape.");
+      }
+    }
+    return true;
+  }
+
+  bool readUnicode(std::pmr::string& out) {
+    unsigned code;
+    if (!readHex4(code)) {
+      return false;
+    }
+    if (code >= 0xDC00 && code <= 0xDFFF) {
+      return fail("Unpaired surrogate in \\u escape.");
+    }
+    if (code >= 0xD800 && code <= 0xDBFF) {
+      unsigned low;
+      if (size - pos < 2 || data[pos] != '\\' || data[pos + 1] != 'u') {
+        return fail("Unpaired surrogate in \\u escape.");
+      }
+      pos += 2;
+      if (!readHex4(low)) {
+        return false;
+      }
+      if (low < 0xDC00 || low > 0xDFFF) {
+        return fail("Unpaired surrogate in \\u escape.");
+      }
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    }
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xC0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xE0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    return true;
+  }
+};
+
+}  // namespace
+
+/**
+ * @brief Returns the offset of the first byte at or after pos that ends a
+ * run of plain string characters: a quote, a backslash or a control
+ * character. Returns size if there is none.
+ */
+size_t JsonScanner::findSpecial(const char* data, size_t pos, size_t size) {
+#ifdef __SSE2__
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i lastControl = _mm_set1_epi8(0x1F);
+  while (pos + 16 <= size) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    // max(c, 0x1F) == 0x1F exactly when c <= 0x1F as an unsigned byte.
+    __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmpeq_epi8(_mm_max_epu8(chunk, lastControl), lastControl));
+    int mask = _mm_movemask_epi8(hits);
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+    pos += 16;
+  }
+#endif
+  for (; pos < size; ++pos) {
+    unsigned char c = static_cast<unsigned char>(data[pos]);
+    if (c == '"' || c == '\\' || c < 0x20) {
+      return pos;
+    }
+  }
+  return size;
+}
+
+/**
+ * @brief Parses a flat JSON object of string values.
+ *
+ * @param text The JSON text.
+ * @param fields Receives the (key, value) pairs in document order.
+ * @param error Receives a description of the first problem found.
+ * @param allowedKeys If given, any other key is rejected.
+ * @return true on success; on failure fields is left empty.
+ */
+bool JsonScanner::scanObject(const std::string& text, Fields& fields,
+                             std::string& error,
+                             const std::vector<std::string>* allowedKeys) {
+  fields.clear();
+  Cursor cursor(text, error);
+  auto fail = [&](const std::string& message) {
+    fields.clear();
+    return cursor.fail(message);
+  };
+
+  if (!cursor.expect('{')) {
+    return false;
+  }
+  cursor.skipWhitespace();
+  if (cursor.peek() == '}') {
+    cursor.expect('}');
+  } else {
+    while (true) {
+      cursor.skipWhitespace();
+      std::pmr::string key(fields.get_allocator().resource());
+      if (!cursor.readString(key)) {
+        fields.clear();
+        return false;
+      }
+      if (allowedKeys != nullptr &&
+          std::find(allowedKeys->begin(), allowedKeys->end(),
+                    std::string_view(key)) == allowedKeys->end()) {
+        return fail("Unknown field " + std::string(key) + ".");
+      }
+      if (!cursor.expect(':')) {
+        fields.clear();
+        return false;
+      }
+      cursor.skipWhitespace();
+      if (cursor.peek() != '"') {
+        return fail("Field " + std::string(key) + " must be a string.");
+      }
+      std::pmr::string value(fields.get_allocator().resource());
+      if (!cursor.readString(value)) {
+        fields.clear();
+        return false;
+      }
+      fields.emplace_back(std::move(key), std::move(value));
+      cursor.skipWhitespace();
+      if (cursor.peek() == ',') {
+        cursor.expect(',');
+        continue;
+      }
+      if (!cursor.expect('}')) {
+        fields.clear();
+        return false;
+      }
+      break;
+    }
+  }
+  cursor.skipWhitespace();
+  if (!cursor.atEnd()) {
+    return fail("Unexpected characters after the JSON object.");
+  }
+  return true;
+}
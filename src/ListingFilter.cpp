@@ -0,0 +1,86 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "ListingFilter.h"
+
+namespace {
+
+/**
+ * @brief Percent-escapes all but unreserved characters, so a value cannot
+ * pass for the separators around it.
+ */
+std::string escape(const std::string& value) {
+  static const char kHex[] = "0123456789ABCDEF";
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (unsigned char c : value) {
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+        (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' ||
+        c == '~') {
+      escaped += static_cast<char>(c);
+    } else {
+      escaped += '%';
+      escaped += kHex[c >> 4];
+      escaped += kHex[c & 0xF];
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+/**
+ * @brief Returns true if no field is filtered on.
+ */
+bool ListingFilter::empty() const {
+  return city.empty() && targetUser.empty() && org.empty();
+}
+
+/**
+ * @brief Returns true if the collection has a field for every parameter
+ * that is set.
+ */
+bool ListingFilter::supportedBy(const ListingFilterSpec& spec) const {
+  return (city.empty() || !spec.city.empty()) &&
+         (targetUser.empty() || !spec.targetUser.empty()) &&
+         (org.empty() || !spec.org.empty());
+}
+
+/**
+ * @brief Returns the filter as an ETag variant suffix, empty if there is
+ * no filter so unfiltered pages keep their tags. Values are escaped, so two
+ * different filters never share a suffix.
+ */
+std::string ListingFilter::variant() const {
+  std::string variant;
+  auto add = [&variant](const char* name, const std::string& value) {
+    if (!value.empty()) {
+      variant += '&';
+      variant += name;
+      variant += '=';
+      variant += escape(value);
+    }
+  };
+  add("city", city);
+  add("targetUser", targetUser);
+  add("org", org);
+  return variant;
+}
+
+/**
+ * @brief Returns the filter as the field/value pairs of a Mongo query on a
+ * collection. Parameters the collection has no field for are left out;
+ * check supportedBy() first.
+ */
+std::vector<std::pair<std::string, std::string>> ListingFilter::keyValues(
+    const ListingFilterSpec& spec) const {
+  std::vector<std::pair<std::string, std::string>> keyValues;
+  if (!city.empty() && !spec.city.empty()) {
+    keyValues.emplace_back(spec.city, city);
+  }
+  if (!targetUser.empty() && !spec.targetUser.empty()) {
+    keyValues.emplace_back(spec.targetUser, targetUser);
+  }
+  if (!org.empty() && !spec.org.empty()) {
+    keyValues.emplace_back(spec.org, org);
+  }
+  return keyValues;
+}
@@ -0,0 +1,229 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "NotificationCoalescer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace {
+
+std::string describe(const std::string& resource, const std::string& city,
+                     int count) {
+  if (count == 1) {
+    return "A new update for " + resource + " in " + city + " is available.";
+  }
+  return std::to_string(count) + " new updates for " + resource + " in " +
+         city + " are available.";
+}
+
+std::string escapeJson(const std::string& value) {
+  std::string out;
+  out.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[7];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out += escaped;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+/**
+ * @brief Renders the digest as a plain-text email body.
+ */
+std::string NotificationDigest::text() const {
+  if (updates.size() == 1) {
+    const auto& [key, count] = *updates.begin();
+    return describe(key.first, key.second, count);
+  }
+  std::string body = "Updates since your last notification:\n";
+  for (const auto& [key, count] : updates) {
+    body += "- " + describe(key.first, key.second, count) + "\n";
+  }
+  return body;
+}
+
+/**
+ * @brief Renders the digest as a webhook payload.
+ *
+ * Keeps the "message" field sent before digests existed and adds the merged
+ * (resource, city, count) entries.
+ */
+std::string NotificationDigest::json() const {
+  std::string payload = "{\"message\": \"" + escapeJson(text()) +
+                        "\", \"updates\": [";
+  bool first = true;
+  for (const auto& [key, count] : updates) {
+    if (!first) {
+      payload += ", ";
+    }
+    first = false;
+    payload += "{\"resource\": \"" + escapeJson(key.first) +
+               "\", \"city\": \"" + escapeJson(key.second) +
+               "\", \"count\": " + std::to_string(count) + "}";
+  }
+  payload += "]}";
+  return payload;
+}
+
+NotificationCoalescer::NotificationCoalescer(Clock::duration immediateWindow,
+                                             Clock::duration hourlyWindow,
+                                             Clock::duration dailyWindow)
+    : immediateWindow(immediateWindow),
+      hourlyWindow(hourlyWindow),
+      dailyWindow(dailyWindow) {}
+
+/**
+ * @brief Parses the "Delivery" field of a subscription.
+ *
+ * @param value "immediate", "hourly" or "daily" (case-insensitive).
+ * @param mode Set to the parsed mode on success.
+ * @return true if the value names a delivery mode.
+ */
+bool NotificationCoalescer::parseDeliveryMode(const std::string& value,
+                                              DeliveryMode& mode) {
+  std::string key = value;
+  std::transform(key.begin(), key.end(), key.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (key == "immediate") {
+    mode = DeliveryMode::Immediate;
+  } else if (key == "hourly") {
+    mode = DeliveryMode::Hourly;
+  } else if (key == "daily") {
+    mode = DeliveryMode::Daily;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the spelling of a delivery mode that parseDeliveryMode
+ * reads back.
+ */
+const char* NotificationCoalescer::deliveryModeName(DeliveryMode mode) {
+  switch (mode) {
+    case DeliveryMode::Hourly:
+      return "hourly";
+    case DeliveryMode::Daily:
+      return "daily";
+    default:
+      return "immediate";
+  }
+}
+
+/**
+ * @brief Records a subscriber's delivery mode. Subscribers without one are
+ * treated as immediate.
+ */
+void NotificationCoalescer::setDelivery(const std::string& subscriberId,
+                                        DeliveryMode mode) {
+  std::lock_guard<std::mutex> lock(mutex);
+  deliveryModes[subscriberId] = mode;
+}
+
+/**
+ * @brief Looks up the delivery mode recorded for a subscriber.
+ *
+ * @return false if none was recorded, i.e. the subscriber is immediate.
+ */
+bool NotificationCoalescer::deliveryOf(const std::string& subscriberId,
+                                       DeliveryMode& mode) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = deliveryModes.find(subscriberId);
+  if (found == deliveryModes.end()) {
+    return false;
+  }
+  mode = found->second;
+  return true;
+}
+
+/**
+ * @brief Drops a subscriber's delivery mode and any pending digest.
+ */
+void NotificationCoalescer::forget(const std::string& subscriberId) {
+  std::lock_guard<std::mutex> lock(mutex);
+  deliveryModes.erase(subscriberId);
+  pendingBySubscriber.erase(subscriberId);
+}
+
+NotificationCoalescer::Clock::duration NotificationCoalescer::windowFor(
+    DeliveryMode mode) const {
+  switch (mode) {
+    case DeliveryMode::Hourly:
+      return hourlyWindow;
+    case DeliveryMode::Daily:
+      return dailyWindow;
+    default:
+      return immediateWindow;
+  }
+}
+
+/**
+ * @brief Merges an update into the subscriber's pending digest.
+ *
+ * @param subscriberId The subscriber to notify.
+ * @param contact The email address or webhook URL to notify.
+ * @param resource The resource type that changed.
+ * @param city The city of the changed resource.
+ */
+void NotificationCoalescer::add(const std::string& subscriberId,
+                                const std::string& contact,
+                                const std::string& resource,
+                                const std::string& city) {
+  std::lock_guard<std::mutex> lock(mutex);
+  NotificationDigest& digest = pendingBySubscriber[subscriberId];
+  digest.subscriberId = subscriberId;
+  digest.contact = contact;
+  digest.updates[{resource, city}]++;
+}
+
+/**
+ * @brief Removes and returns every pending digest.
+ */
+std::vector<NotificationDigest> NotificationCoalescer::drainAll() {
+  std::vector<NotificationDigest> all;
+  std::lock_guard<std::mutex> lock(mutex);
+  all.reserve(pendingBySubscriber.size());
+  for (auto& [id, digest] : pendingBySubscriber) {
+    all.push_back(std::move(digest));
+  }
+  pendingBySubscriber.clear();
+  return all;
+}
+
+/**
+ * @brief Returns the coalescing window of a subscriber's delivery mode.
+ */
+NotificationCoalescer::Clock::duration NotificationCoalescer::windowOf(
+    const std::string& subscriberId) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto mode = deliveryModes.find(subscriberId);
+  return windowFor(mode == deliveryModes.end() ? DeliveryMode::Immediate
+                                               : mode->second);
+}
+
+/**
+ * @brief Returns the number of subscribers with a pending digest.
+ */
+size_t NotificationCoalescer::pending() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pendingBySubscriber.size();
+}
@@ -0,0 +1,340 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "NotificationOutbox.h"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/types.hpp>
+#include <cctype>
+#include <cmath>
+#include <random>
+#include <utility>
+
+#include "Logger.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+const char NotificationOutbox::kCollection[] = "NotificationOutbox";
+
+namespace {
+
+bsoncxx::types::b_date toDate(NotificationOutbox::Clock::time_point time) {
+  return bsoncxx::types::b_date{
+      std::chrono::time_point_cast<std::chrono::milliseconds>(time)};
+}
+
+std::string toString(const bsoncxx::document::element& element) {
+  return element ? element.get_utf8().value.to_string() : "";
+}
+
+int toInt(const bsoncxx::document::element& element) {
+  switch (element.type()) {
+    case bsoncxx::type::k_int32:
+      return element.get_int32().value;
+    case bsoncxx::type::k_int64:
+      return static_cast<int>(element.get_int64().value);
+    case bsoncxx::type::k_double:
+      return static_cast<int>(element.get_double().value);
+    default:
+      return 0;
+  }
+}
+
+// Matches a delivery only while the claim that returned it holds its lease.
+bsoncxx::document::value leased(const OutboxDelivery& delivery) {
+  return make_document(kvp("_id", bsoncxx::oid(delivery.id)),
+                       kvp("State", "sending"),
+                       kvp("LeaseUntil", toDate(delivery.leaseUntil)));
+}
+
+}  // namespace
+
+NotificationOutbox::NotificationOutbox(DatabaseManager& dbManager,
+                                       int maxAttempts, Clock::duration lease,
+                                       Clock::duration baseBackoff,
+                                       Clock::duration maxBackoff)
+    : dbManager(dbManager),
+      maxAttempts(maxAttempts),
+      lease(lease),
+      baseBackoff(baseBackoff),
+      maxBackoff(maxBackoff) {}
+
+/**
+ * @brief Creates the indexes used by the claim and stage queries.
+ */
+void NotificationOutbox::ensureIndexes() {
+  dbManager.createIndex(kCollection,
+                        make_document(kvp("Kind", 1), kvp("State", 1),
+                                      kvp("DueAt", 1)));
+  dbManager.createIndex(kCollection,
+                        make_document(kvp("Kind", 1), kvp("State", 1),
+                                      kvp("LeaseUntil", 1)));
+  dbManager.createIndex(kCollection, make_document(kvp("SubscriberId", 1),
+                                                   kvp("State", 1)));
+}
+
+/**
+ * @brief Escapes a resource and city into a single field name.
+ *
+ * Field names used with $inc cannot contain '.' or start with '$', and '|'
+ * separates the two parts, so those characters (and '%') are
+ * percent-encoded.
+ */
+std::string NotificationOutbox::encodeKey(const std::string& resource,
+                                          const std::string& city) {
+  auto escape = [](const std::string& value) {
+    std::string out;
+    for (char c : value) {
+      switch (c) {
+        case '%':
+          out += "%25";
+          break;
+        case '.':
+          out += "%2E";
+          break;
+        case '$':
+          out += "%24";
+          break;
+        case '|':
+          out += "%7C";
+          break;
+        default:
+          out += c;
+      }
+    }
+    return out;
+  };
+  return escape(resource) + "|" + escape(city);
+}
+
+/**
+ * @brief Reverses encodeKey().
+ */
+std::pair<std::string, std::string> NotificationOutbox::decodeKey(
+    const std::string& key) {
+  auto unescape = [](const std::string& value) {
+    std::string out;
+    for (size_t i = 0; i < value.size(); ++i) {
+      if (value[i] == '%' && i + 2 < value.size() &&
+          std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+          std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+        out += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+        i += 2;
+      } else {
+        out += value[i];
+      }
+    }
+    return out;
+  };
+  size_t bar = key.find('|');
+  if (bar == std::string::npos) {
+    return {unescape(key), ""};
+  }
+  return {unescape(key.substr(0, bar)), unescape(key.substr(bar + 1))};
+}
+
+/**
+ * @brief Records that a resource was added, for the dispatcher to pick up.
+ *
+ * @param resource The resource type that changed.
+ * @param city The city of the changed resource.
+ * @param now The current time.
+ */
+void NotificationOutbox::enqueue(const std::string& resource,
+                                 const std::string& city,
+                                 Clock::time_point now) {
+  dbManager.insertDocument(
+      kCollection,
+      make_document(kvp("Kind", "event"), kvp("State", "pending"),
+                    kvp("Resource", resource), kvp("City", city),
+                    kvp("DueAt", toDate(now)), kvp("CreatedAt", toDate(now))));
+}
+
+// The end of a lease taken now, as precise as the date stored with it, so
+// it can be compared with that date for equality.
+NotificationOutbox::Clock::time_point NotificationOutbox::leaseEnd(
+    Clock::time_point now) const {
+  return std::chrono::time_point_cast<std::chrono::milliseconds>(now + lease);
+}
+
+std::optional<bsoncxx::document::value> NotificationOutbox::claim(
+    const std::string& kind, const std::string& leasedState,
+    Clock::time_point now) {
+  auto filter = make_document(
+      kvp("Kind", kind),
+      kvp("$or",
+          make_array(
+              make_document(kvp("State", "pending"),
+                            kvp("DueAt", make_document(kvp("$lte",
+                                                           toDate(now))))),
+              make_document(
+                  kvp("State", leasedState),
+                  kvp("LeaseUntil",
+                      make_document(kvp("$lte", toDate(now))))))));
+  auto update = make_document(
+      kvp("$set", make_document(kvp("State", leasedState),
+                                kvp("LeaseUntil", toDate(leaseEnd(now))))));
+  return dbManager.findOneAndUpdate(kCollection, filter.view(), update.view());
+}
+
+/**
+ * @brief Leases the next unprocessed event.
+ *
+ * @param now The current time.
+ * @return The event, or nullopt if there is none.
+ */
+std::optional<OutboxEvent> NotificationOutbox::claimEvent(
+    Clock::time_point now) {
+  auto doc = claim("event", "claimed", now);
+  if (!doc) {
+    return std::nullopt;
+  }
+  auto view = doc->view();
+  OutboxEvent event;
+  event.id = view["_id"].get_oid().value.to_string();
+  event.resource = toString(view["Resource"]);
+  event.city = toString(view["City"]);
+  return event;
+}
+
+/**
+ * @brief Removes an event once it has been staged for every subscriber.
+ */
+void NotificationOutbox::completeEvent(const std::string& id) {
+  dbManager.deleteDocument(kCollection,
+                           make_document(kvp("_id", bsoncxx::oid(id))));
+}
+
+/**
+ * @brief Merges a digest into the subscriber's pending delivery record,
+ * creating it (due at dueAt) if there is none.
+ *
+ * @param digest The updates to add for one subscriber.
+ * @param dueAt When a newly created record becomes due.
+ */
+void NotificationOutbox::stage(const NotificationDigest& digest,
+                               Clock::time_point dueAt) {
+  bsoncxx::builder::basic::document counts;
+  for (const auto& [key, count] : digest.updates) {
+    counts.append(kvp("Updates." + encodeKey(key.first, key.second), count));
+  }
+  auto filter = make_document(kvp("Kind", "delivery"),
+                              kvp("SubscriberId", digest.subscriberId),
+                              kvp("State", "pending"));
+  auto update = make_document(
+      kvp("$inc", counts.extract()),
+      kvp("$set", make_document(kvp("Contact", digest.contact))),
+      kvp("$setOnInsert",
+          make_document(kvp("DueAt", toDate(dueAt)), kvp("Attempts", 0))));
+  dbManager.updateDocument(kCollection, filter.view(), update.view(), true);
+}
+
+/**
+ * @brief Leases the next delivery that is due.
+ *
+ * @param now The current time.
+ * @return The delivery, or nullopt if there is none.
+ */
+std::optional<OutboxDelivery> NotificationOutbox::claimDelivery(
+    Clock::time_point now) {
+  auto doc = claim("delivery", "sending", now);
+  if (!doc) {
+    return std::nullopt;
+  }
+  auto view = doc->view();
+  OutboxDelivery delivery;
+  delivery.id = view["_id"].get_oid().value.to_string();
+  delivery.attempts = view["Attempts"] ? toInt(view["Attempts"]) : 0;
+  delivery.digest.subscriberId = toString(view["SubscriberId"]);
+  delivery.digest.contact = toString(view["Contact"]);
+  delivery.leaseUntil = leaseEnd(now);
+  auto updates = view["Updates"];
+  if (updates) {
+    for (const auto& element : updates.get_document().value) {
+      delivery.digest.updates[decodeKey(element.key().to_string())] +=
+          toInt(element);
+    }
+  }
+  return delivery;
+}
+
+/**
+ * @brief Removes a delivery that was sent successfully.
+ *
+ * @return false if the lease was lost and the delivery left alone.
+ */
+bool NotificationOutbox::completeDelivery(const OutboxDelivery& delivery) {
+  return dbManager.deleteDocument(kCollection, leased(delivery).view());
+}
+
+bool NotificationOutbox::reschedule(const OutboxDelivery& delivery,
+                                    const std::string& state, int attempts,
+                                    Clock::time_point dueAt) {
+  auto update = make_document(
+      kvp("$set", make_document(kvp("State", state),
+                                kvp("Attempts", attempts),
+                                kvp("DueAt", toDate(dueAt)))),
+      kvp("$unset", make_document(kvp("LeaseUntil", ""))));
+  return dbManager.updateDocument(kCollection, leased(delivery).view(),
+                                  update.view(), false);
+}
+
+/**
+ * @brief Schedules another attempt after a failed send, or moves the
+ * delivery to the dead-letter state once maxAttempts is reached.
+ *
+ * @param delivery The delivery that failed.
+ * @param now The current time.
+ * @return false if the lease was lost and the delivery left alone.
+ */
+bool NotificationOutbox::retryDelivery(const OutboxDelivery& delivery,
+                                       Clock::time_point now) {
+  int attempts = delivery.attempts + 1;
+  if (attempts >= maxAttempts) {
+    LOG_ERROR("NotificationOutbox",
+              "Giving up on delivery {} to {} after {} attempts", delivery.id,
+              delivery.digest.contact, attempts);
+    return reschedule(delivery, "dead", attempts, now);
+  }
+  thread_local std::mt19937 rng{std::random_device{}()};
+  double jitter = std::uniform_real_distribution<double>(0, 1)(rng);
+  return reschedule(delivery, "pending", attempts,
+                    now + backoff(attempts, jitter));
+}
+
+/**
+ * @brief Puts a delivery back without counting an attempt, e.g. when the
+ * destination's circuit breaker is open.
+ *
+ * @param delivery The delivery to postpone.
+ * @param now The current time.
+ * @return false if the lease was lost and the delivery left alone.
+ */
+bool NotificationOutbox::deferDelivery(const OutboxDelivery& delivery,
+                                       Clock::time_point now) {
+  return reschedule(delivery, "pending", delivery.attempts,
+                    now + baseBackoff);
+}
+
+/**
+ * @brief Computes the delay before retry number attempts.
+ *
+ * The delay doubles with every attempt up to maxBackoff; the upper half of
+ * it is randomized so that deliveries failing together do not retry in
+ * lockstep.
+ *
+ * @param attempts The number of failed attempts so far (at least 1).
+ * @param jitter A sample from [0, 1).
+ */
+NotificationOutbox::Clock::duration NotificationOutbox::backoff(
+    int attempts, double jitter) const {
+  double scale = std::pow(2.0, std::max(0, attempts - 1));
+  auto delay = std::min<Clock::duration>(
+      maxBackoff, std::chrono::duration_cast<Clock::duration>(
+                      baseBackoff * std::min(scale, 1e6)));
+  return std::chrono::duration_cast<Clock::duration>(delay / 2 +
+                                                     delay * (jitter / 2));
+}
@@ -0,0 +1,282 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+
+namespace {
+
+// Buckets looked at to pick one to evict from a full shard.
+constexpr int kEvictionSamples = 4;
+
+int64_t nanos(RateLimiter::Clock::time_point at) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             at.time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Takes a token from a bucket if there is one.
+ *
+ * The bucket holds the time at which it would be empty if nothing refilled
+ * it ("theoretical arrival time"). Every request pushes that time one
+ * interval further; a request that would push it more than burst intervals
+ * past now finds the bucket empty.
+ */
+RateLimiter::Decision take(std::atomic<int64_t>& bucket,
+                           const RateLimiter::Limit& limit, int64_t now) {
+  int64_t interval = std::max<int64_t>(
+      1, std::chrono::duration_cast<std::chrono::nanoseconds>(limit.period)
+                 .count() /
+             limit.requests);
+  int64_t capacity = interval * limit.burst;
+
+  RateLimiter::Decision decision;
+  decision.limit = limit.burst;
+  int64_t tat = bucket.load(std::memory_order_relaxed);
+  while (true) {
+    int64_t next = std::max(tat, now) + interval;
+    if (next - now > capacity) {
+      decision.allowed = false;
+      decision.remaining = 0;
+      decision.reset = std::chrono::nanoseconds(std::max(tat, now) - now);
+      decision.retryAfter = std::chrono::nanoseconds(next - now - capacity);
+      return decision;
+    }
+    if (bucket.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+      decision.remaining = (capacity - (next - now)) / interval;
+      decision.reset = std::chrono::nanoseconds(next - now);
+      return decision;
+    }
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Parses a limit such as "10/s", "30/m:10" or "500/h".
+ *
+ * The number before the slash is the sustained rate per second, minute or
+ * hour; the optional number after the colon is the burst, which defaults
+ * to the rate. "off" means unlimited.
+ *
+ * @return The limit, or nullopt if spec is malformed.
+ */
+std::optional<RateLimiter::Limit> RateLimiter::Limit::parse(
+    const std::string& spec) {
+  if (spec == "off") {
+    return Limit{};
+  }
+  char* end = nullptr;
+  long long requests = std::strtoll(spec.c_str(), &end, 10);
+  if (end == spec.c_str() || requests <= 0 || *end != '/') {
+    return std::nullopt;
+  }
+  Limit limit;
+  limit.requests = requests;
+  limit.burst = requests;
+  switch (*++end) {
+    case 's':
+      limit.period = std::chrono::seconds(1);
+      break;
+    case 'm':
+      limit.period = std::chrono::minutes(1);
+      break;
+    case 'h':
+      limit.period = std::chrono::hours(1);
+      break;
+    default:
+      return std::nullopt;
+  }
+  ++end;
+  if (*end == ':') {
+    const char* burst = end + 1;
+    limit.burst = std::strtoll(burst, &end, 10);
+    if (end == burst || limit.burst <= 0) {
+      return std::nullopt;
+    }
+  }
+  if (*end != '\0') {
+    return std::nullopt;
+  }
+  return limit;
+}
+
+/**
+ * @brief Sets up the limiter.
+ *
+ * @param defaultLimit The limit of routes without one of their own.
+ * @param shards Number of independently locked bucket maps.
+ * @param maxBucketsPerShard Most buckets a shard holds; see the class
+ * comment for how it makes room.
+ */
+RateLimiter::RateLimiter(Limit defaultLimit, size_t shards,
+                         size_t maxBucketsPerShard)
+    : defaultLimit(defaultLimit),
+      maxBucketsPerShard(std::max<size_t>(1, maxBucketsPerShard)),
+      shards(std::max<size_t>(1, shards)) {}
+
+/**
+ * @brief Gives a route its own limit. Must be called before serving.
+ *
+ * @param route The request path, e.g. "/auth/login".
+ * @param limit The limit per client on that route.
+ */
+void RateLimiter::setLimit(const std::string& route, Limit limit) {
+  routeLimits[route] = limit;
+}
+
+/**
+ * @brief Sets route limits from a comma-separated list such as
+ * "/auth/login=30/m:10,/resources/food/add=5/s". Must be called before
+ * serving.
+ *
+ * @return false if any entry was malformed; the other entries still apply.
+ */
+bool RateLimiter::configure(const std::string& spec) {
+  bool ok = true;
+  size_t start = 0;
+  while (start < spec.size()) {
+    size_t end = spec.find(',', start);
+    if (end == std::string::npos) {
+      end = spec.size();
+    }
+    std::string entry = spec.substr(start, end - start);
+    start = end + 1;
+    if (entry.empty()) {
+      continue;
+    }
+    size_t equals = entry.find('=');
+    auto limit = equals == std::string::npos
+                     ? std::nullopt
+                     : Limit::parse(entry.substr(equals + 1));
+    if (!limit) {
+      ok = false;
+      continue;
+    }
+    setLimit(entry.substr(0, equals), *limit);
+  }
+  return ok;
+}
+
+/**
+ * @brief Takes a token for one request.
+ *
+ * @param route The request path; selects the limit.
+ * @param client Who is asking, e.g. "user:<id>" or "ip:<address>".
+ * @param now The current time.
+ * @return Whether the request may proceed, and the values for the
+ * X-RateLimit-* headers.
+ */
+RateLimiter::Decision RateLimiter::check(const std::string& route,
+                                         const std::string& client,
+                                         Clock::time_point now) {
+  auto routeLimit = routeLimits.find(route);
+  const Limit& limit =
+      routeLimit == routeLimits.end() ? defaultLimit : routeLimit->second;
+  if (limit.requests <= 0) {
+    return Decision{};
+  }
+
+  std::string key = route;
+  key += '\n';
+  key += client;
+  Shard& shard = shards[std::hash<std::string>{}(key) % shards.size()];
+  int64_t at = nanos(now);
+  Decision decision;
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto found = shard.buckets.find(key);
+    if (found != shard.buckets.end()) {
+      decision = take(*found->second, limit, at);
+    } else {
+      lock.unlock();
+      std::unique_lock<std::shared_mutex> exclusive(shard.mutex);
+      decision = take(add(shard, key, at), limit, at);
+    }
+  }
+  if (!decision.allowed) {
+    rejectedCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  return decision;
+}
+
+/**
+ * @brief Returns the number of buckets currently kept.
+ */
+size_t RateLimiter::bucketCount() const {
+  size_t count = 0;
+  for (const auto& shard : shards) {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    count += shard.buckets.size();
+  }
+  return count;
+}
+
+/**
+ * @brief Returns the shard's bucket for key, adding it if needed and
+ * making room first if the shard is full. Called with the shard's lock
+ * held exclusively.
+ */
+RateLimiter::Bucket& RateLimiter::add(Shard& shard, const std::string& key,
+                                       int64_t now) {
+  auto found = shard.buckets.find(key);
+  if (found != shard.buckets.end()) {
+    return *found->second;
+  }
+  // One pass over the shard per capacity's worth of additions.
+  if (++shard.addedSinceSweep >= maxBucketsPerShard) {
+    sweep(shard, now);
+    shard.addedSinceSweep = 0;
+  }
+  if (shard.buckets.size() >= maxBucketsPerShard) {
+    evictOne(shard);
+  }
+  auto& bucket = shard.buckets[key];
+  bucket = std::make_unique<Bucket>(0);
+  return *bucket;
+}
+
+/**
+ * @brief Drops the buckets that have refilled completely; such a bucket is
+ * the same as a new one.
+ */
+void RateLimiter::sweep(Shard& shard, int64_t now) {
+  for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+    if (it->second->load(std::memory_order_relaxed) <= now) {
+      it = shard.buckets.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Drops the most refilled of a few buckets picked at random.
+ *
+ * A bucket that has refilled furthest is the one whose client has been
+ * quiet longest, so this approximates dropping the least recently used
+ * bucket without keeping them in order.
+ */
+void RateLimiter::evictOne(Shard& shard) {
+  auto& buckets = shard.buckets;
+  auto victim = buckets.end();
+  int64_t victimTat = 0;
+  for (int i = 0; i < kEvictionSamples; ++i) {
+    // The map is not empty, so some hash bucket is reached; with a load
+    // factor near one that takes a step or two.
+    size_t slot = shard.random() % buckets.bucket_count();
+    while (buckets.bucket_size(slot) == 0) {
+      slot = (slot + 1) % buckets.bucket_count();
+    }
+    auto candidate = buckets.find(buckets.begin(slot)->first);
+    int64_t tat = candidate->second->load(std::memory_order_relaxed);
+    if (victim == buckets.end() || tat < victimTat) {
+      victim = candidate;
+      victimTat = tat;
+    }
+  }
+  buckets.erase(victim);
+}
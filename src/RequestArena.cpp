@@ -0,0 +1,141 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "RequestArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "Config.h"
+
+namespace {
+
+std::atomic<uint64_t> requestCount{0};
+std::atomic<uint64_t> totalBytes{0};
+std::atomic<uint64_t> peakBytes{0};
+std::atomic<uint64_t> overflowCount{0};
+
+/**
+ * @brief Forwards to another resource and counts the bytes requested.
+ */
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  explicit CountingResource(std::pmr::memory_resource* upstream)
+      : upstream(upstream) {}
+
+  size_t bytes = 0;
+
+ private:
+  std::pmr::memory_resource* upstream;
+
+  void* do_allocate(size_t size, size_t alignment) override {
+    bytes += size;
+    return upstream->allocate(size, alignment);
+  }
+
+  void do_deallocate(void* p, size_t size, size_t alignment) override {
+    upstream->deallocate(p, size, alignment);
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+/**
+ * @brief The block and resources owned by one thread. heap counts what the
+ * arena had to take from the global heap; requested counts what the request
+ * asked the arena for.
+ */
+struct ThreadArena {
+  ThreadArena()
+      : block(RequestArena::blockBytes()),
+        heap(std::pmr::new_delete_resource()),
+        arena(block.data(), block.size(), &heap),
+        requested(&arena) {}
+
+  std::vector<std::byte> block;
+  CountingResource heap;
+  std::pmr::monotonic_buffer_resource arena;
+  CountingResource requested;
+};
+
+thread_local int depth = 0;
+thread_local ThreadArena* active = nullptr;
+
+void recordPeak(uint64_t bytes) {
+  uint64_t peak = peakBytes.load(std::memory_order_relaxed);
+  while (bytes > peak &&
+         !peakBytes.compare_exchange_weak(peak, bytes,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Opens the arena for the current thread. Nested scopes share the
+ * outermost one.
+ */
+RequestArena::Scope::Scope() {
+  if (depth++ > 0) {
+    return;
+  }
+  thread_local ThreadArena arena;
+  arena.requested.bytes = 0;
+  arena.heap.bytes = 0;
+  active = &arena;
+}
+
+/**
+ * @brief Closes the scope. The outermost scope records the request in the
+ * statistics and resets the arena to its empty block.
+ */
+RequestArena::Scope::~Scope() {
+  if (--depth > 0) {
+    return;
+  }
+  uint64_t used = active->requested.bytes;
+  requestCount.fetch_add(1, std::memory_order_relaxed);
+  totalBytes.fetch_add(used, std::memory_order_relaxed);
+  recordPeak(used);
+  if (active->heap.bytes > 0) {
+    overflowCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  active->arena.release();
+  active = nullptr;
+}
+
+/**
+ * @brief Returns the memory resource request-scoped containers should use:
+ * the thread's arena inside a Scope, the default resource otherwise.
+ */
+std::pmr::memory_resource* RequestArena::resource() {
+  if (active == nullptr) {
+    return std::pmr::get_default_resource();
+  }
+  return &active->requested;
+}
+
+/**
+ * @brief Size of each thread's block, from GITGUD_ARENA_BYTES (default
+ * 16 KiB, at least 1 KiB).
+ */
+size_t RequestArena::blockBytes() {
+  static const size_t bytes = static_cast<size_t>(
+      std::max(1024LL, config::getInt("GITGUD_ARENA_BYTES", 16 * 1024)));
+  return bytes;
+}
+
+/**
+ * @brief Returns the statistics collected since the process started.
+ */
+ArenaStats RequestArena::stats() {
+  ArenaStats stats;
+  stats.requests = requestCount.load(std::memory_order_relaxed);
+  stats.bytes = totalBytes.load(std::memory_order_relaxed);
+  stats.peakBytes = peakBytes.load(std::memory_order_relaxed);
+  stats.overflows = overflowCount.load(std::memory_order_relaxed);
+  stats.blockBytes = blockBytes();
+  return stats;
+}
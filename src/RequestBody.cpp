@@ -0,0 +1,54 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "RequestBody.h"
+
+#include <string_view>
+#include <utility>
+
+#include "RequestArena.h"
+
+RequestBody::RequestBody(const std::string& json)
+    : text(json), values(RequestArena::resource()) {
+  parse(nullptr);
+}
+
+RequestBody::RequestBody(std::string&& json)
+    : text(std::move(json)), values(RequestArena::resource()) {
+  parse(nullptr);
+}
+
+RequestBody::RequestBody(const char* json)
+    : text(json), values(RequestArena::resource()) {
+  parse(nullptr);
+}
+
+/**
+ * @brief Parses a body that may only contain the given fields; any other
+ * field makes it invalid.
+ */
+RequestBody::RequestBody(const std::string& json,
+                         const std::vector<std::string>& allowedKeys)
+    : text(json), values(RequestArena::resource()) {
+  parse(&allowedKeys);
+}
+
+void RequestBody::parse(const std::vector<std::string>* allowedKeys) {
+  if (!JsonScanner::scanObject(text, values, parseError, allowedKeys) &&
+      parseError.empty()) {
+    parseError = "Invalid JSON.";
+  }
+}
+
+/**
+ * @brief Returns the value of a field.
+ *
+ * @param key The field name.
+ * @return The value, or nullopt if the body has no such field.
+ */
+std::optional<std::string> RequestBody::get(const std::string& key) const {
+  for (const auto& [name, value] : values) {
+    if (std::string_view(name) == key) {
+      return std::string(value);
+    }
+  }
+  return std::nullopt;
+}
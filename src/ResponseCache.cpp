@@ -0,0 +1,240 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "ResponseCache.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+  size_t start = text.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    return {};
+  }
+  size_t end = text.find_last_not_of(" \t");
+  return text.substr(start, end - start + 1);
+}
+
+// Reads the q parameter of one Accept-Encoding entry; 1 if absent.
+double qualityOf(std::string_view parameters) {
+  size_t q = parameters.find("q=");
+  if (q == std::string_view::npos) {
+    return 1.0;
+  }
+  std::string value(trim(parameters.substr(q + 2)));
+  char* end = nullptr;
+  double quality = std::strtod(value.c_str(), &end);
+  return end == value.c_str() ? 1.0 : quality;
+}
+
+}  // namespace
+
+/**
+ * @brief Sets up the cache.
+ *
+ * @param maxBytes Total size of cached bodies, both encodings counted.
+ * @param minCompressBytes Bodies shorter than this are never compressed.
+ * @param level zlib compression level, 1 (fastest) to 9 (smallest); 0
+ * turns compression off.
+ */
+ResponseCache::ResponseCache(size_t maxBytes, size_t minCompressBytes,
+                             int level)
+    : maxBytes(maxBytes),
+      minCompressBytes(minCompressBytes),
+      level(std::clamp(level, 0, 9)) {}
+
+/**
+ * @brief Looks up a listing by ETag.
+ *
+ * @param etag The listing's ETag.
+ * @param accepted The encoding the client accepts, from negotiate().
+ * @return The body to send and its encoding, compressing it now if this is
+ * the first client to want it compressed; nullopt if the listing is not
+ * cached.
+ */
+std::optional<ResponseCache::Representation> ResponseCache::find(
+    const std::string& etag, Encoding accepted) {
+  std::shared_ptr<const std::string> identity;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(etag);
+    if (found == entries.end()) {
+      misses++;
+      return std::nullopt;
+    }
+    hits++;
+    recency.splice(recency.begin(), recency, found->second.recency);
+    identity = found->second.identity;
+    if (!compresses(*identity, accepted)) {
+      return Representation{identity, Encoding::Identity};
+    }
+    if (found->second.gzip) {
+      return Representation{found->second.gzip, Encoding::Gzip};
+    }
+  }
+  return addGzip(etag, identity);
+}
+
+/**
+ * @brief Caches a freshly loaded listing.
+ *
+ * @param etag The listing's ETag.
+ * @param body The listing as loaded.
+ * @param accepted The encoding the client accepts, from negotiate().
+ * @return The body to send and its encoding.
+ */
+ResponseCache::Representation ResponseCache::store(const std::string& etag,
+                                                   std::string body,
+                                                   Encoding accepted) {
+  auto identity = std::make_shared<const std::string>(std::move(body));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(etag);
+    if (found == entries.end()) {
+      recency.push_front(etag);
+      entries.emplace(etag, Entry{identity, nullptr, recency.begin()});
+      bytes += identity->size();
+      evict();
+    } else if (found->second.gzip && compresses(*identity, accepted)) {
+      return Representation{found->second.gzip, Encoding::Gzip};
+    }
+  }
+  if (!compresses(*identity, accepted)) {
+    return Representation{identity, Encoding::Identity};
+  }
+  return addGzip(etag, identity);
+}
+
+/**
+ * @brief Returns the cache's counters.
+ */
+ResponseCacheStats ResponseCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  ResponseCacheStats result;
+  result.hits = hits;
+  result.misses = misses;
+  result.compressions = compressions;
+  result.bytes = bytes;
+  result.entries = entries.size();
+  return result;
+}
+
+/**
+ * @brief Picks the encoding for a response from the Accept-Encoding header.
+ *
+ * @return Gzip if the client accepts gzip (or "*") with a non-zero q value.
+ */
+ResponseCache::Encoding ResponseCache::negotiate(
+    std::string_view acceptEncoding) {
+  double gzipQuality = -1;
+  double anyQuality = -1;
+  while (!acceptEncoding.empty()) {
+    size_t comma = acceptEncoding.find(',');
+    std::string_view entry = acceptEncoding.substr(0, comma);
+    acceptEncoding = comma == std::string_view::npos
+                         ? std::string_view()
+                         : acceptEncoding.substr(comma + 1);
+    size_t semicolon = entry.find(';');
+    std::string name(trim(entry.substr(0, semicolon)));
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    double quality = semicolon == std::string_view::npos
+                         ? 1.0
+                         : qualityOf(entry.substr(semicolon + 1));
+    if (name == "gzip" || name == "x-gzip") {
+      gzipQuality = quality;
+    } else if (name == "*") {
+      anyQuality = quality;
+    }
+  }
+  double quality = gzipQuality >= 0 ? gzipQuality : anyQuality;
+  return quality > 0 ? Encoding::Gzip : Encoding::Identity;
+}
+
+/**
+ * @brief Returns the ETag of one encoding of a listing. Each encoding has
+ * its own strong tag, as the bytes differ.
+ */
+std::string ResponseCache::taggedFor(const std::string& etag,
+                                     Encoding encoding) {
+  if (encoding == Encoding::Identity) {
+    return etag;
+  }
+  if (!etag.empty() && etag.back() == '"') {
+    return etag.substr(0, etag.size() - 1) + "-gzip\"";
+  }
+  return etag + "-gzip";
+}
+
+/**
+ * @brief Compresses a body in gzip format.
+ *
+ * @throws std::runtime_error If zlib fails.
+ */
+std::string ResponseCache::gzip(std::string_view body, int level) {
+  z_stream stream{};
+  // 15 window bits plus 16 selects the gzip wrapper instead of zlib's.
+  if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::runtime_error("Failed to initialize gzip.");
+  }
+  std::string output(deflateBound(&stream, body.size()), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  stream.avail_in = static_cast<uInt>(body.size());
+  stream.next_out = reinterpret_cast<Bytef*>(output.data());
+  stream.avail_out = static_cast<uInt>(output.size());
+  int result = deflate(&stream, Z_FINISH);
+  output.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    throw std::runtime_error("Failed to gzip response.");
+  }
+  return output;
+}
+
+bool ResponseCache::compresses(const std::string& body,
+                               Encoding accepted) const {
+  return accepted == Encoding::Gzip && level > 0 &&
+         body.size() >= minCompressBytes;
+}
+
+/**
+ * @brief Compresses a cached listing outside the lock and keeps the
+ * result. Two requests that miss at once may both compress; the first
+ * result is kept.
+ */
+ResponseCache::Representation ResponseCache::addGzip(
+    const std::string& etag, std::shared_ptr<const std::string> identity) {
+  auto compressed = std::make_shared<const std::string>(gzip(*identity, level));
+  std::lock_guard<std::mutex> lock(mutex);
+  compressions++;
+  auto found = entries.find(etag);
+  if (found != entries.end()) {
+    if (found->second.gzip) {
+      return Representation{found->second.gzip, Encoding::Gzip};
+    }
+    found->second.gzip = compressed;
+    bytes += compressed->size();
+    evict();
+  }
+  return Representation{compressed, Encoding::Gzip};
+}
+
+// Drops least recently used entries until the cache fits in maxBytes.
+void ResponseCache::evict() {
+  while (bytes > maxBytes && !recency.empty()) {
+    auto found = entries.find(recency.back());
+    bytes -= found->second.identity->size();
+    if (found->second.gzip) {
+      bytes -= found->second.gzip->size();
+    }
+    entries.erase(found);
+    recency.pop_back();
+  }
+}
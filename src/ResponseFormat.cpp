@@ -0,0 +1,424 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "ResponseFormat.h"
+
+#include <algorithm>
+#include <bsoncxx/array/view.hpp>
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+  size_t start = text.find_first_not_of(" \t");
+  if (start == std::string_view::npos) {
+    return {};
+  }
+  size_t end = text.find_last_not_of(" \t");
+  return text.substr(start, end - start + 1);
+}
+
+// Reads the q parameter of one Accept entry; 1 if absent.
+double qualityOf(std::string_view parameters) {
+  size_t q = parameters.find("q=");
+  if (q == std::string_view::npos) {
+    return 1.0;
+  }
+  std::string value(trim(parameters.substr(q + 2)));
+  char* end = nullptr;
+  double quality = std::strtod(value.c_str(), &end);
+  return end == value.c_str() ? 1.0 : quality;
+}
+
+bool formatOf(const std::string& mediaType, ResponseFormat::Format& format) {
+  if (mediaType == "application/json" || mediaType == "application/*" ||
+      mediaType == "*/*") {
+    format = ResponseFormat::Format::Json;
+  } else if (mediaType == "application/bson") {
+    format = ResponseFormat::Format::Bson;
+  } else if (mediaType == "application/msgpack" ||
+             mediaType == "application/x-msgpack" ||
+             mediaType == "application/vnd.msgpack") {
+    format = ResponseFormat::Format::MessagePack;
+  } else if (mediaType == "application/cbor") {
+    format = ResponseFormat::Format::Cbor;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void appendBigEndian(std::string& out, uint64_t value, int bytes) {
+  for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+    out.push_back(static_cast<char>((value >> shift) & 0xFF));
+  }
+}
+
+uint64_t bitsOf(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/**
+ * @brief Writes MessagePack, always in the shortest form of each value.
+ */
+class MessagePackWriter {
+ public:
+  explicit MessagePackWriter(std::string& out) : out(out) {}
+
+  void beginMap(uint32_t size) { header(size, 0x80, 0xde, 0xdf); }
+  void beginArray(uint32_t size) { header(size, 0x90, 0xdc, 0xdd); }
+
+  void string(std::string_view text) {
+    size_t size = text.size();
+    if (size < 32) {
+      out.push_back(static_cast<char>(0xa0 | size));
+    } else if (size <= 0xFF) {
+      out.push_back(static_cast<char>(0xd9));
+      appendBigEndian(out, size, 1);
+    } else if (size <= 0xFFFF) {
+      out.push_back(static_cast<char>(0xda));
+      appendBigEndian(out, size, 2);
+    } else {
+      out.push_back(static_cast<char>(0xdb));
+      appendBigEndian(out, size, 4);
+    }
+    out.append(text);
+  }
+
+  void binary(const uint8_t* bytes, uint32_t size) {
+    if (size <= 0xFF) {
+      out.push_back(static_cast<char>(0xc4));
+      appendBigEndian(out, size, 1);
+    } else if (size <= 0xFFFF) {
+      out.push_back(static_cast<char>(0xc5));
+      appendBigEndian(out, size, 2);
+    } else {
+      out.push_back(static_cast<char>(0xc6));
+      appendBigEndian(out, size, 4);
+    }
+    out.append(reinterpret_cast<const char*>(bytes), size);
+  }
+
+  void integer(int64_t value) {
+    if (value >= -32 && value < 128) {
+      // Positive and negative fixints are the value's own low byte.
+      out.push_back(static_cast<char>(value));
+    } else if (value >= INT32_MIN && value <= INT32_MAX) {
+      out.push_back(static_cast<char>(0xd2));
+      appendBigEndian(out, static_cast<uint64_t>(value), 4);
+    } else {
+      out.push_back(static_cast<char>(0xd3));
+      appendBigEndian(out, static_cast<uint64_t>(value), 8);
+    }
+  }
+
+  void real(double value) {
+    out.push_back(static_cast<char>(0xcb));
+    appendBigEndian(out, bitsOf(value), 8);
+  }
+
+  void boolean(bool value) {
+    out.push_back(static_cast<char>(value ? 0xc3 : 0xc2));
+  }
+
+  void null() { out.push_back(static_cast<char>(0xc0)); }
+
+ private:
+  std::string& out;
+
+  void header(uint32_t size, uint8_t fixed, uint8_t size16, uint8_t size32) {
+    if (size < 16) {
+      out.push_back(static_cast<char>(fixed | size));
+    } else if (size <= 0xFFFF) {
+      out.push_back(static_cast<char>(size16));
+      appendBigEndian(out, size, 2);
+    } else {
+      out.push_back(static_cast<char>(size32));
+      appendBigEndian(out, size, 4);
+    }
+  }
+};
+
+/**
+ * @brief Writes CBOR (RFC 8949) with definite lengths, always in the
+ * shortest form of each value.
+ */
+class CborWriter {
+ public:
+  explicit CborWriter(std::string& out) : out(out) {}
+
+  void beginMap(uint32_t size) { head(5, size); }
+  void beginArray(uint32_t size) { head(4, size); }
+
+  void string(std::string_view text) {
+    head(3, text.size());
+    out.append(text);
+  }
+
+  void binary(const uint8_t* bytes, uint32_t size) {
+    head(2, size);
+    out.append(reinterpret_cast<const char*>(bytes), size);
+  }
+
+  void integer(int64_t value) {
+    if (value >= 0) {
+      head(0, static_cast<uint64_t>(value));
+    } else {
+      // Major type 1 holds -1 - value, which is the complement of value.
+      head(1, ~static_cast<uint64_t>(value));
+    }
+  }
+
+  void real(double value) {
+    out.push_back(static_cast<char>(0xfb));
+    appendBigEndian(out, bitsOf(value), 8);
+  }
+
+  void boolean(bool value) {
+    out.push_back(static_cast<char>(value ? 0xf5 : 0xf4));
+  }
+
+  void null() { out.push_back(static_cast<char>(0xf6)); }
+
+ private:
+  std::string& out;
+
+  void head(uint8_t major, uint64_t argument) {
+    uint8_t type = static_cast<uint8_t>(major << 5);
+    if (argument < 24) {
+      out.push_back(static_cast<char>(type | argument));
+    } else if (argument <= 0xFF) {
+      out.push_back(static_cast<char>(type | 24));
+      appendBigEndian(out, argument, 1);
+    } else if (argument <= 0xFFFF) {
+      out.push_back(static_cast<char>(type | 25));
+      appendBigEndian(out, argument, 2);
+    } else if (argument <= 0xFFFFFFFF) {
+      out.push_back(static_cast<char>(type | 26));
+      appendBigEndian(out, argument, 4);
+    } else {
+      out.push_back(static_cast<char>(type | 27));
+      appendBigEndian(out, argument, 8);
+    }
+  }
+};
+
+template <typename View>
+uint32_t countOf(const View& view) {
+  uint32_t count = 0;
+  for (auto it = view.begin(); it != view.end(); ++it) {
+    count++;
+  }
+  return count;
+}
+
+template <typename Writer>
+void writeDocument(Writer& out, bsoncxx::document::view document);
+
+template <typename Writer>
+void writeArray(Writer& out, bsoncxx::array::view array);
+
+// Document and array elements are unrelated types with the same getters.
+template <typename Writer, typename Element>
+void writeValue(Writer& out, const Element& element) {
+  switch (element.type()) {
+    case bsoncxx::type::k_utf8: {
+      auto text = element.get_utf8().value;
+      out.string(std::string_view(text.data(), text.size()));
+      break;
+    }
+    case bsoncxx::type::k_oid:
+      out.string(element.get_oid().value.to_string());
+      break;
+    case bsoncxx::type::k_int32:
+      out.integer(element.get_int32().value);
+      break;
+    case bsoncxx::type::k_int64:
+      out.integer(element.get_int64().value);
+      break;
+    case bsoncxx::type::k_double:
+      out.real(element.get_double().value);
+      break;
+    case bsoncxx::type::k_bool:
+      out.boolean(element.get_bool().value);
+      break;
+    case bsoncxx::type::k_date:
+      out.integer(element.get_date().value.count());
+      break;
+    case bsoncxx::type::k_decimal128:
+      out.string(element.get_decimal128().value.to_string());
+      break;
+    case bsoncxx::type::k_binary: {
+      auto binary = element.get_binary();
+      out.binary(binary.bytes, binary.size);
+      break;
+    }
+    case bsoncxx::type::k_document:
+      writeDocument(out, element.get_document().value);
+      break;
+    case bsoncxx::type::k_array:
+      writeArray(out, element.get_array().value);
+      break;
+    default:
+      // Null, and the types the API never stores (regexes, code, min and
+      // max keys).
+      out.null();
+      break;
+  }
+}
+
+template <typename Writer>
+void writeDocument(Writer& out, bsoncxx::document::view document) {
+  out.beginMap(countOf(document));
+  for (const auto& element : document) {
+    auto key = element.key();
+    out.string(std::string_view(key.data(), key.size()));
+    writeValue(out, element);
+  }
+}
+
+template <typename Writer>
+void writeArray(Writer& out, bsoncxx::array::view array) {
+  out.beginArray(countOf(array));
+  for (const auto& element : array) {
+    writeValue(out, element);
+  }
+}
+
+template <typename Writer>
+std::string writeListing(
+    const std::vector<bsoncxx::document::value>& documents) {
+  std::string out;
+  Writer writer(out);
+  writer.beginArray(static_cast<uint32_t>(documents.size()));
+  for (const auto& document : documents) {
+    writeDocument(writer, document.view());
+  }
+  return out;
+}
+
+}  // namespace
+
+/**
+ * @brief Picks the format of a listing from the Accept header.
+ *
+ * @param accept The Accept header; may be empty.
+ * @return The supported format with the highest q value, the earliest one
+ * on a tie; JSON if the client names none of them.
+ */
+ResponseFormat::Format ResponseFormat::negotiate(std::string_view accept) {
+  Format best = Format::Json;
+  double bestQuality = 0;
+  while (!accept.empty()) {
+    size_t comma = accept.find(',');
+    std::string_view entry = accept.substr(0, comma);
+    accept = comma == std::string_view::npos ? std::string_view()
+                                             : accept.substr(comma + 1);
+    size_t semicolon = entry.find(';');
+    std::string mediaType(trim(entry.substr(0, semicolon)));
+    std::transform(mediaType.begin(), mediaType.end(), mediaType.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    double quality = semicolon == std::string_view::npos
+                         ? 1.0
+                         : qualityOf(entry.substr(semicolon + 1));
+    Format format;
+    if (formatOf(mediaType, format) && quality > bestQuality) {
+      best = format;
+      bestQuality = quality;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Returns the Content-Type of a format.
+ */
+const char* ResponseFormat::contentType(Format format) {
+  switch (format) {
+    case Format::Bson:
+      return "application/bson";
+    case Format::MessagePack:
+      return "application/msgpack";
+    case Format::Cbor:
+      return "application/cbor";
+    default:
+      return "application/json";
+  }
+}
+
+/**
+ * @brief Returns a short name of a format, used in listing ETags.
+ */
+const char* ResponseFormat::name(Format format) {
+  switch (format) {
+    case Format::Bson:
+      return "bson";
+    case Format::MessagePack:
+      return "msgpack";
+    case Format::Cbor:
+      return "cbor";
+    default:
+      return "json";
+  }
+}
+
+/**
+ * @brief Returns the ETag variant of a listing page in a format. JSON pages
+ * keep the tags they had before there were other formats.
+ */
+std::string ResponseFormat::variant(int start, Format format) {
+  std::string variant = "start=" + std::to_string(start);
+  if (format != Format::Json) {
+    variant += "&format=";
+    variant += name(format);
+  }
+  return variant;
+}
+
+/**
+ * @brief Encodes a page of documents as a listing.
+ *
+ * @param documents The documents as read from the database.
+ * @param format The format to write.
+ * @return A JSON, MessagePack or CBOR array of the documents, or for BSON
+ * the documents' own bytes back to back.
+ */
+std::string ResponseFormat::encode(
+    const std::vector<bsoncxx::document::value>& documents, Format format) {
+  switch (format) {
+    case Format::Bson: {
+      std::string out;
+      size_t size = 0;
+      for (const auto& document : documents) {
+        size += document.view().length();
+      }
+      out.reserve(size);
+      for (const auto& document : documents) {
+        auto view = document.view();
+        out.append(reinterpret_cast<const char*>(view.data()), view.length());
+      }
+      return out;
+    }
+    case Format::MessagePack:
+      return writeListing<MessagePackWriter>(documents);
+    case Format::Cbor:
+      return writeListing<CborWriter>(documents);
+    default: {
+      if (documents.empty()) {
+        return "[]";
+      }
+      bsoncxx::builder::basic::array arrayBuilder;
+      for (const auto& document : documents) {
+        arrayBuilder.append(document.view());
+      }
+      return bsoncxx::to_json(arrayBuilder.view());
+    }
+  }
+}
@@ -2,20 +2,93 @@
 
 #include "RouteController.h"
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
 
+#include "CollectionVersions.h"
+#include "Config.h"
+#include "Deadline.h"
 #include "Food.h"
 #include "Healthcare.h"
 #include "Logger.h"
 #include "Outreach.h"
+#include "RequestArena.h"
+#include "RequestBody.h"
 
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
 #include <bsoncxx/json.hpp>
 
+/**
+ * @brief Releases an admitted request's slot once its handler is done.
+ * Handlers queued on the executor hold one too, so the executor is drained
+ * by RouteController::shutdown() while the AdmissionController still lives.
+ */
+class AdmissionSlot {
+ public:
+  AdmissionSlot(AdmissionController* admission, RouteClass routeClass)
+      : admission(admission), routeClass(routeClass) {}
+  ~AdmissionSlot() {
+    if (admission != nullptr) {
+      admission->finished(routeClass);
+    }
+  }
+  AdmissionSlot(const AdmissionSlot&) = delete;
+  AdmissionSlot& operator=(const AdmissionSlot&) = delete;
+
+ private:
+  AdmissionController* admission;
+  RouteClass routeClass;
+};
+
+/**
+ * @brief Marks a bearer token as verified for the request being handled on
+ * this thread, so the handler does not check its signature again.
+ */
+class VerifiedToken {
+ public:
+  explicit VerifiedToken(const std::string& token)
+      : previous(current), token(token) {
+    current = token.empty() ? nullptr : &this->token;
+  }
+  ~VerifiedToken() { current = previous; }
+  VerifiedToken(const VerifiedToken&) = delete;
+  VerifiedToken& operator=(const VerifiedToken&) = delete;
+
+  static bool is(const std::string& token) {
+    return current != nullptr && *current == token;
+  }
+
+ private:
+  static thread_local const std::string* current;
+  const std::string* previous;
+  std::string token;
+};
+
+thread_local const std::string* VerifiedToken::current = nullptr;
+
+/**
+ * @brief What a live feed connection follows, kept in the connection's
+ * user data from the handshake until it closes.
+ */
+struct FeedSubscription {
+  std::string resource;
+  std::string city;
+  std::optional<uint64_t> id;
+};
+
 crow::response handleException(const std::exception& e) {
   std::cerr << "Error: " << e.what() << std::endl;
+  if (auto deadline = dynamic_cast<const DeadlineExceeded*>(&e)) {
+    crow::response response{504, e.what()};
+    response.set_header("X-Deadline-Stage", deadline->stage());
+    return response;
+  }
   return crow::response{500, "An error has occurred: " + std::string(e.what())};
   std::cerr << "Error: " << e.what() << std::endl;
   return crow::response{500, "An error has occurred: " + std::string(e.what())};
@@ -40,7 +113,7 @@ bool RouteController::authenticateToken(const crow::request& req,
     return false;
   }
 
-  if (!authService.verifyJWT(token)) {
+  if (!VerifiedToken::is(token) && !authService.verifyJWT(token)) {
     res.code = 401;
     res.write("Invalid or expired token.");
     res.end();
@@ -109,9 +182,24 @@ void RouteController::getShelter(const crow::request& req,
     if (start_param && std::stoi(start_param) > 0) {
       start = std::stoi(start_param);
     }
-    std::string response = shelterManager.searchShelterAll(start);
-    res.code = 200;
-    res.write(response);
+    auto format = ResponseFormat::negotiate(req.get_header_value("Accept"));
+    ListingFilter filter = listingFilter(req);
+    if (!acceptsFilter(filter, Shelter::kFilterSpec, res)) {
+      return;
+    }
+    bool replicated = replicates("ShelterService");
+    std::string etag =
+        replicated
+            ? catalogue->listingETag("ShelterService", start, format, filter)
+            : shelterManager.listingETag(start, format, filter);
+    if (serveListing(req, res, etag, format)) {
+      return;
+    }
+    std::string response =
+        replicated
+            ? catalogue->listing("ShelterService", start, format, filter)
+            : shelterManager.encodedListing(start, format, filter);
+    sendListing(req, res, etag, response);
     LOG_INFO("RouteController", "getShelter response: code={}, body={}",
              res.code, response);
     res.end();
@@ -153,30 +241,26 @@ void RouteController::addShelter(const crow::request& req,
     return;
   }
   try {
-    std::string result = shelterManager.addShelter(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = shelterManager.addShelter(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "addShelter validation error: code={}, message={}", res.code,
-                result);
+                result.error().message);
     } else {
       res.code = 201;
-      res.write(result);
-
-      auto resource = bsoncxx::from_json(req.body);
-      std::string city = "";
+      res.write(result.value());
 
-      for (auto element : resource.view()) {
-        if (element.key().to_string() == "City")
-          city = element.get_utf8().value.to_string();
-      }
+      std::string city = body.get("City").value_or("");
 
       subscriptionManager.notifySubscribers("shelter", city);
+      publishChange("shelter", "add", result.value(), city, body.raw());
 
       LOG_INFO("RouteController", "addShelter success: code={}, response={}",
-               res.code, result);
+               res.code, result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -225,19 +309,22 @@ void RouteController::updateShelter(const crow::request& req,
     return;
   }
   try {
-    std::string result = shelterManager.updateShelter(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = shelterManager.updateShelter(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "updateShelter validation error: code={}, message={}", res.code,
-                result);
+                result.error().message);
     } else {
       res.code = 200;
       res.write("Shelter resource updated successfully.");
+      publishChange("shelter", "update", body.get("id").value_or(""),
+                    body.get("City").value_or(""), body.raw());
       LOG_INFO("RouteController", "updateShelter success: code={}, response={}",
-               res.code, result);
+               res.code, result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -288,14 +375,13 @@ void RouteController::deleteShelter(const crow::request& req,
     return;
   }
   try {
-    auto resource = bsoncxx::from_json(req.body);
-    std::string id = "";
-    for (auto element : resource.view()) {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
-      }
+    RequestBody body(req.body);
+    if (!body.valid()) {
+      throw std::invalid_argument(body.error());
     }
+    std::string id = body.get("id").value_or("");
     shelterManager.deleteShelter(id, req.get_header_value("Authorization"));
+    publishChange("shelter", "delete", id, "");
     res.code = 200;
     std::string message = "Shelter resource deleted successfully.";
     res.write(message);
@@ -357,9 +443,24 @@ void RouteController::getCounseling(const crow::request& req,
     if (start_param && std::stoi(start_param) > 0) {
       start = std::stoi(start_param);
     }
-    std::string response = counselingManager.searchCounselorsAll(start);
-    res.code = 200;
-    res.write(response);
+    auto format = ResponseFormat::negotiate(req.get_header_value("Accept"));
+    ListingFilter filter = listingFilter(req);
+    if (!acceptsFilter(filter, Counseling::kFilterSpec, res)) {
+      return;
+    }
+    bool replicated = replicates("CounselingService");
+    std::string etag =
+        replicated
+            ? catalogue->listingETag("CounselingService", start, format, filter)
+            : counselingManager.listingETag(start, format, filter);
+    if (serveListing(req, res, etag, format)) {
+      return;
+    }
+    std::string response =
+        replicated
+            ? catalogue->listing("CounselingService", start, format, filter)
+            : counselingManager.encodedListing(start, format, filter);
+    sendListing(req, res, etag, response);
     LOG_INFO("RouteController", "getCounseling response: code={}, body={}",
              res.code, response);
     res.end();
@@ -412,29 +513,25 @@ void RouteController::addCounseling(const crow::request& req,
     return;
   }
   try {
-    std::string result = counselingManager.addCounselor(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = counselingManager.addCounselor(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "addCounseling validation error: code={}, message={}", res.code,
-                result);
+                result.error().message);
     } else {
       res.code = 201;
-      res.write(result);
-
-      auto resource = bsoncxx::from_json(req.body);
-      std::string city = "";
+      res.write(result.value());
 
-      for (auto element : resource.view()) {
-        if (element.key().to_string() == "City")
-          city = element.get_utf8().value.to_string();
-      }
+      std::string city = body.get("City").value_or("");
 
       subscriptionManager.notifySubscribers("counseling", city);
+      publishChange("counseling", "add", result.value(), city, body.raw());
       LOG_INFO("RouteController", "addCounseling success: code={}, response={}",
-               res.code, result);
+               res.code, result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -486,20 +583,23 @@ void RouteController::updateCounseling(const crow::request& req,
     return;
   }
   try {
-    std::string result = counselingManager.updateCounselor(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = counselingManager.updateCounselor(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "updateCounseling validation error: code={}, message={}",
-                res.code, result);
+                res.code, result.error().message);
     } else {
       res.code = 200;
       res.write("Counseling resource updated successfully.");
+      publishChange("counseling", "update", body.get("id").value_or(""),
+                    body.get("City").value_or(""), body.raw());
       LOG_INFO("RouteController",
                "updateCounseling success: code={}, response={}", res.code,
-               result);
+               result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -552,15 +652,14 @@ void RouteController::deleteCounseling(const crow::request& req,
     return;
   }
   try {
-    auto resource = bsoncxx::from_json(req.body);
-    std::string id = "";
-    for (auto element : resource.view()) {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
-      }
+    RequestBody body(req.body);
+    if (!body.valid()) {
+      throw std::invalid_argument(body.error());
     }
+    std::string id = body.get("id").value_or("");
     counselingManager.deleteCounselor(id,
                                       req.get_header_value("Authorization"));
+    publishChange("counseling", "delete", id, "");
     res.code = 200;
     std::string message = "Counseling resource deleted successfully.";
     res.write(message);
@@ -616,29 +715,25 @@ void RouteController::addFood(const crow::request& req, crow::response& res) {
     return;
   }
   try {
-    std::string result =
-        foodManager.addFood(req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result =
+        foodManager.addFood(body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "addFood validation error: code={}, message={}", res.code,
-                result);
+                result.error().message);
     } else {
       res.code = 201;
-      res.write(result);
+      res.write(result.value());
 
-      auto resource = bsoncxx::from_json(req.body);
-      std::string city = "";
-
-      for (auto element : resource.view()) {
-        if (element.key().to_string() == "City")
-          city = element.get_utf8().value.to_string();
-      }
+      std::string city = body.get("City").value_or("");
 
       subscriptionManager.notifySubscribers("food", city);
+      publishChange("food", "add", result.value(), city, body.raw());
       LOG_INFO("RouteController", "addFood success: code={}, response={}",
-               res.code, result);
+               res.code, result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -698,11 +793,26 @@ void RouteController::getAllFood(const crow::request& req,
     if (start_param && std::stoi(start_param) > 0) {
       start = std::stoi(start_param);
     }
-    std::string response = foodManager.getAllFood(start);
+    auto format = ResponseFormat::negotiate(req.get_header_value("Accept"));
+    ListingFilter filter = listingFilter(req);
+    if (!acceptsFilter(filter, Food::kFilterSpec, res)) {
+      return;
+    }
+    bool replicated = replicates("Food");
+    std::string etag =
+        replicated
+            ? catalogue->listingETag("Food", start, format, filter)
+            : foodManager.listingETag(start, format, filter);
+    if (serveListing(req, res, etag, format)) {
+      return;
+    }
+    std::string response =
+        replicated
+            ? catalogue->listing("Food", start, format, filter)
+            : foodManager.encodedListing(start, format, filter);
 
     // Return the raw response without additional formatting
-    res.code = 200;
-    res.write(response);
+    sendListing(req, res, etag, response);
     LOG_INFO("RouteController", "getAllFood response: code={}, body={}",
              res.code, response);
     res.end();
@@ -755,14 +865,13 @@ void RouteController::deleteFood(const crow::request& req,
     return;
   }
   try {
-    auto resource = bsoncxx::from_json(req.body);
-    std::string id = "";
-    for (auto element : resource.view()) {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
-      }
+    RequestBody body(req.body);
+    if (!body.valid()) {
+      throw std::invalid_argument(body.error());
     }
+    std::string id = body.get("id").value_or("");
     foodManager.deleteFood(id, req.get_header_value("Authorization"));
+    publishChange("food", "delete", id, "");
     res.code = 200;
     std::string message = "Food resource deleted successfully.";
     res.write(message);
@@ -817,19 +926,22 @@ void RouteController::updateFood(const crow::request& req,
     return;
   }
   try {
-    std::string result =
-        foodManager.updateFood(req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = foodManager.updateFood(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "updateFood validation error: code={}, message={}", res.code,
-                result);
+                result.error().message);
     } else {
       res.code = 200;
       res.write("Food resource updated successfully.");
+      publishChange("food", "update", body.get("id").value_or(""),
+                    body.get("City").value_or(""), body.raw());
       LOG_INFO("RouteController", "updateFood success: code={}, response={}",
-               res.code, result);
+               res.code, result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -882,30 +994,26 @@ void RouteController::addOutreachService(const crow::request& req,
     return;
   }
   try {
-    std::string result = outreachManager.addOutreachService(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = outreachManager.addOutreachService(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "addOutreachService validation error: code={}, message={}",
-                res.code, result);
+                res.code, result.error().message);
     } else {
       res.code = 201;
-      res.write(result);
+      res.write(result.value());
 
-      auto resource = bsoncxx::from_json(req.body);
-      std::string city = "";
-
-      for (auto element : resource.view()) {
-        if (element.key().to_string() == "City")
-          city = element.get_utf8().value.to_string();
-      }
+      std::string city = body.get("City").value_or("");
 
       subscriptionManager.notifySubscribers("outreach", city);
+      publishChange("outreach", "add", result.value(), city, body.raw());
       LOG_INFO("RouteController",
                "addOutreachService success: code={}, response={}", res.code,
-               result);
+               result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -966,10 +1074,24 @@ void RouteController::getAllOutreachServices(const crow::request& req,
     if (start_param && std::stoi(start_param) > 0) {
       start = std::stoi(start_param);
     }
-    std::string response = outreachManager.getAllOutreachServices(
-        start);  // Retrieve all outreach services
-    res.code = 200;
-    res.write(response);
+    auto format = ResponseFormat::negotiate(req.get_header_value("Accept"));
+    ListingFilter filter = listingFilter(req);
+    if (!acceptsFilter(filter, Outreach::kFilterSpec, res)) {
+      return;
+    }
+    bool replicated = replicates("OutreachService");
+    std::string etag =
+        replicated
+            ? catalogue->listingETag("OutreachService", start, format, filter)
+            : outreachManager.listingETag(start, format, filter);
+    if (serveListing(req, res, etag, format)) {
+      return;
+    }
+    std::string response =
+        replicated
+            ? catalogue->listing("OutreachService", start, format, filter)
+            : outreachManager.encodedListing(start, format, filter);
+    sendListing(req, res, etag, response);
     LOG_INFO("RouteController",
              "getAllOutreachServices response: code={}, body={}", res.code,
              response);
@@ -1021,20 +1143,23 @@ void RouteController::updateOutreach(const crow::request& req,
     return;
   }
   try {
-    std::string result = outreachManager.updateOutreach(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = outreachManager.updateOutreach(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "updateOutreach validation error: code={}, message={}",
-                res.code, result);
+                res.code, result.error().message);
     } else {
       res.code = 200;
       res.write("Outreach resource update successfully.");
+      publishChange("outreach", "update", body.get("id").value_or(""),
+                    body.get("City").value_or(""), body.raw());
       LOG_INFO("RouteController",
                "updateOutreach success: code={}, response={}", res.code,
-               result);
+               result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -1082,14 +1207,13 @@ void RouteController::deleteOutreach(const crow::request& req,
     return;
   }
   try {
-    auto resource = bsoncxx::from_json(req.body);
-    std::string id = "";
-    for (auto element : resource.view()) {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
-      }
+    RequestBody body(req.body);
+    if (!body.valid()) {
+      throw std::invalid_argument(body.error());
     }
+    std::string id = body.get("id").value_or("");
     outreachManager.deleteOutreach(id, req.get_header_value("Authorization"));
+    publishChange("outreach", "delete", id, "");
     res.code = 200;
     std::string message = "Outreach resource deleted successfully.";
     res.write(message);
@@ -1144,30 +1268,26 @@ void RouteController::addHealthcareService(const crow::request& req,
     return;
   }
   try {
-    std::string result = healthcareManager.addHealthcareService(
-        req.body, req.get_header_value("Authorization"));
-
-    auto resource = bsoncxx::from_json(req.body);
-    std::string city = "";
+    RequestBody body(req.body);
+    auto result = healthcareManager.addHealthcareService(
+        body, req.get_header_value("Authorization"));
 
-    for (auto element : resource.view()) {
-      if (element.key().to_string() == "City")
-        city = element.get_utf8().value.to_string();
-    }
+    std::string city = body.get("City").value_or("");
 
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "addHealthcareService validation error: code={}, message={}",
-                res.code, result);
+                res.code, result.error().message);
     } else {
       subscriptionManager.notifySubscribers("healthcare", city);
+      publishChange("healthcare", "add", result.value(), city, body.raw());
       res.code = 201;
-      res.write(result);
+      res.write(result.value());
       LOG_INFO("RouteController",
                "addHealthcareService success: code={}, response={}", res.code,
-               result);
+               result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -1226,9 +1346,24 @@ void RouteController::getAllHealthcareServices(const crow::request& req,
     if (start_param && std::stoi(start_param) > 0) {
       start = std::stoi(start_param);
     }
-    std::string response = healthcareManager.getAllHealthcareServices(start);
-    res.code = 200;
-    res.write(response);
+    auto format = ResponseFormat::negotiate(req.get_header_value("Accept"));
+    ListingFilter filter = listingFilter(req);
+    if (!acceptsFilter(filter, Healthcare::kFilterSpec, res)) {
+      return;
+    }
+    bool replicated = replicates("HealthcareService");
+    std::string etag =
+        replicated
+            ? catalogue->listingETag("HealthcareService", start, format, filter)
+            : healthcareManager.listingETag(start, format, filter);
+    if (serveListing(req, res, etag, format)) {
+      return;
+    }
+    std::string response =
+        replicated
+            ? catalogue->listing("HealthcareService", start, format, filter)
+            : healthcareManager.encodedListing(start, format, filter);
+    sendListing(req, res, etag, response);
     LOG_INFO("RouteController",
              "getAllHealthcareServices response: code={}, body={}", res.code,
              response);
@@ -1284,20 +1419,23 @@ void RouteController::updateHealthcareService(const crow::request& req,
     return;
   }
   try {
-    std::string result = healthcareManager.updateHealthcare(
-        req.body, req.get_header_value("Authorization"));
-    if (result.find("Error") != std::string::npos) {
-      res.code = 400;
-      res.write(result);
+    RequestBody body(req.body);
+    auto result = healthcareManager.updateHealthcare(
+        body, req.get_header_value("Authorization"));
+    if (!result.ok()) {
+      res.code = result.error().httpStatus();
+      res.write(result.error().message);
       LOG_ERROR("RouteController",
                 "updateHealthcareService validation error: code={}, message={}",
-                res.code, result);
+                res.code, result.error().message);
     } else {
       res.code = 200;
       res.write("Healthcare resource update successfully.");
+      publishChange("healthcare", "update", body.get("id").value_or(""),
+                    body.get("City").value_or(""), body.raw());
       LOG_INFO("RouteController",
                "updateHealthcareService success: code={}, response={}",
-               res.code, result);
+               res.code, result.value());
     }
     res.end();
   } catch (const std::exception& e) {
@@ -1351,19 +1489,17 @@ void RouteController::deleteHealthcareService(const crow::request& req,
     return;
   }
   try {
-    auto resource = bsoncxx::from_json(req.body);
-    std::string id = "";
-
-    for (auto element : resource.view()) {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
-      }
+    RequestBody body(req.body);
+    if (!body.valid()) {
+      throw std::invalid_argument(body.error());
     }
+    std::string id = body.get("id").value_or("");
 
     std::cout << "Auth token received: "
               << req.get_header_value("Authorization") << std::endl;
     std::string msg = healthcareManager.deleteHealthcare(
         id, req.get_header_value("Authorization"));
+    publishChange("healthcare", "delete", id, "");
     res.code = 200;
     res.write(msg);
     LOG_INFO("RouteController",
@@ -1545,12 +1681,12 @@ void RouteController::subscribeToResources(const crow::request& req,
   }
 
   try {
-    auto resource = bsoncxx::from_json(req.body);
-    std::map<std::string, std::string> content;
-
-    for (auto element : resource.view()) {
-      content[element.key().to_string()] = element.get_utf8().value.to_string();
+    RequestBody body(req.body);
+    if (!body.valid()) {
+      throw std::invalid_argument(body.error());
     }
+    std::map<std::string, std::string> content(body.fields().begin(),
+                                               body.fields().end());
 
     if (content.find("Resource") == content.end() ||
         content.find("City") == content.end() ||
@@ -1565,6 +1701,19 @@ void RouteController::subscribeToResources(const crow::request& req,
       return;
     }
 
+    DeliveryMode mode;
+    if (content.find("Delivery") != content.end() &&
+        !NotificationCoalescer::parseDeliveryMode(content["Delivery"], mode)) {
+      res.code = 400;
+      std::string err =
+          "Error: Delivery must be one of immediate, hourly or daily.";
+      res.write(err);
+      LOG_ERROR("RouteController",
+                "subscribeToResources error: code={}, error={}", res.code, err);
+      res.end();
+      return;
+    }
+
     std::string id = subscriptionManager.addSubscriber(content);
 
     res.code = 201;
@@ -1581,6 +1730,828 @@ void RouteController::subscribeToResources(const crow::request& req,
   }
 }
 
+/**
+ * @brief Answers a listing request without loading the listing, if it can:
+ * with 304 if the client's If-None-Match already names the current version,
+ * or from the response cache.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ * @param etag The ETag of the listing requested.
+ * @param format The format the client asked for; its Content-Type is set
+ * here and kept for the body sendListing() writes.
+ * @return true if the response has been sent.
+ */
+bool RouteController::serveListing(const crow::request& req,
+                                   crow::response& res,
+                                   const std::string& etag,
+                                   ResponseFormat::Format format) {
+  res.set_header("Cache-Control", "no-cache");
+  res.set_header("Vary", "Accept, Accept-Encoding");
+  if (format != ResponseFormat::Format::Json) {
+    res.set_header("Content-Type", ResponseFormat::contentType(format));
+  }
+  std::string ifNoneMatch = req.get_header_value("If-None-Match");
+  for (auto encoding :
+       {ResponseCache::Encoding::Identity, ResponseCache::Encoding::Gzip}) {
+    std::string tag = ResponseCache::taggedFor(etag, encoding);
+    if (CollectionVersions::matches(ifNoneMatch, tag)) {
+      res.set_header("ETag", tag);
+      res.code = 304;
+      res.end();
+      return true;
+    }
+  }
+  if (responseCache == nullptr) {
+    return false;
+  }
+  auto cached = responseCache->find(
+      etag, ResponseCache::negotiate(req.get_header_value("Accept-Encoding")));
+  if (!cached) {
+    return false;
+  }
+  writeRepresentation(res, etag, *cached);
+  res.end();
+  return true;
+}
+
+/**
+ * @brief Writes a freshly loaded listing, compressed if the client accepts
+ * it and the body is large enough, and keeps it in the response cache. The
+ * caller ends the response.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ * @param etag The ETag of the listing.
+ * @param body The listing.
+ */
+void RouteController::sendListing(const crow::request& req,
+                                  crow::response& res, const std::string& etag,
+                                  const std::string& body) {
+  if (responseCache == nullptr) {
+    res.set_header("ETag", etag);
+    res.code = 200;
+    res.write(body);
+    return;
+  }
+  writeRepresentation(
+      res, etag,
+      responseCache->store(
+          etag, body,
+          ResponseCache::negotiate(req.get_header_value("Accept-Encoding"))));
+}
+
+/**
+ * @brief Writes one encoding of a listing with its ETag.
+ */
+void RouteController::writeRepresentation(
+    crow::response& res, const std::string& etag,
+    const ResponseCache::Representation& representation) {
+  res.set_header("ETag",
+                 ResponseCache::taggedFor(etag, representation.encoding));
+  if (representation.encoding == ResponseCache::Encoding::Gzip) {
+    res.set_header("Content-Encoding", "gzip");
+  }
+  res.code = 200;
+  res.write(*representation.body);
+}
+
+/**
+ * @brief Reports the response cache's hit, miss and compression counts and
+ * its size.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getCacheStatus(const crow::request& req,
+                                     crow::response& res) {
+  LOG_INFO("RouteController", "getCacheStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getCacheStatus");
+    return;
+  }
+  if (responseCache == nullptr) {
+    res.code = 404;
+    res.write("The response cache is not enabled.");
+    res.end();
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  ResponseCacheStats stats = responseCache->stats();
+  bsoncxx::builder::basic::document status;
+  status.append(kvp("hits", static_cast<int64_t>(stats.hits)),
+                kvp("misses", static_cast<int64_t>(stats.misses)),
+                kvp("compressions", static_cast<int64_t>(stats.compressions)),
+                kvp("entries", static_cast<int64_t>(stats.entries)),
+                kvp("bytes", static_cast<int64_t>(stats.bytes)));
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(status.view()));
+  res.end();
+}
+
+/**
+ * @brief Reports the live feed's connections and how many changes it has
+ * published, delivered and dropped for slow connections.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getFeedStatus(const crow::request& req,
+                                    crow::response& res) {
+  LOG_INFO("RouteController", "getFeedStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getFeedStatus");
+    return;
+  }
+  if (changeFeed == nullptr) {
+    res.code = 404;
+    res.write("The live feed is not enabled.");
+    res.end();
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  ChangeFeedStats stats = changeFeed->stats();
+  bsoncxx::builder::basic::document status;
+  status.append(kvp("connections", static_cast<int64_t>(stats.connections)),
+                kvp("published", static_cast<int64_t>(stats.published)),
+                kvp("delivered", static_cast<int64_t>(stats.delivered)),
+                kvp("evicted", static_cast<int64_t>(stats.evicted)));
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(status.view()));
+  res.end();
+}
+
+/**
+ * @brief Reports how many changes the journal holds, its latest sequence,
+ * the floor below which cursors are refused and how often it compacted.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getJournalStatus(const crow::request& req,
+                                       crow::response& res) {
+  LOG_INFO("RouteController", "getJournalStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getJournalStatus");
+    return;
+  }
+  if (changeJournal == nullptr) {
+    res.code = 404;
+    res.write("The change journal is not enabled.");
+    res.end();
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  ChangeJournalStats stats = changeJournal->stats();
+  bsoncxx::builder::basic::document status;
+  status.append(kvp("entries", static_cast<int64_t>(stats.entries)),
+                kvp("latest", static_cast<int64_t>(stats.latest)),
+                kvp("floor", static_cast<int64_t>(stats.floor)),
+                kvp("compactions", static_cast<int64_t>(stats.compactions)));
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(status.view()));
+  res.end();
+}
+
+/**
+ * @brief Reports, for each collection followed for other instances'
+ * writes, whether it is being watched and how many changes, resets and
+ * errors it has seen.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getWatcherStatus(const crow::request& req,
+                                       crow::response& res) {
+  LOG_INFO("RouteController", "getWatcherStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getWatcherStatus");
+    return;
+  }
+  if (watcher == nullptr) {
+    res.code = 404;
+    res.write("Change stream watching is not enabled.");
+    res.end();
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  bsoncxx::builder::basic::array collections;
+  for (const WatcherStatus& status : watcher->status()) {
+    bsoncxx::builder::basic::document entry;
+    entry.append(kvp("collection", status.collection),
+                 kvp("running", status.running),
+                 kvp("following", status.following),
+                 kvp("events", static_cast<int64_t>(status.events)),
+                 kvp("resets", static_cast<int64_t>(status.resets)),
+                 kvp("errors", static_cast<int64_t>(status.errors)));
+    collections.append(entry.view());
+  }
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(collections.view()));
+  res.end();
+}
+
+/**
+ * @brief Reports, for each collection held in memory, whether it is loaded,
+ * how many documents and distinct cities, target users and organizations it
+ * has, how many snapshots have been published and how many listings were
+ * served from it.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getCatalogueStatus(const crow::request& req,
+                                         crow::response& res) {
+  LOG_INFO("RouteController", "getCatalogueStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController",
+              "Authentication failed in getCatalogueStatus");
+    return;
+  }
+  if (catalogue == nullptr) {
+    res.code = 404;
+    res.write("The catalogue replica is not enabled.");
+    res.end();
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  bsoncxx::builder::basic::array collections;
+  for (const CatalogueStatus& status : catalogue->status()) {
+    bsoncxx::builder::basic::document entry;
+    entry.append(kvp("collection", status.collection),
+                 kvp("loaded", status.loaded),
+                 kvp("serving", replicates(status.collection)),
+                 kvp("documents", static_cast<int64_t>(status.documents)),
+                 kvp("cities", static_cast<int64_t>(status.cities)),
+                 kvp("targetUsers", static_cast<int64_t>(status.targetUsers)),
+                 kvp("orgs", static_cast<int64_t>(status.orgs)),
+                 kvp("snapshots", static_cast<int64_t>(status.snapshots)),
+                 kvp("reads", static_cast<int64_t>(status.reads)));
+    collections.append(entry.view());
+  }
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(collections.view()));
+  res.end();
+}
+
+/**
+ * @brief Returns the changes to every resource made after a sequence
+ * number, so mirrors can sync without downloading every listing again.
+ *
+ * GET /resources/changes?since=<seq>&limit=<n> answers
+ * {"changes": [...], "next": <seq>, "more": <bool>}. Each change carries its
+ * sequence, resource, action, id, city and, for adds and updates, the
+ * document that was written. The client applies the changes in order and
+ * asks again from "next", straight away if "more" is true.
+ *
+ * Without "since", the answer has no changes and "next" is the latest
+ * sequence: a new mirror takes that cursor first and then loads the
+ * listings. A cursor that is too old, or from before a restart, is answered
+ * with 410 Gone and the mirror must reload.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getChanges(const crow::request& req,
+                                 crow::response& res) {
+  LOG_INFO("RouteController", "getChanges called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getChanges");
+    return;
+  }
+  if (!authService.hasRole(extractToken(req.get_header_value("Authorization")),
+                           "HML") &&
+      !authService.hasRole(extractToken(req.get_header_value("Authorization")),
+                           "RFG") &&
+      !authService.hasRole(extractToken(req.get_header_value("Authorization")),
+                           "VET") &&
+      !authService.hasRole(extractToken(req.get_header_value("Authorization")),
+                           "SUB")) {
+    res.code = 403;
+    res.write("Insufficient permissions to access this resource.");
+    res.end();
+    return;
+  }
+  if (changeJournal == nullptr) {
+    res.code = 404;
+    res.write("The change journal is not enabled.");
+    res.end();
+    return;
+  }
+
+  try {
+    auto since_param = req.url_params.get("since");
+    if (since_param == nullptr) {
+      res.code = 200;
+      res.set_header("Content-Type", "application/json");
+      res.write("{\"changes\": [], \"next\": " +
+                std::to_string(changeJournal->latest()) +
+                ", \"more\": false}");
+      res.end();
+      return;
+    }
+    uint64_t since = std::stoull(since_param);
+    size_t limit = 500;
+    auto limit_param = req.url_params.get("limit");
+    if (limit_param && std::stoi(limit_param) > 0) {
+      limit = std::min(std::stoi(limit_param), 5000);
+    }
+
+    auto page = changeJournal->since(since, limit);
+    if (!page) {
+      res.code = 410;
+      res.write("Changes since " + std::to_string(since) +
+                " are no longer available; reload and continue from " +
+                std::to_string(changeJournal->latest()) + ".");
+      LOG_INFO("RouteController", "getChanges: cursor {} expired", since);
+      res.end();
+      return;
+    }
+    std::string response = "{\"changes\": [";
+    for (size_t i = 0; i < page->entries.size(); ++i) {
+      if (i > 0) {
+        response += ", ";
+      }
+      response += page->entries[i].json();
+    }
+    response += "], \"next\": " + std::to_string(page->next) +
+                ", \"more\": " + (page->more ? "true" : "false") + "}";
+    res.code = 200;
+    res.set_header("Content-Type", "application/json");
+    res.write(response);
+    LOG_INFO("RouteController", "getChanges: {} changes since {}",
+             page->entries.size(), since);
+    res.end();
+  } catch (const std::logic_error&) {
+    // std::stoull and std::stoi throw invalid_argument or out_of_range.
+    res.code = 400;
+    res.write("since and limit must be numbers.");
+    res.end();
+  }
+}
+
+/**
+ * @brief Pushes a successful add, update or delete to live feed clients and
+ * records it in the change journal.
+ *
+ * @param resource The resource type, e.g. "shelter".
+ * @param action "add", "update" or "delete".
+ * @param id The resource's id.
+ * @param city The resource's city, or empty if not known.
+ * @param document The JSON that was written; empty for deletes.
+ */
+void RouteController::publishChange(const std::string& resource,
+                                    const std::string& action,
+                                    const std::string& id,
+                                    const std::string& city,
+                                    const std::string& document) {
+  ResourceChange change{resource, action, id, city};
+  if (changeJournal != nullptr) {
+    changeJournal->append(change, document);
+  }
+  if (changeFeed != nullptr) {
+    changeFeed->publish(change);
+  }
+}
+
+/**
+ * @brief Reads the optional city, targetUser and org query parameters that
+ * narrow a listing down to the documents with those values.
+ */
+ListingFilter RouteController::listingFilter(const crow::request& req) {
+  ListingFilter filter;
+  if (auto city = req.url_params.get("city")) {
+    filter.city = city;
+  }
+  if (auto targetUser = req.url_params.get("targetUser")) {
+    filter.targetUser = targetUser;
+  }
+  if (auto org = req.url_params.get("org")) {
+    filter.org = org;
+  }
+  return filter;
+}
+
+/**
+ * @brief Answers 400 if the filter sets a parameter the collection has no
+ * field for, instead of listing nothing.
+ *
+ * @return true if listings of the collection can be filtered this way.
+ */
+bool RouteController::acceptsFilter(const ListingFilter& filter,
+                                    const ListingFilterSpec& spec,
+                                    crow::response& res) {
+  if (filter.supportedBy(spec)) {
+    return true;
+  }
+  res.code = 400;
+  res.write("This resource cannot be filtered on that parameter.");
+  res.end();
+  return false;
+}
+
+/**
+ * @brief Returns true if listings of the collection are served from the
+ * catalogue replica: it has been loaded and its change stream is being
+ * followed, so it is at most a moment behind the database. Otherwise they
+ * are read from the database.
+ */
+bool RouteController::replicates(const std::string& collection) {
+  return catalogue != nullptr && watcher != nullptr &&
+         watcher->isFollowing(collection) && catalogue->loaded(collection);
+}
+
+/**
+ * @brief Serves the live feed of resource changes as a WebSocket at
+ * /resources/feed.
+ *
+ * Clients pick what to follow with the "resource" and "city" query
+ * parameters, either of which may be "*" or left out. Browsers cannot set
+ * headers on a WebSocket, so the token may also be passed as the
+ * "access_token" query parameter. Each change arrives as one JSON text
+ * frame; messages from the client are ignored.
+ */
+void RouteController::initFeed(crow::SimpleApp& app) {
+  CROW_WEBSOCKET_ROUTE(app, "/resources/feed")
+      .onaccept([this](const crow::request& req, void** userdata) {
+        std::string token =
+            extractToken(req.get_header_value("Authorization"));
+        if (token.empty() && req.url_params.get("access_token")) {
+          token = req.url_params.get("access_token");
+        }
+        try {
+          if (token.empty() || !authService.verifyJWT(token)) {
+            return false;
+          }
+        } catch (const std::exception& e) {
+          LOG_ERROR("RouteController", "Feed token check failed: {}",
+                    e.what());
+          return false;
+        }
+        auto* subscription = new FeedSubscription();
+        const char* resource = req.url_params.get("resource");
+        const char* city = req.url_params.get("city");
+        subscription->resource = resource ? resource : "*";
+        subscription->city = city ? city : "*";
+        *userdata = subscription;
+        return true;
+      })
+      .onopen([this](crow::websocket::connection& conn) {
+        auto* subscription =
+            static_cast<FeedSubscription*>(conn.userdata());
+        subscription->id = changeFeed->subscribe(
+            subscription->resource, subscription->city,
+            [&conn](const std::string& frame) { conn.send_text(frame); },
+            [&conn](const std::string& reason) { conn.close(reason); });
+        if (!subscription->id) {
+          LOG_ERROR("RouteController", "Feed is full, closing connection");
+          conn.close("Too many feed connections.");
+        }
+      })
+      // Newer Crow versions also pass the close code.
+      .onclose([this](crow::websocket::connection& conn,
+                      const std::string& reason, auto&&...) {
+        auto* subscription =
+            static_cast<FeedSubscription*>(conn.userdata());
+        if (subscription == nullptr) {
+          return;
+        }
+        if (subscription->id) {
+          changeFeed->unsubscribe(*subscription->id);
+        }
+        delete subscription;
+        conn.userdata(nullptr);
+      })
+      .onmessage([](crow::websocket::connection& conn,
+                    const std::string& data, bool isBinary) {});
+}
+
+/**
+ * @brief Reports circuit breaker state, in-flight calls and average latency
+ * for every webhook destination host.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getWebhookStatus(const crow::request& req,
+                                       crow::response& res) {
+  LOG_INFO("RouteController", "getWebhookStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getWebhookStatus");
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  bsoncxx::builder::basic::array hosts;
+  for (const auto& status : subscriptionManager.webhookStatus()) {
+    bsoncxx::builder::basic::document host;
+    host.append(kvp("host", status.host), kvp("state", status.state),
+                kvp("inFlight", status.inFlight),
+                kvp("consecutiveFailures", status.consecutiveFailures),
+                kvp("latencyMs", status.latencyMs),
+                kvp("successes", static_cast<int64_t>(status.successes)),
+                kvp("failures", static_cast<int64_t>(status.failures)),
+                kvp("rejected", static_cast<int64_t>(status.rejected)));
+    hosts.append(host.view());
+  }
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(hosts.view()));
+  res.end();
+}
+
+/**
+ * @brief Reports the request arena's allocator statistics.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getArenaStatus(const crow::request& req,
+                                     crow::response& res) {
+  LOG_INFO("RouteController", "getArenaStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getArenaStatus");
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  ArenaStats stats = RequestArena::stats();
+  bsoncxx::builder::basic::document status;
+  status.append(
+      kvp("requests", static_cast<int64_t>(stats.requests)),
+      kvp("bytes", static_cast<int64_t>(stats.bytes)),
+      kvp("averageBytes",
+          stats.requests == 0 ? 0.0
+                              : static_cast<double>(stats.bytes) /
+                                    static_cast<double>(stats.requests)),
+      kvp("peakBytes", static_cast<int64_t>(stats.peakBytes)),
+      kvp("overflows", static_cast<int64_t>(stats.overflows)),
+      kvp("blockBytes", static_cast<int64_t>(stats.blockBytes)));
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(status.view()));
+  res.end();
+}
+
+/**
+ * @brief Reports the admission controller's queueing delay estimate and,
+ * per route class, requests in flight, admitted and shed.
+ *
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::getAdmissionStatus(const crow::request& req,
+                                         crow::response& res) {
+  LOG_INFO("RouteController", "getAdmissionStatus called");
+  if (!authenticateToken(req, res)) {
+    LOG_ERROR("RouteController", "Authentication failed in getAdmissionStatus");
+    return;
+  }
+  if (admission == nullptr) {
+    res.code = 404;
+    res.write("Admission control is not enabled.");
+    res.end();
+    return;
+  }
+
+  using bsoncxx::builder::basic::kvp;
+  bsoncxx::builder::basic::array classes;
+  for (const auto& status : admission->snapshot()) {
+    bsoncxx::builder::basic::document routeClass;
+    routeClass.append(
+        kvp("class", status.routeClass), kvp("inFlight", status.inFlight),
+        kvp("maxInFlight", status.maxInFlight),
+        kvp("admitted", static_cast<int64_t>(status.admitted)),
+        kvp("shedBusy", static_cast<int64_t>(status.shedBusy)),
+        kvp("shedOverloaded", static_cast<int64_t>(status.shedOverloaded)));
+    classes.append(routeClass.view());
+  }
+  auto delay = admission->queueDelay(AdmissionController::Clock::now());
+  bsoncxx::builder::basic::document status;
+  status.append(
+      kvp("queueDelayMs",
+          std::chrono::duration<double, std::milli>(delay).count()),
+      kvp("classes", classes.view()),
+      kvp("rateLimited",
+          static_cast<int64_t>(rateLimiter ? rateLimiter->rejected() : 0)));
+  res.code = 200;
+  res.set_header("Content-Type", "application/json");
+  res.write(bsoncxx::to_json(status.view()));
+  res.end();
+}
+
+/**
+ * @brief Runs a route handler with the thread's request arena open, so
+ * everything the request parses is released in one step when the handler
+ * has written the response, and under the request's deadline. A request
+ * whose deadline passed while it waited for a thread gets 503.
+ *
+ * @param handler The member function handling the route.
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::dispatch(Handler handler, const crow::request& req,
+                               crow::response& res) {
+  RequestArena::Scope arena;
+  Deadline::Scope deadline(requestBudget());
+  if (Deadline::expired()) {
+    LOG_ERROR("RouteController", "Deadline passed while queued: {}", req.url);
+    res.code = 503;
+    res.set_header("X-Deadline-Stage", "queue");
+    res.set_header("Retry-After", "1");
+    res.write("Deadline exceeded during queue.");
+    res.end();
+    return;
+  }
+  (this->*handler)(req, res);
+}
+
+/**
+ * @brief The time a request may take from routing to response, from
+ * GITGUD_REQUEST_DEADLINE_MS (default 5000).
+ */
+std::chrono::milliseconds RouteController::requestBudget() {
+  static const std::chrono::milliseconds budget(
+      config::getInt("GITGUD_REQUEST_DEADLINE_MS", 5000));
+  return budget;
+}
+
+RouteController::~RouteController() { shutdown(); }
+
+/**
+ * @brief Answers the requests still queued on the executor and refuses
+ * further ones with 503. The queued handlers use this controller, the
+ * objects it was given and Crow's requests and connections, so call this
+ * while Crow is still serving; the destructor calls it again, as a last
+ * resort, to keep the handlers from outliving the controller.
+ */
+void RouteController::shutdown() {
+  if (executor != nullptr) {
+    executor->stop();
+  }
+}
+
+/**
+ * @brief Runs a route handler that blocks on I/O on the executor, so the
+ * Crow worker can move on to the next request. The handler completes the
+ * response from the executor thread; Crow keeps the request and the
+ * connection alive until res.end(). Without an executor the handler runs
+ * inline, and with a full queue the request is turned away with 503.
+ *
+ * Before that, the client's rate limit for the route is checked, and then
+ * admission control may shed the request: 429 if its route class is at its
+ * cap, 503 if requests are queueing for too long for its class. Either way
+ * Retry-After says when to come back.
+ *
+ * @param routeClass How admission control treats the route.
+ * @param handler The member function handling the route.
+ * @param req The HTTP request object containing the request data.
+ * @param res The HTTP response object used to send the response.
+ */
+void RouteController::dispatchAsync(RouteClass routeClass, Handler handler,
+                                    const crow::request& req,
+                                    crow::response& res) {
+  std::string verified;
+  if (!withinRateLimit(req, res, verified)) {
+    return;
+  }
+  auto arrived = AdmissionController::Clock::now();
+  if (!admit(routeClass, req, res, arrived)) {
+    return;
+  }
+  if (executor == nullptr) {
+    AdmissionSlot slot(admission, routeClass);
+    VerifiedToken token(verified);
+    dispatch(handler, req, res);
+    return;
+  }
+  // Start the clock now, so time spent in the queue counts; the executor
+  // carries the deadline over to the thread that runs the handler.
+  Deadline::Scope deadline(requestBudget());
+  bool queued = executor->post([this, routeClass, arrived, handler,
+                                verified = std::move(verified), &req, &res] {
+    AdmissionSlot slot(admission, routeClass);
+    VerifiedToken token(verified);
+    if (admission != nullptr) {
+      auto now = AdmissionController::Clock::now();
+      admission->started(now - arrived, now);
+    }
+    try {
+      dispatch(handler, req, res);
+    } catch (const std::exception& e) {
+      LOG_ERROR("RouteController", "Deferred handler failed: {}", e.what());
+      if (!res.is_completed()) {
+        res.code = 500;
+        res.write("An error has occurred");
+        res.end();
+      }
+    }
+  });
+  if (!queued) {
+    if (admission != nullptr) {
+      admission->finished(routeClass);
+    }
+    LOG_ERROR("RouteController", "Handler queue full, rejecting {}", req.url);
+    res.code = 503;
+    res.set_header("Retry-After", "1");
+    res.write("Server is busy, please retry.");
+    res.end();
+  }
+}
+
+/**
+ * @brief Takes a token from the client's bucket for the route and sets the
+ * X-RateLimit-* headers; answers 429 if the bucket is empty.
+ *
+ * Runs before the body is parsed or the request is logged. Every request
+ * first takes a token from its IP address's bucket, which costs no more
+ * than a hash lookup, so a flood is turned away before any token is
+ * verified. Only then is a bearer token verified, and a client whose token
+ * verifies is also limited by its userId; the handler is told the token
+ * has been verified and does not check it again. The /auth/ routes go by
+ * IP address alone, and a forged claim never selects a bucket.
+ *
+ * @param verified Set to the bearer token if its signature was checked.
+ * @return true if the request may proceed.
+ */
+bool RouteController::withinRateLimit(const crow::request& req,
+                                      crow::response& res,
+                                      std::string& verified) {
+  if (rateLimiter == nullptr) {
+    return true;
+  }
+  auto now = RateLimiter::Clock::now();
+  auto decision =
+      rateLimiter->check(req.url, "ip:" + req.remote_ip_address, now);
+  if (decision.limit == 0) {
+    return true;
+  }
+  if (decision.allowed && req.url.rfind("/auth/", 0) != 0) {
+    std::string token = extractToken(req.get_header_value("Authorization"));
+    if (!token.empty() && authService.verifyJWT(token)) {
+      verified = token;
+      if (auto payload = authService.decodeJWT(token)) {
+        decision = rateLimiter->check(req.url, "user:" + payload->userId, now);
+      }
+    }
+  }
+  auto seconds = [](RateLimiter::Clock::duration duration) {
+    return std::to_string(
+        std::chrono::ceil<std::chrono::seconds>(duration).count());
+  };
+  res.set_header("X-RateLimit-Limit", std::to_string(decision.limit));
+  res.set_header("X-RateLimit-Remaining", std::to_string(decision.remaining));
+  res.set_header("X-RateLimit-Reset", seconds(decision.reset));
+  if (decision.allowed) {
+    return true;
+  }
+  res.code = 429;
+  res.set_header("Retry-After", seconds(decision.retryAfter));
+  res.write("Rate limit exceeded, please retry later.");
+  res.end();
+  return false;
+}
+
+/**
+ * @brief Asks admission control to let a request in, and answers it if
+ * not.
+ *
+ * @return true if the request may proceed; the caller must release its
+ * slot with AdmissionController::finished().
+ */
+bool RouteController::admit(RouteClass routeClass, const crow::request& req,
+                            crow::response& res,
+                            AdmissionController::Clock::time_point now) {
+  if (admission == nullptr) {
+    return true;
+  }
+  auto decision = admission->admit(routeClass, now);
+  if (decision == AdmissionController::Decision::Admit) {
+    return true;
+  }
+  bool busy = decision == AdmissionController::Decision::Busy;
+  LOG_ERROR("RouteController", "Shedding {} request {}: {}",
+            AdmissionController::name(routeClass), req.url,
+            busy ? "class at capacity" : "queueing delay too high");
+  res.code = busy ? 429 : 503;
+  res.set_header("Retry-After",
+                 std::to_string(admission->retryAfterSeconds(now)));
+  res.write(busy ? "Too many requests, please retry."
+                 : "Server is overloaded, please retry.");
+  res.end();
+  return false;
+}
+
 void RouteController::initRoutes(crow::SimpleApp& app) {
   CROW_ROUTE(app, "/").methods(crow::HTTPMethod::GET)(
       [this](const crow::request& req, crow::response& res) { index(res); });
@@ -1588,134 +2559,216 @@ void RouteController::initRoutes(crow::SimpleApp& app) {
   CROW_ROUTE(app, "/resources/food/add")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            addFood(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::addFood,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/food/getAll")
       .methods(crow::HTTPMethod::GET)(
           [this](const crow::request& req, crow::response& res) {
-            getAllFood(req, res);
+            dispatchAsync(RouteClass::Read, &RouteController::getAllFood,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/food/delete")
       .methods(crow::HTTPMethod::DELETE)(
           [this](const crow::request& req, crow::response& res) {
-            deleteFood(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::deleteFood,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/food/update")
       .methods(crow::HTTPMethod::PATCH)(
           [this](const crow::request& req, crow::response& res) {
-            updateFood(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::updateFood,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/shelter/add")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            addShelter(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::addShelter,
+                          req, res);
           });
   CROW_ROUTE(app, "/resources/shelter/update")
       .methods(crow::HTTPMethod::PATCH)(
           [this](const crow::request& req, crow::response& res) {
-            updateShelter(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::updateShelter,
+                          req, res);
           });
   CROW_ROUTE(app, "/resources/shelter/delete")
       .methods(crow::HTTPMethod::DELETE)(
           [this](const crow::request& req, crow::response& res) {
-            deleteShelter(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::deleteShelter,
+                          req, res);
           });
   CROW_ROUTE(app, "/resources/shelter/getAll")
       .methods(crow::HTTPMethod::GET)(
           [this](const crow::request& req, crow::response& res) {
-            getShelter(req, res);
+            dispatchAsync(RouteClass::Read, &RouteController::getShelter,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/counseling/getAll")
       .methods(crow::HTTPMethod::GET)(
           [this](const crow::request& req, crow::response& res) {
-            getCounseling(req, res);
+            dispatchAsync(RouteClass::Read, &RouteController::getCounseling,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/counseling/add")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            addCounseling(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::addCounseling,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/counseling/update")
       .methods(crow::HTTPMethod::PATCH)(
           [this](const crow::request& req, crow::response& res) {
-            updateCounseling(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::updateCounseling,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/counseling/delete")
       .methods(crow::HTTPMethod::DELETE)(
           [this](const crow::request& req, crow::response& res) {
-            deleteCounseling(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::deleteCounseling,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/outreach/add")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            addOutreachService(req, res);
+            dispatchAsync(RouteClass::Write,
+                          &RouteController::addOutreachService, req, res);
           });
 
   CROW_ROUTE(app, "/resources/outreach/update")
       .methods(crow::HTTPMethod::PATCH)(
           [this](const crow::request& req, crow::response& res) {
-            updateOutreach(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::updateOutreach,
+                          req, res);
           });
   CROW_ROUTE(app, "/resources/outreach/delete")
       .methods(crow::HTTPMethod::DELETE)(
           [this](const crow::request& req, crow::response& res) {
-            deleteOutreach(req, res);
+            dispatchAsync(RouteClass::Write, &RouteController::deleteOutreach,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/outreach/getAll")
       .methods(crow::HTTPMethod::GET)(
           [this](const crow::request& req, crow::response& res) {
-            getAllOutreachServices(req, res);
+            dispatchAsync(RouteClass::Read,
+                          &RouteController::getAllOutreachServices, req, res);
           });
 
   CROW_ROUTE(app, "/resources/healthcare/add")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            addHealthcareService(req, res);
+            dispatchAsync(RouteClass::Write,
+                          &RouteController::addHealthcareService, req, res);
           });
 
   CROW_ROUTE(app, "/resources/healthcare/getAll")
       .methods(crow::HTTPMethod::GET)(
           [this](const crow::request& req, crow::response& res) {
-            getAllHealthcareServices(req, res);
+            dispatchAsync(RouteClass::Read,
+                          &RouteController::getAllHealthcareServices, req, res);
           });
 
   CROW_ROUTE(app, "/resources/healthcare/update")
       .methods(crow::HTTPMethod::PATCH)(
           [this](const crow::request& req, crow::response& res) {
-            updateHealthcareService(req, res);
+            dispatchAsync(RouteClass::Write,
+                          &RouteController::updateHealthcareService, req, res);
           });
 
   CROW_ROUTE(app, "/resources/healthcare/delete")
       .methods(crow::HTTPMethod::DELETE)(
           [this](const crow::request& req, crow::response& res) {
-            deleteHealthcareService(req, res);
+            dispatchAsync(RouteClass::Write,
+                          &RouteController::deleteHealthcareService, req, res);
           });
 
   CROW_ROUTE(app, "/auth/register")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            registerUser(req, res);
+            dispatchAsync(RouteClass::Auth, &RouteController::registerUser,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/auth/login")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            loginUser(req, res);
+            dispatchAsync(RouteClass::Auth, &RouteController::loginUser,
+                          req, res);
           });
 
   CROW_ROUTE(app, "/resources/subscribe")
       .methods(crow::HTTPMethod::POST)(
           [this](const crow::request& req, crow::response& res) {
-            subscribeToResources(req, res);
+            dispatchAsync(RouteClass::Write,
+                          &RouteController::subscribeToResources, req, res);
           });
+
+  CROW_ROUTE(app, "/status/webhooks")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getWebhookStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/arena")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getArenaStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/admission")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getAdmissionStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/cache")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getCacheStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/feed")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getFeedStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/journal")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getJournalStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/watchers")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getWatcherStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/status/catalogue")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatch(&RouteController::getCatalogueStatus, req, res);
+          });
+
+  CROW_ROUTE(app, "/resources/changes")
+      .methods(crow::HTTPMethod::GET)(
+          [this](const crow::request& req, crow::response& res) {
+            dispatchAsync(RouteClass::Read, &RouteController::getChanges, req,
+                          res);
+          });
+
+  if (changeFeed != nullptr) {
+    initFeed(app);
+  }
 }
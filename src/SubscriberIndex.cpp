@@ -0,0 +1,146 @@
+// Copyright 2024 COMSW4156-Git-Gud
+#include "SubscriberIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>  // NOLINT(build/c++11)
+
+const char SubscriberIndex::kWildcard[] = "*";
+
+/**
+ * @brief Normalizes a resource or city for matching.
+ *
+ * Matching is case-insensitive and ignores surrounding whitespace, and "all"
+ * is accepted as a spelling of the wildcard.
+ *
+ * @param value The resource or city as given by the client.
+ * @return std::string The bucket key.
+ */
+std::string SubscriberIndex::normalize(const std::string& value) {
+  size_t first = value.find_first_not_of(" \t");
+  if (first == std::string::npos) {
+    return "";
+  }
+  size_t last = value.find_last_not_of(" \t");
+  std::string key = value.substr(first, last - first + 1);
+  std::transform(key.begin(), key.end(), key.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (key == "all") {
+    return kWildcard;
+  }
+  return key;
+}
+
+/**
+ * @brief Adds or replaces a subscription.
+ *
+ * @param id The subscriber's database id.
+ * @param resource The resource type, or "*" for every resource.
+ * @param city The city, or "*" for every city.
+ * @param contact The email address or webhook URL to notify.
+ */
+void SubscriberIndex::add(const std::string& id, const std::string& resource,
+                          const std::string& city, const std::string& contact) {
+  std::string resourceKey = normalize(resource);
+  std::string cityKey = normalize(city);
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto existing = entries.find(id);
+  if (existing != entries.end()) {
+    buckets[existing->second.resource][existing->second.city].erase(id);
+  }
+  buckets[resourceKey][cityKey][id] = contact;
+  entries[id] = Entry{resourceKey, cityKey};
+}
+
+/**
+ * @brief Removes a subscription.
+ *
+ * @param id The subscriber's database id.
+ * @return true if the subscriber was indexed.
+ */
+bool SubscriberIndex::remove(const std::string& id) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto it = entries.find(id);
+  if (it == entries.end()) {
+    return false;
+  }
+  auto resourceIt = buckets.find(it->second.resource);
+  auto cityIt = resourceIt->second.find(it->second.city);
+  cityIt->second.erase(id);
+  if (cityIt->second.empty()) {
+    resourceIt->second.erase(cityIt);
+    if (resourceIt->second.empty()) {
+      buckets.erase(resourceIt);
+    }
+  }
+  entries.erase(it);
+  return true;
+}
+
+/**
+ * @brief Drops every subscription, e.g. before a reload.
+ */
+void SubscriberIndex::clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  buckets.clear();
+  entries.clear();
+}
+
+void SubscriberIndex::collect(const std::string& resource,
+                              const std::string& city,
+                              std::map<std::string, std::string>& out) const {
+  auto resourceIt = buckets.find(resource);
+  if (resourceIt == buckets.end()) {
+    return;
+  }
+  auto cityIt = resourceIt->second.find(city);
+  if (cityIt == resourceIt->second.end()) {
+    return;
+  }
+  out.insert(cityIt->second.begin(), cityIt->second.end());
+}
+
+/**
+ * @brief Finds every subscriber interested in an update.
+ *
+ * @param resource The resource type that changed.
+ * @param city The city of the changed resource.
+ * @return std::map<std::string, std::string> Subscriber ids and contacts.
+ */
+std::map<std::string, std::string> SubscriberIndex::match(
+    const std::string& resource, const std::string& city) const {
+  std::string resourceKey = normalize(resource);
+  std::string cityKey = normalize(city);
+  std::map<std::string, std::string> result;
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  collect(resourceKey, cityKey, result);
+  collect(resourceKey, kWildcard, result);
+  collect(kWildcard, cityKey, result);
+  collect(kWildcard, kWildcard, result);
+  return result;
+}
+
+/**
+ * @brief Returns the number of indexed subscribers.
+ */
+size_t SubscriberIndex::size() const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  return entries.size();
+}
+
+/**
+ * @brief Visits every subscription, with its resource and city as
+ * normalized. The index is locked for reading meanwhile, so the visitor must
+ * not change it.
+ */
+void SubscriberIndex::forEach(
+    const std::function<void(const std::string& id,
+                             const std::string& resource,
+                             const std::string& city,
+                             const std::string& contact)>& visitor) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  for (const auto& [id, entry] : entries) {
+    const ContactsById& contacts = buckets.at(entry.resource).at(entry.city);
+    visitor(id, entry.resource, entry.city, contacts.at(id));
+  }
+}
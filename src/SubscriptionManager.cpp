@@ -5,9 +5,19 @@
 #include <curl/curlver.h>
 #include <curl/easy.h>
 
+#include <algorithm>
+#include <future>  // NOLINT(build/c++11)
+#include <tuple>
+#include <unordered_set>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
 
+#include "Config.h"
+#include "Deadline.h"
 #include "Logger.h"
 #include "Poco/Net/AcceptCertificateHandler.h"
 #include "Poco/Net/InvalidCertificateHandler.h"
@@ -19,8 +29,10 @@
 #include "Poco/Net/SSLManager.h"
 #include "Poco/Net/SecureSMTPClientSession.h"
 #include "Poco/Net/SecureStreamSocket.h"
+#include "Poco/Timespan.h"
 
 using Poco::SharedPtr;
+using Poco::Timespan;
 using Poco::Net::AcceptCertificateHandler;
 using Poco::Net::Context;
 using Poco::Net::InvalidCertificateHandler;
@@ -32,15 +44,380 @@ using Poco::Net::SMTPClientSession;
 using Poco::Net::SocketAddress;
 using Poco::Net::SSLManager;
 
+/**
+ * @brief Converts a timeout in milliseconds to a Poco Timespan.
+ */
+static Timespan timespanMs(long long ms) {
+  return Timespan(static_cast<long>(ms / 1000),
+                  static_cast<long>((ms % 1000) * 1000));
+}
+
+/**
+ * @brief Returns the SSL context shared by all SMTP sessions.
+ *
+ * SSLManager::initializeClient replaces the process-wide client context, so
+ * it is only called once instead of on every email.
+ */
+static Context::Ptr smtpContext() {
+  static Context::Ptr context = [] {
+    SharedPtr<InvalidCertificateHandler> pCert =
+        new AcceptCertificateHandler(false);
+    Context::Ptr pContext = new Context(Context::CLIENT_USE, "", "", "",
+                                        Context::VERIFY_NONE, 9, false,
+                                        "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+    SSLManager::instance().initializeClient(0, pCert, pContext);
+    return pContext;
+  }();
+  return context;
+}
+
 SubscriptionManager::SubscriptionManager(DatabaseManager& dbManager)
-    : dbManager(dbManager) {}
+    : dbManager(dbManager),
+      coalescer(std::chrono::seconds(
+          config::getInt("GITGUD_NOTIFY_IMMEDIATE_WINDOW_SECONDS", 0))),
+      webhookBreakers(
+          config::getInt("GITGUD_WEBHOOK_MAX_PER_HOST", 4),
+          config::getInt("GITGUD_WEBHOOK_BREAKER_FAILURES", 5),
+          std::chrono::milliseconds(
+              config::getInt("GITGUD_WEBHOOK_BREAKER_COOLDOWN_MS", 30000))),
+      webhookConnectTimeoutMs(
+          config::getInt("GITGUD_WEBHOOK_CONNECT_TIMEOUT_MS", 2000)),
+      webhookTimeoutMs(config::getInt("GITGUD_WEBHOOK_TIMEOUT_MS", 5000)),
+      smtpTimeoutMs(config::getInt("GITGUD_SMTP_TIMEOUT_MS", 10000)),
+      deliveryDeadline(
+          config::getInt("GITGUD_DELIVERY_DEADLINE_MS", 15000)),
+      deliveryWorkers(config::getInt("GITGUD_NOTIFY_WORKERS", 8)),
+      outbox(dbManager, config::getInt("GITGUD_OUTBOX_MAX_ATTEMPTS", 8),
+             std::chrono::seconds(
+                 config::getInt("GITGUD_OUTBOX_LEASE_SECONDS", 60)),
+             std::chrono::seconds(
+                 config::getInt("GITGUD_OUTBOX_BACKOFF_SECONDS", 30)),
+             std::chrono::seconds(
+                 config::getInt("GITGUD_OUTBOX_MAX_BACKOFF_SECONDS", 3600))),
+      outboxBatch(config::getInt("GITGUD_OUTBOX_BATCH", 100)) {}
+
+SubscriptionManager::~SubscriptionManager() { stopDispatcher(); }
+
+/**
+ * @brief Starts the background thread that drains the notification outbox,
+ * and the GITGUD_NOTIFY_WORKERS threads that send its deliveries.
+ *
+ * The thread wakes once a second, stages new outbox events into per-subscriber
+ * deliveries and sends every delivery that is due.
+ */
+void SubscriptionManager::startDispatcher() {
+  std::lock_guard<std::mutex> lock(dispatcherMutex);
+  if (dispatcherRunning) {
+    return;
+  }
+  outbox.ensureIndexes();
+  deliveryPool = std::make_unique<AsyncExecutor>(
+      std::max(1, deliveryWorkers), std::max(1, outboxBatch));
+  dispatcherRunning = true;
+  dispatcher = std::thread([this] {
+    std::unique_lock<std::mutex> lock(dispatcherMutex);
+    while (dispatcherRunning) {
+      dispatcherWake.wait_for(lock, std::chrono::seconds(1));
+      lock.unlock();
+      try {
+        flushNotifications();
+      } catch (const std::exception& e) {
+        LOG_ERROR("SubscriptionManager", "Outbox dispatch failed: {}",
+                  e.what());
+      }
+      lock.lock();
+    }
+  });
+}
+
+/**
+ * @brief Stops the dispatcher. Undelivered notifications stay in the outbox
+ * and are picked up after the next start.
+ */
+void SubscriptionManager::stopDispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(dispatcherMutex);
+    if (!dispatcherRunning) {
+      return;
+    }
+    dispatcherRunning = false;
+  }
+  dispatcherWake.notify_all();
+  dispatcher.join();
+  deliveryPool.reset();
+}
+
+/**
+ * @brief Runs one dispatcher pass: stages new events, then sends what is due.
+ */
+void SubscriptionManager::flushNotifications() {
+  auto now = NotificationOutbox::Clock::now();
+  stageEvents(now);
+  sendDue(now);
+}
+
+/**
+ * @brief Matches a batch of outbox events against subscribers and merges
+ * them into each subscriber's pending delivery.
+ *
+ * Events are removed only after staging, so a crash in between re-stages
+ * them once their lease expires (at-least-once).
+ *
+ * @param now The current time.
+ */
+void SubscriptionManager::stageEvents(NotificationOutbox::Clock::time_point now) {
+  std::vector<std::string> staged;
+  while (static_cast<int>(staged.size()) < outboxBatch) {
+    auto event = outbox.claimEvent(now);
+    if (!event) {
+      break;
+    }
+    for (const auto& [id, contact] :
+         getSubscribers(event->resource, event->city)) {
+      coalescer.add(id, contact, event->resource, event->city);
+    }
+    staged.push_back(event->id);
+  }
+  for (const auto& digest : coalescer.drainAll()) {
+    outbox.stage(digest, now + std::chrono::duration_cast<
+                                   NotificationOutbox::Clock::duration>(
+                                   coalescer.windowOf(digest.subscriberId)));
+  }
+  for (const auto& id : staged) {
+    outbox.completeEvent(id);
+  }
+}
+
+/**
+ * @brief Sends a batch of due deliveries, recording each outcome as soon as
+ * its send finishes.
+ *
+ * Sends run in parallel on the delivery workers, so a slow destination
+ * only holds up its own worker; the per-host cap keeps it from holding up
+ * all of them. Without the dispatcher running they run one at a time on
+ * the calling thread. A batch is no
+ * bigger than the workers can get through, at one delivery deadline each,
+ * before the lease on it runs out.
+ *
+ * @param now The current time.
+ */
+void SubscriptionManager::sendDue(NotificationOutbox::Clock::time_point now) {
+  size_t workers = deliveryPool ? deliveryPool->threadCount() : 1;
+  size_t rounds = std::max<long long>(
+      1, outbox.leaseLength() / std::max(deliveryDeadline,
+                                         std::chrono::milliseconds(1)));
+  size_t limit = std::min(static_cast<size_t>(std::max(0, outboxBatch)),
+                          workers * rounds);
+  std::vector<OutboxDelivery> due;
+  while (due.size() < limit) {
+    auto delivery = outbox.claimDelivery(now);
+    if (!delivery) {
+      break;
+    }
+    due.push_back(std::move(*delivery));
+  }
+  if (due.empty()) {
+    return;
+  }
+
+  if (!deliveryPool) {
+    for (const auto& delivery : due) {
+      send(delivery);
+    }
+    return;
+  }
+  std::vector<std::future<void>> sent;
+  sent.reserve(due.size());
+  for (const auto& delivery : due) {
+    sent.push_back(deliveryPool->submit([this, &delivery] { send(delivery); }));
+  }
+  for (auto& result : sent) {
+    try {
+      result.get();
+    } catch (const std::exception& e) {
+      // Left in the outbox; it is claimed again once its lease expires.
+      LOG_ERROR("SubscriptionManager", "Delivery failed: {}", e.what());
+    }
+  }
+}
+
+/**
+ * @brief Sends one claimed delivery and records its outcome. A delivery
+ * whose lease could run out before its send does is left alone, to be
+ * claimed again once the lease expires, so it is never sent twice at once.
+ *
+ * @param delivery The claimed delivery.
+ */
+void SubscriptionManager::send(const OutboxDelivery& delivery) {
+  if (NotificationOutbox::Clock::now() + deliveryDeadline >
+      delivery.leaseUntil) {
+    LOG_INFO("SubscriptionManager",
+             "Leaving delivery {}: its lease runs out before it could be sent",
+             delivery.id);
+    return;
+  }
+  DeliveryOutcome outcome = deliver(delivery.digest);
+  auto finished = NotificationOutbox::Clock::now();
+  bool held = false;
+  try {
+    switch (outcome) {
+      case DeliveryOutcome::Delivered:
+        held = outbox.completeDelivery(delivery);
+        break;
+      case DeliveryOutcome::Failed:
+        held = outbox.retryDelivery(delivery, finished);
+        break;
+      case DeliveryOutcome::Deferred:
+        held = outbox.deferDelivery(delivery, finished);
+        break;
+    }
+  } catch (const std::exception& e) {
+    LOG_ERROR("SubscriptionManager", "Could not record delivery {}: {}",
+              delivery.id, e.what());
+    return;
+  }
+  if (!held) {
+    LOG_INFO("SubscriptionManager",
+             "Lost the lease on delivery {}; its new holder records it",
+             delivery.id);
+  }
+}
+
+/**
+ * @brief Returns breaker state, in-flight calls and latency per webhook host.
+ */
+std::vector<HostStatus> SubscriptionManager::webhookStatus() const {
+  return webhookBreakers.snapshot();
+}
 
 /**
- * @brief Adds a subscriber to the database.
+ * @brief Loads every stored subscription into the in-memory index.
+ *
+ * Called at startup, and again whenever the Subscribers change stream
+ * cannot be resumed; otherwise the index is kept in sync by addSubscriber,
+ * deleteSubscriber and, for other instances' writes, refreshSubscriber and
+ * forgetSubscriber.
+ *
+ * @throws std::exception If there is an error during the database query.
+ */
+void SubscriptionManager::loadSubscribers() {
+  index.clear();
+  dbManager.scanCollection(
+      "Subscribers",
+      [this](const bsoncxx::document::view& view) { indexSubscriber(view); });
+  LOG_INFO("SubscriptionManager", "Loaded {} subscribers", index.size());
+}
+
+/**
+ * @brief Brings an index restored from a snapshot up to date: indexes every
+ * stored subscription, as loadSubscribers does, then drops those deleted
+ * since the snapshot. Unlike loadSubscribers it never empties the index, so
+ * notifications keep reaching everyone meanwhile.
+ *
+ * @throws std::exception If there is an error during the database query.
+ */
+void SubscriptionManager::reconcileSubscribers() {
+  std::unordered_set<std::string> gone;
+  index.forEach([&gone](const std::string& id, const std::string&,
+                        const std::string&, const std::string&) {
+    gone.insert(id);
+  });
+  dbManager.scanCollection(
+      "Subscribers", [this, &gone](const bsoncxx::document::view& view) {
+        indexSubscriber(view);
+        auto id = view["_id"];
+        if (id && id.type() == bsoncxx::type::k_oid) {
+          gone.erase(id.get_oid().value.to_string());
+        }
+      });
+  for (const std::string& id : gone) {
+    forgetSubscriber(id);
+  }
+  LOG_INFO("SubscriptionManager",
+           "Reconciled {} subscribers, {} deleted since the snapshot",
+           index.size(), gone.size());
+}
+
+/**
+ * @brief Indexes a subscriber added or changed by another instance, as
+ * reported by the Subscribers change stream.
+ *
+ * @param document The subscriber's stored document.
+ */
+void SubscriptionManager::refreshSubscriber(
+    const bsoncxx::document::view& document) {
+  indexSubscriber(document);
+}
+
+/**
+ * @brief Drops a subscriber deleted by another instance from the index.
+ *
+ * @param id The subscriber's database id.
+ */
+void SubscriptionManager::forgetSubscriber(const std::string& id) {
+  index.remove(id);
+  coalescer.forget(id);
+}
+
+/**
+ * @brief Visits every indexed subscription as a Subscribers document, as
+ * refreshSubscriber reads it back. Used to write snapshots.
+ */
+void SubscriptionManager::forEachSubscriber(
+    const std::function<void(const bsoncxx::document::view&)>& visitor)
+    const {
+  using bsoncxx::builder::basic::kvp;
+  // Copied out first, so the index is not locked while the visitor runs.
+  std::vector<std::tuple<std::string, std::string, std::string, std::string>>
+      subscriptions;
+  index.forEach([&subscriptions](const std::string& id,
+                                 const std::string& resource,
+                                 const std::string& city,
+                                 const std::string& contact) {
+    subscriptions.emplace_back(id, resource, city, contact);
+  });
+  for (const auto& [id, resource, city, contact] : subscriptions) {
+    bsoncxx::builder::basic::document document;
+    document.append(kvp("_id", bsoncxx::oid(id)), kvp("Resource", resource),
+                    kvp("City", city), kvp("Contact", contact));
+    DeliveryMode mode;
+    if (coalescer.deliveryOf(id, mode)) {
+      document.append(
+          kvp("Delivery", NotificationCoalescer::deliveryModeName(mode)));
+    }
+    visitor(document.view());
+  }
+}
+
+void SubscriptionManager::indexSubscriber(
+    const bsoncxx::document::view& view) {
+  auto id = view["_id"];
+  auto resource = view["Resource"];
+  auto city = view["City"];
+  auto contact = view["Contact"];
+  if (!id || !resource || !city || !contact) {
+    return;
+  }
+  std::string subscriberId = id.get_oid().value.to_string();
+  index.add(subscriberId, resource.get_utf8().value.to_string(),
+            city.get_utf8().value.to_string(),
+            contact.get_utf8().value.to_string());
+  DeliveryMode mode;
+  auto delivery = view["Delivery"];
+  if (delivery && NotificationCoalescer::parseDeliveryMode(
+                      delivery.get_utf8().value.to_string(), mode)) {
+    coalescer.setDelivery(subscriberId, mode);
+  }
+}
+
+/**
+ * @brief Adds a subscriber to the database and the in-memory index.
  *
  * @param subscriberDetails A map containing subscriber details such as email,
- *        city, and resources.
- * @return std::string A message indicating the success of the operation.
+ *        city, and resources. Resource or City may be "*" (or "all") to
+ *        subscribe to every resource or every city, and the optional
+ *        Delivery field selects "immediate", "hourly" or "daily" delivery.
+ * @return std::string The id of the new subscriber.
  *
  * @throws std::exception If there is an error during the database operation.
  */
@@ -49,11 +426,25 @@ std::string SubscriptionManager::addSubscriber(
   std::vector<std::pair<std::string, std::string>> keyValues(
       subscriberDetails.begin(), subscriberDetails.end());
   std::string id = dbManager.insertResource("Subscribers", keyValues);
+
+  auto resource = subscriberDetails.find("Resource");
+  auto city = subscriberDetails.find("City");
+  auto contact = subscriberDetails.find("Contact");
+  if (resource != subscriberDetails.end() && city != subscriberDetails.end() &&
+      contact != subscriberDetails.end()) {
+    index.add(id, resource->second, city->second, contact->second);
+  }
+  DeliveryMode mode;
+  auto delivery = subscriberDetails.find("Delivery");
+  if (delivery != subscriberDetails.end() &&
+      NotificationCoalescer::parseDeliveryMode(delivery->second, mode)) {
+    coalescer.setDelivery(id, mode);
+  }
   return id;
 }
 
 /**
- * @brief Deletes a subscriber from the database.
+ * @brief Deletes a subscriber from the database and the in-memory index.
  *
  * @param id The unique identifier of the subscriber to delete.
  * @return std::string A message indicating success or failure of the operation.
@@ -62,6 +453,8 @@ std::string SubscriptionManager::addSubscriber(
  */
 std::string SubscriptionManager::deleteSubscriber(const std::string& id) {
   if (dbManager.deleteResource("Subscribers", id, "")) {
+    index.remove(id);
+    coalescer.forget(id);
     return "Subscriber deleted successfully.";
   } else {
     return "Error: Subscriber not found.";
@@ -71,75 +464,93 @@ std::string SubscriptionManager::deleteSubscriber(const std::string& id) {
 /**
  * @brief Retrieves subscribers based on the specified resource and city.
  *
+ * Served from the in-memory index, so there is no database round trip and no
+ * page limit: every matching subscriber, including wildcard subscriptions, is
+ * returned.
+ *
  * @param resource The resource type the subscribers are interested in.
  * @param city The city associated with the subscribers.
  * @return std::map<std::string, std::string> A map of subscriber IDs and their
  *         contact information.
- *
- * @throws std::exception If there is an error during the database query.
  */
 std::map<std::string, std::string> SubscriptionManager::getSubscribers(
     const std::string& resource, const std::string& city) {
-  std::vector<bsoncxx::document::value> docs;
-  std::map<std::string, std::string> subscribers;
-  dbManager.findCollection(0, "Subscribers",
-                           {{"Resource", resource}, {"City", city}}, docs);
-
-  for (const auto& doc : docs) {
-    auto view = doc.view();
-    std::string id = view["_id"].get_oid().value.to_string();
-    std::string contact = view["Contact"].get_utf8().value.to_string();
-
-    subscribers[id] = contact;
-  }
-
-  return subscribers;
+  return index.match(resource, city);
 }
 
 /**
  * @brief Notifies subscribers about an update to a resource in a city.
  *
- * Sends notifications to subscribers via email or webhook, depending on the
- * format of their contact information.
+ * Only records the update in the notification outbox; matching, coalescing
+ * and delivery happen on the dispatcher thread, so the write path never
+ * waits on SMTP or webhooks. A failure to record the update is logged but
+ * does not fail the request that added the resource.
  *
  * @param resource The resource type that has an update.
  * @param city The city associated with the update.
- *
- * @throws std::exception If there is an error during notification dispatch.
  */
 void SubscriptionManager::notifySubscribers(const std::string& resource,
                                             const std::string& city) {
   LOG_INFO("SubscriptionManager",
-           "Sending notifications for resource {}, city {}", resource, city);
-  std::map<std::string, std::string> subscribers =
-      getSubscribers(resource, city);
-
-  for (const auto& [id, contact] : subscribers) {
-    if (contact.find('@') != std::string::npos) {
-      sendEmail(
-          contact, "Notification",
-          "A new update for " + resource + " in " + city + " is available.");
-    } else {
-      sendWebhook(contact, "{\"message\": \"A new update for " + resource +
-                               " in " + city + " is available.\"}");
-    }
+           "Queueing notifications for resource {}, city {}", resource, city);
+  try {
+    outbox.enqueue(resource, city, NotificationOutbox::Clock::now());
+  } catch (const std::exception& e) {
+    LOG_ERROR("SubscriptionManager",
+              "Failed to queue notification for {} in {}: {}", resource, city,
+              e.what());
   }
 }
 
+/**
+ * @brief Sends a digest to its subscriber.
+ *
+ * Each delivery gets its own deadline, so one slow SMTP server or webhook
+ * cannot hold a delivery worker past GITGUD_DELIVERY_DEADLINE_MS however
+ * the individual timeouts are configured.
+ *
+ * @param digest The merged updates for one subscriber.
+ * @return Whether the digest was sent, failed, or was deferred because the
+ *         destination's breaker is open or the host is at its cap.
+ */
+SubscriptionManager::DeliveryOutcome SubscriptionManager::deliver(
+    const NotificationDigest& digest) {
+  Deadline::Scope deadline(deliveryDeadline);
+  if (digest.contact.find('@') != std::string::npos) {
+    return sendEmail(digest.contact, "Notification", digest.text())
+               ? DeliveryOutcome::Delivered
+               : DeliveryOutcome::Failed;
+  }
+
+  std::string host = CircuitBreakerRegistry::hostOf(digest.contact);
+  auto start = CircuitBreakerRegistry::Clock::now();
+  auto permit = webhookBreakers.tryAcquire(host, start);
+  if (!permit) {
+    LOG_INFO("SubscriptionManager",
+             "Deferring webhook to {}: breaker open or host busy", host);
+    return DeliveryOutcome::Deferred;
+  }
+  bool ok = sendWebhook(digest.contact, digest.json());
+  auto end = CircuitBreakerRegistry::Clock::now();
+  webhookBreakers.release(host, permit, ok, end - start, end);
+  return ok ? DeliveryOutcome::Delivered : DeliveryOutcome::Failed;
+}
+
 /**
  * @brief Sends an email to a specified recipient.
  *
  * Uses a secure SMTP connection to send an email containing a subject and
- * content.
+ * content. Connecting and each read or write give up after
+ * GITGUD_SMTP_TIMEOUT_MS, or sooner if the delivery deadline is closer.
  *
  * @param to The recipient's email address.
  * @param subject The subject of the email.
  * @param content The content/body of the email.
  *
- * @throws Poco::Net::SMTPException If there is an SMTP-specific error.
- * @throws Poco::Net::NetException If there is a general network error.
+ * @return true if the message was accepted by the SMTP server. SMTP and
+ *         network errors are logged and reported as false.
  */
-void SubscriptionManager::sendEmail(const std::string& to,
+bool SubscriptionManager::sendEmail(const std::string& to,
                                     const std::string& subject,
                                     const std::string& content) {
   LOG_INFO("SubscriptionManager", "About to send email to: {}", to);
@@ -152,15 +563,15 @@ void SubscriptionManager::sendEmail(const std::string& to,
   MailMessage message;
 
   try {
-    SharedPtr<InvalidCertificateHandler> pCert =
-        new AcceptCertificateHandler(false);
-    Context::Ptr pContext = new Poco::Net::Context(
-        Context::CLIENT_USE, "", "", "", Context::VERIFY_NONE, 9, false,
-        "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
-    SSLManager::instance().initializeClient(0, pCert, pContext);
+    Context::Ptr pContext = smtpContext();
 
+    // One timeout for connecting and for every read and write, cut short
+    // by the delivery deadline.
+    Timespan timeout = timespanMs(Deadline::clampMs(smtpTimeoutMs));
     SecureStreamSocket pSSLSocket(pContext);
-    pSSLSocket.connect(SocketAddress(host, port));
+    pSSLSocket.connect(SocketAddress(host, port), timeout);
+    pSSLSocket.setReceiveTimeout(timeout);
+    pSSLSocket.setSendTimeout(timeout);
     SecureSMTPClientSession secure(pSSLSocket);
 
     secure.login();
@@ -177,42 +588,61 @@ void SubscriptionManager::sendEmail(const std::string& to,
     secure.close();
 
     LOG_INFO("SubscriptionManager", "Email sent successfully to: {}", to);
+    return true;
   } catch (Poco::Net::SMTPException& e) {
     LOG_ERROR("SubscriptionManager", "SMTPException: {}", e.displayText());
   } catch (Poco::Net::NetException& e) {
     LOG_ERROR("SubscriptionManager", "NetException: {}", e.displayText());
   }
+  return false;
 }
 
 /**
  * @brief Sends a webhook notification to a specified URL.
  *
- * Makes an HTTP POST request to send a payload to a given URL.
+ * Makes an HTTP POST request to send a payload to a given URL, bounded by
+ * the configured connect and total timeouts and by the delivery deadline.
  *
  * @param url The target URL for the webhook.
  * @param payload The payload to be sent as part of the HTTP POST request.
- *
- * @throws std::exception If there is an error during the HTTP request.
+ * @return true if the endpoint answered with a 2xx status.
  */
-void SubscriptionManager::sendWebhook(const std::string& url,
+bool SubscriptionManager::sendWebhook(const std::string& url,
                                       const std::string& payload) {
   LOG_INFO("SubscriptionManager", "Sending webhook to URL: {}", url);
   CURL* curl = curl_easy_init();
-  if (curl) {
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+  if (!curl) {
+    LOG_ERROR("SubscriptionManager", "Failed to initialize CURL.");
+    return false;
+  }
 
-    CURLcode res = curl_easy_perform(curl);
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+  long connectTimeoutMs =
+      static_cast<long>(Deadline::clampMs(webhookConnectTimeoutMs));
+  long timeoutMs = static_cast<long>(Deadline::clampMs(webhookTimeoutMs));
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, connectTimeoutMs);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+  // Timeouts must not rely on signals, which are unsafe with worker threads.
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
 
-    if (res != CURLE_OK) {
-      LOG_ERROR("SubscriptionManager", "curl_easy_perform() failed: {}",
-                curl_easy_strerror(res));
-    } else {
+  bool ok = false;
+  CURLcode res = curl_easy_perform(curl);
+  if (res != CURLE_OK) {
+    LOG_ERROR("SubscriptionManager", "curl_easy_perform() failed: {}",
+              curl_easy_strerror(res));
+  } else {
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    ok = status >= 200 && status < 300;
+    if (ok) {
       LOG_INFO("SubscriptionManager", "Webhook sent successfully to: {}", url);
+    } else {
+      LOG_ERROR("SubscriptionManager", "Webhook to {} returned HTTP {}", url,
+                status);
     }
-
-    curl_easy_cleanup(curl);
-  } else {
-    LOG_ERROR("SubscriptionManager", "Failed to initialize CURL.");
   }
+
+  curl_easy_cleanup(curl);
+  return ok;
 }
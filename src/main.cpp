@@ -1,16 +1,36 @@
 // Copyright 2024 COMSW4156-Git-Gud
 
+#include <pthread.h>
+
+#include <chrono>  // NOLINT(build/c++11)
 #include <csignal>
+#include <ctime>
+#include <future>  // NOLINT(build/c++11)
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
 
 #include "../external_libraries/Crow/include/crow.h"
+#include "AdmissionController.h"
+#include "AsyncExecutor.h"
+#include "CatalogueReplica.h"
+#include "CatalogueSnapshot.h"
+#include "ChangeFeed.h"
+#include "ChangeJournal.h"
+#include "ChangeStreamWatcher.h"
+#include "CollectionVersions.h"
+#include "Config.h"
 #include "Counseling.h"
 #include "DatabaseManager.h"
 #include "Food.h"
 #include "Healthcare.h"
 #include "Outreach.h"
+#include "RateLimiter.h"
+#include "ResponseCache.h"
 #include "RouteController.h"
 #include "Shelter.h"
 #include "SubscriptionManager.h"
@@ -20,12 +40,18 @@
 #include <mongocxx/uri.hpp>
 
 /**
- *  Method to handle proper termination protocols
+ *  Waits for SIGINT or SIGTERM, which main blocks in every thread so they
+ *  are only taken here, or for the server to stop on its own.
  */
-void signalHandler(int signal) {
-  if (signal == SIGINT || signal == SIGTERM) {
-    std::cout << "Terminating the application..." << std::endl;
-    std::exit(signal);
+void waitForTermination(const sigset_t& signals,
+                        const std::future<void>& server) {
+  const timespec second{1, 0};
+  while (server.wait_for(std::chrono::seconds(0)) !=
+         std::future_status::ready) {
+    if (sigtimedwait(&signals, nullptr, &second) > 0) {
+      std::cout << "Terminating the application..." << std::endl;
+      return;
+    }
   }
 }
 
@@ -33,8 +59,12 @@ void signalHandler(int signal) {
  *  Sets up the HTTP server and runs the program
  */
 int main(int argc, char* argv[]) {
-  std::signal(SIGINT, signalHandler);
-  std::signal(SIGTERM, signalHandler);
+  // Blocked before any thread starts, so every thread inherits the mask.
+  sigset_t termination;
+  sigemptyset(&termination);
+  sigaddset(&termination, SIGINT);
+  sigaddset(&termination, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &termination, nullptr);
 
   mongocxx::instance instance{};
   DatabaseManager dbManager("mongodb://localhost:27017");
@@ -46,6 +76,7 @@ int main(int argc, char* argv[]) {
   dbManager.createCollection("Counseling");
   dbManager.createCollection("Users");
   dbManager.createCollection("Subscribers");
+  dbManager.createCollection("NotificationOutbox");
 
   crow::SimpleApp app;
 
@@ -57,11 +88,234 @@ int main(int argc, char* argv[]) {
   AuthService authService(dbManager);
   SubscriptionManager subscriptionManager(dbManager);
 
-  RouteController routeController(dbManager, shelter, counseling, healthcare,
-                                  outreach, food, authService,
-                                  subscriptionManager);
+  // What the last run saved, if anything, so this one can answer at full
+  // speed straight away and catch up with MongoDB in the background.
+  std::string snapshotPath =
+      config::getString("GITGUD_SNAPSHOT_PATH", "gitgud.snapshot");
+  std::unique_ptr<CatalogueSnapshot> snapshot;
+  if (!snapshotPath.empty()) {
+    try {
+      snapshot = CatalogueSnapshot::open(snapshotPath);
+    } catch (const std::exception& e) {
+      std::cerr << "Ignoring " << snapshotPath << ": " << e.what()
+                << std::endl;
+    }
+  }
+  if (snapshot &&
+      std::chrono::system_clock::now() - snapshot->writtenAt() >
+          std::chrono::seconds(
+              config::getInt("GITGUD_SNAPSHOT_MAX_AGE_SECONDS", 86400))) {
+    std::cerr << "Ignoring " << snapshotPath << ": too old" << std::endl;
+    snapshot.reset();
+  }
+
+  const CatalogueSnapshot::Section* savedSubscribers =
+      snapshot ? snapshot->section("Subscribers") : nullptr;
+  bool subscribersRestored = savedSubscribers != nullptr;
+  if (subscribersRestored) {
+    for (const auto& document : savedSubscribers->documents) {
+      subscriptionManager.refreshSubscriber(document);
+    }
+  } else {
+    subscriptionManager.loadSubscribers();
+  }
+  subscriptionManager.startDispatcher();
+
+  // Handlers that block on Mongo, bcrypt or curl run here rather than on
+  // Crow's workers, so slow requests do not hold up the rest.
+  AsyncExecutor handlerExecutor(
+      config::getInt("GITGUD_HANDLER_THREADS", 64),
+      config::getInt("GITGUD_HANDLER_QUEUE", 4096));
+
+  // Under overload, sheds registration and login first, then writes, so
+  // that resource reads keep being answered.
+  AdmissionController admission(
+      std::chrono::milliseconds(
+          config::getInt("GITGUD_ADMIT_TARGET_DELAY_MS", 50)),
+      config::getInt("GITGUD_ADMIT_READ_MAX", 4096),
+      config::getInt("GITGUD_ADMIT_WRITE_MAX", 1024),
+      config::getInt("GITGUD_ADMIT_AUTH_MAX", 32));
+
+  // Per-client token buckets, keyed by user for authenticated requests and
+  // by IP address otherwise.
+  RateLimiter rateLimiter(
+      RateLimiter::Limit::parse(
+          config::getString("GITGUD_RATE_LIMIT_DEFAULT", "20/s:40"))
+          .value_or(RateLimiter::Limit{}));
+  if (!rateLimiter.configure(config::getString(
+          "GITGUD_RATE_LIMITS", "/auth/login=30/m:10,/auth/register=10/m:5"))) {
+    std::cerr << "Ignoring malformed entries in GITGUD_RATE_LIMITS"
+              << std::endl;
+  }
+
+  // Listings by ETag, as sent and gzip-compressed. Lower the level for
+  // CPU-bound deployments, raise it for bandwidth-bound ones.
+  ResponseCache responseCache(
+      config::getInt("GITGUD_RESPONSE_CACHE_BYTES", 32 << 20),
+      config::getInt("GITGUD_COMPRESS_MIN_BYTES", 1024),
+      config::getInt("GITGUD_GZIP_LEVEL", 6));
+
+  // Pushes adds, updates and deletes to WebSocket clients; a client whose
+  // queue fills up is disconnected rather than buffered without bound.
+  ChangeFeed changeFeed(
+      config::getInt("GITGUD_FEED_QUEUE", 256),
+      config::getInt("GITGUD_FEED_MAX_CONNECTIONS", 50000));
+
+  // Sequenced adds, updates and deletes for /resources/changes, compacted
+  // down to the latest change per resource once it holds this many.
+  ChangeJournal changeJournal(config::getInt("GITGUD_JOURNAL_ENTRIES", 100000),
+                              ChangeJournal::startingSequence());
+
+  bool watchChanges = config::getInt("GITGUD_WATCH_CHANGES", 1) != 0;
+
+  // The resource collections in memory, for listings that need no database
+  // round trip. Kept current from the change streams, so only with them.
+  // Each collection's listings filter on its own fields.
+  const std::vector<std::pair<std::string, ListingFilterSpec>> resources = {
+      {"ShelterService", Shelter::kFilterSpec},
+      {"CounselingService", Counseling::kFilterSpec},
+      {"HealthcareService", Healthcare::kFilterSpec},
+      {"OutreachService", Outreach::kFilterSpec},
+      {"Food", Food::kFilterSpec}};
+  std::vector<std::string> resourceCollections;
+  for (const auto& resource : resources) {
+    resourceCollections.push_back(resource.first);
+  }
+  CatalogueReplica catalogue(dbManager, resources);
+  bool replicate =
+      watchChanges && config::getInt("GITGUD_CATALOGUE_REPLICA", 1) != 0;
+
+  // Applies writes made through other instances to what this one caches:
+  // listing ETags (and so the response cache), the catalogue replica and the
+  // subscriber index.
+  ChangeStreamWatcher watcher(
+      dbManager,
+      config::getString("GITGUD_NODE_ID", ChangeStreamWatcher::defaultNode()),
+      std::chrono::seconds(config::getInt("GITGUD_WATCH_TOKEN_SECONDS", 5)));
+  for (const std::string& collection : resourceCollections) {
+    watcher.watch(collection,
+                  [&catalogue, replicate](const ChangeEvent& event) {
+                    CollectionVersions::bump(event.collection);
+                    if (replicate) {
+                      catalogue.apply(event);
+                    }
+                  });
+  }
+  watcher.watch("Subscribers", [&subscriptionManager](
+                                   const ChangeEvent& event) {
+    switch (event.operation) {
+      case ChangeEvent::Operation::Insert:
+      case ChangeEvent::Operation::Update:
+        if (event.document) {
+          subscriptionManager.refreshSubscriber(event.document->view());
+        }
+        break;
+      case ChangeEvent::Operation::Delete:
+        subscriptionManager.forgetSubscriber(event.id);
+        break;
+      case ChangeEvent::Operation::Reset:
+        subscriptionManager.loadSubscribers();
+        break;
+    }
+  });
+  std::vector<std::string> restored;
+  if (replicate) {
+    for (const std::string& collection : resourceCollections) {
+      const CatalogueSnapshot::Section* saved =
+          snapshot ? snapshot->section(collection) : nullptr;
+      if (saved != nullptr) {
+        catalogue.restore(collection, saved->documents);
+        restored.push_back(collection);
+        continue;
+      }
+      try {
+        catalogue.load(collection);
+      } catch (const std::exception& e) {
+        // Its listings are read from the database instead.
+        std::cerr << "Could not load " << collection
+                  << " into the catalogue replica: " << e.what() << std::endl;
+      }
+    }
+  }
+  // Everything restored has been copied out of the mapping.
+  snapshot.reset();
+  if (watchChanges) {
+    watcher.start();
+  }
+
+  // Brings what was restored up to date with the writes made since the
+  // snapshot was taken, while the restored state is being served.
+  std::thread catchUp;
+  if (!restored.empty() || subscribersRestored) {
+    catchUp = std::thread([&catalogue, &subscriptionManager, restored,
+                           subscribersRestored]() {
+      for (const std::string& collection : restored) {
+        try {
+          catalogue.load(collection);
+        } catch (const std::exception& e) {
+          std::cerr << "Could not catch " << collection
+                    << " up with the database: " << e.what() << std::endl;
+        }
+      }
+      if (subscribersRestored) {
+        try {
+          subscriptionManager.reconcileSubscribers();
+        } catch (const std::exception& e) {
+          std::cerr << "Could not catch subscribers up with the database: "
+                    << e.what() << std::endl;
+        }
+      }
+    });
+  }
+
+  // Saves the catalogue replica and the subscriber index for the next run:
+  // every GITGUD_SNAPSHOT_SECONDS, and once more on shutdown.
+  SnapshotWriter::Sections sections;
+  if (replicate) {
+    for (const std::string& collection : resourceCollections) {
+      sections.emplace_back(
+          collection,
+          [&catalogue, collection](const CatalogueSnapshot::Visitor& visitor) {
+            return catalogue.scan(collection, visitor);
+          });
+    }
+  }
+  sections.emplace_back(
+      "Subscribers",
+      [&subscriptionManager](const CatalogueSnapshot::Visitor& visitor) {
+        subscriptionManager.forEachSubscriber(visitor);
+        return true;
+      });
+  SnapshotWriter snapshotWriter(
+      snapshotPath,
+      std::chrono::seconds(config::getInt("GITGUD_SNAPSHOT_SECONDS", 30)),
+      std::move(sections));
+  if (!snapshotPath.empty()) {
+    snapshotWriter.start();
+  }
+
+  RouteController routeController(
+      dbManager, shelter, counseling, healthcare, outreach, food, authService,
+      subscriptionManager, &handlerExecutor, &admission, &rateLimiter,
+      &responseCache, &changeFeed, &changeJournal,
+      watchChanges ? &watcher : nullptr, replicate ? &catalogue : nullptr);
   routeController.initRoutes(app);
-  app.port(8080).multithreaded().run();
+  // Shutdown is driven from here rather than by Crow's own signal handling,
+  // so the requests still queued for a handler thread are answered while
+  // Crow can send their responses, before anything they use is destroyed.
+  app.signal_clear();
+  std::future<void> server = app.port(8080).multithreaded().run_async();
+  waitForTermination(termination, server);
+  routeController.shutdown();
+  app.stop();
+  server.get();
 
+  if (catchUp.joinable()) {
+    catchUp.join();
+  }
+  if (!snapshotPath.empty()) {
+    snapshotWriter.stop();
+    snapshotWriter.writeNow();
+  }
   return 0;
 }
@@ -7,7 +7,9 @@
 #include <utility>
 #include <vector>
 
+#include "CollectionVersions.h"
 #include "DatabaseManager.h"
+#include "Deadline.h"
 
 #include <bsoncxx/document/view.hpp>
 #include <bsoncxx/json.hpp>
@@ -22,6 +24,10 @@ Description: specialty
 ContactInfo
 Hours of Operation
 */
+// Fields the getAll query parameters filter on; counseling services only
+// have a City.
+const ListingFilterSpec Counseling::kFilterSpec = {"City", "", ""};
+
 /**
  * @brief Constructs a Counseling object.
  * @param dbManager Reference to the DatabaseManager object.
@@ -32,79 +38,92 @@ Counseling::Counseling(DatabaseManager &dbManager,
   cols = std::vector<std::string>({"Name", "counselorName", "City", "Address",
                                    "Description", "ContactInfo",
                                    "HoursOfOperation"});
-  cleanCache();
 }
 /**
- * @brief Resets the cached data format.
+ * @brief Returns every property of a counseling service, each empty.
  */
-void Counseling::cleanCache() {
-  for (auto name : cols) {
-    format[name] = "";
+Counseling::Fields Counseling::emptyFields() const {
+  Fields fields;
+  for (const auto &name : cols) {
+    fields.emplace(name, std::string());
   }
+  return fields;
 }
 /**
  * @brief Validates the input format and extracts the ID if provided.
- * @param content The input JSON string containing counselor data.
- * @return The extracted ID as a string.
- * @throws std::invalid_argument If the input is missing required fields or
- * contains invalid fields.
+ * @param body The parsed request body containing counselor data.
+ * @param fields Receives the properties and the auth token, for
+ * createDBContent().
+ * @return The extracted ID as a string, or an InvalidInput error if the input
+ * is missing required fields or contains invalid fields.
  */
-std::string Counseling::checkInputFormat(std::string content,
-                                         std::string authToken) {
-  auto resource = bsoncxx::from_json(content);
+Result<std::string> Counseling::checkInputFormat(const RequestBody &body,
+                                                 std::string_view authToken,
+                                                 Fields &fields) const {
+  fields = emptyFields();
+  if (!body.valid()) {
+    return Error{ErrorCode::InvalidInput, body.error()};
+  }
   std::string id;
-  for (auto element : resource.view()) {
-    if (format.find(element.key().to_string()) != format.end()) {
-      format[element.key().to_string()] = element.get_utf8().value.to_string();
+  for (const auto &[key, value] : body.fields()) {
+    auto field = fields.find(std::string_view(key));
+    if (field != fields.end()) {
+      field->second = value;
     } else {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
+      if (key == "id") {
+        id = value;
         continue;
       }
-      cleanCache();
-      throw std::invalid_argument(
-          "Counseling: The request with unrelative argument.");
+      return Error{ErrorCode::InvalidInput,
+                   "Counseling: The request with unrelative argument."};
     }
   }
 
-  format["authToken"] = authToken;
-  for (auto property : format) {
-    if (property.second == "") {
-      cleanCache();
-      throw std::invalid_argument(
-          "Counseling: The request missing some properties.");
+  fields["authToken"].assign(authToken.data(), authToken.size());
+  for (const auto &property : fields) {
+    if (property.second.empty()) {
+      return Error{ErrorCode::InvalidInput,
+                   "Counseling: The request missing some properties."};
     }
   }
   return id;
 }
 /**
  * @brief Adds a new counselor to the database.
- * @param request_body A JSON string containing the counselor data.
+ * @param request_body The parsed request body containing the counselor data.
  * @return The ID of the newly added counselor or an error message.
  */
-std::string Counseling::addCounselor(std::string request_body,
-                                     std::string request_auth) {
+Result<std::string> Counseling::addCounselor(const RequestBody &request_body,
+                                             std::string_view request_auth) {
+  Fields fields;
+  auto checked = checkInputFormat(request_body, request_auth, fields);
+  if (!checked.ok()) {
+    return Error{checked.error().code, "Error: " + checked.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    std::string ID = dbManager.insertResource(collection_name, content_new);
-    return ID;
+    std::string id = dbManager.insertResource(collection_name, content_new);
+    CollectionVersions::bump(collection_name);
+    return id;
+  } catch (const DeadlineExceeded &e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception &e) {
     std::cerr << e.what() << '\n';
-    return "Error: " + std::string(e.what());
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
 }
 /**
  * @brief Creates the database content for a counselor.
+ * @param fields The properties filled in by checkInputFormat().
  * @return A vector of key-value pairs representing the counselor's data.
  */
-std::vector<std::pair<std::string, std::string>> Counseling::createDBContent() {
+std::vector<std::pair<std::string, std::string>> Counseling::createDBContent(
+    Fields fields) const {
   std::vector<std::pair<std::string, std::string>> content;
-  for (auto property : format) {
-    content.push_back(property);
+  content.reserve(fields.size());
+  for (auto &[key, value] : fields) {
+    content.emplace_back(key, std::move(value));
   }
-  cleanCache();
   return content;
 }
 
@@ -115,8 +134,9 @@ std::vector<std::pair<std::string, std::string>> Counseling::createDBContent() {
  * @throws std::runtime_error If the specified document is not found.
  */
 std::string Counseling::deleteCounselor(const std::string &counselorId,
-                                        std::string request_auth) {
+                                        const std::string &request_auth) {
   if (dbManager.deleteResource(collection_name, counselorId, request_auth)) {
+    CollectionVersions::bump(collection_name);
     return "Success";
   }
   throw std::runtime_error(
@@ -140,20 +160,56 @@ std::string Counseling::searchCounselorsAll(int start) {
   return ret;
 }
 
+/**
+ * @brief Returns the ETag of the listing page that starts at start, so an
+ * unchanged page can be answered with 304 without a query.
+ */
+std::string Counseling::listingETag(int start, ResponseFormat::Format format,
+                                    const ListingFilter &filter) const {
+  return CollectionVersions::etag(
+      collection_name,
+      ResponseFormat::variant(start, format) + filter.variant());
+}
+
+/**
+ * @brief Returns the listing page that starts at start, filtered on the fields
+ * in kFilterSpec, in the format the client asked for. Unfiltered JSON comes
+ * from searchCounselorsAll(); everything else is written from the documents as
+ * read, without going through JSON.
+ */
+std::string Counseling::encodedListing(int start, ResponseFormat::Format format,
+                                       const ListingFilter &filter) {
+  if (format == ResponseFormat::Format::Json && filter.empty()) {
+    return searchCounselorsAll(start);
+  }
+  std::vector<bsoncxx::document::value> result;
+  dbManager.findCollection(start, collection_name,
+                           filter.keyValues(kFilterSpec), result);
+  return ResponseFormat::encode(result, format);
+}
+
 /**
  * @brief Updates a counselor's information in the database.
- * @param request_body A JSON string containing updated counselor data.
+ * @param request_body The parsed request body containing updated counselor
+ * data.
  * @return "Success" if the update succeeds or an error message.
  */
-std::string Counseling::updateCounselor(std::string request_body,
-                                        std::string request_auth) {
+Result<std::string> Counseling::updateCounselor(const RequestBody &request_body,
+                                                std::string_view request_auth) {
+  Fields fields;
+  auto id = checkInputFormat(request_body, request_auth, fields);
+  if (!id.ok()) {
+    return Error{id.error().code, "Error: " + id.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    std::string id = checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    dbManager.updateResource(collection_name, id, content_new);
+    dbManager.updateResource(collection_name, id.value(), content_new);
+    CollectionVersions::bump(collection_name);
+  } catch (const DeadlineExceeded &e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception &e) {
-    return "Error: " + std::string(e.what());
+    std::cerr << e.what() << '\n';
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
   return "Success";
 }
@@ -4,6 +4,9 @@
 
 #include <iostream>
 
+#include "CollectionVersions.h"
+#include "Deadline.h"
+
 /*
 Name: Provider
 City
@@ -16,6 +19,9 @@ Quantity
 ExpirationDate
 */
 
+// Fields the getAll query parameters filter on; food has no ORG.
+const ListingFilterSpec Food::kFilterSpec = {"City", "TargetUser", ""};
+
 /**
  * @brief Constructs a Food object.
  * @param db Reference to the DatabaseManager object.
@@ -25,15 +31,16 @@ Food::Food(DatabaseManager& db, const std::string& collection_name)
   cols = std::vector<std::string>({"Name", "City", "Address", "Description",
                                    "ContactInfo", "HoursOfOperation",
                                    "TargetUser", "Quantity", "ExpirationDate"});
-  cleanCache();
 }
 /**
- * @brief Resets the cache format to an empty state.
+ * @brief Returns every property of a food resource, each empty.
  */
-void Food::cleanCache() {
-  for (auto name : cols) {
-    format[name] = "";
+Food::Fields Food::emptyFields() const {
+  Fields fields;
+  for (const auto &name : cols) {
+    fields.emplace(name, std::string());
   }
+  return fields;
 }
 /**
  * @brief Validates the input JSON format and extracts the ID if present.
@@ -41,40 +48,50 @@ void Food::cleanCache() {
  * This method ensures all required fields are provided and valid in the
  * request body. It also checks that the quantity is a positive integer.
  *
- * @param content A JSON string containing the food resource data.
- *
- * @return The extracted ID as a string, if present in the input.
+ * @param body The parsed request body containing the food resource data.
+ * @param fields Receives the properties and the auth token, for
+ * createDBContent().
  *
- * @throws std::invalid_argument If the input is empty, missing required fields,
- * or contains invalid data.
+ * @return The extracted ID as a string, if present in the input, or an
+ * InvalidInput error if the input is empty, missing required fields, or
+ * contains invalid data.
  */
-std::string Food::checkInputFormat(std::string content, std::string authToken) {
-  if (content.empty()) {
-    throw std::invalid_argument("Invalid input: Request body cannot be empty.");
+Result<std::string> Food::checkInputFormat(const RequestBody &body,
+                                           std::string_view authToken,
+                                           Fields &fields) const {
+  fields = emptyFields();
+  if (body.raw().empty()) {
+    return Error{ErrorCode::InvalidInput,
+                 "Invalid input: Request body cannot be empty."};
+  }
+  if (!body.valid()) {
+    return Error{ErrorCode::InvalidInput, body.error()};
   }
-  auto resource = bsoncxx::from_json(content);
   std::string id;
-  for (auto element : resource.view()) {
-    if (format.find(element.key().to_string()) != format.end()) {
-      format[element.key().to_string()] = element.get_utf8().value.to_string();
+  for (const auto &[key, value] : body.fields()) {
+    auto field = fields.find(std::string_view(key));
+    if (field != fields.end()) {
+      field->second = value;
     } else {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
+      if (key == "id") {
+        id = value;
         continue;
       }
-      throw std::invalid_argument("The request with unrelative argument.");
+      return Error{ErrorCode::InvalidInput,
+                   "The request with unrelative argument."};
     }
   }
-  int capacity = atoi(format["Quantity"].c_str());
+  int capacity = atoi(fields["Quantity"].c_str());
 
   if (capacity <= 0) {
-    throw std::invalid_argument("The request with invalid argument.");
+    return Error{ErrorCode::InvalidInput, "The request with invalid argument."};
   }
 
-  format["authToken"] = authToken;
-  for (auto property : format) {
-    if (property.second == "") {
-      throw std::invalid_argument("The request missing some properties.");
+  fields["authToken"].assign(authToken.data(), authToken.size());
+  for (const auto &property : fields) {
+    if (property.second.empty()) {
+      return Error{ErrorCode::InvalidInput,
+                   "The request missing some properties."};
     }
   }
   return id;
@@ -82,12 +99,15 @@ std::string Food::checkInputFormat(std::string content, std::string authToken) {
 /**
  * @brief Creates a vector of key-value pairs representing the food resource.
  *
+ * @param fields The properties filled in by checkInputFormat().
  * @return A vector containing all key-value pairs for the food resource.
  */
-std::vector<std::pair<std::string, std::string>> Food::createDBContent() {
+std::vector<std::pair<std::string, std::string>> Food::createDBContent(
+    Fields fields) const {
   std::vector<std::pair<std::string, std::string>> content;
-  for (auto property : format) {
-    content.push_back(property);
+  content.reserve(fields.size());
+  for (auto &[key, value] : fields) {
+    content.emplace_back(key, std::move(value));
   }
   return content;
 }
@@ -106,22 +126,30 @@ std::vector<std::pair<std::string, std::string>> Food::createDBContent() {
  * @param resource A vector of key-value pairs representing the food resource to
  * be added.
  *
- * @return std::string Returns item ID if the food resource is added
- * successfully, or an error message if the insertion fails.
- *
- * @exception std::exception Throws if an error occurs during the database
- * insertion.
+ * @return The item ID if the food resource is added successfully, an
+ * InvalidInput error if the body is rejected, or an Internal error if the
+ * insertion fails.
  */
-std::string Food::addFood(std::string request_body, std::string request_auth) {
+Result<std::string> Food::addFood(const RequestBody &request_body,
+                                  std::string_view request_auth) {
+  Fields fields;
+  auto checked = checkInputFormat(request_body, request_auth, fields);
+  if (!checked.ok()) {
+    return Error{checked.error().code,
+                 "Error inserting food resource: " + checked.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    std::string ID = db.insertResource("Food", content_new);
-    return ID;
+    std::string id = db.insertResource("Food", content_new);
+    CollectionVersions::bump("Food");
+    return id;
+  } catch (const DeadlineExceeded& e) {
+    return Error{ErrorCode::Timeout,
+                 "Error inserting food resource: " + std::string(e.what())};
   } catch (const std::exception& e) {
     std::cerr << "Error inserting food resource: " << e.what() << std::endl;
-    return "Error inserting food resource: " + std::string(e.what());
+    return Error{ErrorCode::Internal,
+                 "Error inserting food resource: " + std::string(e.what())};
   }
 }
 /**
@@ -137,8 +165,10 @@ std::string Food::addFood(std::string request_body, std::string request_auth) {
  * @throws std::runtime_error If the specified document is not found in the
  * database.
  */
-std::string Food::deleteFood(const std::string& id, std::string request_auth) {
+std::string Food::deleteFood(const std::string& id,
+                             const std::string& request_auth) {
   if (db.deleteResource("Food", id, request_auth)) {
+    CollectionVersions::bump("Food");
     return "SUC";
   }
   throw std::runtime_error("Food Document with the specified _id not found.");
@@ -174,30 +204,64 @@ std::string Food::getAllFood(int start) {
   return bsoncxx::to_json(arrayBuilder.view());
 }
 
+/**
+ * @brief Returns the ETag of the listing page that starts at start, so an
+ * unchanged page can be answered with 304 without a query.
+ */
+std::string Food::listingETag(int start, ResponseFormat::Format format,
+                              const ListingFilter& filter) const {
+  return CollectionVersions::etag(
+      "Food",
+      ResponseFormat::variant(start, format) + filter.variant());
+}
+
+/**
+ * @brief Returns the listing page that starts at start, filtered on the fields
+ * in kFilterSpec, in the format the client asked for. Unfiltered JSON comes
+ * from getAllFood(); everything else is written from the documents as read,
+ * without going through JSON.
+ */
+std::string Food::encodedListing(int start, ResponseFormat::Format format,
+                                 const ListingFilter& filter) {
+  if (format == ResponseFormat::Format::Json && filter.empty()) {
+    return getAllFood(start);
+  }
+  std::vector<bsoncxx::document::value> result;
+  db.findCollection(start, "Food", filter.keyValues(kFilterSpec), result);
+  return ResponseFormat::encode(result, format);
+}
+
 /**
  * @brief Updates a food resource in the database.
  *
  * This method updates a food resource in the database based on its ID and the
  * provided JSON request body.
  *
- * @param request_body A JSON string containing the updated food resource
- * details.
+ * @param request_body The parsed request body containing the updated food
+ * resource details.
  *
- * @return "Success" if the resource is updated successfully, or an error
- * message if the update fails.
- *
- * @throws std::exception If an error occurs during database update.
+ * @return "Success" if the resource is updated successfully, an InvalidInput
+ * error if the body is rejected, or an Internal error if the update fails.
  */
-std::string Food::updateFood(std::string request_body,
-                             std::string request_auth) {
+Result<std::string> Food::updateFood(const RequestBody &request_body,
+                                     std::string_view request_auth) {
+  Fields fields;
+  auto id = checkInputFormat(request_body, request_auth, fields);
+  if (!id.ok()) {
+    return Error{id.error().code,
+                 "Error updating food resource: " + id.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    std::string id = checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    db.updateResource("Food", id, content_new);
-    return "Success";
+    db.updateResource("Food", id.value(), content_new);
+    CollectionVersions::bump("Food");
+  } catch (const DeadlineExceeded& e) {
+    return Error{ErrorCode::Timeout,
+                 "Error updating food resource: " + std::string(e.what())};
   } catch (const std::exception& e) {
     std::cerr << "Error updating food resource: " << e.what() << std::endl;
-    return "Error updating food resource: " + std::string(e.what());
+    return Error{ErrorCode::Internal,
+                 "Error updating food resource: " + std::string(e.what())};
   }
+  return "Success";
 }
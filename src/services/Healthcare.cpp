@@ -5,7 +5,9 @@
 #include <iostream>
 #include <unordered_set>
 
+#include "CollectionVersions.h"
 #include "DatabaseManager.h"
+#include "Deadline.h"
 
 #include <bsoncxx/document/view.hpp>
 #include <bsoncxx/oid.hpp>
@@ -20,6 +22,11 @@ eligibilityCriteria
 Hours of Operation
 */
 
+// Fields the getAll query parameters filter on: who a provider serves is
+// its eligibilityCriteria, and it has no ORG.
+const ListingFilterSpec Healthcare::kFilterSpec = {
+    "City", "eligibilityCriteria", ""};
+
 /**
  * @brief Constructs a Healthcare object.
  *
@@ -34,16 +41,16 @@ Healthcare::Healthcare(DatabaseManager& dbManager,
   cols = std::vector<std::string>({"Name", "City", "Address", "Description",
                                    "ContactInfo", "HoursOfOperation",
                                    "eligibilityCriteria"});
-  cleanCache();
 }
 /**
- * @brief Clears the internal cache by resetting all properties to empty
- * strings.
+ * @brief Returns every property of a healthcare service, each empty.
  */
-void Healthcare::cleanCache() {
-  for (auto name : cols) {
-    format[name] = "";
+Healthcare::Fields Healthcare::emptyFields() const {
+  Fields fields;
+  for (const auto &name : cols) {
+    fields.emplace(name, std::string());
   }
+  return fields;
 }
 /**
  * @brief Validates and parses the input JSON string for a healthcare service.
@@ -51,38 +58,41 @@ void Healthcare::cleanCache() {
  * Checks the input JSON string to ensure all required fields are present and
  * valid. Extracts the ID if provided.
  *
- * @param content A JSON string containing the healthcare service data.
- *
- * @return The extracted ID as a string, or an empty string if no ID is
- * provided.
+ * @param body The parsed request body containing the healthcare service data.
+ * @param fields Receives the properties and the auth token, for
+ * createDBContent().
  *
- * @throws std::invalid_argument If required fields are missing or unexpected
- * fields are present.
+ * @return The extracted ID as a string (empty if no ID is provided), or an
+ * InvalidInput error if required fields are missing or unexpected fields are
+ * present.
  */
-std::string Healthcare::checkInputFormat(std::string content,
-                                         std::string authToken) {
-  auto resource = bsoncxx::from_json(content);
+Result<std::string> Healthcare::checkInputFormat(const RequestBody &body,
+                                                 std::string_view authToken,
+                                                 Fields &fields) const {
+  fields = emptyFields();
+  if (!body.valid()) {
+    return Error{ErrorCode::InvalidInput, body.error()};
+  }
   std::string id;
-  for (auto element : resource.view()) {
-    if (format.find(element.key().to_string()) != format.end()) {
-      format[element.key().to_string()] = element.get_utf8().value.to_string();
+  for (const auto &[key, value] : body.fields()) {
+    auto field = fields.find(std::string_view(key));
+    if (field != fields.end()) {
+      field->second = value;
     } else {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
+      if (key == "id") {
+        id = value;
         continue;
       }
-      cleanCache();
-      throw std::invalid_argument(
-          "Healthcare: The request with unrelative argument.");
+      return Error{ErrorCode::InvalidInput,
+                   "Healthcare: The request with unrelative argument."};
     }
   }
 
-  format["authToken"] = authToken;
-  for (auto property : format) {
-    if (property.second == "") {
-      cleanCache();
-      throw std::invalid_argument(
-          "Healthcare: The request missing some properties.");
+  fields["authToken"].assign(authToken.data(), authToken.size());
+  for (const auto &property : fields) {
+    if (property.second.empty()) {
+      return Error{ErrorCode::InvalidInput,
+                   "Healthcare: The request missing some properties."};
     }
   }
   return id;
@@ -90,22 +100,29 @@ std::string Healthcare::checkInputFormat(std::string content,
 /**
  * @brief Adds a new healthcare service to the database.
  *
- * @param request_body A JSON string containing the healthcare service data.
+ * @param request_body The parsed request body containing the healthcare service
+ * data.
  *
  * @return The ID of the newly added healthcare service, or an error message if
  * the operation fails.
  */
-std::string Healthcare::addHealthcareService(std::string request_body,
-                                             std::string request_auth) {
+Result<std::string> Healthcare::addHealthcareService(
+    const RequestBody &request_body, std::string_view request_auth) {
+  Fields fields;
+  auto checked = checkInputFormat(request_body, request_auth, fields);
+  if (!checked.ok()) {
+    return Error{checked.error().code, "Error: " + checked.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    std::string ID = dbManager.insertResource(collection_name, content_new);
-    return ID;
+    std::string id = dbManager.insertResource(collection_name, content_new);
+    CollectionVersions::bump(collection_name);
+    return id;
+  } catch (const DeadlineExceeded& e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception& e) {
     std::cerr << e.what() << '\n';
-    return "Error: " + std::string(e.what());
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
 }
 
@@ -113,12 +130,15 @@ std::string Healthcare::addHealthcareService(std::string request_body,
  * @brief Converts the healthcare service data into key-value pairs for database
  * storage.
  *
+ * @param fields The properties filled in by checkInputFormat().
  * @return A vector of key-value pairs representing the healthcare service.
  */
-std::vector<std::pair<std::string, std::string>> Healthcare::createDBContent() {
+std::vector<std::pair<std::string, std::string>> Healthcare::createDBContent(
+    Fields fields) const {
   std::vector<std::pair<std::string, std::string>> content;
-  for (auto property : format) {
-    content.push_back(property);
+  content.reserve(fields.size());
+  for (auto &[key, value] : fields) {
+    content.emplace_back(key, std::move(value));
   }
   return content;
 }
@@ -147,24 +167,59 @@ std::string Healthcare::getAllHealthcareServices(int start) {
   }
   return "[]";
 }
+
+/**
+ * @brief Returns the ETag of the listing page that starts at start, so an
+ * unchanged page can be answered with 304 without a query.
+ */
+std::string Healthcare::listingETag(int start, ResponseFormat::Format format,
+                                    const ListingFilter& filter) const {
+  return CollectionVersions::etag(
+      collection_name,
+      ResponseFormat::variant(start, format) + filter.variant());
+}
+
+/**
+ * @brief Returns the listing page that starts at start, filtered on the fields
+ * in kFilterSpec, in the format the client asked for. Unfiltered JSON comes
+ * from getAllHealthcareServices(); everything else is written from the
+ * documents as read, without going through JSON.
+ */
+std::string Healthcare::encodedListing(int start, ResponseFormat::Format format,
+                                       const ListingFilter& filter) {
+  if (format == ResponseFormat::Format::Json && filter.empty()) {
+    return getAllHealthcareServices(start);
+  }
+  std::vector<bsoncxx::document::value> result;
+  dbManager.findCollection(start, collection_name,
+                           filter.keyValues(kFilterSpec), result);
+  return ResponseFormat::encode(result, format);
+}
 /**
  * @brief Updates an existing healthcare service in the database.
  *
- * @param request_body A JSON string containing the updated healthcare service
- * data.
+ * @param request_body The parsed request body containing the updated healthcare
+ * service data.
  *
  * @return "Update" if the operation is successful, or an error message if it
  * fails.
  */
-std::string Healthcare::updateHealthcare(std::string request_body,
-                                         std::string request_auth) {
+Result<std::string> Healthcare::updateHealthcare(
+    const RequestBody &request_body, std::string_view request_auth) {
+  Fields fields;
+  auto id = checkInputFormat(request_body, request_auth, fields);
+  if (!id.ok()) {
+    return Error{id.error().code, "Error: " + id.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    std::string id = checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    dbManager.updateResource(collection_name, id, content_new);
+    dbManager.updateResource(collection_name, id.value(), content_new);
+    CollectionVersions::bump(collection_name);
+  } catch (const DeadlineExceeded& e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception& e) {
-    return "Error: " + std::string(e.what());
+    std::cerr << e.what() << '\n';
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
   return "Update";
 }
@@ -178,9 +233,10 @@ std::string Healthcare::updateHealthcare(std::string request_body,
  *
  * @throws std::runtime_error If the specified healthcare record is not found.
  */
-std::string Healthcare::deleteHealthcare(std::string id,
-                                         std::string authToken) {
+std::string Healthcare::deleteHealthcare(const std::string& id,
+                                         const std::string& authToken) {
   if (dbManager.deleteResource(collection_name, id, authToken)) {
+    CollectionVersions::bump(collection_name);
     return "Healthcare record deleted successfully.";
   }
 
@@ -1,6 +1,10 @@
 // Copyright 2024 COMSW4156-Git-Gud
 
 #include "Outreach.h"
+
+#include "CollectionVersions.h"
+#include "Deadline.h"
+
 /*
 Name: programName
 City
@@ -11,6 +15,10 @@ ContactInfo
 Hours of Operation
 */
 
+// Fields the getAll query parameters filter on: who a service is for is its
+// TargetAudience, and it has no ORG.
+const ListingFilterSpec Outreach::kFilterSpec = {"City", "TargetAudience", ""};
+
 /**
  * @brief Constructs an Outreach object.
  *
@@ -27,17 +35,16 @@ Outreach::Outreach(DatabaseManager& dbManager,
   cols = std::vector<std::string>({"Name", "City", "Address", "Description",
                                    "ContactInfo", "HoursOfOperation",
                                    "TargetAudience"});
-  cleanCache();
 }
 /**
- * @brief Clears the internal cache.
- *
- * Resets all properties to empty strings in preparation for new input.
+ * @brief Returns every property of an outreach service, each empty.
  */
-void Outreach::cleanCache() {
-  for (auto name : cols) {
-    format[name] = "";
+Outreach::Fields Outreach::emptyFields() const {
+  Fields fields;
+  for (const auto &name : cols) {
+    fields.emplace(name, std::string());
   }
+  return fields;
 }
 /**
  * @brief Validates and parses the input JSON string for an outreach service.
@@ -45,38 +52,41 @@ void Outreach::cleanCache() {
  * Ensures all required fields are present and valid. Extracts the ID if
  * provided.
  *
- * @param content A JSON string containing the outreach service data.
- *
- * @return The extracted ID as a string, or an empty string if no ID is
- * provided.
+ * @param body The parsed request body containing the outreach service data.
+ * @param fields Receives the properties and the auth token, for
+ * createDBContent().
  *
- * @throws std::invalid_argument If required fields are missing or unexpected
- * fields are present.
+ * @return The extracted ID as a string (empty if no ID is provided), or an
+ * InvalidInput error if required fields are missing or unexpected fields are
+ * present.
  */
-std::string Outreach::checkInputFormat(std::string content,
-                                       std::string authToken) {
-  auto resource = bsoncxx::from_json(content);
+Result<std::string> Outreach::checkInputFormat(const RequestBody &body,
+                                               std::string_view authToken,
+                                               Fields &fields) const {
+  fields = emptyFields();
+  if (!body.valid()) {
+    return Error{ErrorCode::InvalidInput, body.error()};
+  }
   std::string id;
-  for (auto element : resource.view()) {
-    if (format.find(element.key().to_string()) != format.end()) {
-      format[element.key().to_string()] = element.get_utf8().value.to_string();
+  for (const auto &[key, value] : body.fields()) {
+    auto field = fields.find(std::string_view(key));
+    if (field != fields.end()) {
+      field->second = value;
     } else {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
+      if (key == "id") {
+        id = value;
         continue;
       }
-      cleanCache();
-      throw std::invalid_argument(
-          "Outreach: The request with unrelative argument.");
+      return Error{ErrorCode::InvalidInput,
+                   "Outreach: The request with unrelative argument."};
     }
   }
 
-  format["authToken"] = authToken;
-  for (auto property : format) {
-    if (property.second == "") {
-      cleanCache();
-      throw std::invalid_argument(
-          "Outreach: The request missing some properties.");
+  fields["authToken"].assign(authToken.data(), authToken.size());
+  for (const auto &property : fields) {
+    if (property.second.empty()) {
+      return Error{ErrorCode::InvalidInput,
+                   "Outreach: The request missing some properties."};
     }
   }
   return id;
@@ -84,22 +94,29 @@ std::string Outreach::checkInputFormat(std::string content,
 /**
  * @brief Adds a new outreach service to the database.
  *
- * @param request_body A JSON string containing the outreach service data.
+ * @param request_body The parsed request body containing the outreach service
+ * data.
  *
  * @return The ID of the newly added outreach service, or an error message if
  * the operation fails.
  */
-std::string Outreach::addOutreachService(std::string request_body,
-                                         std::string request_auth) {
+Result<std::string> Outreach::addOutreachService(
+    const RequestBody &request_body, std::string_view request_auth) {
+  Fields fields;
+  auto checked = checkInputFormat(request_body, request_auth, fields);
+  if (!checked.ok()) {
+    return Error{checked.error().code, "Error: " + checked.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    std::string ID = dbManager.insertResource(collection_name, content_new);
-    return ID;
+    std::string id = dbManager.insertResource(collection_name, content_new);
+    CollectionVersions::bump(collection_name);
+    return id;
+  } catch (const DeadlineExceeded& e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception& e) {
     std::cerr << e.what() << '\n';
-    return "Error: " + std::string(e.what());
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
 }
 
@@ -107,12 +124,15 @@ std::string Outreach::addOutreachService(std::string request_body,
  * @brief Formats the outreach service data into key-value pairs for database
  * storage.
  *
+ * @param fields The properties filled in by checkInputFormat().
  * @return A vector of key-value pairs representing the outreach service data.
  */
-std::vector<std::pair<std::string, std::string>> Outreach::createDBContent() {
+std::vector<std::pair<std::string, std::string>> Outreach::createDBContent(
+    Fields fields) const {
   std::vector<std::pair<std::string, std::string>> content;
-  for (auto property : format) {
-    content.push_back(property);
+  content.reserve(fields.size());
+  for (auto &[key, value] : fields) {
+    content.emplace_back(key, std::move(value));
   }
   return content;
 }
@@ -143,6 +163,34 @@ std::string Outreach::getAllOutreachServices(int start) {
   return "[]";
 }
 
+/**
+ * @brief Returns the ETag of the listing page that starts at start, so an
+ * unchanged page can be answered with 304 without a query.
+ */
+std::string Outreach::listingETag(int start, ResponseFormat::Format format,
+                                  const ListingFilter& filter) const {
+  return CollectionVersions::etag(
+      collection_name,
+      ResponseFormat::variant(start, format) + filter.variant());
+}
+
+/**
+ * @brief Returns the listing page that starts at start, filtered on the fields
+ * in kFilterSpec, in the format the client asked for. Unfiltered JSON comes
+ * from getAllOutreachServices(); everything else is written from the documents
+ * as read, without going through JSON.
+ */
+std::string Outreach::encodedListing(int start, ResponseFormat::Format format,
+                                     const ListingFilter& filter) {
+  if (format == ResponseFormat::Format::Json && filter.empty()) {
+    return getAllOutreachServices(start);
+  }
+  std::vector<bsoncxx::document::value> result;
+  dbManager.findCollection(start, collection_name,
+                           filter.keyValues(kFilterSpec), result);
+  return ResponseFormat::encode(result, format);
+}
+
 /**
  * @brief Converts a list of outreach services into a human-readable format.
  *
@@ -174,8 +222,10 @@ std::string Outreach::printOutreachServices(
  *
  * @throws std::runtime_error If the specified outreach service is not found.
  */
-std::string Outreach::deleteOutreach(std::string id, std::string request_auth) {
+std::string Outreach::deleteOutreach(const std::string& id,
+                                     const std::string& request_auth) {
   if (dbManager.deleteResource(collection_name, id, request_auth)) {
+    CollectionVersions::bump(collection_name);
     return "Outreach Service deleted successfully.";
   }
   throw std::runtime_error("Document with the specified _id not found.");
@@ -183,23 +233,28 @@ std::string Outreach::deleteOutreach(std::string id, std::string request_auth) {
 /**
  * @brief Updates an existing outreach service in the database.
  *
- * @param request_body A JSON string containing the updated outreach service
- * data.
+ * @param request_body The parsed request body containing the updated outreach
+ * service data.
  *
  * @return A success message if the operation is successful, or an error message
  * if it fails.
  */
-std::string Outreach::updateOutreach(std::string request_body,
-                                     std::string request_auth) {
+Result<std::string> Outreach::updateOutreach(const RequestBody &request_body,
+                                             std::string_view request_auth) {
+  Fields fields;
+  auto id = checkInputFormat(request_body, request_auth, fields);
+  if (!id.ok()) {
+    return Error{id.error().code, "Error: " + id.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    std::string id = checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    dbManager.updateResource(collection_name, id, content_new);
+    dbManager.updateResource(collection_name, id.value(), content_new);
+    CollectionVersions::bump(collection_name);
+  } catch (const DeadlineExceeded& e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception& e) {
-    // Return error message if there is an exception
-    return "Error: " + std::string(e.what());
+    std::cerr << e.what() << '\n';
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
-  // Return success message
   return "Outreach Service updated successfully.";
 }
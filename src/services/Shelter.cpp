@@ -1,5 +1,9 @@
 // Copyright 2024 COMSW4156-Git-Gud
 #include "Shelter.h"
+
+#include "CollectionVersions.h"
+#include "Deadline.h"
+
 /* property in database
 Name
 City
@@ -13,6 +17,9 @@ Capacity
 CurrentUse
 */
 
+// Fields the getAll query parameters filter on.
+const ListingFilterSpec Shelter::kFilterSpec = {"City", "TargetUser", "ORG"};
+
 /**
  * @brief Constructs a Shelter object.
  *
@@ -28,17 +35,16 @@ Shelter::Shelter(DatabaseManager &dbManager, std::string collection_name)
   cols = std::vector<std::string>({"Name", "City", "Address", "Description",
                                    "ContactInfo", "HoursOfOperation", "ORG",
                                    "TargetUser", "Capacity", "CurrentUse"});
-  cleanCache();
 }
 /**
- * @brief Clears the internal cache.
- *
- * Resets all property values in the cache to empty strings.
+ * @brief Returns every property of a shelter, each empty.
  */
-void Shelter::cleanCache() {
-  for (auto name : cols) {
-    format[name] = "";
+Shelter::Fields Shelter::emptyFields() const {
+  Fields fields;
+  for (const auto &name : cols) {
+    fields.emplace(name, std::string());
   }
+  return fields;
 }
 /**
  * @brief Validates and parses the input JSON string for a shelter entry.
@@ -46,44 +52,47 @@ void Shelter::cleanCache() {
  * Ensures all required fields are present, validates capacity and current use,
  * and extracts the ID if provided.
  *
- * @param content A JSON string containing the shelter data.
- *
- * @return The extracted ID as a string, or an empty string if no ID is
- * provided.
+ * @param body The parsed request body containing the shelter data.
+ * @param fields Receives the properties and the auth token, for
+ * createDBContent().
  *
- * @throws std::invalid_argument If required fields are missing or contain
- * invalid values.
+ * @return The extracted ID as a string (empty if no ID is provided), or an
+ * InvalidInput error if required fields are missing or contain invalid
+ * values.
  */
-std::string Shelter::checkInputFormat(std::string content,
-                                      std::string authToken) {
-  auto resource = bsoncxx::from_json(content);
+Result<std::string> Shelter::checkInputFormat(const RequestBody &body,
+                                              std::string_view authToken,
+                                              Fields &fields) const {
+  fields = emptyFields();
+  if (!body.valid()) {
+    return Error{ErrorCode::InvalidInput, body.error()};
+  }
   std::string id;
-  for (auto element : resource.view()) {
-    if (format.find(element.key().to_string()) != format.end()) {
-      format[element.key().to_string()] = element.get_utf8().value.to_string();
+  for (const auto &[key, value] : body.fields()) {
+    auto field = fields.find(std::string_view(key));
+    if (field != fields.end()) {
+      field->second = value;
     } else {
-      if (element.key().to_string() == "id") {
-        id = element.get_utf8().value.to_string();
+      if (key == "id") {
+        id = value;
         continue;
       }
-      cleanCache();
-      throw std::invalid_argument(
-          "Shelter: The request with unrelative argument.");
+      return Error{ErrorCode::InvalidInput,
+                   "Shelter: The request with unrelative argument."};
     }
   }
-  int capacity = atoi(format["Capacity"].c_str());
-  int current = atoi(format["CurrentUse"].c_str());
+  int capacity = atoi(fields["Capacity"].c_str());
+  int current = atoi(fields["CurrentUse"].c_str());
   if (capacity <= 0 || current > capacity) {
-    cleanCache();
-    throw std::invalid_argument("Shelter: The request with invalid argument.");
+    return Error{ErrorCode::InvalidInput,
+                 "Shelter: The request with invalid argument."};
   }
 
-  format["authToken"] = authToken;
-  for (auto property : format) {
-    if (property.second == "") {
-      cleanCache();
-      throw std::invalid_argument(
-          "Shelter: The request missing some properties.");
+  fields["authToken"].assign(authToken.data(), authToken.size());
+  for (const auto &property : fields) {
+    if (property.second.empty()) {
+      return Error{ErrorCode::InvalidInput,
+                   "Shelter: The request missing some properties."};
     }
   }
   return id;
@@ -91,33 +100,42 @@ std::string Shelter::checkInputFormat(std::string content,
 /**
  * @brief Adds a new shelter to the database.
  *
- * @param request_body A JSON string containing the shelter data.
+ * @param request_body The parsed request body containing the shelter data.
  *
  * @return The ID of the newly added shelter, or an error message if the
  * operation fails.
  */
-std::string Shelter::addShelter(std::string request_body,
-                                std::string request_auth) {
+Result<std::string> Shelter::addShelter(const RequestBody &request_body,
+                                        std::string_view request_auth) {
+  Fields fields;
+  auto checked = checkInputFormat(request_body, request_auth, fields);
+  if (!checked.ok()) {
+    return Error{checked.error().code, "Error: " + checked.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    std::string ID = dbManager.insertResource(collection_name, content_new);
-    return ID;
+    std::string id = dbManager.insertResource(collection_name, content_new);
+    CollectionVersions::bump(collection_name);
+    return id;
+  } catch (const DeadlineExceeded &e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception &e) {
-    return "Error: " + std::string(e.what());
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
 }
 
 /**
  * @brief Formats the shelter data into key-value pairs for database insertion.
  *
+ * @param fields The properties filled in by checkInputFormat().
  * @return A vector of key-value pairs representing the shelter data.
  */
-std::vector<std::pair<std::string, std::string>> Shelter::createDBContent() {
+std::vector<std::pair<std::string, std::string>> Shelter::createDBContent(
+    Fields fields) const {
   std::vector<std::pair<std::string, std::string>> content;
-  for (auto property : format) {
-    content.push_back(property);
+  content.reserve(fields.size());
+  for (auto &[key, value] : fields) {
+    content.emplace_back(key, std::move(value));
   }
   return content;
 }
@@ -145,6 +163,34 @@ std::string Shelter::searchShelterAll(int start) {
   return "[]";
 }
 
+/**
+ * @brief Returns the ETag of the listing page that starts at start, so an
+ * unchanged page can be answered with 304 without a query.
+ */
+std::string Shelter::listingETag(int start, ResponseFormat::Format format,
+                                 const ListingFilter &filter) const {
+  return CollectionVersions::etag(
+      collection_name,
+      ResponseFormat::variant(start, format) + filter.variant());
+}
+
+/**
+ * @brief Returns the listing page that starts at start, filtered on the fields
+ * in kFilterSpec, in the format the client asked for. Unfiltered JSON comes
+ * from searchShelterAll(); everything else is written from the documents as
+ * read, without going through JSON.
+ */
+std::string Shelter::encodedListing(int start, ResponseFormat::Format format,
+                                    const ListingFilter &filter) {
+  if (format == ResponseFormat::Format::Json && filter.empty()) {
+    return searchShelterAll(start);
+  }
+  std::vector<bsoncxx::document::value> result;
+  dbManager.findCollection(start, collection_name,
+                           filter.keyValues(kFilterSpec), result);
+  return ResponseFormat::encode(result, format);
+}
+
 // std::string Shelter::getShelterID(bsoncxx::document::value &shelter) {
 //   std::string id = shelter["_id"].get_oid().value.to_string();
 //   return id;
@@ -172,20 +218,27 @@ std::string Shelter::printShelters(
 /**
  * @brief Updates an existing shelter in the database.
  *
- * @param request_body A JSON string containing the updated shelter data.
+ * @param request_body The parsed request body containing the updated shelter
+ * data.
  *
  * @return A success message if the operation is successful, or an error message
  * if it fails.
  */
-std::string Shelter::updateShelter(std::string request_body,
-                                   std::string request_auth) {
+Result<std::string> Shelter::updateShelter(const RequestBody &request_body,
+                                           std::string_view request_auth) {
+  Fields fields;
+  auto id = checkInputFormat(request_body, request_auth, fields);
+  if (!id.ok()) {
+    return Error{id.error().code, "Error: " + id.error().message};
+  }
+  auto content_new = createDBContent(std::move(fields));
   try {
-    cleanCache();
-    std::string id = checkInputFormat(request_body, request_auth);
-    auto content_new = createDBContent();
-    dbManager.updateResource(collection_name, id, content_new);
+    dbManager.updateResource(collection_name, id.value(), content_new);
+    CollectionVersions::bump(collection_name);
+  } catch (const DeadlineExceeded &e) {
+    return Error{ErrorCode::Timeout, "Error: " + std::string(e.what())};
   } catch (const std::exception &e) {
-    return "Error: " + std::string(e.what());
+    return Error{ErrorCode::Internal, "Error: " + std::string(e.what())};
   }
   return "Update";
 }
@@ -198,8 +251,10 @@ std::string Shelter::updateShelter(std::string request_body,
  *
  * @throws std::runtime_error If the specified shelter is not found.
  */
-std::string Shelter::deleteShelter(std::string id, std::string request_auth) {
+std::string Shelter::deleteShelter(const std::string &id,
+                                   const std::string &request_auth) {
   if (dbManager.deleteResource(collection_name, id, request_auth)) {
+    CollectionVersions::bump(collection_name);
     return "SUC";
   }
   throw std::runtime_error(
@@ -0,0 +1,110 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "AdmissionController.h"
+
+namespace {
+
+using Clock = AdmissionController::Clock;
+using Decision = AdmissionController::Decision;
+using std::chrono::milliseconds;
+
+// Reports a queueing delay for every request of one interval, then moves
+// past it so the estimate is updated.
+Clock::time_point observe(AdmissionController& admission,
+                          Clock::time_point now, milliseconds queued) {
+  admission.started(queued, now);
+  return now + milliseconds(200);
+}
+
+}  // namespace
+
+TEST(AdmissionControllerUnitTests, AdmitsUpToTheCapOfEachClass) {
+  AdmissionController admission(milliseconds(50), 2, 2, 1);
+  auto now = Clock::now();
+
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Admit);
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Busy);
+  EXPECT_EQ(admission.admit(RouteClass::Read, now), Decision::Admit);
+  EXPECT_EQ(admission.admit(RouteClass::Read, now), Decision::Admit);
+  EXPECT_EQ(admission.admit(RouteClass::Read, now), Decision::Busy);
+
+  admission.finished(RouteClass::Auth);
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Admit);
+}
+
+TEST(AdmissionControllerUnitTests, ShedsAuthBeforeWritesBeforeReads) {
+  AdmissionController admission(milliseconds(50), 100, 100, 100);
+  auto now = Clock::now();
+
+  now = observe(admission, now, milliseconds(80));
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Overloaded);
+  EXPECT_EQ(admission.admit(RouteClass::Write, now), Decision::Admit);
+  EXPECT_EQ(admission.admit(RouteClass::Read, now), Decision::Admit);
+
+  now = observe(admission, now, milliseconds(150));
+  EXPECT_EQ(admission.admit(RouteClass::Write, now), Decision::Overloaded);
+  EXPECT_EQ(admission.admit(RouteClass::Read, now), Decision::Admit);
+
+  now = observe(admission, now, milliseconds(250));
+  EXPECT_EQ(admission.admit(RouteClass::Read, now), Decision::Overloaded);
+}
+
+TEST(AdmissionControllerUnitTests, IgnoresABurstThatDrainsWithinAnInterval) {
+  AdmissionController admission(milliseconds(50), 100, 100, 100);
+  auto now = Clock::now();
+
+  admission.started(milliseconds(400), now);
+  now = observe(admission, now, milliseconds(1));
+
+  EXPECT_EQ(admission.queueDelay(now), milliseconds(1));
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Admit);
+}
+
+TEST(AdmissionControllerUnitTests, RecoversOnceIdle) {
+  AdmissionController admission(milliseconds(50), 100, 100, 100);
+  auto now = Clock::now();
+
+  now = observe(admission, now, milliseconds(300));
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Overloaded);
+  EXPECT_EQ(admission.retryAfterSeconds(now), 1);
+
+  now += milliseconds(200);
+  EXPECT_EQ(admission.queueDelay(now), Clock::duration::zero());
+  EXPECT_EQ(admission.admit(RouteClass::Auth, now), Decision::Admit);
+}
+
+TEST(AdmissionControllerUnitTests, KeepsTheEstimateWhileRequestsAreStuck) {
+  AdmissionController admission(milliseconds(50), 100, 100, 100);
+  auto now = Clock::now();
+  ASSERT_EQ(admission.admit(RouteClass::Read, now), Decision::Admit);
+
+  now = observe(admission, now, milliseconds(2500));
+  now += milliseconds(200);
+
+  EXPECT_EQ(admission.queueDelay(now), milliseconds(2500));
+  EXPECT_EQ(admission.retryAfterSeconds(now), 3);
+}
+
+TEST(AdmissionControllerUnitTests, CountsShedRequestsPerClass) {
+  AdmissionController admission(milliseconds(50), 1, 1, 1);
+  auto now = Clock::now();
+  admission.admit(RouteClass::Write, now);
+  admission.admit(RouteClass::Write, now);
+  now = observe(admission, now, milliseconds(80));
+  admission.admit(RouteClass::Auth, now);
+
+  auto status = admission.snapshot();
+
+  ASSERT_EQ(status.size(), 3u);
+  EXPECT_EQ(status[0].routeClass, "read");
+  EXPECT_EQ(status[1].routeClass, "write");
+  EXPECT_EQ(status[1].inFlight, 1);
+  EXPECT_EQ(status[1].admitted, 1);
+  EXPECT_EQ(status[1].shedBusy, 1);
+  EXPECT_EQ(status[2].routeClass, "auth");
+  EXPECT_EQ(status[2].shedOverloaded, 1);
+}
@@ -0,0 +1,98 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <future>  // NOLINT(build/c++11)
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "AsyncExecutor.h"
+
+TEST(AsyncExecutorUnitTests, RunsTasksOffTheCallingThread) {
+  AsyncExecutor executor(2, 16);
+  auto id = executor.submit([] { return std::this_thread::get_id(); });
+
+  EXPECT_NE(id.get(), std::this_thread::get_id());
+  EXPECT_EQ(executor.threadCount(), 2u);
+}
+
+TEST(AsyncExecutorUnitTests, ReturnsResultsAndExceptionsThroughFutures) {
+  AsyncExecutor executor(1, 16);
+  auto value = executor.submit([] { return std::string("done"); });
+  auto failure = executor.submit([]() -> int {
+    throw std::invalid_argument("bad input");
+  });
+
+  EXPECT_EQ(value.get(), "done");
+  EXPECT_THROW(failure.get(), std::invalid_argument);
+}
+
+TEST(AsyncExecutorUnitTests, RejectsTasksWhenTheQueueIsFull) {
+  AsyncExecutor executor(1, 1);
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  std::promise<void> started;
+
+  ASSERT_TRUE(executor.post([&] {
+    started.set_value();
+    gate.wait();
+  }));
+  started.get_future().wait();
+  EXPECT_TRUE(executor.post([] {}));
+  EXPECT_FALSE(executor.post([] {}));
+  EXPECT_EQ(executor.pending(), 1u);
+
+  auto rejected = executor.submit([] { return 1; });
+  EXPECT_THROW(rejected.get(), std::runtime_error);
+  release.set_value();
+}
+
+TEST(AsyncExecutorUnitTests, KeepsManySlowTasksInFlight) {
+  std::atomic<int> completed{0};
+  auto start = std::chrono::steady_clock::now();
+  {
+    AsyncExecutor executor(32, 64);
+    for (int i = 0; i < 64; ++i) {
+      ASSERT_TRUE(executor.post([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        completed.fetch_add(1);
+      }));
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(completed.load(), 64);
+  EXPECT_LT(elapsed, std::chrono::milliseconds(64 * 50 / 4));
+}
+
+TEST(AsyncExecutorUnitTests, DrainsQueuedTasksOnDestruction) {
+  std::atomic<int> completed{0};
+  {
+    AsyncExecutor executor(1, 100);
+    for (int i = 0; i < 100; ++i) {
+      executor.post([&] { completed.fetch_add(1); });
+    }
+  }
+
+  EXPECT_EQ(completed.load(), 100);
+}
+
+TEST(AsyncExecutorUnitTests, StopFinishesQueuedTasksAndRefusesNewOnes) {
+  std::atomic<int> completed{0};
+  AsyncExecutor executor(1, 100);
+  for (int i = 0; i < 10; ++i) {
+    executor.post([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      completed.fetch_add(1);
+    });
+  }
+  executor.stop();
+
+  EXPECT_EQ(completed.load(), 10);
+  EXPECT_FALSE(executor.post([&] { completed.fetch_add(1); }));
+  executor.stop();
+  EXPECT_EQ(completed.load(), 10);
+}
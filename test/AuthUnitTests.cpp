@@ -3,6 +3,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
 
@@ -59,6 +63,28 @@ TEST_F(AuthUnitTests, RegisterUserInvalidPassword) {
   EXPECT_THROW(authService->registerUser(email, password), AuthException);
 }
 
+TEST_F(AuthUnitTests, RegisterUserAlreadyExists) {
+  std::string email = "test@example.com";
+  std::vector<bsoncxx::document::value> mockResult;
+  mockResult.push_back(bsoncxx::builder::stream::document{}
+                       << "_id" << bsoncxx::oid{} << "email" << email
+                       << bsoncxx::builder::stream::finalize);
+  std::thread::id lookupThread;
+  EXPECT_CALL(*mockDbManager, findCollection(0, "Users", ::testing::_,
+                                             ::testing::_))
+      .WillOnce(::testing::DoAll(
+          ::testing::Invoke([&](auto&&...) {
+            lookupThread = std::this_thread::get_id();
+          }),
+          ::testing::SetArgReferee<3>(mockResult)));
+  EXPECT_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
+      .Times(0);
+
+  EXPECT_THROW(authService->registerUser(email, "TestPass123"),
+               UserAlreadyExistsException);
+  EXPECT_NE(lookupThread, std::this_thread::get_id());
+}
+
 TEST_F(AuthUnitTests, LoginUser) {
   std::string email = "test@example.com";
   std::string password = "TestPass123";
@@ -0,0 +1,267 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "CatalogueReplica.h"
+#include "MockDatabaseManager.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+using ::testing::_;
+
+namespace {
+
+const char kFood[] = "Food";
+const ListingFilterSpec kSpec = {"City", "TargetUser", "ORG"};
+
+bsoncxx::document::value resource(const std::string& id,
+                                  const std::string& city,
+                                  const std::string& org) {
+  return make_document(kvp("_id", bsoncxx::oid(id)), kvp("City", city),
+                       kvp("ORG", org), kvp("TargetUser", "HML"),
+                       kvp("authToken", "secret"));
+}
+
+std::string idAt(int i) {
+  std::string suffix = std::to_string(i);
+  return "507f1f77bcf86cd7994" + std::string(5 - suffix.size(), '0') + suffix;
+}
+
+ChangeEvent change(ChangeEvent::Operation operation, const std::string& id,
+                   std::optional<bsoncxx::document::value> document) {
+  ChangeEvent event;
+  event.collection = kFood;
+  event.operation = operation;
+  event.id = id;
+  event.document = std::move(document);
+  return event;
+}
+
+}  // namespace
+
+class CatalogueReplicaUnitTests : public ::testing::Test {
+ protected:
+  MockDatabaseManager mockDbManager;
+  std::vector<bsoncxx::document::value> documents;
+
+  void SetUp() override {
+    ON_CALL(mockDbManager, scanCollection(kFood, _))
+        .WillByDefault(
+            [this](const std::string&,
+                   const std::function<void(const bsoncxx::document::view&)>&
+                       visitor) {
+              for (const auto& document : documents) {
+                visitor(document.view());
+              }
+            });
+  }
+
+  static std::vector<std::string> cities(const std::string& listing) {
+    std::vector<std::string> result;
+    auto parsed = bsoncxx::from_json("{\"rows\": " + listing + "}");
+    for (const auto& row : parsed.view()["rows"].get_array().value) {
+      result.push_back(row["City"].get_utf8().value.to_string());
+    }
+    return result;
+  }
+};
+
+TEST_F(CatalogueReplicaUnitTests, ServesNothingUntilLoaded) {
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}});
+
+  EXPECT_FALSE(replica.loaded(kFood));
+  EXPECT_FALSE(replica.loaded("Unknown"));
+  EXPECT_EQ(replica.listing(kFood, 0, ResponseFormat::Format::Json, {}), "[]");
+}
+
+TEST_F(CatalogueReplicaUnitTests, PagesInIdOrderWithoutTheAuthToken) {
+  for (int i = 4; i >= 0; --i) {
+    documents.push_back(resource(idAt(i), "City" + std::to_string(i), "Org"));
+  }
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}}, 2);
+  replica.load(kFood);
+
+  ASSERT_TRUE(replica.loaded(kFood));
+  std::string first =
+      replica.listing(kFood, 0, ResponseFormat::Format::Json, {});
+  EXPECT_EQ(cities(first), (std::vector<std::string>{"City0", "City1"}));
+  EXPECT_EQ(first.find("authToken"), std::string::npos);
+  EXPECT_EQ(cities(replica.listing(kFood, 4, ResponseFormat::Format::Json,
+                                   {})),
+            std::vector<std::string>{"City4"});
+  EXPECT_EQ(replica.listing(kFood, 5, ResponseFormat::Format::Json, {}),
+            "[]");
+}
+
+TEST_F(CatalogueReplicaUnitTests, FiltersOnEveryGivenField) {
+  for (int i = 0; i < 600; ++i) {
+    documents.push_back(resource(idAt(i), i % 3 == 0 ? "Boston" : "Queens",
+                                 i % 2 == 0 ? "Even" : "Odd"));
+  }
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}}, 20);
+  replica.load(kFood);
+
+  ListingFilter boston;
+  boston.city = "Boston";
+  EXPECT_EQ(cities(replica.listing(kFood, 0, ResponseFormat::Format::Json,
+                                   boston))
+                .size(),
+            20u);
+  // Matches are i = 0, 6, 12, ...; skipping 95 of the 100 leaves 5, across
+  // the 256-row blocks.
+  boston.org = "Even";
+  EXPECT_EQ(cities(replica.listing(kFood, 95, ResponseFormat::Format::Json,
+                                   boston))
+                .size(),
+            5u);
+
+  ListingFilter nowhere;
+  nowhere.city = "Atlantis";
+  EXPECT_EQ(replica.listing(kFood, 0, ResponseFormat::Format::Json, nowhere),
+            "[]");
+
+  auto status = replica.status();
+  ASSERT_EQ(status.size(), 1u);
+  EXPECT_EQ(status[0].documents, 600u);
+  EXPECT_EQ(status[0].cities, 2u);
+  EXPECT_EQ(status[0].orgs, 2u);
+  EXPECT_EQ(status[0].targetUsers, 1u);
+}
+
+TEST_F(CatalogueReplicaUnitTests, FiltersOnTheCollectionsOwnFields) {
+  documents.push_back(make_document(kvp("_id", bsoncxx::oid(idAt(0))),
+                                    kvp("City", "Boston"),
+                                    kvp("eligibilityCriteria", "HML")));
+  documents.push_back(make_document(kvp("_id", bsoncxx::oid(idAt(1))),
+                                    kvp("City", "Queens"),
+                                    kvp("eligibilityCriteria", "VET"),
+                                    kvp("TargetUser", "HML")));
+  CatalogueReplica replica(
+      mockDbManager, {{kFood, ListingFilterSpec{"City", "eligibilityCriteria",
+                                                ""}}});
+  replica.load(kFood);
+
+  ListingFilter homeless;
+  homeless.targetUser = "HML";
+  EXPECT_EQ(cities(replica.listing(kFood, 0, ResponseFormat::Format::Json,
+                                   homeless)),
+            std::vector<std::string>{"Boston"});
+  EXPECT_EQ(replica.status()[0].orgs, 0u);
+}
+
+TEST_F(CatalogueReplicaUnitTests, AppliesChangesAndMovesTheETagOn) {
+  documents.push_back(resource(idAt(1), "Boston", "Org"));
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}});
+  replica.load(kFood);
+  std::string loadedTag =
+      replica.listingETag(kFood, 0, ResponseFormat::Format::Json, {});
+
+  replica.apply(change(ChangeEvent::Operation::Insert, idAt(0),
+                       resource(idAt(0), "Albany", "Org")));
+  std::string insertedTag =
+      replica.listingETag(kFood, 0, ResponseFormat::Format::Json, {});
+  EXPECT_NE(insertedTag, loadedTag);
+  EXPECT_EQ(cities(replica.listing(kFood, 0, ResponseFormat::Format::Json,
+                                   {})),
+            (std::vector<std::string>{"Albany", "Boston"}));
+
+  replica.apply(change(ChangeEvent::Operation::Update, idAt(1),
+                       resource(idAt(1), "Queens", "Org")));
+  ListingFilter queens;
+  queens.city = "Queens";
+  EXPECT_EQ(cities(replica.listing(kFood, 0, ResponseFormat::Format::Json,
+                                   queens)),
+            std::vector<std::string>{"Queens"});
+
+  replica.apply(change(ChangeEvent::Operation::Delete, idAt(0), std::nullopt));
+  EXPECT_EQ(cities(replica.listing(kFood, 0, ResponseFormat::Format::Json,
+                                   {})),
+            std::vector<std::string>{"Queens"});
+  EXPECT_NE(replica.listingETag(kFood, 0, ResponseFormat::Format::Json, {}),
+            insertedTag);
+  EXPECT_EQ(replica.status()[0].snapshots, 4u);
+}
+
+TEST_F(CatalogueReplicaUnitTests, KeepsIdOrderAsChunksSplitAndMerge) {
+  std::vector<std::string> expected;
+  for (int i = 0; i < 1200; i += 2) {
+    documents.push_back(resource(idAt(i), std::to_string(i), "Org"));
+  }
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}}, 2000);
+  replica.load(kFood);
+
+  for (int i = 1; i < 1200; i += 2) {
+    replica.apply(change(ChangeEvent::Operation::Insert, idAt(i),
+                         resource(idAt(i), std::to_string(i), "Org")));
+  }
+  for (int i = 0; i < 1200; ++i) {
+    if (i % 5 != 0) {
+      replica.apply(
+          change(ChangeEvent::Operation::Delete, idAt(i), std::nullopt));
+    } else {
+      expected.push_back(std::to_string(i));
+    }
+  }
+  replica.apply(change(ChangeEvent::Operation::Insert, idAt(1200),
+                       resource(idAt(1200), "1200", "Org")));
+  expected.push_back("1200");
+
+  EXPECT_EQ(cities(replica.listing(kFood, 0, ResponseFormat::Format::Json,
+                                   {})),
+            expected);
+  EXPECT_EQ(replica.status()[0].documents, expected.size());
+  ListingFilter org;
+  org.org = "Org";
+  EXPECT_EQ(cities(replica.listing(kFood, 200, ResponseFormat::Format::Json,
+                                   org)),
+            std::vector<std::string>(expected.begin() + 200, expected.end()));
+}
+
+TEST_F(CatalogueReplicaUnitTests, ReloadsOnReset) {
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}});
+  replica.apply(change(ChangeEvent::Operation::Insert, idAt(0),
+                       resource(idAt(0), "Boston", "Org")));
+  EXPECT_FALSE(replica.loaded(kFood));
+
+  documents.push_back(resource(idAt(0), "Boston", "Org"));
+  documents.push_back(resource(idAt(1), "Queens", "Org"));
+  EXPECT_CALL(mockDbManager, scanCollection(kFood, _)).Times(1);
+  replica.apply(change(ChangeEvent::Operation::Reset, "", std::nullopt));
+
+  EXPECT_TRUE(replica.loaded(kFood));
+  EXPECT_EQ(replica.status()[0].documents, 2u);
+}
+
+TEST_F(CatalogueReplicaUnitTests, RestoresWhatItScanned) {
+  documents.push_back(resource(idAt(1), "Queens", "Org"));
+  documents.push_back(resource(idAt(0), "Boston", "Org"));
+  CatalogueReplica replica(mockDbManager, {{kFood, kSpec}});
+  EXPECT_FALSE(replica.scan(kFood, [](const bsoncxx::document::view&) {}));
+  replica.load(kFood);
+
+  std::vector<bsoncxx::document::value> saved;
+  EXPECT_TRUE(replica.scan(kFood, [&saved](const bsoncxx::document::view& d) {
+    saved.emplace_back(d);
+  }));
+  std::vector<bsoncxx::document::view> views;
+  for (const auto& document : saved) {
+    views.push_back(document.view());
+  }
+  CatalogueReplica restored(mockDbManager, {{kFood, kSpec}});
+  EXPECT_CALL(mockDbManager, scanCollection(_, _)).Times(0);
+  restored.restore(kFood, views);
+
+  EXPECT_TRUE(restored.loaded(kFood));
+  EXPECT_EQ(restored.listing(kFood, 0, ResponseFormat::Format::Json, {}),
+            replica.listing(kFood, 0, ResponseFormat::Format::Json, {}));
+}
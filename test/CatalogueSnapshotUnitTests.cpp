@@ -0,0 +1,126 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/json.hpp>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CatalogueSnapshot.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+class CatalogueSnapshotUnitTests : public ::testing::Test {
+ protected:
+  std::string path;
+  std::vector<bsoncxx::document::value> food;
+
+  void SetUp() override {
+    path = ::testing::TempDir() + "catalogue-" +
+           ::testing::UnitTest::GetInstance()->current_test_info()->name() +
+           ".snapshot";
+    std::remove(path.c_str());
+    food.push_back(make_document(kvp("Name", "Pantry"), kvp("City", "NYC")));
+    food.push_back(make_document(kvp("Name", "Kitchen"), kvp("Meals", 40)));
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  CatalogueSnapshot::Source foodSource() {
+    return [this](const CatalogueSnapshot::Visitor& visitor) {
+      for (const auto& document : food) {
+        visitor(document.view());
+      }
+      return true;
+    };
+  }
+
+  // Overwrites one byte of the file.
+  void poke(std::streamoff offset, char value) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.put(value);
+  }
+};
+
+TEST_F(CatalogueSnapshotUnitTests, ReadsBackWhatWasWritten) {
+  auto before = std::chrono::system_clock::now() - std::chrono::seconds(1);
+  uint64_t bytes = CatalogueSnapshot::write(
+      path, {{"Food", foodSource()},
+             {"Empty",
+              [](const CatalogueSnapshot::Visitor&) { return true; }},
+             {"Unloaded",
+              [](const CatalogueSnapshot::Visitor&) { return false; }}});
+
+  auto snapshot = CatalogueSnapshot::open(path);
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot->size(), bytes);
+  EXPECT_GE(snapshot->writtenAt(), before);
+  ASSERT_EQ(snapshot->sections().size(), 2u);
+  EXPECT_EQ(snapshot->section("Unloaded"), nullptr);
+  ASSERT_NE(snapshot->section("Empty"), nullptr);
+  EXPECT_TRUE(snapshot->section("Empty")->documents.empty());
+
+  const auto* section = snapshot->section("Food");
+  ASSERT_NE(section, nullptr);
+  ASSERT_EQ(section->documents.size(), 2u);
+  EXPECT_EQ(bsoncxx::to_json(section->documents[0]),
+            bsoncxx::to_json(food[0].view()));
+  EXPECT_EQ(section->documents[1]["Meals"].get_int32().value, 40);
+}
+
+TEST_F(CatalogueSnapshotUnitTests, HasNothingToOpenWithoutAFile) {
+  EXPECT_EQ(CatalogueSnapshot::open(path), nullptr);
+}
+
+TEST_F(CatalogueSnapshotUnitTests, RefusesACorruptFile) {
+  uint64_t bytes = CatalogueSnapshot::write(path, {{"Food", foodSource()}});
+  poke(static_cast<std::streamoff>(bytes) - 8, 'x');
+
+  EXPECT_THROW(CatalogueSnapshot::open(path), std::runtime_error);
+}
+
+TEST_F(CatalogueSnapshotUnitTests, RefusesAnotherFormatVersion) {
+  CatalogueSnapshot::write(path, {{"Food", foodSource()}});
+  poke(8, static_cast<char>(CatalogueSnapshot::kFormatVersion + 1));
+
+  EXPECT_THROW(CatalogueSnapshot::open(path), std::runtime_error);
+}
+
+TEST_F(CatalogueSnapshotUnitTests, RefusesATruncatedFile) {
+  CatalogueSnapshot::write(path, {{"Food", foodSource()}});
+  std::string contents;
+  {
+    std::ifstream file(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file), {});
+  }
+  std::ofstream(path, std::ios::binary | std::ios::trunc)
+      .write(contents.data(), contents.size() - 1);
+
+  EXPECT_THROW(CatalogueSnapshot::open(path), std::runtime_error);
+}
+
+TEST_F(CatalogueSnapshotUnitTests, KeepsThePreviousFileWhenAWriteFails) {
+  CatalogueSnapshot::write(path, {{"Food", foodSource()}});
+  SnapshotWriter writer(
+      path, std::chrono::hours(1),
+      {{"Food", [](const CatalogueSnapshot::Visitor&) -> bool {
+          throw std::runtime_error("scan failed");
+        }}});
+
+  EXPECT_FALSE(writer.writeNow());
+  EXPECT_EQ(writer.failures(), 1u);
+  auto snapshot = CatalogueSnapshot::open(path);
+  ASSERT_TRUE(snapshot);
+  EXPECT_EQ(snapshot->section("Food")->documents.size(), 2u);
+  EXPECT_EQ(CatalogueSnapshot::open(path + ".tmp"), nullptr);
+}
@@ -0,0 +1,170 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "ChangeFeed.h"
+
+namespace {
+
+// Collects the frames sent to one connection.
+class Client {
+ public:
+  ChangeFeed::Send send() {
+    return [this](const std::string& frame) {
+      std::lock_guard<std::mutex> lock(mutex);
+      frames.push_back(frame);
+    };
+  }
+
+  ChangeFeed::Close close() {
+    return [](const std::string&) {};
+  }
+
+  std::vector<std::string> received() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames;
+  }
+
+ private:
+  std::mutex mutex;
+  std::vector<std::string> frames;
+};
+
+bool eventually(const std::function<bool()>& condition) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (condition()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return condition();
+}
+
+ResourceChange change(const std::string& resource, const std::string& action,
+                      const std::string& id, const std::string& city) {
+  return ResourceChange{resource, action, id, city};
+}
+
+}  // namespace
+
+TEST(ChangeFeedUnitTests, RendersAChangeAsJson) {
+  EXPECT_EQ(change("shelter", "add", "42", "New \"York\"").json(),
+            "{\"resource\": \"shelter\", \"action\": \"add\", \"id\": \"42\", "
+            "\"city\": \"New \\\"York\\\"\"}");
+}
+
+TEST(ChangeFeedUnitTests, SendsOnlyMatchingChangesInOrder) {
+  ChangeFeed feed(16, 16);
+  Client client;
+  ASSERT_TRUE(
+      feed.subscribe("Shelter", "New York", client.send(), client.close()));
+
+  feed.publish(change("shelter", "add", "1", "New York"));
+  feed.publish(change("food", "add", "2", "New York"));
+  feed.publish(change("shelter", "add", "3", "Boston"));
+  feed.publish(change("shelter", "update", "1", "new york"));
+
+  ASSERT_TRUE(eventually([&] { return client.received().size() == 2; }));
+  auto frames = client.received();
+  EXPECT_NE(frames[0].find("\"add\""), std::string::npos);
+  EXPECT_NE(frames[1].find("\"update\""), std::string::npos);
+  EXPECT_EQ(feed.stats().published, 4u);
+}
+
+TEST(ChangeFeedUnitTests, WildcardsAndUnknownCitiesReachEveryFollower) {
+  ChangeFeed feed(16, 16);
+  Client everything;
+  Client allShelters;
+  Client bostonShelters;
+  feed.subscribe("*", "", everything.send(), everything.close());
+  feed.subscribe("shelter", "all", allShelters.send(), allShelters.close());
+  feed.subscribe("shelter", "Boston", bostonShelters.send(),
+                 bostonShelters.close());
+
+  feed.publish(change("shelter", "add", "1", "New York"));
+  feed.publish(change("shelter", "delete", "1", ""));
+  feed.publish(change("food", "add", "2", "Boston"));
+
+  ASSERT_TRUE(eventually([&] {
+    return everything.received().size() == 3 &&
+           allShelters.received().size() == 2 &&
+           bostonShelters.received().size() == 1;
+  }));
+  EXPECT_NE(bostonShelters.received()[0].find("\"delete\""),
+            std::string::npos);
+}
+
+TEST(ChangeFeedUnitTests, EvictsAConnectionThatFallsBehind) {
+  ChangeFeed feed(2, 16);
+  std::promise<void> unblock;
+  std::shared_future<void> unblocked = unblock.get_future().share();
+  std::promise<void> blocked;
+  std::string closedWith;
+  std::mutex closeMutex;
+  bool first = true;
+  feed.subscribe(
+      "shelter", "*",
+      [&](const std::string&) {
+        if (first) {
+          first = false;
+          blocked.set_value();
+          unblocked.wait();
+        }
+      },
+      [&](const std::string& reason) {
+        std::lock_guard<std::mutex> lock(closeMutex);
+        closedWith = reason;
+      });
+
+  feed.publish(change("shelter", "add", "1", "NYC"));
+  blocked.get_future().wait();
+  for (int i = 2; i <= 4; ++i) {
+    feed.publish(change("shelter", "add", std::to_string(i), "NYC"));
+  }
+  unblock.set_value();
+
+  ASSERT_TRUE(eventually([&] {
+    std::lock_guard<std::mutex> lock(closeMutex);
+    return !closedWith.empty();
+  }));
+  auto stats = feed.stats();
+  EXPECT_EQ(stats.evicted, 1u);
+  EXPECT_EQ(stats.connections, 0u);
+}
+
+TEST(ChangeFeedUnitTests, RefusesConnectionsBeyondTheCap) {
+  ChangeFeed feed(16, 1);
+  Client first;
+  Client second;
+
+  auto id = feed.subscribe("shelter", "*", first.send(), first.close());
+  ASSERT_TRUE(id);
+  EXPECT_FALSE(feed.subscribe("shelter", "*", second.send(), second.close()));
+
+  feed.unsubscribe(*id);
+  EXPECT_TRUE(feed.subscribe("shelter", "*", second.send(), second.close()));
+}
+
+TEST(ChangeFeedUnitTests, StopsSendingOnceUnsubscribed) {
+  ChangeFeed feed(16, 16);
+  Client client;
+  auto id = feed.subscribe("food", "*", client.send(), client.close());
+  feed.publish(change("food", "add", "1", "NYC"));
+  ASSERT_TRUE(eventually([&] { return client.received().size() == 1; }));
+
+  feed.unsubscribe(*id);
+  feed.publish(change("food", "add", "2", "NYC"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  EXPECT_EQ(client.received().size(), 1u);
+  EXPECT_EQ(feed.stats().connections, 0u);
+}
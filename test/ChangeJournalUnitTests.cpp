@@ -0,0 +1,108 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "ChangeJournal.h"
+
+namespace {
+
+ResourceChange change(const std::string& action, const std::string& id) {
+  return ResourceChange{"shelter", action, id, "NYC"};
+}
+
+}  // namespace
+
+TEST(ChangeJournalUnitTests, NumbersChangesFromTheFirstSequence) {
+  ChangeJournal journal(100, 1000);
+
+  EXPECT_EQ(journal.latest(), 999u);
+  EXPECT_EQ(journal.append(change("add", "a"), R"({"Name": "A"})"), 1000u);
+  EXPECT_EQ(journal.append(change("delete", "a"), ""), 1001u);
+
+  auto page = journal.since(999, 10);
+  ASSERT_TRUE(page);
+  ASSERT_EQ(page->entries.size(), 2u);
+  EXPECT_EQ(page->entries[0].change.action, "add");
+  EXPECT_EQ(page->entries[1].change.action, "delete");
+  EXPECT_EQ(page->next, 1001u);
+  EXPECT_FALSE(page->more);
+}
+
+TEST(ChangeJournalUnitTests, PagesThroughChanges) {
+  ChangeJournal journal(100, 1);
+  journal.append(change("add", "a"), "{}");
+  journal.append(change("add", "b"), "{}");
+  journal.append(change("add", "c"), "{}");
+
+  auto first = journal.since(0, 2);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first->entries.size(), 2u);
+  EXPECT_TRUE(first->more);
+  EXPECT_EQ(first->next, 2u);
+
+  auto second = journal.since(first->next, 2);
+  ASSERT_TRUE(second);
+  ASSERT_EQ(second->entries.size(), 1u);
+  EXPECT_EQ(second->entries[0].change.id, "c");
+  EXPECT_FALSE(second->more);
+
+  auto none = journal.since(second->next, 2);
+  ASSERT_TRUE(none);
+  EXPECT_TRUE(none->entries.empty());
+  EXPECT_EQ(none->next, 3u);
+}
+
+TEST(ChangeJournalUnitTests, CompactionKeepsTheLatestChangePerResource) {
+  ChangeJournal journal(4, 1);
+  journal.append(change("add", "x"), R"({"Name": "1"})");
+  journal.append(change("update", "x"), R"({"Name": "2"})");
+  journal.append(change("add", "y"), "{}");
+  journal.append(change("delete", "x"), "");
+  journal.append(change("add", "z"), "{}");
+
+  auto page = journal.since(0, 10);
+  ASSERT_TRUE(page);
+  ASSERT_EQ(page->entries.size(), 3u);
+  EXPECT_EQ(page->entries[0].change.id, "y");
+  EXPECT_EQ(page->entries[1].change.action, "delete");
+  EXPECT_EQ(page->entries[2].change.id, "z");
+  EXPECT_EQ(page->next, 5u);
+  EXPECT_EQ(journal.stats().compactions, 1u);
+  EXPECT_EQ(journal.stats().floor, 0u);
+}
+
+TEST(ChangeJournalUnitTests, DroppingOldChangesRejectsOlderCursors) {
+  ChangeJournal journal(4, 1);
+  for (const char* id : {"a", "b", "c", "d", "e"}) {
+    journal.append(change("add", id), "{}");
+  }
+
+  EXPECT_EQ(journal.stats().floor, 2u);
+  EXPECT_FALSE(journal.since(0, 10));
+  EXPECT_FALSE(journal.since(1, 10));
+  auto page = journal.since(2, 10);
+  ASSERT_TRUE(page);
+  ASSERT_EQ(page->entries.size(), 3u);
+  EXPECT_EQ(page->entries[0].change.id, "c");
+}
+
+TEST(ChangeJournalUnitTests, RejectsSequencesNeverIssued) {
+  ChangeJournal journal(100, 50);
+  journal.append(change("add", "a"), "{}");
+
+  EXPECT_TRUE(journal.since(50, 10));
+  EXPECT_FALSE(journal.since(51, 10));
+}
+
+TEST(ChangeJournalUnitTests, RendersEntriesAsJson) {
+  JournalEntry added{7, change("add", "a"), R"({"Name": "A"})"};
+  JournalEntry deleted{8, change("delete", "a"), ""};
+
+  EXPECT_EQ(added.json(),
+            "{\"seq\": 7, \"resource\": \"shelter\", \"action\": \"add\", "
+            "\"id\": \"a\", \"city\": \"NYC\", \"document\": {\"Name\": "
+            "\"A\"}}");
+  EXPECT_NE(deleted.json().find("\"document\": null"), std::string::npos);
+}
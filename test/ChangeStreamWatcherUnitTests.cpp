@@ -0,0 +1,238 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/oid.hpp>
+#include <chrono>  // NOLINT(build/c++11)
+#include <future>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <string>
+#include <system_error>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "ChangeStreamWatcher.h"
+#include "MockDatabaseManager.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+using ::testing::_;
+
+namespace {
+
+using Callback = std::function<bool(const bsoncxx::document::view&)>;
+
+bsoncxx::document::value token(const std::string& data) {
+  return make_document(kvp("_data", data));
+}
+
+bsoncxx::document::value insertEvent(const std::string& id) {
+  return make_document(
+      kvp("operationType", "insert"),
+      kvp("documentKey", make_document(kvp("_id", bsoncxx::oid(id)))),
+      kvp("fullDocument", make_document(kvp("_id", bsoncxx::oid(id)),
+                                        kvp("Resource", "food"))));
+}
+
+// Stands in for an idle stream: reports the same token until told to stop.
+void idleUntilStopped(const Callback& onBatch, const std::string& data) {
+  auto resumeToken = token(data);
+  while (onBatch(resumeToken.view())) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+}  // namespace
+
+class ChangeStreamWatcherUnitTests : public ::testing::Test {
+ protected:
+  MockDatabaseManager mockDbManager;
+  std::mutex mutex;
+  std::vector<ChangeEvent> received;
+  std::promise<void> handled;
+  std::string savedToken;
+
+  void SetUp() override {
+    ON_CALL(mockDbManager, updateDocument("ChangeStreamTokens", _, _, true))
+        .WillByDefault([this](const std::string&,
+                              const bsoncxx::document::view& filter,
+                              const bsoncxx::document::view& update, bool) {
+          std::lock_guard<std::mutex> lock(mutex);
+          EXPECT_EQ(filter["_id"].get_utf8().value.to_string(),
+                    "node-1/Subscribers");
+          savedToken = update["$set"]["Token"]["_data"]
+                           .get_utf8()
+                           .value.to_string();
+          return true;
+        });
+  }
+
+  ChangeStreamWatcher::Handler recorder() {
+    return [this](const ChangeEvent& event) {
+      std::lock_guard<std::mutex> lock(mutex);
+      received.push_back(event);
+      if (received.size() == 1) {
+        handled.set_value();
+      }
+    };
+  }
+
+  void waitForFirstEvent() {
+    ASSERT_EQ(handled.get_future().wait_for(std::chrono::seconds(2)),
+              std::future_status::ready);
+  }
+};
+
+TEST_F(ChangeStreamWatcherUnitTests, TranslatesStreamEvents) {
+  auto inserted =
+      ChangeEvent::fromStream("Food", insertEvent("507f1f77bcf86cd799439011"));
+  ASSERT_TRUE(inserted);
+  EXPECT_EQ(inserted->operation, ChangeEvent::Operation::Insert);
+  EXPECT_EQ(inserted->id, "507f1f77bcf86cd799439011");
+  ASSERT_TRUE(inserted->document);
+  EXPECT_EQ(
+      inserted->document->view()["Resource"].get_utf8().value.to_string(),
+      "food");
+
+  auto replaced = ChangeEvent::fromStream(
+      "Food",
+      make_document(kvp("operationType", "replace"),
+                    kvp("documentKey", make_document(kvp("_id", "x")))));
+  ASSERT_TRUE(replaced);
+  EXPECT_EQ(replaced->operation, ChangeEvent::Operation::Update);
+  EXPECT_EQ(replaced->id, "x");
+  EXPECT_FALSE(replaced->document);
+
+  auto dropped = ChangeEvent::fromStream(
+      "Food", make_document(kvp("operationType", "drop")));
+  ASSERT_TRUE(dropped);
+  EXPECT_EQ(dropped->operation, ChangeEvent::Operation::Reset);
+
+  EXPECT_FALSE(ChangeEvent::fromStream(
+      "Food", make_document(kvp("operationType", "createIndexes"))));
+}
+
+TEST_F(ChangeStreamWatcherUnitTests, ResumesFromTheSavedToken) {
+  EXPECT_CALL(mockDbManager, findDocument("ChangeStreamTokens", _))
+      .WillOnce(::testing::Return(std::optional<bsoncxx::document::value>(
+          make_document(kvp("_id", "node-1/Subscribers"),
+                        kvp("Token", token("saved"))))));
+  EXPECT_CALL(mockDbManager, watchCollection("Subscribers", _, _, _, _))
+      .WillOnce([](const std::string&,
+                   const std::optional<bsoncxx::document::value>& resumeAfter,
+                   std::chrono::milliseconds, const Callback& onEvent,
+                   const Callback& onBatch) {
+        ASSERT_TRUE(resumeAfter);
+        EXPECT_EQ(resumeAfter->view()["_data"].get_utf8().value.to_string(),
+                  "saved");
+        onEvent(insertEvent("507f1f77bcf86cd799439011"));
+        idleUntilStopped(onBatch, "next");
+      });
+  ChangeStreamWatcher watcher(mockDbManager, "node-1",
+                              std::chrono::milliseconds(0));
+  watcher.watch("Subscribers", recorder());
+
+  watcher.start();
+  waitForFirstEvent();
+  watcher.stop();
+
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].operation, ChangeEvent::Operation::Insert);
+  EXPECT_EQ(received[0].collection, "Subscribers");
+  EXPECT_EQ(savedToken, "next");
+  auto status = watcher.status();
+  ASSERT_EQ(status.size(), 1u);
+  EXPECT_EQ(status[0].events, 1u);
+  EXPECT_EQ(status[0].resets, 0u);
+  EXPECT_FALSE(status[0].running);
+}
+
+TEST_F(ChangeStreamWatcherUnitTests, ResetsWhenThereIsNoToken) {
+  EXPECT_CALL(mockDbManager, findDocument("ChangeStreamTokens", _))
+      .WillOnce(::testing::Return(std::nullopt));
+  EXPECT_CALL(mockDbManager, watchCollection("Subscribers", _, _, _, _))
+      .WillOnce([](const std::string&,
+                   const std::optional<bsoncxx::document::value>& resumeAfter,
+                   std::chrono::milliseconds, const Callback&,
+                   const Callback& onBatch) {
+        EXPECT_FALSE(resumeAfter);
+        idleUntilStopped(onBatch, "first");
+      });
+  ChangeStreamWatcher watcher(mockDbManager, "node-1",
+                              std::chrono::hours(1));
+  watcher.watch("Subscribers", recorder());
+
+  watcher.start();
+  waitForFirstEvent();
+  EXPECT_TRUE(watcher.isFollowing("Subscribers"));
+  watcher.stop();
+
+  EXPECT_FALSE(watcher.isFollowing("Subscribers"));
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].operation, ChangeEvent::Operation::Reset);
+  EXPECT_EQ(savedToken, "first");
+  EXPECT_EQ(watcher.status()[0].resets, 1u);
+}
+
+TEST_F(ChangeStreamWatcherUnitTests, StartsOverWhenTheHistoryIsGone) {
+  EXPECT_CALL(mockDbManager, findDocument("ChangeStreamTokens", _))
+      .WillOnce(::testing::Return(std::optional<bsoncxx::document::value>(
+          make_document(kvp("Token", token("ancient"))))));
+  EXPECT_CALL(mockDbManager, watchCollection("Subscribers", _, _, _, _))
+      .WillOnce([](const std::string&,
+                   const std::optional<bsoncxx::document::value>& resumeAfter,
+                   std::chrono::milliseconds, const Callback&,
+                   const Callback&) {
+        EXPECT_TRUE(resumeAfter);
+        throw std::system_error(286, std::generic_category(),
+                                "history lost");
+      })
+      .WillOnce([](const std::string&,
+                   const std::optional<bsoncxx::document::value>& resumeAfter,
+                   std::chrono::milliseconds, const Callback&,
+                   const Callback& onBatch) {
+        EXPECT_FALSE(resumeAfter);
+        idleUntilStopped(onBatch, "fresh");
+      });
+  ChangeStreamWatcher watcher(mockDbManager, "node-1",
+                              std::chrono::hours(1));
+  watcher.watch("Subscribers", recorder());
+
+  watcher.start();
+  waitForFirstEvent();
+  watcher.stop();
+
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].operation, ChangeEvent::Operation::Reset);
+  EXPECT_EQ(watcher.status()[0].errors, 0u);
+}
+
+TEST_F(ChangeStreamWatcherUnitTests, StopsWithoutAReplicaSet) {
+  EXPECT_CALL(mockDbManager, findDocument("ChangeStreamTokens", _))
+      .WillOnce(::testing::Return(std::nullopt));
+  std::promise<void> refused;
+  EXPECT_CALL(mockDbManager, watchCollection("Subscribers", _, _, _, _))
+      .WillOnce([&refused](const std::string&,
+                           const std::optional<bsoncxx::document::value>&,
+                           std::chrono::milliseconds, const Callback&,
+                           const Callback&) {
+        refused.set_value();
+        throw std::system_error(40573, std::generic_category(),
+                                "not a replica set");
+      });
+  ChangeStreamWatcher watcher(mockDbManager, "node-1",
+                              std::chrono::hours(1));
+  watcher.watch("Subscribers", recorder());
+
+  watcher.start();
+  refused.get_future().wait();
+  for (int i = 0; i < 2000 && watcher.status()[0].running; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  EXPECT_FALSE(watcher.status()[0].running);
+  EXPECT_TRUE(received.empty());
+}
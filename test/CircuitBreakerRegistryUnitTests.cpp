@@ -0,0 +1,118 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include "CircuitBreakerRegistry.h"
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+class CircuitBreakerRegistryUnitTests : public ::testing::Test {
+ protected:
+  CircuitBreakerRegistry breakers{2, 3, seconds(30)};
+  CircuitBreakerRegistry::Clock::time_point start =
+      CircuitBreakerRegistry::Clock::now();
+
+  void fail(const std::string& host, int times) {
+    for (int i = 0; i < times; ++i) {
+      auto permit = breakers.tryAcquire(host, start);
+      ASSERT_TRUE(permit);
+      breakers.release(host, permit, false, milliseconds(10), start);
+    }
+  }
+};
+
+TEST_F(CircuitBreakerRegistryUnitTests, HostOf) {
+  EXPECT_EQ(CircuitBreakerRegistry::hostOf("https://Hooks.Example.org/a?b=c"),
+            "hooks.example.org");
+  EXPECT_EQ(CircuitBreakerRegistry::hostOf("http://user:pw@host:8443/x"),
+            "host:8443");
+  EXPECT_EQ(CircuitBreakerRegistry::hostOf("host.example.org"),
+            "host.example.org");
+}
+
+TEST_F(CircuitBreakerRegistryUnitTests, CapsConcurrencyPerHost) {
+  auto first = breakers.tryAcquire("slow", start);
+  EXPECT_TRUE(first);
+  EXPECT_TRUE(breakers.tryAcquire("slow", start));
+  EXPECT_FALSE(breakers.tryAcquire("slow", start));
+  EXPECT_TRUE(breakers.tryAcquire("healthy", start));
+
+  breakers.release("slow", first, true, milliseconds(5), start);
+  EXPECT_TRUE(breakers.tryAcquire("slow", start));
+}
+
+TEST_F(CircuitBreakerRegistryUnitTests, OpensAfterConsecutiveFailures) {
+  fail("dead", 3);
+
+  EXPECT_FALSE(breakers.tryAcquire("dead", start + seconds(29)));
+  EXPECT_TRUE(breakers.tryAcquire("healthy", start));
+
+  auto status = breakers.snapshot();
+  ASSERT_EQ(status.size(), 2);
+  EXPECT_EQ(status[0].host, "dead");
+  EXPECT_EQ(status[0].state, "open");
+  EXPECT_EQ(status[0].failures, 3);
+  EXPECT_EQ(status[0].rejected, 1);
+}
+
+TEST_F(CircuitBreakerRegistryUnitTests, SuccessResetsFailureCount) {
+  fail("flaky", 2);
+  auto permit = breakers.tryAcquire("flaky", start);
+  ASSERT_TRUE(permit);
+  breakers.release("flaky", permit, true, milliseconds(10), start);
+  fail("flaky", 2);
+
+  EXPECT_TRUE(breakers.tryAcquire("flaky", start));
+}
+
+TEST_F(CircuitBreakerRegistryUnitTests, HalfOpenAllowsOneProbe) {
+  fail("dead", 3);
+  auto later = start + seconds(30);
+
+  auto probe = breakers.tryAcquire("dead", later);
+  EXPECT_TRUE(probe);
+  EXPECT_TRUE(probe.probe);
+  EXPECT_FALSE(breakers.tryAcquire("dead", later));
+  EXPECT_EQ(breakers.snapshot()[0].state, "half-open");
+
+  breakers.release("dead", probe, false, milliseconds(10), later);
+  EXPECT_FALSE(breakers.tryAcquire("dead", later + seconds(29)));
+
+  auto retry = later + seconds(30);
+  probe = breakers.tryAcquire("dead", retry);
+  EXPECT_TRUE(probe);
+  breakers.release("dead", probe, true, milliseconds(10), retry);
+  EXPECT_EQ(breakers.snapshot()[0].state, "closed");
+  EXPECT_TRUE(breakers.tryAcquire("dead", retry));
+}
+
+TEST_F(CircuitBreakerRegistryUnitTests, EarlierCallsDoNotSettleTheProbe) {
+  auto slow = breakers.tryAcquire("dead", start);
+  ASSERT_TRUE(slow);
+  EXPECT_FALSE(slow.probe);
+  fail("dead", 3);
+  auto later = start + seconds(30);
+  auto probe = breakers.tryAcquire("dead", later);
+  ASSERT_TRUE(probe.probe);
+
+  // The call admitted before the breaker opened finishes first.
+  breakers.release("dead", slow, true, milliseconds(10), later);
+  EXPECT_EQ(breakers.snapshot()[0].state, "half-open");
+  EXPECT_FALSE(breakers.tryAcquire("dead", later));
+
+  breakers.release("dead", probe, false, milliseconds(10), later);
+  EXPECT_EQ(breakers.snapshot()[0].state, "open");
+  EXPECT_FALSE(breakers.tryAcquire("dead", later + seconds(29)));
+}
+
+TEST_F(CircuitBreakerRegistryUnitTests, TracksLatencyAverage) {
+  auto permit = breakers.tryAcquire("host", start);
+  ASSERT_TRUE(permit);
+  breakers.release("host", permit, true, milliseconds(100), start);
+  permit = breakers.tryAcquire("host", start);
+  ASSERT_TRUE(permit);
+  breakers.release("host", permit, true, milliseconds(200), start);
+
+  EXPECT_DOUBLE_EQ(breakers.snapshot()[0].latencyMs, 120.0);
+}
@@ -0,0 +1,59 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "CollectionVersions.h"
+
+TEST(CollectionVersionsUnitTests, BumpsEachCollectionSeparately) {
+  uint64_t food = CollectionVersions::current("VersionsFood");
+  uint64_t shelter = CollectionVersions::current("VersionsShelter");
+
+  EXPECT_EQ(CollectionVersions::bump("VersionsFood"), food + 1);
+  EXPECT_EQ(CollectionVersions::current("VersionsFood"), food + 1);
+  EXPECT_EQ(CollectionVersions::current("VersionsShelter"), shelter);
+}
+
+TEST(CollectionVersionsUnitTests, TagChangesWithVersionAndVariant) {
+  std::string first = CollectionVersions::etag("VersionsTag", "start=0");
+
+  EXPECT_EQ(CollectionVersions::etag("VersionsTag", "start=0"), first);
+  EXPECT_NE(CollectionVersions::etag("VersionsTag", "start=20"), first);
+  EXPECT_NE(CollectionVersions::etag("VersionsOther", "start=0"), first);
+  CollectionVersions::bump("VersionsTag");
+  EXPECT_NE(CollectionVersions::etag("VersionsTag", "start=0"), first);
+  EXPECT_EQ(first.front(), '"');
+  EXPECT_EQ(first.back(), '"');
+}
+
+TEST(CollectionVersionsUnitTests, MatchesIfNoneMatchLists) {
+  std::string tag = "\"abc-1-ff\"";
+
+  EXPECT_TRUE(CollectionVersions::matches(tag, tag));
+  EXPECT_TRUE(CollectionVersions::matches("W/\"abc-1-ff\"", tag));
+  EXPECT_TRUE(CollectionVersions::matches("\"x\", \"abc-1-ff\"", tag));
+  EXPECT_TRUE(CollectionVersions::matches("*", tag));
+  EXPECT_FALSE(CollectionVersions::matches("", tag));
+  EXPECT_FALSE(CollectionVersions::matches("\"abc-2-ff\"", tag));
+  EXPECT_FALSE(CollectionVersions::matches("abc-1-ff", tag));
+}
+
+TEST(CollectionVersionsUnitTests, CountsConcurrentBumps) {
+  uint64_t before = CollectionVersions::current("VersionsConcurrent");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; ++i) {
+        CollectionVersions::bump("VersionsConcurrent");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(CollectionVersions::current("VersionsConcurrent"), before + 8000);
+}
@@ -9,6 +9,19 @@
 #include "Counseling.h"
 #include "MockDatabaseManager.h"
 
+namespace {
+
+// A document with the given City and the given value in field.
+bsoncxx::document::value resource(const std::string& city,
+                                  const std::string& field,
+                                  const std::string& value) {
+  return bsoncxx::builder::stream::document{}
+         << "City" << city << field << value
+         << bsoncxx::builder::stream::finalize;
+}
+
+}  // namespace
+
 class CounselingUnitTests : public ::testing::Test {
  protected:
   MockDatabaseManager *mockDbManager;
@@ -55,9 +68,10 @@ TEST_F(CounselingUnitTests, AddCounselor) {
         "HoursOfOperation": "2024-01-11",
         "counselorName": "Jack"
     })";
-  counseling->checkInputFormat(input, "456");
+  Counseling::Fields fields;
+  counseling->checkInputFormat(input, "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      counseling->createDBContent();
+      counseling->createDBContent(fields);
 
   ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
       .WillByDefault(::testing::Invoke(
@@ -68,9 +82,10 @@ TEST_F(CounselingUnitTests, AddCounselor) {
             return "12345";
           }));
 
-  std::string result = counseling->addCounselor(input, "456");
+  auto result = counseling->addCounselor(input, "456");
 
-  EXPECT_EQ(result, "12345");
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value(), "12345");
 }
 
 TEST_F(CounselingUnitTests, updateCounseling) {
@@ -85,9 +100,10 @@ TEST_F(CounselingUnitTests, updateCounseling) {
         "HoursOfOperation": "2024-01-11",
         "counselorName": "Jack"
   })";
-  counseling->checkInputFormat(input, "456");
+  Counseling::Fields fields;
+  counseling->checkInputFormat(input, "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      counseling->createDBContent();
+      counseling->createDBContent(fields);
   std::string id_temp = "123456789";
   ON_CALL(*mockDbManager,
           updateResource(::testing::_, ::testing::_, ::testing::_))
@@ -101,8 +117,9 @@ TEST_F(CounselingUnitTests, updateCounseling) {
             return true;
           });
 
-  std::string result = counseling->updateCounselor(input, "456");
-  EXPECT_EQ(result, "Success");
+  auto result = counseling->updateCounselor(input, "456");
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value(), "Success");
 
   // Verify the updated data can be retrieved
   std::vector<bsoncxx::document::value> mockResult;
@@ -151,3 +168,19 @@ TEST_F(CounselingUnitTests, DeleteCounselor) {
   std::string counselingItems = counseling->searchCounselorsAll(0);
   EXPECT_EQ(counselingItems, "[]");
 }
+
+TEST_F(CounselingUnitTests, FiltersListingsOnItsOwnFields) {
+  mockDbManager->findIn({resource("Boston", "Name", "Match"),
+                         resource("Queens", "Name", "Other")});
+  ListingFilter filter;
+  filter.city = "Boston";
+
+  std::string listing =
+      counseling->encodedListing(0, ResponseFormat::Format::Json, filter);
+
+  EXPECT_NE(listing.find("Match"), std::string::npos);
+  EXPECT_EQ(listing.find("Other"), std::string::npos);
+
+  filter.targetUser = "HML";
+  EXPECT_FALSE(filter.supportedBy(Counseling::kFilterSpec));
+}
@@ -0,0 +1,102 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <future>  // NOLINT(build/c++11)
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/builder/stream/document.hpp>
+
+#include "MockDatabaseManager.h"
+
+using ::testing::_;
+using ::testing::Return;
+
+class DatabaseManagerAsyncUnitTests : public ::testing::Test {
+ protected:
+  MockDatabaseManager mockDbManager;
+};
+
+TEST_F(DatabaseManagerAsyncUnitTests, InsertRunsOnTheIoExecutor) {
+  std::thread::id caller = std::this_thread::get_id();
+  std::thread::id ranOn;
+  EXPECT_CALL(mockDbManager, insertResource("Shelter", _))
+      .WillOnce([&](const std::string&,
+                    const std::vector<std::pair<std::string, std::string>>&) {
+        ranOn = std::this_thread::get_id();
+        return std::string("507f191e810c19729de860ea");
+      });
+
+  auto id = mockDbManager.insertResourceAsync("Shelter", {{"Name", "A"}});
+
+  EXPECT_EQ(id.get(), "507f191e810c19729de860ea");
+  EXPECT_NE(ranOn, caller);
+}
+
+TEST_F(DatabaseManagerAsyncUnitTests, FindReturnsTheDocuments) {
+  std::vector<bsoncxx::document::value> documents;
+  documents.push_back(bsoncxx::builder::stream::document{}
+                      << "Name" << "Shelter A"
+                      << bsoncxx::builder::stream::finalize);
+  EXPECT_CALL(mockDbManager, findCollection(0, "Shelter", _, _))
+      .WillOnce(::testing::SetArgReferee<3>(documents));
+
+  auto result = mockDbManager.findCollectionAsync(0, "Shelter", {}).get();
+
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].view()["Name"].get_utf8().value.to_string(),
+            "Shelter A");
+}
+
+TEST_F(DatabaseManagerAsyncUnitTests, UpdateFailuresReachTheFuture) {
+  EXPECT_CALL(mockDbManager, updateResource("Shelter", "bad-id", _))
+      .WillOnce(::testing::Throw(std::invalid_argument("wrong id")));
+
+  auto done = mockDbManager.updateResourceAsync("Shelter", "bad-id", {});
+
+  EXPECT_THROW(done.get(), std::invalid_argument);
+}
+
+TEST_F(DatabaseManagerAsyncUnitTests, DeleteReturnsTheOutcome) {
+  EXPECT_CALL(mockDbManager, deleteResource("Shelter", "id", "token"))
+      .WillOnce(Return(true));
+
+  auto deleted = mockDbManager.deleteResourceAsync("Shelter", "id", "token");
+
+  EXPECT_TRUE(deleted.get());
+}
+
+TEST_F(DatabaseManagerAsyncUnitTests, IndependentQueriesOverlap) {
+  std::atomic<int> inFlight{0};
+  std::atomic<int> maxInFlight{0};
+  EXPECT_CALL(mockDbManager, findCollection(_, _, _, _))
+      .Times(4)
+      .WillRepeatedly([&](int, const std::string&,
+                          const std::vector<std::pair<std::string,
+                                                      std::string>>&,
+                          std::vector<bsoncxx::document::value>&) {
+        int now = inFlight.fetch_add(1) + 1;
+        int seen = maxInFlight.load();
+        while (now > seen && !maxInFlight.compare_exchange_weak(seen, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        inFlight.fetch_sub(1);
+      });
+
+  std::vector<std::future<std::vector<bsoncxx::document::value>>> queries;
+  for (int i = 0; i < 4; ++i) {
+    queries.push_back(mockDbManager.findCollectionAsync(i, "Shelter", {}));
+  }
+  for (auto& query : queries) {
+    query.get();
+  }
+
+  EXPECT_GT(maxInFlight.load(), 1);
+}
@@ -0,0 +1,71 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <future>  // NOLINT(build/c++11)
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "AsyncExecutor.h"
+#include "Deadline.h"
+
+TEST(DeadlineUnitTests, HasNoDeadlineOutsideAScope) {
+  EXPECT_FALSE(Deadline::current().has_value());
+  EXPECT_FALSE(Deadline::remaining().has_value());
+  EXPECT_FALSE(Deadline::expired());
+  EXPECT_EQ(Deadline::clampMs(5000), 5000);
+  EXPECT_NO_THROW(Deadline::check("mongo.find"));
+}
+
+TEST(DeadlineUnitTests, NestedScopesOnlyShortenTheDeadline) {
+  Deadline::Scope outer(std::chrono::milliseconds(200));
+  auto outerAt = Deadline::current();
+  {
+    Deadline::Scope longer(std::chrono::seconds(60));
+    EXPECT_EQ(Deadline::current(), outerAt);
+    Deadline::Scope shorter(std::chrono::milliseconds(50));
+    EXPECT_LT(*Deadline::current(), *outerAt);
+  }
+  EXPECT_EQ(Deadline::current(), outerAt);
+}
+
+TEST(DeadlineUnitTests, ClampsTimeoutsToTheTimeLeft) {
+  Deadline::Scope deadline(std::chrono::milliseconds(100));
+
+  EXPECT_LE(Deadline::clampMs(5000), 100);
+  EXPECT_GE(Deadline::clampMs(5000), 1);
+  EXPECT_EQ(Deadline::clampMs(10), 10);
+}
+
+TEST(DeadlineUnitTests, ThrowsWithTheStageOnceExpired) {
+  Deadline::Scope deadline(std::chrono::milliseconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+  EXPECT_TRUE(Deadline::expired());
+  EXPECT_EQ(Deadline::remaining(), std::chrono::milliseconds(0));
+  EXPECT_EQ(Deadline::clampMs(5000), 1);
+  try {
+    Deadline::check("mongo.insert");
+    FAIL() << "Expected DeadlineExceeded";
+  } catch (const DeadlineExceeded& e) {
+    EXPECT_EQ(e.stage(), "mongo.insert");
+    EXPECT_STREQ(e.what(), "Deadline exceeded during mongo.insert.");
+  }
+}
+
+TEST(DeadlineUnitTests, ExecutorTasksRunUnderThePostersDeadline) {
+  AsyncExecutor executor(1, 16);
+  std::optional<Deadline::Clock::time_point> posted;
+  std::future<std::optional<Deadline::Clock::time_point>> seen;
+  {
+    Deadline::Scope deadline(std::chrono::seconds(5));
+    posted = Deadline::current();
+    seen = executor.submit([] { return Deadline::current(); });
+  }
+  auto without = executor.submit([] { return Deadline::current(); });
+
+  EXPECT_EQ(seen.get(), posted);
+  EXPECT_FALSE(without.get().has_value());
+}
@@ -9,6 +9,19 @@
 #include "Food.h"
 #include "MockDatabaseManager.h"
 
+namespace {
+
+// A document with the given City and the given value in field.
+bsoncxx::document::value resource(const std::string& city,
+                                  const std::string& field,
+                                  const std::string& value) {
+  return bsoncxx::builder::stream::document{}
+         << "City" << city << field << value
+         << bsoncxx::builder::stream::finalize;
+}
+
+}  // namespace
+
 class FoodUnitTests : public ::testing::Test {
  protected:
   Food* food;
@@ -60,8 +73,9 @@ TEST_F(FoodUnitTests, addFood) {
     "Quantity" : "100",
     "ExpirationDate": "10"
   })";
-  food->checkInputFormat(input, "456");
-  auto target = food->createDBContent();
+  Food::Fields fields;
+  food->checkInputFormat(input, "456", fields);
+  auto target = food->createDBContent(fields);
   ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
       .WillByDefault(
           [&](const std::string& collectionName,
@@ -140,9 +154,10 @@ TEST_F(FoodUnitTests, updateFood) {
     "Quantity" : "100",
     "ExpirationDate": "2024-01-11"
   })";
-  food->checkInputFormat(input, "456");
+  Food::Fields fields;
+  food->checkInputFormat(input, "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      food->createDBContent();
+      food->createDBContent(fields);
   std::string id_temp = "123456789";
   ON_CALL(*mockDbManager,
           updateResource(::testing::_, ::testing::_, ::testing::_))
@@ -156,8 +171,9 @@ TEST_F(FoodUnitTests, updateFood) {
             return true;
           });
 
-  std::string result = food->updateFood(input, "456");
-  EXPECT_EQ(result, "Success");
+  auto result = food->updateFood(input, "456");
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value(), "Success");
 
   // Verify the updated data can be retrieved
   std::vector<bsoncxx::document::value> mockResult;
@@ -177,3 +193,22 @@ TEST_F(FoodUnitTests, updateFood) {
   EXPECT_TRUE(foodItems.find("100") != std::string::npos);
   EXPECT_TRUE(foodItems.find("2024-01-11") != std::string::npos);
 }
+
+TEST_F(FoodUnitTests, FiltersListingsOnItsOwnFields) {
+  mockDbManager->findIn({resource("Boston", "TargetUser", "HML"),
+                         resource("Boston", "TargetUser", "VET"),
+                         resource("Queens", "TargetUser", "HML")});
+  ListingFilter filter;
+  filter.city = "Boston";
+  filter.targetUser = "HML";
+
+  std::string listing =
+      food->encodedListing(0, ResponseFormat::Format::Json, filter);
+
+  EXPECT_NE(listing.find("Boston"), std::string::npos);
+  EXPECT_EQ(listing.find("Queens"), std::string::npos);
+  EXPECT_EQ(listing.find("VET"), std::string::npos);
+
+  filter.org = "NGO";
+  EXPECT_FALSE(filter.supportedBy(Food::kFilterSpec));
+}
@@ -9,6 +9,19 @@
 #include "Healthcare.h"
 #include "MockDatabaseManager.h"
 
+namespace {
+
+// A document with the given City and the given value in field.
+bsoncxx::document::value resource(const std::string& city,
+                                  const std::string& field,
+                                  const std::string& value) {
+  return bsoncxx::builder::stream::document{}
+         << "City" << city << field << value
+         << bsoncxx::builder::stream::finalize;
+}
+
+}  // namespace
+
 class HealthcareServiceUnitTests : public ::testing::Test {
  protected:
   MockDatabaseManager* mockDbManager;
@@ -61,9 +74,10 @@ TEST_F(HealthcareServiceUnitTests, AddNewHealthcareService) {
 })";
 
   // for comparison in mock call
-  healthcareService->checkInputFormat(input, "456");
+  Healthcare::Fields fields;
+  healthcareService->checkInputFormat(input, "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      healthcareService->createDBContent();
+      healthcareService->createDBContent(fields);
   ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
       .WillByDefault(::testing::Invoke(
           [&](const std::string& collectionName,
@@ -73,9 +87,10 @@ TEST_F(HealthcareServiceUnitTests, AddNewHealthcareService) {
             return "12345";
           }));
 
-  std::string result = healthcareService->addHealthcareService(input, "456");
+  auto result = healthcareService->addHealthcareService(input, "456");
 
-  EXPECT_EQ(result, "12345");
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value(), "12345");
 }
 
 TEST_F(HealthcareServiceUnitTests, DeleteHealthcare) {
@@ -115,9 +130,10 @@ TEST_F(HealthcareServiceUnitTests, UpdateHealthcare) {
   "eligibilityCriteria": "Adults",
   "ContactInfo": "123-456-7890"
 })";
-  healthcareService->checkInputFormat(input, "456");
+  Healthcare::Fields fields;
+  healthcareService->checkInputFormat(input, "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      healthcareService->createDBContent();
+      healthcareService->createDBContent(fields);
   ON_CALL(*mockDbManager,
           updateResource(::testing::_, ::testing::_, ::testing::_))
       .WillByDefault(
@@ -130,8 +146,9 @@ TEST_F(HealthcareServiceUnitTests, UpdateHealthcare) {
             return true;
           });
 
-  std::string result = healthcareService->updateHealthcare(input, "456");
-  EXPECT_EQ(result, "Update");
+  auto result = healthcareService->updateHealthcare(input, "456");
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value(), "Update");
 
   std::vector<bsoncxx::document::value> mockResult;
   mockResult.push_back(bsoncxx::builder::stream::document{}
@@ -156,3 +173,22 @@ TEST_F(HealthcareServiceUnitTests, UpdateHealthcare) {
   EXPECT_TRUE(healthcareItems.find("24/7") != std::string::npos);
   EXPECT_TRUE(healthcareItems.find("321-654-0987") != std::string::npos);
 }
+
+TEST_F(HealthcareServiceUnitTests, FiltersListingsOnItsOwnFields) {
+  mockDbManager->findIn({resource("Boston", "eligibilityCriteria", "HML"),
+                         resource("Boston", "eligibilityCriteria", "VET"),
+                         resource("Queens", "eligibilityCriteria", "HML")});
+  ListingFilter filter;
+  filter.city = "Boston";
+  filter.targetUser = "HML";
+
+  std::string listing = healthcareService->encodedListing(
+      0, ResponseFormat::Format::Json, filter);
+
+  EXPECT_NE(listing.find("Boston"), std::string::npos);
+  EXPECT_EQ(listing.find("Queens"), std::string::npos);
+  EXPECT_EQ(listing.find("VET"), std::string::npos);
+
+  filter.org = "NGO";
+  EXPECT_FALSE(filter.supportedBy(Healthcare::kFilterSpec));
+}
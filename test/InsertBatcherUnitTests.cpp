@@ -0,0 +1,160 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "InsertBatcher.h"
+
+namespace {
+
+// Returns "<collection>:<Name>" as the id of each document.
+std::vector<std::string> echoIds(
+    const std::string& collectionName,
+    const std::vector<const InsertBatcher::KeyValues*>& documents) {
+  std::vector<std::string> ids;
+  for (const auto* document : documents) {
+    ids.push_back(collectionName + ":" + document->at(0).second);
+  }
+  return ids;
+}
+
+std::vector<std::string> insertConcurrently(InsertBatcher& batcher,
+                                            const std::string& collection,
+                                            int count) {
+  std::vector<std::string> ids(count);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < count; ++i) {
+    threads.emplace_back([&, i] {
+      ids[i] = batcher.insert(collection, {{"Name", std::to_string(i)}});
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return ids;
+}
+
+}  // namespace
+
+TEST(InsertBatcherUnitTests, WritesALoneInsertAfterTheWindow) {
+  InsertBatcher batcher(std::chrono::microseconds(0), 16, echoIds);
+
+  EXPECT_EQ(batcher.insert("Shelter", {{"Name", "A"}}), "Shelter:A");
+  EXPECT_EQ(batcher.stats().batches, 1u);
+  EXPECT_EQ(batcher.stats().documents, 1u);
+}
+
+TEST(InsertBatcherUnitTests, GroupsConcurrentInsertsAndReturnsEachId) {
+  InsertBatcher batcher(std::chrono::milliseconds(200), 64, echoIds);
+
+  auto ids = insertConcurrently(batcher, "Shelter", 8);
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(ids[i], "Shelter:" + std::to_string(i));
+  }
+  EXPECT_EQ(batcher.stats().documents, 8u);
+  EXPECT_LT(batcher.stats().batches, 8u);
+}
+
+TEST(InsertBatcherUnitTests, WritesAFullBatchWithoutWaitingForTheWindow) {
+  InsertBatcher batcher(std::chrono::seconds(30), 4, echoIds);
+  auto start = std::chrono::steady_clock::now();
+
+  auto ids = insertConcurrently(batcher, "Food", 4);
+
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  EXPECT_EQ(batcher.stats().batches, 1u);
+  EXPECT_EQ(std::set<std::string>(ids.begin(), ids.end()).size(), 4u);
+}
+
+TEST(InsertBatcherUnitTests, KeepsCollectionsInSeparateBatches) {
+  std::atomic<int> calls{0};
+  InsertBatcher batcher(
+      std::chrono::milliseconds(100), 64,
+      [&](const std::string& collectionName,
+          const std::vector<const InsertBatcher::KeyValues*>& documents) {
+        calls.fetch_add(1);
+        return echoIds(collectionName, documents);
+      });
+
+  std::thread food([&] {
+    EXPECT_EQ(batcher.insert("Food", {{"Name", "F"}}), "Food:F");
+  });
+  EXPECT_EQ(batcher.insert("Shelter", {{"Name", "S"}}), "Shelter:S");
+  food.join();
+
+  EXPECT_EQ(calls.load(), 2);
+}
+
+TEST(InsertBatcherUnitTests, ReportsAFailedWriteToEveryCaller) {
+  InsertBatcher batcher(
+      std::chrono::milliseconds(200), 3,
+      [](const std::string&,
+         const std::vector<const InsertBatcher::KeyValues*>&)
+          -> std::vector<std::string> {
+        throw std::runtime_error("connection lost");
+      });
+  std::atomic<int> failures{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i) {
+    threads.emplace_back([&] {
+      try {
+        batcher.insert("Shelter", {{"Name", "x"}});
+      } catch (const std::runtime_error&) {
+        failures.fetch_add(1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(failures.load(), 3);
+  EXPECT_EQ(batcher.stats().batches, 0u);
+}
+
+TEST(InsertBatcherUnitTests, ReportsAPartialWriteOnlyToTheFailedCallers) {
+  InsertBatcher batcher(
+      std::chrono::milliseconds(200), 3,
+      [](const std::string& collectionName,
+         const std::vector<const InsertBatcher::KeyValues*>& documents)
+          -> std::vector<std::string> {
+        std::map<size_t, std::string> errors;
+        for (size_t i = 0; i < documents.size(); ++i) {
+          if (documents[i]->at(0).second == "1") {
+            errors[i] = "duplicate key";
+          }
+        }
+        throw InsertBatcher::PartialWrite(echoIds(collectionName, documents),
+                                          errors);
+      });
+  std::vector<std::string> outcomes(3);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i) {
+    threads.emplace_back([&, i] {
+      try {
+        outcomes[i] = batcher.insert("Shelter", {{"Name", std::to_string(i)}});
+      } catch (const std::runtime_error& e) {
+        outcomes[i] = std::string("error: ") + e.what();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(outcomes, (std::vector<std::string>{
+                          "Shelter:0", "error: duplicate key", "Shelter:2"}));
+  EXPECT_EQ(batcher.stats().batches, 1u);
+  EXPECT_EQ(batcher.stats().documents, 2u);
+}
@@ -130,7 +130,8 @@ TEST_F(IntegrationTest, TestUpdateHealthcareService) {
   "ContactInfo": "987-654-3210"
 })";
 
-  std::string id = healthcare->addHealthcareService(initialBody, "456");
+  std::string id =
+      healthcare->addHealthcareService(initialBody, "456").value();
 
   std::string updateBody = R"({
   "id": ")" + id + R"(",
@@ -174,8 +175,9 @@ TEST_F(IntegrationTest, TestDeleteHealthcareService) {
   "ContactInfo": "123-123-1234"
 })";
 
-  std::string id = healthcare->addHealthcareService(
+  auto added = healthcare->addHealthcareService(
       body, "Bearer " + getValidTokenForPost());
+  std::string id = added.value();
 
   std::string deleteBody = R"({"id": ")" + id + R"("})";
 
@@ -0,0 +1,128 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "JsonScanner.h"
+
+namespace {
+
+JsonScanner::Fields scan(const std::string& text, std::string& error) {
+  JsonScanner::Fields fields;
+  JsonScanner::scanObject(text, fields, error);
+  return fields;
+}
+
+}  // namespace
+
+TEST(JsonScannerUnitTests, ParsesFlatObject) {
+  std::string error;
+  auto fields = scan(" {\n\t\"City\" : \"New York\",\"Zip\":\"10027\" } ", error);
+
+  EXPECT_TRUE(error.empty());
+  ASSERT_EQ(fields.size(), 2u);
+  EXPECT_EQ(fields[0].first, "City");
+  EXPECT_EQ(fields[0].second, "New York");
+  EXPECT_EQ(fields[1].first, "Zip");
+  EXPECT_EQ(fields[1].second, "10027");
+}
+
+TEST(JsonScannerUnitTests, ParsesEmptyObject) {
+  JsonScanner::Fields fields;
+  std::string error;
+
+  EXPECT_TRUE(JsonScanner::scanObject("{ }", fields, error));
+  EXPECT_TRUE(fields.empty());
+}
+
+TEST(JsonScannerUnitTests, DecodesEscapes) {
+  std::string error;
+  auto fields = scan(
+      R"({"a": "q\"b\\s\/n\nt\t", "u": "é中😀"})", error);
+
+  ASSERT_EQ(fields.size(), 2u);
+  EXPECT_EQ(fields[0].second, "q\"b\\s/n\nt\t");
+  EXPECT_EQ(fields[1].second, "\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80");
+}
+
+TEST(JsonScannerUnitTests, FindsQuotesAtEveryOffsetOfLongStrings) {
+  for (size_t length = 0; length < 70; ++length) {
+    std::string value(length, 'x');
+    std::string error;
+    auto fields = scan("{\"k\": \"" + value + "\"}", error);
+
+    ASSERT_EQ(fields.size(), 1u) << length;
+    EXPECT_EQ(fields[0].second, value.c_str());
+  }
+}
+
+TEST(JsonScannerUnitTests, KeepsNonAsciiBytes) {
+  std::string error;
+  auto fields = scan("{\"City\": \"S\xC3\xA3o Paulo, M\xC3\xBCnchen\"}", error);
+
+  ASSERT_EQ(fields.size(), 1u);
+  EXPECT_EQ(fields[0].second, "S\xC3\xA3o Paulo, M\xC3\xBCnchen");
+}
+
+TEST(JsonScannerUnitTests, RejectsNonStringValue) {
+  JsonScanner::Fields fields;
+  std::string error;
+
+  EXPECT_FALSE(JsonScanner::scanObject(R"({"City": "NY", "Capacity": 10})",
+                                       fields, error));
+  EXPECT_EQ(error, "Field Capacity must be a string.");
+  EXPECT_TRUE(fields.empty());
+}
+
+TEST(JsonScannerUnitTests, RejectsUnknownField) {
+  JsonScanner::Fields fields;
+  std::string error;
+  std::vector<std::string> allowed = {"City"};
+
+  EXPECT_FALSE(JsonScanner::scanObject(R"({"City": "NY", "Other": "x"})",
+                                       fields, error, &allowed));
+  EXPECT_EQ(error, "Unknown field Other.");
+  EXPECT_TRUE(fields.empty());
+}
+
+TEST(JsonScannerUnitTests, RejectsMalformedInput) {
+  const std::vector<std::string> inputs = {
+      "",
+      "[]",
+      "{",
+      R"({"a": "b")",
+      R"({"a" "b"})",
+      R"({"a": "b",})",
+      R"({"a": "b"} x)",
+      "{\"a\": \"line\nbreak\"}",
+      R"({"a": "\q"})",
+      R"({"a": "\u12"})",
+      R"({"a": "\ud83d"})",
+      R"({"a": "\ude00"})",
+      R"({"a": "unterminated)",
+  };
+  for (const auto& input : inputs) {
+    JsonScanner::Fields fields;
+    std::string error;
+
+    EXPECT_FALSE(JsonScanner::scanObject(input, fields, error)) << input;
+    EXPECT_FALSE(error.empty()) << input;
+    EXPECT_TRUE(fields.empty()) << input;
+  }
+}
+
+TEST(JsonScannerUnitTests, FindSpecialMatchesScalarScan) {
+  std::string text(100, 'a');
+  text[37] = '\x01';
+  text[70] = '"';
+
+  EXPECT_EQ(JsonScanner::findSpecial(text.data(), 0, text.size()), 37u);
+  EXPECT_EQ(JsonScanner::findSpecial(text.data(), 38, text.size()), 70u);
+  EXPECT_EQ(JsonScanner::findSpecial(text.data(), 71, text.size()),
+            text.size());
+  text[90] = '\x80';
+  EXPECT_EQ(JsonScanner::findSpecial(text.data(), 71, text.size()),
+            text.size());
+}
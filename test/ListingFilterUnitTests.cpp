@@ -0,0 +1,51 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ListingFilter.h"
+
+TEST(ListingFilterUnitTests, HasNoVariantWhenEmpty) {
+  ListingFilter filter;
+
+  EXPECT_TRUE(filter.empty());
+  EXPECT_EQ(filter.variant(), "");
+}
+
+TEST(ListingFilterUnitTests, EscapesValuesInTheVariant) {
+  ListingFilter filter;
+  filter.city = "New York";
+  filter.org = "A&B=C";
+
+  EXPECT_EQ(filter.variant(), "&city=New%20York&org=A%26B%3DC");
+}
+
+TEST(ListingFilterUnitTests, GivesDifferentFiltersDifferentVariants) {
+  // Unescaped, both would read "&city=Boston&org=NGO".
+  ListingFilter joined;
+  joined.city = "Boston&org=NGO";
+  ListingFilter apart;
+  apart.city = "Boston";
+  apart.org = "NGO";
+
+  EXPECT_NE(joined.variant(), apart.variant());
+}
+
+TEST(ListingFilterUnitTests, MatchesEachParameterAgainstTheCollectionsField) {
+  ListingFilterSpec healthcare{"City", "eligibilityCriteria", ""};
+  ListingFilter filter;
+  filter.city = "Boston";
+  filter.targetUser = "HML";
+
+  EXPECT_TRUE(filter.supportedBy(healthcare));
+  EXPECT_EQ(filter.keyValues(healthcare),
+            (std::vector<std::pair<std::string, std::string>>{
+                {"City", "Boston"}, {"eligibilityCriteria", "HML"}}));
+
+  filter.org = "NGO";
+  EXPECT_FALSE(filter.supportedBy(healthcare));
+  EXPECT_TRUE(ListingFilter{}.supportedBy(ListingFilterSpec{}));
+}
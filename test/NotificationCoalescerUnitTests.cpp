@@ -0,0 +1,107 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include "NotificationCoalescer.h"
+
+using std::chrono::hours;
+using std::chrono::seconds;
+
+class NotificationCoalescerUnitTests : public ::testing::Test {
+ protected:
+  NotificationCoalescer coalescer{seconds(30), hours(1), hours(24)};
+};
+
+TEST_F(NotificationCoalescerUnitTests, MergesBulkLoadIntoOneDigest) {
+  for (int i = 0; i < 200; ++i) {
+    coalescer.add("sub1", "a@example.com", "food", "New York");
+  }
+  EXPECT_EQ(coalescer.pending(), 1);
+
+  auto drained = coalescer.drainAll();
+  ASSERT_EQ(drained.size(), 1);
+  EXPECT_EQ(drained[0].subscriberId, "sub1");
+  EXPECT_EQ(drained[0].contact, "a@example.com");
+  ASSERT_EQ(drained[0].updates.size(), 1);
+  EXPECT_EQ((drained[0].updates.at({"food", "New York"})), 200);
+  EXPECT_EQ(drained[0].text(),
+            "200 new updates for food in New York are available.");
+  EXPECT_EQ(coalescer.pending(), 0);
+}
+
+TEST_F(NotificationCoalescerUnitTests, SingleUpdateKeepsOriginalMessage) {
+  coalescer.add("sub1", "https://hooks.example.org/x", "shelter", "Boston");
+
+  auto drained = coalescer.drainAll();
+  ASSERT_EQ(drained.size(), 1);
+  EXPECT_EQ(drained[0].text(),
+            "A new update for shelter in Boston is available.");
+  EXPECT_EQ(drained[0].json(),
+            "{\"message\": \"A new update for shelter in Boston is "
+            "available.\", \"updates\": [{\"resource\": \"shelter\", "
+            "\"city\": \"Boston\", \"count\": 1}]}");
+}
+
+TEST_F(NotificationCoalescerUnitTests, EscapesControlCharactersInJson) {
+  coalescer.add("sub1", "https://hooks.example.org/x", "food\t", "A\x01\"B");
+
+  auto drained = coalescer.drainAll();
+  ASSERT_EQ(drained.size(), 1);
+  EXPECT_EQ(drained[0].json(),
+            "{\"message\": \"A new update for food\\u0009 in A\\u0001\\\"B "
+            "is available.\", \"updates\": [{\"resource\": "
+            "\"food\\u0009\", \"city\": \"A\\u0001\\\"B\", \"count\": 1}]}");
+}
+
+TEST_F(NotificationCoalescerUnitTests, KeepsEachSubscribersUpdatesApart) {
+  coalescer.add("sub1", "a@example.com", "food", "Boston");
+  coalescer.add("sub1", "a@example.com", "shelter", "Boston");
+  coalescer.add("sub2", "b@example.com", "food", "Boston");
+
+  auto drained = coalescer.drainAll();
+  ASSERT_EQ(drained.size(), 2);
+  for (const auto& digest : drained) {
+    EXPECT_EQ(digest.updates.size(), digest.subscriberId == "sub1" ? 2 : 1);
+  }
+}
+
+TEST_F(NotificationCoalescerUnitTests, DigestModesUseLongerWindows) {
+  coalescer.setDelivery("hourly", DeliveryMode::Hourly);
+  coalescer.setDelivery("daily", DeliveryMode::Daily);
+
+  EXPECT_EQ(coalescer.windowOf("immediate"), seconds(30));
+  EXPECT_EQ(coalescer.windowOf("hourly"), hours(1));
+  EXPECT_EQ(coalescer.windowOf("daily"), hours(24));
+}
+
+TEST_F(NotificationCoalescerUnitTests, ImmediateIsNotHeldByDefault) {
+  NotificationCoalescer defaults;
+
+  EXPECT_EQ(defaults.windowOf("sub1"),
+            NotificationCoalescer::Clock::duration::zero());
+}
+
+TEST_F(NotificationCoalescerUnitTests, ForgetDropsPendingDigest) {
+  coalescer.add("sub1", "a@example.com", "food", "Boston");
+  coalescer.forget("sub1");
+
+  EXPECT_TRUE(coalescer.drainAll().empty());
+}
+
+TEST_F(NotificationCoalescerUnitTests, ParseDeliveryMode) {
+  DeliveryMode mode;
+  EXPECT_TRUE(NotificationCoalescer::parseDeliveryMode("Hourly", mode));
+  EXPECT_EQ(mode, DeliveryMode::Hourly);
+  EXPECT_TRUE(NotificationCoalescer::parseDeliveryMode("daily", mode));
+  EXPECT_EQ(mode, DeliveryMode::Daily);
+  EXPECT_TRUE(NotificationCoalescer::parseDeliveryMode("immediate", mode));
+  EXPECT_EQ(mode, DeliveryMode::Immediate);
+  EXPECT_FALSE(NotificationCoalescer::parseDeliveryMode("weekly", mode));
+}
+
+TEST_F(NotificationCoalescerUnitTests, WindowOfFollowsDeliveryMode) {
+  coalescer.setDelivery("daily", DeliveryMode::Daily);
+
+  EXPECT_EQ(coalescer.windowOf("daily"), hours(24));
+  EXPECT_EQ(coalescer.windowOf("unknown"), seconds(30));
+}
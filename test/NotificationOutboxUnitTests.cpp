@@ -0,0 +1,175 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/json.hpp>
+
+#include "MockDatabaseManager.h"
+#include "NotificationOutbox.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+using std::chrono::hours;
+using std::chrono::seconds;
+using ::testing::_;
+
+class NotificationOutboxUnitTests : public ::testing::Test {
+ protected:
+  MockDatabaseManager mockDbManager;
+  NotificationOutbox outbox{mockDbManager, 3, seconds(60), seconds(30),
+                            hours(1)};
+  NotificationOutbox::Clock::time_point now = NotificationOutbox::Clock::now();
+};
+
+TEST_F(NotificationOutboxUnitTests, EnqueueWritesPendingEvent) {
+  std::string kind, state, resource, city;
+  EXPECT_CALL(mockDbManager, insertDocument("NotificationOutbox", _))
+      .WillOnce([&](const std::string&, const bsoncxx::document::view& doc) {
+        kind = doc["Kind"].get_utf8().value.to_string();
+        state = doc["State"].get_utf8().value.to_string();
+        resource = doc["Resource"].get_utf8().value.to_string();
+        city = doc["City"].get_utf8().value.to_string();
+        return "507f1f77bcf86cd799439011";
+      });
+
+  outbox.enqueue("food", "New York", now);
+
+  EXPECT_EQ(kind, "event");
+  EXPECT_EQ(state, "pending");
+  EXPECT_EQ(resource, "food");
+  EXPECT_EQ(city, "New York");
+}
+
+TEST_F(NotificationOutboxUnitTests, ClaimEventLeasesAndParses) {
+  std::string leasedState;
+  EXPECT_CALL(mockDbManager, findOneAndUpdate("NotificationOutbox", _, _))
+      .WillOnce([&](const std::string&, const bsoncxx::document::view&,
+                    const bsoncxx::document::view& update) {
+        leasedState = update["$set"]["State"].get_utf8().value.to_string();
+        return std::optional<bsoncxx::document::value>(make_document(
+            kvp("_id", bsoncxx::oid("507f1f77bcf86cd799439011")),
+            kvp("Resource", "shelter"), kvp("City", "Boston")));
+      })
+      .WillOnce(::testing::Return(std::nullopt));
+
+  auto event = outbox.claimEvent(now);
+  ASSERT_TRUE(event.has_value());
+  EXPECT_EQ(event->id, "507f1f77bcf86cd799439011");
+  EXPECT_EQ(event->resource, "shelter");
+  EXPECT_EQ(event->city, "Boston");
+  EXPECT_EQ(leasedState, "claimed");
+
+  EXPECT_FALSE(outbox.claimEvent(now).has_value());
+}
+
+TEST_F(NotificationOutboxUnitTests, StageIncrementsEncodedCounts) {
+  NotificationDigest digest;
+  digest.subscriberId = "sub1";
+  digest.contact = "a@example.com";
+  digest.updates[{"food", "St. Louis"}] = 3;
+
+  bool upsert = false;
+  int count = 0;
+  EXPECT_CALL(mockDbManager, updateDocument("NotificationOutbox", _, _, _))
+      .WillOnce([&](const std::string&, const bsoncxx::document::view& filter,
+                    const bsoncxx::document::view& update, bool doUpsert) {
+        upsert = doUpsert;
+        EXPECT_EQ(filter["SubscriberId"].get_utf8().value.to_string(), "sub1");
+        count = update["$inc"]["Updates.food|St%2E Louis"].get_int32().value;
+        return true;
+      });
+
+  outbox.stage(digest, now + seconds(30));
+
+  EXPECT_TRUE(upsert);
+  EXPECT_EQ(count, 3);
+}
+
+TEST_F(NotificationOutboxUnitTests, ClaimDeliveryRebuildsDigest) {
+  EXPECT_CALL(mockDbManager, findOneAndUpdate("NotificationOutbox", _, _))
+      .WillOnce(::testing::Return(std::optional<bsoncxx::document::value>(
+          make_document(kvp("_id", bsoncxx::oid("507f1f77bcf86cd799439012")),
+                        kvp("SubscriberId", "sub1"),
+                        kvp("Contact", "https://hooks.example.org/x"),
+                        kvp("Attempts", 2),
+                        kvp("Updates",
+                            make_document(kvp("food|St%2E Louis", 3),
+                                          kvp("shelter|Boston", 1)))))));
+
+  auto delivery = outbox.claimDelivery(now);
+
+  ASSERT_TRUE(delivery.has_value());
+  EXPECT_EQ(delivery->attempts, 2);
+  EXPECT_EQ(delivery->digest.contact, "https://hooks.example.org/x");
+  EXPECT_EQ((delivery->digest.updates.at({"food", "St. Louis"})), 3);
+  EXPECT_EQ((delivery->digest.updates.at({"shelter", "Boston"})), 1);
+}
+
+TEST_F(NotificationOutboxUnitTests, OutcomesOnlyLandWhileTheLeaseIsHeld) {
+  EXPECT_CALL(mockDbManager, findOneAndUpdate("NotificationOutbox", _, _))
+      .WillOnce(::testing::Return(std::optional<bsoncxx::document::value>(
+          make_document(kvp("_id", bsoncxx::oid("507f1f77bcf86cd799439012")),
+                        kvp("SubscriberId", "sub1"),
+                        kvp("Contact", "a@example.com")))));
+  auto delivery = outbox.claimDelivery(now);
+  ASSERT_TRUE(delivery.has_value());
+  EXPECT_LE(delivery->leaseUntil - (now + seconds(60)),
+            std::chrono::milliseconds(0));
+  EXPECT_GT(delivery->leaseUntil - (now + seconds(60)),
+            std::chrono::milliseconds(-1));
+
+  std::string state;
+  NotificationOutbox::Clock::time_point leaseUntil;
+  EXPECT_CALL(mockDbManager, deleteDocument("NotificationOutbox", _))
+      .WillOnce([&](const std::string&, const bsoncxx::document::view& filter) {
+        state = filter["State"].get_utf8().value.to_string();
+        leaseUntil = NotificationOutbox::Clock::time_point(
+            filter["LeaseUntil"].get_date().value);
+        return false;
+      });
+
+  EXPECT_FALSE(outbox.completeDelivery(*delivery));
+  EXPECT_EQ(state, "sending");
+  EXPECT_EQ(leaseUntil, delivery->leaseUntil);
+}
+
+TEST_F(NotificationOutboxUnitTests, RetryBacksOffThenDeadLetters) {
+  OutboxDelivery delivery;
+  delivery.id = "507f1f77bcf86cd799439012";
+  delivery.attempts = 1;
+
+  std::vector<std::string> states;
+  EXPECT_CALL(mockDbManager, updateDocument("NotificationOutbox", _, _, false))
+      .Times(2)
+      .WillRepeatedly([&](const std::string&, const bsoncxx::document::view&,
+                          const bsoncxx::document::view& update, bool) {
+        states.push_back(update["$set"]["State"].get_utf8().value.to_string());
+        return true;
+      });
+
+  outbox.retryDelivery(delivery, now);
+  delivery.attempts = 2;
+  outbox.retryDelivery(delivery, now);
+
+  EXPECT_EQ(states, (std::vector<std::string>{"pending", "dead"}));
+}
+
+TEST_F(NotificationOutboxUnitTests, BackoffDoublesWithJitterAndCap) {
+  EXPECT_EQ(outbox.backoff(1, 0.0), seconds(15));
+  EXPECT_EQ(outbox.backoff(1, 1.0), seconds(30));
+  EXPECT_EQ(outbox.backoff(3, 0.0), seconds(60));
+  EXPECT_EQ(outbox.backoff(3, 1.0), seconds(120));
+  EXPECT_EQ(outbox.backoff(30, 1.0), hours(1));
+}
+
+TEST_F(NotificationOutboxUnitTests, KeyEncodingRoundTrips) {
+  std::string key = NotificationOutbox::encodeKey("$food.x", "50% | off");
+
+  EXPECT_EQ(key.find('.'), std::string::npos);
+  EXPECT_NE(key[0], '$');
+  EXPECT_EQ(NotificationOutbox::decodeKey(key),
+            std::make_pair(std::string("$food.x"), std::string("50% | off")));
+}
@@ -9,6 +9,19 @@
 #include "MockDatabaseManager.h"
 #include "Outreach.h"
 
+namespace {
+
+// A document with the given City and the given value in field.
+bsoncxx::document::value resource(const std::string& city,
+                                  const std::string& field,
+                                  const std::string& value) {
+  return bsoncxx::builder::stream::document{}
+         << "City" << city << field << value
+         << bsoncxx::builder::stream::finalize;
+}
+
+}  // namespace
+
 /**
  * @brief Unit tests for the OutreachService class.
  *
@@ -80,10 +93,11 @@ TEST_F(OutreachServiceUnitTests, AddNewOutreachService) {
     "HoursOfOperation":"05/01/24 - 12/31/24",
     "TargetAudience":"HML"
 })";
-  outreachService->checkInputFormat(input, "456");
+  Outreach::Fields fields;
+  outreachService->checkInputFormat(input, "456", fields);
 
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      outreachService->createDBContent();
+      outreachService->createDBContent(fields);
 
   ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
       .WillByDefault(::testing::Invoke(
@@ -94,9 +108,10 @@ TEST_F(OutreachServiceUnitTests, AddNewOutreachService) {
             return "12345";
           }));
 
-  std::string result = outreachService->addOutreachService(input, "456");
+  auto result = outreachService->addOutreachService(input, "456");
 
-  EXPECT_EQ(result, "12345");
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value(), "12345");
 }
 
 TEST_F(OutreachServiceUnitTests, UpdateOutreach) {
@@ -110,9 +125,10 @@ TEST_F(OutreachServiceUnitTests, UpdateOutreach) {
     "HoursOfOperation":"05/01/24 - 12/31/24",
     "TargetAudience":"HML"
 })";
-  outreachService->checkInputFormat(input, "456");
+  Outreach::Fields fields;
+  outreachService->checkInputFormat(input, "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      outreachService->createDBContent();
+      outreachService->createDBContent(fields);
   std::string id_temp = "123456789";
   ON_CALL(*mockDbManager,
           updateResource(::testing::_, ::testing::_, ::testing::_))
@@ -123,8 +139,9 @@ TEST_F(OutreachServiceUnitTests, UpdateOutreach) {
             EXPECT_EQ(collectionName, "Outreach");
             EXPECT_EQ(content, expectedContent);
           });
-  std::string ret = outreachService->updateOutreach(input, "456");
-  EXPECT_EQ(ret, "Outreach Service updated successfully.");
+  auto ret = outreachService->updateOutreach(input, "456");
+  ASSERT_TRUE(ret.ok());
+  EXPECT_EQ(ret.value(), "Outreach Service updated successfully.");
 }
 
 TEST_F(OutreachServiceUnitTests, DeleteOutreach) {
@@ -141,3 +158,22 @@ TEST_F(OutreachServiceUnitTests, DeleteOutreach) {
   std::string ret = outreachService->deleteOutreach(id_temp, "456");
   EXPECT_EQ(ret, "Outreach Service deleted successfully.");
 }
+
+TEST_F(OutreachServiceUnitTests, FiltersListingsOnItsOwnFields) {
+  mockDbManager->findIn({resource("Boston", "TargetAudience", "HML"),
+                         resource("Boston", "TargetAudience", "VET"),
+                         resource("Queens", "TargetAudience", "HML")});
+  ListingFilter filter;
+  filter.city = "Boston";
+  filter.targetUser = "HML";
+
+  std::string listing = outreachService->encodedListing(
+      0, ResponseFormat::Format::Json, filter);
+
+  EXPECT_NE(listing.find("Boston"), std::string::npos);
+  EXPECT_EQ(listing.find("Queens"), std::string::npos);
+  EXPECT_EQ(listing.find("VET"), std::string::npos);
+
+  filter.org = "NGO";
+  EXPECT_FALSE(filter.supportedBy(Outreach::kFilterSpec));
+}
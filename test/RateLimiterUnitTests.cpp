@@ -0,0 +1,144 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "RateLimiter.h"
+
+namespace {
+
+using Clock = RateLimiter::Clock;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+RateLimiter::Limit limitOf(const std::string& spec) {
+  return RateLimiter::Limit::parse(spec).value();
+}
+
+}  // namespace
+
+TEST(RateLimiterUnitTests, ParsesLimits) {
+  auto limit = limitOf("30/m:10");
+  EXPECT_EQ(limit.requests, 30);
+  EXPECT_EQ(limit.period, std::chrono::minutes(1));
+  EXPECT_EQ(limit.burst, 10);
+  EXPECT_EQ(limitOf("5/s").burst, 5);
+  EXPECT_EQ(limitOf("off").requests, 0);
+
+  EXPECT_FALSE(RateLimiter::Limit::parse("").has_value());
+  EXPECT_FALSE(RateLimiter::Limit::parse("10").has_value());
+  EXPECT_FALSE(RateLimiter::Limit::parse("10/d").has_value());
+  EXPECT_FALSE(RateLimiter::Limit::parse("0/s").has_value());
+  EXPECT_FALSE(RateLimiter::Limit::parse("10/s:").has_value());
+  EXPECT_FALSE(RateLimiter::Limit::parse("10/sx").has_value());
+}
+
+TEST(RateLimiterUnitTests, AllowsTheBurstThenRejects) {
+  RateLimiter limiter(limitOf("1/s:3"));
+  auto now = Clock::now();
+
+  for (int i = 0; i < 3; ++i) {
+    auto decision = limiter.check("/resources/food/add", "ip:1.2.3.4", now);
+    EXPECT_TRUE(decision.allowed);
+    EXPECT_EQ(decision.limit, 3);
+    EXPECT_EQ(decision.remaining, 2 - i);
+  }
+  auto rejected = limiter.check("/resources/food/add", "ip:1.2.3.4", now);
+
+  EXPECT_FALSE(rejected.allowed);
+  EXPECT_EQ(rejected.remaining, 0);
+  EXPECT_EQ(rejected.retryAfter, seconds(1));
+  EXPECT_EQ(rejected.reset, seconds(3));
+  EXPECT_EQ(limiter.rejected(), 1);
+}
+
+TEST(RateLimiterUnitTests, RefillsOverTime) {
+  RateLimiter limiter(limitOf("10/s:1"));
+  auto now = Clock::now();
+
+  EXPECT_TRUE(limiter.check("/auth/login", "ip:a", now).allowed);
+  EXPECT_FALSE(limiter.check("/auth/login", "ip:a", now).allowed);
+  EXPECT_FALSE(
+      limiter.check("/auth/login", "ip:a", now + milliseconds(50)).allowed);
+  EXPECT_TRUE(
+      limiter.check("/auth/login", "ip:a", now + milliseconds(100)).allowed);
+}
+
+TEST(RateLimiterUnitTests, KeepsClientsAndRoutesApart) {
+  RateLimiter limiter(limitOf("1/m"));
+  auto now = Clock::now();
+
+  EXPECT_TRUE(limiter.check("/auth/login", "ip:a", now).allowed);
+  EXPECT_FALSE(limiter.check("/auth/login", "ip:a", now).allowed);
+  EXPECT_TRUE(limiter.check("/auth/login", "ip:b", now).allowed);
+  EXPECT_TRUE(limiter.check("/auth/register", "ip:a", now).allowed);
+}
+
+TEST(RateLimiterUnitTests, UsesRouteLimitsOverTheDefault) {
+  RateLimiter limiter(limitOf("off"));
+  EXPECT_TRUE(limiter.configure("/auth/login=1/m"));
+  auto now = Clock::now();
+
+  EXPECT_FALSE(limiter.configure("/auth/register=2/m,bad,/x=oops"));
+  EXPECT_TRUE(limiter.check("/auth/login", "ip:a", now).allowed);
+  EXPECT_FALSE(limiter.check("/auth/login", "ip:a", now).allowed);
+  EXPECT_TRUE(limiter.check("/auth/register", "ip:a", now).allowed);
+  EXPECT_TRUE(limiter.check("/auth/register", "ip:a", now).allowed);
+  EXPECT_FALSE(limiter.check("/auth/register", "ip:a", now).allowed);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(limiter.check("/resources/food/getAll", "ip:a", now).allowed);
+  }
+  EXPECT_EQ(limiter.bucketCount(), 2u);
+}
+
+TEST(RateLimiterUnitTests, DropsRefilledBucketsOncePerCapacity) {
+  RateLimiter limiter(limitOf("1/s"), 1, 4);
+  auto now = Clock::now();
+  for (int i = 0; i < 3; ++i) {
+    limiter.check("/auth/login", "ip:" + std::to_string(i), now);
+  }
+
+  limiter.check("/auth/login", "ip:new", now + seconds(2));
+
+  EXPECT_EQ(limiter.bucketCount(), 1u);
+}
+
+TEST(RateLimiterUnitTests, NeverHoldsMoreThanItsCapacity) {
+  RateLimiter limiter(limitOf("1/h"), 2, 8);
+  auto now = Clock::now();
+  for (int i = 0; i < 1000; ++i) {
+    limiter.check("/auth/login", "ip:" + std::to_string(i), now);
+    ASSERT_LE(limiter.bucketCount(), 16u);
+  }
+
+  // A client that was evicted starts over with a full bucket, but one that
+  // is kept is still limited.
+  EXPECT_FALSE(limiter.check("/auth/login", "ip:999", now).allowed);
+}
+
+TEST(RateLimiterUnitTests, GrantsExactlyTheBurstUnderContention) {
+  RateLimiter limiter(limitOf("1/h:100"));
+  auto now = Clock::now();
+  std::atomic<int> allowed{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 50; ++i) {
+        if (limiter.check("/resources/food/add", "user:u1", now).allowed) {
+          allowed.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(allowed.load(), 100);
+}
@@ -0,0 +1,73 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <optional>
+#include <string>
+
+#include "RequestArena.h"
+#include "RequestBody.h"
+
+TEST(RequestArenaUnitTests, UsesDefaultResourceOutsideScope) {
+  EXPECT_EQ(RequestArena::resource(), std::pmr::get_default_resource());
+
+  RequestBody body(R"({"City": "New York"})");
+  EXPECT_EQ(body.fields().get_allocator().resource(),
+            std::pmr::get_default_resource());
+}
+
+TEST(RequestArenaUnitTests, ParsesIntoArenaInsideScope) {
+  RequestArena::Scope scope;
+  EXPECT_NE(RequestArena::resource(), std::pmr::get_default_resource());
+
+  RequestBody body(R"({"City": "New York", "Name": "Shelter A"})");
+  EXPECT_EQ(body.fields().get_allocator().resource(),
+            RequestArena::resource());
+  EXPECT_EQ(body.get("Name"), std::optional<std::string>("Shelter A"));
+}
+
+TEST(RequestArenaUnitTests, CountsNestedScopesAsOneRequest) {
+  ArenaStats before = RequestArena::stats();
+  {
+    RequestArena::Scope outer;
+    std::pmr::memory_resource* resource = RequestArena::resource();
+    {
+      RequestArena::Scope inner;
+      EXPECT_EQ(RequestArena::resource(), resource);
+    }
+    EXPECT_EQ(RequestArena::resource(), resource);
+    RequestBody body(R"({"City": "New York"})");
+  }
+  ArenaStats after = RequestArena::stats();
+
+  EXPECT_EQ(after.requests, before.requests + 1);
+  EXPECT_GT(after.bytes, before.bytes);
+  EXPECT_EQ(RequestArena::resource(), std::pmr::get_default_resource());
+}
+
+TEST(RequestArenaUnitTests, CountsRequestsThatOutgrowTheBlock) {
+  ArenaStats before = RequestArena::stats();
+  {
+    RequestArena::Scope scope;
+    std::pmr::string large(RequestArena::blockBytes() * 2, 'x',
+                           RequestArena::resource());
+  }
+  ArenaStats after = RequestArena::stats();
+
+  EXPECT_EQ(after.overflows, before.overflows + 1);
+  EXPECT_GE(after.peakBytes, RequestArena::blockBytes() * 2);
+}
+
+TEST(RequestArenaUnitTests, CopiesOutliveTheScope) {
+  std::optional<RequestBody> copy;
+  {
+    RequestArena::Scope scope;
+    RequestBody body(R"({"City": "New York"})");
+    copy.emplace(body);
+  }
+
+  EXPECT_EQ(copy->fields().get_allocator().resource(),
+            std::pmr::get_default_resource());
+  EXPECT_EQ(copy->get("City"), std::optional<std::string>("New York"));
+}
@@ -0,0 +1,57 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include "RequestBody.h"
+
+TEST(RequestBodyUnitTests, ParsesStringFieldsInOrder) {
+  RequestBody body(R"({"City": "New York", "Name": "Shelter A"})");
+
+  ASSERT_TRUE(body.valid());
+  ASSERT_EQ(body.fields().size(), 2u);
+  EXPECT_EQ(body.fields()[0].first, "City");
+  EXPECT_EQ(body.fields()[0].second, "New York");
+  EXPECT_EQ(body.fields()[1].first, "Name");
+  EXPECT_EQ(body.fields()[1].second, "Shelter A");
+}
+
+TEST(RequestBodyUnitTests, GetReturnsFieldValue) {
+  RequestBody body(R"({"id": "abc123"})");
+
+  EXPECT_EQ(body.get("id").value_or(""), "abc123");
+  EXPECT_FALSE(body.get("City").has_value());
+}
+
+TEST(RequestBodyUnitTests, InvalidJsonIsReported) {
+  RequestBody body("{not json");
+
+  EXPECT_FALSE(body.valid());
+  EXPECT_FALSE(body.error().empty());
+  EXPECT_TRUE(body.fields().empty());
+  EXPECT_EQ(body.raw(), "{not json");
+}
+
+TEST(RequestBodyUnitTests, NonStringFieldIsReported) {
+  RequestBody body(R"({"City": "New York", "Capacity": 10})");
+
+  EXPECT_FALSE(body.valid());
+  EXPECT_EQ(body.error(), "Field Capacity must be a string.");
+  EXPECT_TRUE(body.fields().empty());
+}
+
+TEST(RequestBodyUnitTests, ComparesByRawText) {
+  std::string json = R"({"City": "New York"})";
+
+  EXPECT_TRUE(RequestBody(json) == json);
+  EXPECT_FALSE(RequestBody(json) == RequestBody("{}"));
+}
+
+TEST(RequestBodyUnitTests, RejectsFieldsOutsideAllowedKeys) {
+  std::vector<std::string> allowed = {"City", "Name"};
+
+  EXPECT_TRUE(RequestBody(R"({"City": "New York"})", allowed).valid());
+
+  RequestBody body(R"({"City": "New York", "Extra": "x"})", allowed);
+  EXPECT_FALSE(body.valid());
+  EXPECT_EQ(body.error(), "Unknown field Extra.");
+}
@@ -0,0 +1,112 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <string>
+
+#include "ResponseCache.h"
+
+namespace {
+
+using Encoding = ResponseCache::Encoding;
+
+std::string listing(int shelters) {
+  std::string body = "[";
+  for (int i = 0; i < shelters; ++i) {
+    body += R"({"Name": "Shelter", "City": "New York", "Capacity": "100"},)";
+  }
+  body.back() = ']';
+  return body;
+}
+
+std::string gunzip(const std::string& compressed) {
+  z_stream stream{};
+  inflateInit2(&stream, 15 + 16);
+  std::string output(1 << 20, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(
+      const_cast<char*>(compressed.data()));
+  stream.avail_in = static_cast<uInt>(compressed.size());
+  stream.next_out = reinterpret_cast<Bytef*>(output.data());
+  stream.avail_out = static_cast<uInt>(output.size());
+  inflate(&stream, Z_FINISH);
+  output.resize(stream.total_out);
+  inflateEnd(&stream);
+  return output;
+}
+
+}  // namespace
+
+TEST(ResponseCacheUnitTests, NegotiatesGzip) {
+  EXPECT_EQ(ResponseCache::negotiate("gzip, deflate, br"), Encoding::Gzip);
+  EXPECT_EQ(ResponseCache::negotiate("br;q=1.0, GZIP;q=0.5"), Encoding::Gzip);
+  EXPECT_EQ(ResponseCache::negotiate("*"), Encoding::Gzip);
+  EXPECT_EQ(ResponseCache::negotiate(""), Encoding::Identity);
+  EXPECT_EQ(ResponseCache::negotiate("deflate, br"), Encoding::Identity);
+  EXPECT_EQ(ResponseCache::negotiate("gzip;q=0, *"), Encoding::Identity);
+  EXPECT_EQ(ResponseCache::negotiate("*;q=0"), Encoding::Identity);
+}
+
+TEST(ResponseCacheUnitTests, TagsEachEncodingSeparately) {
+  EXPECT_EQ(ResponseCache::taggedFor("\"a-1-f\"", Encoding::Identity),
+            "\"a-1-f\"");
+  EXPECT_EQ(ResponseCache::taggedFor("\"a-1-f\"", Encoding::Gzip),
+            "\"a-1-f-gzip\"");
+}
+
+TEST(ResponseCacheUnitTests, CompressesLargeBodiesOnceForGzipClients) {
+  ResponseCache cache(1 << 20, 256, 6);
+  std::string body = listing(50);
+
+  auto stored = cache.store("\"v1\"", body, Encoding::Gzip);
+  auto again = cache.find("\"v1\"", Encoding::Gzip);
+
+  EXPECT_EQ(stored.encoding, Encoding::Gzip);
+  EXPECT_LT(stored.body->size(), body.size() / 4);
+  EXPECT_EQ(gunzip(*stored.body), body);
+  ASSERT_TRUE(again.has_value());
+  EXPECT_EQ(again->body, stored.body);
+  EXPECT_EQ(cache.stats().compressions, 1u);
+  EXPECT_EQ(cache.stats().hits, 1u);
+}
+
+TEST(ResponseCacheUnitTests, ServesIdentityToOtherClientsAndSmallBodies) {
+  ResponseCache cache(1 << 20, 256, 6);
+  std::string body = listing(50);
+  cache.store("\"v1\"", body, Encoding::Identity);
+
+  auto plain = cache.find("\"v1\"", Encoding::Identity);
+  auto small = cache.store("\"v2\"", "[]", Encoding::Gzip);
+
+  ASSERT_TRUE(plain.has_value());
+  EXPECT_EQ(plain->encoding, Encoding::Identity);
+  EXPECT_EQ(*plain->body, body);
+  EXPECT_EQ(small.encoding, Encoding::Identity);
+  EXPECT_EQ(cache.stats().compressions, 0u);
+  EXPECT_FALSE(cache.find("\"v3\"", Encoding::Gzip).has_value());
+  EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST(ResponseCacheUnitTests, LevelZeroDisablesCompression) {
+  ResponseCache cache(1 << 20, 0, 0);
+
+  auto stored = cache.store("\"v1\"", listing(50), Encoding::Gzip);
+
+  EXPECT_EQ(stored.encoding, Encoding::Identity);
+}
+
+TEST(ResponseCacheUnitTests, EvictsLeastRecentlyUsedBeyondMaxBytes) {
+  std::string body = listing(10);
+  ResponseCache cache(body.size() * 2, 1 << 20, 6);
+  cache.store("\"a\"", body, Encoding::Identity);
+  cache.store("\"b\"", body, Encoding::Identity);
+  cache.find("\"a\"", Encoding::Identity);
+
+  cache.store("\"c\"", body, Encoding::Identity);
+
+  EXPECT_TRUE(cache.find("\"a\"", Encoding::Identity).has_value());
+  EXPECT_FALSE(cache.find("\"b\"", Encoding::Identity).has_value());
+  EXPECT_TRUE(cache.find("\"c\"", Encoding::Identity).has_value());
+  EXPECT_EQ(cache.stats().entries, 2u);
+  EXPECT_EQ(cache.stats().bytes, body.size() * 2);
+}
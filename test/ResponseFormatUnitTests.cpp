@@ -0,0 +1,110 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <bsoncxx/json.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ResponseFormat.h"
+
+namespace {
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+using Format = ResponseFormat::Format;
+
+std::string bytes(std::initializer_list<int> values) {
+  std::string out;
+  for (int value : values) {
+    out.push_back(static_cast<char>(value));
+  }
+  return out;
+}
+
+std::vector<bsoncxx::document::value> sampleListing() {
+  std::vector<bsoncxx::document::value> documents;
+  documents.push_back(make_document(kvp("a", 1), kvp("b", "x")));
+  return documents;
+}
+
+}  // namespace
+
+TEST(ResponseFormatUnitTests, NegotiatesFromTheAcceptHeader) {
+  EXPECT_EQ(ResponseFormat::negotiate(""), Format::Json);
+  EXPECT_EQ(ResponseFormat::negotiate("*/*"), Format::Json);
+  EXPECT_EQ(ResponseFormat::negotiate("text/html"), Format::Json);
+  EXPECT_EQ(ResponseFormat::negotiate("application/bson"), Format::Bson);
+  EXPECT_EQ(ResponseFormat::negotiate("Application/X-MsgPack"),
+            Format::MessagePack);
+  EXPECT_EQ(ResponseFormat::negotiate("application/cbor, */*;q=0.1"),
+            Format::Cbor);
+  EXPECT_EQ(ResponseFormat::negotiate(
+                "application/json;q=0.5, application/msgpack;q=0.9"),
+            Format::MessagePack);
+  EXPECT_EQ(ResponseFormat::negotiate("application/json, application/cbor"),
+            Format::Json);
+  EXPECT_EQ(ResponseFormat::negotiate("application/cbor;q=0"), Format::Json);
+}
+
+TEST(ResponseFormatUnitTests, OnlyBinaryFormatsChangeTheVariant) {
+  EXPECT_EQ(ResponseFormat::variant(20, Format::Json), "start=20");
+  EXPECT_EQ(ResponseFormat::variant(20, Format::Cbor),
+            "start=20&format=cbor");
+  EXPECT_NE(ResponseFormat::variant(0, Format::Bson),
+            ResponseFormat::variant(0, Format::MessagePack));
+}
+
+TEST(ResponseFormatUnitTests, PassesBsonThroughUnchanged) {
+  auto documents = sampleListing();
+  documents.push_back(make_document(kvp("c", true)));
+
+  std::string body = ResponseFormat::encode(documents, Format::Bson);
+
+  auto first = documents[0].view();
+  auto second = documents[1].view();
+  ASSERT_EQ(body.size(), first.length() + second.length());
+  EXPECT_EQ(body.substr(0, first.length()),
+            std::string(reinterpret_cast<const char*>(first.data()),
+                        first.length()));
+  EXPECT_EQ(body.substr(first.length()),
+            std::string(reinterpret_cast<const char*>(second.data()),
+                        second.length()));
+}
+
+TEST(ResponseFormatUnitTests, WritesMessagePack) {
+  EXPECT_EQ(ResponseFormat::encode(sampleListing(), Format::MessagePack),
+            bytes({0x91, 0x82, 0xa1, 'a', 0x01, 0xa1, 'b', 0xa1, 'x'}));
+
+  std::vector<bsoncxx::document::value> numbers;
+  numbers.push_back(
+      make_document(kvp("n", -40), kvp("m", int64_t{5000000000})));
+  EXPECT_EQ(ResponseFormat::encode(numbers, Format::MessagePack),
+            bytes({0x91, 0x82, 0xa1, 'n', 0xd2, 0xff, 0xff, 0xff, 0xd8, 0xa1,
+                   'm', 0xd3, 0x00, 0x00, 0x00, 0x01, 0x2a, 0x05, 0xf2,
+                   0x00}));
+}
+
+TEST(ResponseFormatUnitTests, WritesCbor) {
+  EXPECT_EQ(ResponseFormat::encode(sampleListing(), Format::Cbor),
+            bytes({0x81, 0xa2, 0x61, 'a', 0x01, 0x61, 'b', 0x61, 'x'}));
+
+  std::vector<bsoncxx::document::value> numbers;
+  numbers.push_back(
+      make_document(kvp("n", -40), kvp("m", int64_t{5000000000})));
+  EXPECT_EQ(ResponseFormat::encode(numbers, Format::Cbor),
+            bytes({0x81, 0xa2, 0x61, 'n', 0x38, 0x27, 0x61, 'm', 0x1b, 0x00,
+                   0x00, 0x00, 0x01, 0x2a, 0x05, 0xf2, 0x00}));
+}
+
+TEST(ResponseFormatUnitTests, WritesAnEmptyListingInEveryFormat) {
+  std::vector<bsoncxx::document::value> none;
+
+  EXPECT_EQ(ResponseFormat::encode(none, Format::Json), "[]");
+  EXPECT_EQ(ResponseFormat::encode(none, Format::Bson), "");
+  EXPECT_EQ(ResponseFormat::encode(none, Format::MessagePack), bytes({0x90}));
+  EXPECT_EQ(ResponseFormat::encode(none, Format::Cbor), bytes({0x80}));
+}
@@ -0,0 +1,40 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "Result.h"
+
+TEST(ResultUnitTests, HoldsValue) {
+  Result<std::string> result = "12345";
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_TRUE(static_cast<bool>(result));
+  EXPECT_EQ(result.value(), "12345");
+}
+
+TEST(ResultUnitTests, HoldsError) {
+  Result<std::string> result = Error{ErrorCode::NotFound, "missing"};
+
+  ASSERT_FALSE(result.ok());
+  EXPECT_EQ(result.error().code, ErrorCode::NotFound);
+  EXPECT_EQ(result.error().message, "missing");
+}
+
+TEST(ResultUnitTests, ValueContainingErrorIsNotAnError) {
+  Result<std::string> result = std::string("Error Street Shelter");
+
+  EXPECT_TRUE(result.ok());
+}
+
+TEST(ResultUnitTests, MapsCodesToHttpStatus) {
+  EXPECT_EQ((Error{ErrorCode::InvalidInput, ""}.httpStatus()), 400);
+  EXPECT_EQ((Error{ErrorCode::Unauthorized, ""}.httpStatus()), 401);
+  EXPECT_EQ((Error{ErrorCode::Forbidden, ""}.httpStatus()), 403);
+  EXPECT_EQ((Error{ErrorCode::NotFound, ""}.httpStatus()), 404);
+  EXPECT_EQ((Error{ErrorCode::Conflict, ""}.httpStatus()), 409);
+  EXPECT_EQ((Error{ErrorCode::Unavailable, ""}.httpStatus()), 503);
+  EXPECT_EQ((Error{ErrorCode::Timeout, ""}.httpStatus()), 504);
+  EXPECT_EQ((Error{ErrorCode::Internal, ""}.httpStatus()), 500);
+}
@@ -3,6 +3,18 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <chrono>  // NOLINT(build/c++11)
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "AdmissionController.h"
+#include "AsyncExecutor.h"
+#include "ChangeFeed.h"
+#include "ChangeJournal.h"
 #include "Counseling.h"
 #include "Food.h"
 #include "Healthcare.h"
@@ -16,14 +28,15 @@ class MockShelter : public Shelter {
   explicit MockShelter(DatabaseManager* dbManager)
       : Shelter(*dbManager, "ShelterTest") {}
 
-  MOCK_METHOD(std::string, addShelter,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, addShelter,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
   MOCK_METHOD(std::string, deleteShelter,
-              (std::string id, (std::string request_auth)), (override));
+              (const std::string& id, const std::string& request_auth),
+              (override));
   MOCK_METHOD(std::string, searchShelterAll, (int start), (override));
-  MOCK_METHOD(std::string, updateShelter,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, updateShelter,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
 };
 
@@ -33,15 +46,15 @@ class MockCounseling : public Counseling {
                           const std::string& collection_name)
       : Counseling(*dbManager, "CounselingTests") {}
 
-  MOCK_METHOD(std::string, addCounselor,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, addCounselor,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
   MOCK_METHOD(std::string, deleteCounselor,
-              (const std::string& counselorId, (std::string request_auth)),
+              (const std::string& counselorId, const std::string& request_auth),
               (override));
   MOCK_METHOD(std::string, searchCounselorsAll, (int start), (override));
-  MOCK_METHOD(std::string, updateCounselor,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, updateCounselor,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
 };
 
@@ -50,15 +63,15 @@ class MockFood : public Food {
   explicit MockFood(DatabaseManager* db, const std::string& collection_name)
       : Food(*db, "FoodTests") {}
 
-  MOCK_METHOD(std::string, addFood,
-              ((std::string request_body), (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, addFood,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
   MOCK_METHOD(std::string, getAllFood, (int start), (override));
   MOCK_METHOD(std::string, deleteFood,
-              (const std::string& counselorId, (std::string request_auth)),
+              (const std::string& counselorId, const std::string& request_auth),
               (override));
-  MOCK_METHOD(std::string, updateFood,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, updateFood,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
 };
 
@@ -68,15 +81,15 @@ class MockOutreachService : public Outreach {
                       const std::string& collection_name)
       : Outreach(*dbManager, collection_name) {}
 
-  MOCK_METHOD(std::string, addOutreachService,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, addOutreachService,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
   MOCK_METHOD(std::string, getAllOutreachServices, (int start), (override));
   MOCK_METHOD(std::string, deleteOutreach,
-              (std::string counselorId, (std::string request_auth)),
+              (const std::string& counselorId, const std::string& request_auth),
               (override));
-  MOCK_METHOD(std::string, updateOutreach,
-              (std::string request_body, (std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, updateOutreach,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
 };
 
@@ -87,17 +100,15 @@ class MockHealthcareService : public Healthcare {
       : Healthcare(*dbManager, collection_name) {}
 
   // Mock methods
-  MOCK_METHOD(std::string, addHealthcareService,
-              ((const std::string request_body),
-               (const std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, addHealthcareService,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
   MOCK_METHOD(std::string, getAllHealthcareServices, (int start), (override));
-  MOCK_METHOD(std::string, updateHealthcare,
-              ((const std::string request_body),
-               (const std::string request_auth)),
+  MOCK_METHOD(Result<std::string>, updateHealthcare,
+              (const RequestBody& request_body, std::string_view request_auth),
               (override));
   MOCK_METHOD(std::string, deleteHealthcare,
-              ((const std::string id), (const std::string request_auth)),
+              (const std::string& id, const std::string& request_auth),
               (override));
 };
 
@@ -201,6 +212,172 @@ TEST_F(RouteControllerUnitTests, GetShelterTestAuthorized) {
   EXPECT_EQ(res.body, mockResponse);
 }
 
+TEST_F(RouteControllerUnitTests, AnswersQueuedRequestsBeforeItIsDestroyed) {
+  AsyncExecutor executor(1, 16);
+  AdmissionController admission(std::chrono::seconds(1), 16, 16, 16);
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  ASSERT_TRUE(executor.post([gate] { gate.wait(); }));
+
+  crow::SimpleApp app;
+  auto controller = std::make_unique<RouteController>(
+      *mockDbManager, *mockShelter, *mockCounseling, *mockHealthcare,
+      *mockOutreach, *mockFood, *mockAuthService, *mockSubscriptionManager,
+      &executor, &admission);
+  controller->initRoutes(app);
+  app.validate();
+  std::vector<crow::request> requests(3);
+  std::vector<crow::response> responses(3);
+  for (size_t i = 0; i < requests.size(); ++i) {
+    requests[i].url = "/resources/shelter/getAll";
+    requests[i].method = crow::HTTPMethod::GET;
+    app.handle_full(requests[i], responses[i]);
+  }
+  EXPECT_EQ(executor.pending(), 3u);
+
+  std::thread opener([&release] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release.set_value();
+  });
+  controller.reset();
+  opener.join();
+
+  for (const auto& res : responses) {
+    EXPECT_TRUE(res.is_completed());
+    EXPECT_EQ(res.code, 401);
+  }
+  for (const auto& status : admission.snapshot()) {
+    EXPECT_EQ(status.inFlight, 0);
+  }
+  EXPECT_FALSE(executor.post([] {}));
+}
+
+TEST_F(RouteControllerUnitTests, LimitsForgedTokensByTheirAddress) {
+  RateLimiter rateLimiter(RateLimiter::Limit{1, std::chrono::minutes(1), 1});
+  crow::SimpleApp app;
+  RouteController controller(
+      *mockDbManager, *mockShelter, *mockCounseling, *mockHealthcare,
+      *mockOutreach, *mockFood, *mockAuthService, *mockSubscriptionManager,
+      nullptr, nullptr, &rateLimiter);
+  controller.initRoutes(app);
+  app.validate();
+
+  std::vector<int> codes;
+  for (const char* user : {"alice", "bob"}) {
+    crow::request req;
+    req.url = "/resources/shelter/getAll";
+    req.method = crow::HTTPMethod::GET;
+    req.remote_ip_address = "203.0.113.7";
+    req.add_header("Authorization", std::string("Bearer forged.") + user);
+    crow::response res;
+    app.handle_full(req, res);
+    codes.push_back(res.code);
+  }
+
+  EXPECT_EQ(codes, (std::vector<int>{401, 429}));
+  EXPECT_EQ(rateLimiter.rejected(), 1);
+}
+
+TEST_F(RouteControllerUnitTests, GetShelterAnswersNotModifiedForCurrentETag) {
+  std::string mockResponse =
+      R"([{"ORG": "NGO", "User": "HML", "location": "NYC"}])";
+  EXPECT_CALL(*mockShelter, searchShelterAll(0))
+      .Times(1)
+      .WillOnce(::testing::Return(mockResponse));
+
+  crow::request first{};
+  first.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  crow::response full{};
+  routeController->getShelter(first, full);
+  std::string etag = full.get_header_value("ETag");
+
+  crow::request second{};
+  second.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  second.add_header("If-None-Match", etag);
+  crow::response cached{};
+  routeController->getShelter(second, cached);
+
+  EXPECT_EQ(full.code, 200);
+  EXPECT_FALSE(etag.empty());
+  EXPECT_EQ(cached.code, 304);
+  EXPECT_TRUE(cached.body.empty());
+  EXPECT_EQ(cached.get_header_value("ETag"), etag);
+}
+
+TEST_F(RouteControllerUnitTests, GetShelterServesCompressedListingFromCache) {
+  std::string mockResponse = "[";
+  for (int i = 0; i < 40; ++i) {
+    mockResponse += R"({"ORG": "NGO", "User": "HML", "location": "NYC"},)";
+  }
+  mockResponse.back() = ']';
+  EXPECT_CALL(*mockShelter, searchShelterAll(0))
+      .Times(1)
+      .WillOnce(::testing::Return(mockResponse));
+  ResponseCache cache(1 << 20, 256, 6);
+  RouteController cachingController(
+      *mockDbManager, *mockShelter, *mockCounseling, *mockHealthcare,
+      *mockOutreach, *mockFood, *mockAuthService, *mockSubscriptionManager,
+      nullptr, nullptr, nullptr, &cache);
+
+  crow::request req{};
+  req.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  req.add_header("Accept-Encoding", "gzip, deflate");
+  crow::response first{};
+  cachingController.getShelter(req, first);
+  crow::response second{};
+  cachingController.getShelter(req, second);
+
+  EXPECT_EQ(first.code, 200);
+  EXPECT_EQ(first.get_header_value("Content-Encoding"), "gzip");
+  EXPECT_LT(first.body.size(), mockResponse.size());
+  EXPECT_EQ(second.code, 200);
+  EXPECT_EQ(second.body, first.body);
+  EXPECT_EQ(second.get_header_value("ETag"), first.get_header_value("ETag"));
+  EXPECT_EQ(cache.stats().compressions, 1u);
+}
+
+TEST_F(RouteControllerUnitTests, GetShelterAnswersMessagePackWhenAccepted) {
+  std::vector<bsoncxx::document::value> documents;
+  documents.push_back(bsoncxx::builder::basic::make_document(
+      bsoncxx::builder::basic::kvp("ORG", "NGO")));
+  EXPECT_CALL(*mockShelter, searchShelterAll(::testing::_)).Times(0);
+  EXPECT_CALL(*mockDbManager, findCollection(0, "ShelterTest", ::testing::_,
+                                             ::testing::_))
+      .WillOnce(::testing::SetArgReferee<3>(documents));
+
+  crow::request req{};
+  req.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  req.add_header("Accept", "application/msgpack");
+  crow::response res{};
+  routeController->getShelter(req, res);
+
+  EXPECT_EQ(res.code, 200);
+  EXPECT_EQ(res.get_header_value("Content-Type"), "application/msgpack");
+  EXPECT_EQ(res.get_header_value("Vary"), "Accept, Accept-Encoding");
+  EXPECT_EQ(res.body, std::string("\x91\x81\xa3ORG\xa3NGO"));
+  EXPECT_NE(res.get_header_value("ETag"), mockShelter->listingETag(0));
+}
+
+TEST_F(RouteControllerUnitTests, GetShelterFiltersByTheQueryParameters) {
+  std::vector<std::pair<std::string, std::string>> wanted = {
+      {"City", "Boston"}, {"ORG", "NGO"}};
+  EXPECT_CALL(*mockShelter, searchShelterAll(::testing::_)).Times(0);
+  EXPECT_CALL(*mockDbManager,
+              findCollection(0, "ShelterTest", wanted, ::testing::_))
+      .Times(1);
+
+  crow::request req{};
+  req.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  req.url_params =
+      crow::query_string("/resources/shelter/getAll?city=Boston&org=NGO");
+  crow::response res{};
+  routeController->getShelter(req, res);
+
+  EXPECT_EQ(res.code, 200);
+  EXPECT_EQ(res.body, "[]");
+  EXPECT_NE(res.get_header_value("ETag"), mockShelter->listingETag(0));
+}
+
 TEST_F(RouteControllerUnitTests, AddShelterTestAuthorized) {
   std::string body =
       "{\"Name\" : \"temp\",\"City\" : \"New York\",\"Address\": "
@@ -213,7 +390,8 @@ TEST_F(RouteControllerUnitTests, AddShelterTestAuthorized) {
   req.add_header("Authorization", "Bearer " + getValidTokenForPost());
   crow::response res{};
 
-  ON_CALL(*mockShelter, addShelter(body, req.get_header_value("Authorization")))
+  ON_CALL(*mockShelter, addShelter(RequestBody(body),
+                                   req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addShelter(req, res);
@@ -221,6 +399,38 @@ TEST_F(RouteControllerUnitTests, AddShelterTestAuthorized) {
   EXPECT_EQ(res.code, 201);
 }
 
+TEST_F(RouteControllerUnitTests, AddShelterReturnsStatusOfError) {
+  crow::request req;
+  req.body = R"({"Name": "temp"})";
+  req.add_header("Authorization", "Bearer " + getValidTokenForPost());
+  crow::response res{};
+
+  ON_CALL(*mockShelter, addShelter(::testing::_, ::testing::_))
+      .WillByDefault(::testing::Return(
+          Error{ErrorCode::InvalidInput,
+                "Error: Shelter: The request missing some properties."}));
+
+  routeController->addShelter(req, res);
+
+  EXPECT_EQ(res.code, 400);
+  EXPECT_EQ(res.body, "Error: Shelter: The request missing some properties.");
+}
+
+TEST_F(RouteControllerUnitTests, AddShelterWithErrorInNameSucceeds) {
+  crow::request req;
+  req.body = R"({"Name": "Error Street Shelter", "City": "New York"})";
+  req.add_header("Authorization", "Bearer " + getValidTokenForPost());
+  crow::response res{};
+
+  ON_CALL(*mockShelter, addShelter(::testing::_, ::testing::_))
+      .WillByDefault(::testing::Return("ErrorStreet-1"));
+
+  routeController->addShelter(req, res);
+
+  EXPECT_EQ(res.code, 201);
+  EXPECT_EQ(res.body, "ErrorStreet-1");
+}
+
 TEST_F(RouteControllerUnitTests, GetShelterTestUnauthorized) {
   std::string mockResponse =
       R"([{"ORG": "NGO", "User": "HML", "location": "NYC"}])";
@@ -248,7 +458,8 @@ TEST_F(RouteControllerUnitTests, AddShelterTestUnauthorized) {
   req.add_header("Authorization", "Bearer invalid.token.here");
   crow::response res{};
 
-  ON_CALL(*mockShelter, addShelter(body, req.get_header_value("Authorization")))
+  ON_CALL(*mockShelter, addShelter(RequestBody(body),
+                                   req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addShelter(req, res);
@@ -276,6 +487,70 @@ TEST_F(RouteControllerUnitTests, DeleteShelterTestAuthorized) {
   EXPECT_EQ(res.body, "Shelter resource deleted successfully.");
 }
 
+TEST_F(RouteControllerUnitTests, DeleteShelterPublishesToTheLiveFeed) {
+  std::string id = "507f191e810c19729de860ea";
+  crow::request req;
+  req.add_header("Authorization", "Bearer " + getValidTokenForPost());
+  req.body = R"({"id": "507f191e810c19729de860ea"})";
+  crow::response res{};
+  ON_CALL(*mockShelter,
+          deleteShelter(id, req.get_header_value("Authorization")))
+      .WillByDefault(::testing::Return("SUC"));
+  ChangeFeed feed(16, 16);
+  std::promise<std::string> frame;
+  feed.subscribe(
+      "shelter", "New York",
+      [&frame](const std::string& sent) { frame.set_value(sent); },
+      [](const std::string&) {});
+  RouteController feedController(
+      *mockDbManager, *mockShelter, *mockCounseling, *mockHealthcare,
+      *mockOutreach, *mockFood, *mockAuthService, *mockSubscriptionManager,
+      nullptr, nullptr, nullptr, nullptr, &feed);
+
+  feedController.deleteShelter(req, res);
+
+  auto sent = frame.get_future();
+  ASSERT_EQ(sent.wait_for(std::chrono::seconds(2)),
+            std::future_status::ready);
+  ResourceChange expected{"shelter", "delete", id, ""};
+  EXPECT_EQ(sent.get(), expected.json());
+}
+
+TEST_F(RouteControllerUnitTests, GetChangesReturnsTheDeltasAfterACursor) {
+  std::string id = "507f191e810c19729de860ea";
+  crow::request del;
+  del.add_header("Authorization", "Bearer " + getValidTokenForPost());
+  del.body = R"({"id": "507f191e810c19729de860ea"})";
+  crow::response deleted{};
+  ON_CALL(*mockShelter,
+          deleteShelter(id, del.get_header_value("Authorization")))
+      .WillByDefault(::testing::Return("SUC"));
+  ChangeJournal journal(16, 100);
+  RouteController journalController(
+      *mockDbManager, *mockShelter, *mockCounseling, *mockHealthcare,
+      *mockOutreach, *mockFood, *mockAuthService, *mockSubscriptionManager,
+      nullptr, nullptr, nullptr, nullptr, nullptr, &journal);
+  journalController.deleteShelter(del, deleted);
+
+  crow::request req;
+  req.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  req.url_params = crow::query_string("/resources/changes?since=99");
+  crow::response res{};
+  journalController.getChanges(req, res);
+
+  JournalEntry expected{100, ResourceChange{"shelter", "delete", id, ""}, ""};
+  EXPECT_EQ(res.code, 200);
+  EXPECT_EQ(res.body, "{\"changes\": [" + expected.json() +
+                          "], \"next\": 100, \"more\": false}");
+
+  crow::request stale;
+  stale.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  stale.url_params = crow::query_string("/resources/changes?since=5");
+  crow::response gone{};
+  journalController.getChanges(stale, gone);
+  EXPECT_EQ(gone.code, 410);
+}
+
 TEST_F(RouteControllerUnitTests, DeleteShelterTestUnauthorized) {
   std::string body = R"({"id": "507f191e810c19729de860ea"})";
   crow::request req;
@@ -296,7 +571,8 @@ TEST_F(RouteControllerUnitTests, UpdateShelterTestAuthorized) {
   crow::response res{};
 
   ON_CALL(*mockShelter,
-          updateShelter(body, req.get_header_value("Authorization")))
+          updateShelter(RequestBody(body),
+                        req.get_header_value("Authorization")))
       .WillByDefault(
           ::testing::Return("Shelter resource updated successfully."));
 
@@ -320,6 +596,22 @@ TEST_F(RouteControllerUnitTests, GetCounselingTestAuthorized) {
   EXPECT_EQ(res.body, mockResponse);
 }
 
+TEST_F(RouteControllerUnitTests, GetCounselingRefusesAFilterItHasNoFieldFor) {
+  EXPECT_CALL(*mockCounseling, searchCounselorsAll(::testing::_)).Times(0);
+  EXPECT_CALL(*mockDbManager, findCollection(::testing::_, ::testing::_,
+                                             ::testing::_, ::testing::_))
+      .Times(0);
+
+  crow::request req{};
+  req.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  req.url_params =
+      crow::query_string("/resources/counseling/getAll?targetUser=HML");
+  crow::response res{};
+  routeController->getCounseling(req, res);
+
+  EXPECT_EQ(res.code, 400);
+}
+
 TEST_F(RouteControllerUnitTests, AddCounselingTestAuthorized) {
   std::string body = R"({
         "Name" : "OrganicFarm",
@@ -336,7 +628,8 @@ TEST_F(RouteControllerUnitTests, AddCounselingTestAuthorized) {
   crow::response res{};
 
   ON_CALL(*mockCounseling,
-          addCounselor(body, req.get_header_value("Authorization")))
+          addCounselor(RequestBody(body),
+                       req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Suc"));
 
   routeController->addCounseling(req, res);
@@ -374,7 +667,8 @@ TEST_F(RouteControllerUnitTests, AddCounselingTestUnauthorized) {
   crow::response res{};
 
   ON_CALL(*mockCounseling,
-          addCounselor(body, req.get_header_value("Authorization")))
+          addCounselor(RequestBody(body),
+                       req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addCounseling(req, res);
@@ -422,7 +716,8 @@ TEST_F(RouteControllerUnitTests, UpdateCounselingTestAuthorized) {
   crow::response res{};
 
   ON_CALL(*mockCounseling,
-          updateCounselor(body, req.get_header_value("Authorization")))
+          updateCounselor(RequestBody(body),
+                          req.get_header_value("Authorization")))
       .WillByDefault(
           ::testing::Return("Counseling resource updated successfully."));
 
@@ -464,7 +759,8 @@ TEST_F(RouteControllerUnitTests, AddFoodTest) {
       "\"quantity\": \"100\", "
       "\"expirationDate\": \"2024-12-31\"}";
 
-  ON_CALL(*mockFood, addFood(req.body, req.get_header_value("Authorization")))
+  ON_CALL(*mockFood, addFood(RequestBody(req.body),
+                             req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addFood(req, res);
@@ -504,7 +800,8 @@ TEST_F(RouteControllerUnitTests, AddFoodTestUnauthorized) {
   req.add_header("Authorization", "Bearer invalid.token.here");
   crow::response res{};
 
-  ON_CALL(*mockFood, addFood(input, req.get_header_value("Authorization")))
+  ON_CALL(*mockFood, addFood(RequestBody(input),
+                             req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("12345"));
 
   routeController->addFood(req, res);
@@ -549,7 +846,8 @@ TEST_F(RouteControllerUnitTests, UpdateFoodTestAuthorized) {
   req.body = body;
   crow::response res{};
 
-  ON_CALL(*mockFood, updateFood(body, req.get_header_value("Authorization")))
+  ON_CALL(*mockFood, updateFood(RequestBody(body),
+                                req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Food resource updated successfully."));
 
   routeController->updateFood(req, res);
@@ -588,7 +886,8 @@ TEST_F(RouteControllerUnitTests, AddOutreachServiceTestAuthorized) {
   crow::response res{};
 
   ON_CALL(*mockOutreach,
-          addOutreachService(body, req.get_header_value("Authorization")))
+          addOutreachService(RequestBody(body),
+                             req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addOutreachService(req, res);
@@ -628,7 +927,8 @@ TEST_F(RouteControllerUnitTests, AddOutreachServiceTestUnauthorized) {
   crow::response res{};
 
   ON_CALL(*mockOutreach,
-          addOutreachService(body, req.get_header_value("Authorization")))
+          addOutreachService(RequestBody(body),
+                             req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addOutreachService(req, res);
@@ -676,7 +976,8 @@ TEST_F(RouteControllerUnitTests, UpdateOutreachTestAuthorized) {
   crow::response res{};
 
   ON_CALL(*mockOutreach,
-          updateOutreach(body, req.get_header_value("Authorization")))
+          updateOutreach(RequestBody(body),
+                         req.get_header_value("Authorization")))
       .WillByDefault(
           ::testing::Return("Outreach resource update successfully."));
 
@@ -716,7 +1017,8 @@ TEST_F(RouteControllerUnitTests, AddHealthcareServiceTestAuthorized) {
   crow::response res{};
 
   ON_CALL(*mockHealthcare,
-          addHealthcareService(body, req.get_header_value("Authorization")))
+          addHealthcareService(RequestBody(body),
+                               req.get_header_value("Authorization")))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addHealthcareService(req, res);
@@ -753,7 +1055,7 @@ TEST_F(RouteControllerUnitTests, AddHealthcareServiceTestUnauthorized) {
   req.add_header("Authorization", "Bearer invalid.token.here");
   crow::response res{};
 
-  ON_CALL(*mockHealthcare, addHealthcareService(body, "456"))
+  ON_CALL(*mockHealthcare, addHealthcareService(RequestBody(body), "456"))
       .WillByDefault(::testing::Return("Success"));
 
   routeController->addHealthcareService(req, res);
@@ -785,7 +1087,7 @@ TEST_F(RouteControllerUnitTests, UpdateHealthcareServiceTestAuthorized) {
       {"operatingHours", "24/7"},    {"contactInfo", "987-654-3210"}};
   std::string id = "507f191e810c19729de860ea";
 
-  ON_CALL(*mockHealthcare, updateHealthcare(body, "456"))
+  ON_CALL(*mockHealthcare, updateHealthcare(RequestBody(body), "456"))
       .WillByDefault(
           ::testing::Return("Healthcare resource update successfully."));
 
@@ -892,3 +1194,22 @@ TEST_F(RouteControllerUnitTests, AddSubscriberTestUnauthorized) {
   EXPECT_EQ(res.code, 401);
   EXPECT_EQ(res.body, "Invalid or expired token.");
 }
+
+TEST_F(RouteControllerUnitTests, GetWebhookStatusAuthorized) {
+  crow::request req{};
+  req.add_header("Authorization", "Bearer " + getValidTokenForGet());
+  crow::response res{};
+
+  routeController->getWebhookStatus(req, res);
+
+  EXPECT_EQ(res.code, 200);
+}
+
+TEST_F(RouteControllerUnitTests, GetWebhookStatusUnauthorized) {
+  crow::request req{};
+  crow::response res{};
+
+  routeController->getWebhookStatus(req, res);
+
+  EXPECT_EQ(res.code, 401);
+}
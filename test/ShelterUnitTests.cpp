@@ -6,9 +6,28 @@
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
 
+#include "Deadline.h"
 #include "MockDatabaseManager.h"
 #include "Shelter.h"
 
+namespace {
+
+// A document with the given City, the given value in field and, if org is
+// set, that ORG.
+bsoncxx::document::value resource(const std::string& city,
+                                  const std::string& field,
+                                  const std::string& value,
+                                  const std::string& org = "") {
+  bsoncxx::builder::stream::document document{};
+  document << "City" << city << field << value;
+  if (!org.empty()) {
+    document << "ORG" << org;
+  }
+  return document << bsoncxx::builder::stream::finalize;
+}
+
+}  // namespace
+
 class ShelterUnitTests : public ::testing::Test {
  protected:
   Shelter* shelter;
@@ -23,15 +42,16 @@ class ShelterUnitTests : public ::testing::Test {
   }
 };
 TEST_F(ShelterUnitTests, AddNewShelter) {
+  Shelter::Fields fields;
   shelter->checkInputFormat(
       "{\"Name\" : \"temp\",\"City\" : \"New York\",\"Address\": "
       "\"temp\",\"Description\" : \"NULL\",\"ContactInfo\" : "
       "\"66664566565\",\"HoursOfOperation\": "
       "\"2024-01-11\",\"ORG\":\"NGO\",\"TargetUser\" "
       ":\"HML\",\"Capacity\" : \"100\",\"CurrentUse\": \"10\"}",
-      "456");
+      "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      shelter->createDBContent();
+      shelter->createDBContent(fields);
   ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
       .WillByDefault(
           [&](const std::string& collectionName,
@@ -40,14 +60,15 @@ TEST_F(ShelterUnitTests, AddNewShelter) {
             EXPECT_EQ(content, expectedContent);
             return "12345";
           });
-  std::string ret = shelter->addShelter(
+  auto ret = shelter->addShelter(
       "{\"Name\" : \"temp\",\"City\" : \"New York\",\"Address\": "
       "\"temp\",\"Description\" : \"NULL\",\"ContactInfo\" : "
       "\"66664566565\",\"HoursOfOperation\": "
       "\"2024-01-11\",\"ORG\":\"NGO\",\"TargetUser\" "
       ":\"HML\",\"Capacity\" : \"100\",\"CurrentUse\": \"10\"}",
       "456");
-  EXPECT_EQ(ret, "12345");
+  ASSERT_TRUE(ret.ok());
+  EXPECT_EQ(ret.value(), "12345");
 }
 
 TEST_F(ShelterUnitTests, searchShelterAll) {
@@ -73,6 +94,7 @@ TEST_F(ShelterUnitTests, searchShelterAll) {
 }
 
 TEST_F(ShelterUnitTests, UpdateShelter) {
+  Shelter::Fields fields;
   shelter->checkInputFormat(R"({
         "id":"123456789" ,
         "CurrentUse" : "10", "Capacity" : "100", 
@@ -81,9 +103,9 @@ TEST_F(ShelterUnitTests, UpdateShelter) {
         "ContactInfo" : "66664566565", "Description" : "NULL", 
         "Address" : "temp", "City" : "New York", "Name" : "temp"
         })",
-                            "456");
+                            "456", fields);
   std::vector<std::pair<std::string, std::string>> expectedContent =
-      shelter->createDBContent();
+      shelter->createDBContent(fields);
   std::string id_temp = "123456789";
   ON_CALL(*mockDbManager,
           updateResource(::testing::_, ::testing::_, ::testing::_))
@@ -94,7 +116,7 @@ TEST_F(ShelterUnitTests, UpdateShelter) {
             EXPECT_EQ(collectionName, "ShelterTest");
             EXPECT_EQ(content, expectedContent);
           });
-  std::string ret = shelter->updateShelter(
+  auto ret = shelter->updateShelter(
       R"({
         "id":"123456789" ,
         "CurrentUse" : "10", "Capacity" : "100", 
@@ -104,7 +126,8 @@ TEST_F(ShelterUnitTests, UpdateShelter) {
         "Address" : "temp", "City" : "New York", "Name" : "temp"
         })",
       "456");
-  EXPECT_EQ(ret, "Update");
+  ASSERT_TRUE(ret.ok());
+  EXPECT_EQ(ret.value(), "Update");
 }
 
 TEST_F(ShelterUnitTests, DeleteShelter) {
@@ -121,3 +144,91 @@ TEST_F(ShelterUnitTests, DeleteShelter) {
   std::string ret = shelter->deleteShelter(id_temp, "456");
   EXPECT_EQ(ret, "SUC");
 }
+
+TEST_F(ShelterUnitTests, AddShelterRejectsInvalidInputWithoutThrowing) {
+  EXPECT_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
+      .Times(0);
+
+  auto ret = shelter->addShelter(R"({"Name": "temp", "Capacity": "0"})", "456");
+
+  ASSERT_FALSE(ret.ok());
+  EXPECT_EQ(ret.error().code, ErrorCode::InvalidInput);
+  EXPECT_EQ(ret.error().httpStatus(), 400);
+  EXPECT_EQ(ret.error().message,
+            "Error: Shelter: The request with invalid argument.");
+}
+
+TEST_F(ShelterUnitTests, AddShelterReportsDatabaseFailureAsInternal) {
+  ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
+      .WillByDefault(::testing::Throw(std::runtime_error("connection lost")));
+
+  auto ret = shelter->addShelter(
+      R"({"Name": "temp", "City": "New York", "Address": "temp",
+          "Description": "NULL", "ContactInfo": "66664566565",
+          "HoursOfOperation": "2024-01-11", "ORG": "NGO",
+          "TargetUser": "HML", "Capacity": "100", "CurrentUse": "10"})",
+      "456");
+
+  ASSERT_FALSE(ret.ok());
+  EXPECT_EQ(ret.error().code, ErrorCode::Internal);
+  EXPECT_EQ(ret.error().httpStatus(), 500);
+  EXPECT_EQ(ret.error().message, "Error: connection lost");
+}
+
+TEST_F(ShelterUnitTests, AddShelterReportsAnExpiredDeadlineAsTimeout) {
+  ON_CALL(*mockDbManager, insertResource(::testing::_, ::testing::_))
+      .WillByDefault(::testing::Throw(DeadlineExceeded("mongo.insert")));
+
+  auto ret = shelter->addShelter(
+      R"({"Name": "temp", "City": "New York", "Address": "temp",
+          "Description": "NULL", "ContactInfo": "66664566565",
+          "HoursOfOperation": "2024-01-11", "ORG": "NGO",
+          "TargetUser": "HML", "Capacity": "100", "CurrentUse": "10"})",
+      "456");
+
+  ASSERT_FALSE(ret.ok());
+  EXPECT_EQ(ret.error().code, ErrorCode::Timeout);
+  EXPECT_EQ(ret.error().httpStatus(), 504);
+  EXPECT_EQ(ret.error().message,
+            "Error: Deadline exceeded during mongo.insert.");
+}
+
+TEST_F(ShelterUnitTests, WritesChangeTheListingETag) {
+  std::string before = shelter->listingETag(0);
+  EXPECT_EQ(shelter->listingETag(0), before);
+  EXPECT_NE(shelter->listingETag(20), before);
+
+  auto ret = shelter->addShelter(
+      R"({"Name": "temp", "City": "New York", "Address": "temp",
+          "Description": "NULL", "ContactInfo": "66664566565",
+          "HoursOfOperation": "2024-01-11", "ORG": "NGO",
+          "TargetUser": "HML", "Capacity": "100", "CurrentUse": "10"})",
+      "456");
+  ASSERT_TRUE(ret.ok());
+  std::string added = shelter->listingETag(0);
+  EXPECT_NE(added, before);
+
+  ON_CALL(*mockDbManager,
+          deleteResource(::testing::_, ::testing::_, ::testing::_))
+      .WillByDefault(::testing::Return(true));
+  shelter->deleteShelter("abc", "456");
+  EXPECT_NE(shelter->listingETag(0), added);
+}
+
+TEST_F(ShelterUnitTests, FiltersListingsOnItsOwnFields) {
+  mockDbManager->findIn({resource("Boston", "TargetUser", "HML", "NGO"),
+                         resource("Boston", "TargetUser", "VET", "NGO"),
+                         resource("Queens", "TargetUser", "HML", "NGO")});
+  ListingFilter filter;
+  filter.city = "Boston";
+  filter.targetUser = "HML";
+  filter.org = "NGO";
+
+  std::string listing =
+      shelter->encodedListing(0, ResponseFormat::Format::Json, filter);
+
+  EXPECT_NE(listing.find("Boston"), std::string::npos);
+  EXPECT_EQ(listing.find("Queens"), std::string::npos);
+  EXPECT_EQ(listing.find("VET"), std::string::npos);
+  EXPECT_TRUE(filter.supportedBy(Shelter::kFilterSpec));
+}
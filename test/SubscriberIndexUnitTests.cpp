@@ -0,0 +1,77 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "SubscriberIndex.h"
+
+TEST(SubscriberIndexUnitTests, MatchesExactResourceAndCity) {
+  SubscriberIndex index;
+  index.add("1", "food", "New York", "a@example.com");
+  index.add("2", "shelter", "New York", "b@example.com");
+  index.add("3", "food", "Boston", "c@example.com");
+
+  auto matched = index.match("food", "New York");
+
+  ASSERT_EQ(matched.size(), 1);
+  EXPECT_EQ(matched["1"], "a@example.com");
+}
+
+TEST(SubscriberIndexUnitTests, MatchingIgnoresCaseAndWhitespace) {
+  SubscriberIndex index;
+  index.add("1", "Healthcare", " New York ", "a@example.com");
+
+  EXPECT_EQ(index.match("healthcare", "new york").size(), 1);
+}
+
+TEST(SubscriberIndexUnitTests, WildcardSubscriptions) {
+  SubscriberIndex index;
+  index.add("all-cities", "food", "*", "a@example.com");
+  index.add("all-resources", "all", "Boston", "b@example.com");
+  index.add("everything", "*", "ALL", "https://hooks.example.org/x");
+  index.add("other", "shelter", "Chicago", "d@example.com");
+
+  auto matched = index.match("food", "Boston");
+
+  EXPECT_EQ(matched.size(), 3);
+  EXPECT_EQ(matched.count("all-cities"), 1);
+  EXPECT_EQ(matched.count("all-resources"), 1);
+  EXPECT_EQ(matched.count("everything"), 1);
+  EXPECT_EQ(index.match("shelter", "Chicago").size(), 2);
+}
+
+TEST(SubscriberIndexUnitTests, RemoveAndReAdd) {
+  SubscriberIndex index;
+  index.add("1", "food", "Boston", "a@example.com");
+
+  EXPECT_TRUE(index.remove("1"));
+  EXPECT_FALSE(index.remove("1"));
+  EXPECT_TRUE(index.match("food", "Boston").empty());
+  EXPECT_EQ(index.size(), 0);
+
+  index.add("1", "food", "Boston", "a@example.com");
+  index.add("1", "food", "Chicago", "a@example.com");
+
+  EXPECT_TRUE(index.match("food", "Boston").empty());
+  EXPECT_EQ(index.match("food", "Chicago").size(), 1);
+  EXPECT_EQ(index.size(), 1);
+}
+
+TEST(SubscriberIndexUnitTests, ForEachVisitsEverySubscription) {
+  SubscriberIndex index;
+  index.add("1", "Food", " Boston", "a@example.com");
+  index.add("2", "all", "Chicago", "https://example.com/hook");
+
+  std::map<std::string, std::string> visited;
+  index.forEach([&visited](const std::string& id, const std::string& resource,
+                           const std::string& city,
+                           const std::string& contact) {
+    visited[id] = resource + "|" + city + "|" + contact;
+  });
+
+  ASSERT_EQ(visited.size(), 2);
+  EXPECT_EQ(visited["1"], "food|boston|a@example.com");
+  EXPECT_EQ(visited["2"], "*|chicago|https://example.com/hook");
+}
@@ -3,8 +3,13 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdlib>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "MockDatabaseManager.h"
 #include "SubscriptionManager.h"
@@ -72,26 +77,37 @@ TEST_F(SubscriptionManagerUnitTests, GetSubscribers) {
   std::string resource = "Healthcare";
   std::string city = "New York";
 
-  std::vector<std::pair<std::string, std::string>> expectedQuery = {
-      {"Resource", resource}, {"City", city}};
-
   std::vector<bsoncxx::document::value> mockDocs;
 
   bsoncxx::builder::stream::document doc1;
-  doc1 << "_id" << bsoncxx::oid("507f1f77bcf86cd799439011") << "Contact"
-       << "user1@example.com";
+  doc1 << "_id" << bsoncxx::oid("507f1f77bcf86cd799439011") << "Resource"
+       << resource << "City" << city << "Contact" << "user1@example.com";
   mockDocs.push_back(doc1.extract());
 
   bsoncxx::builder::stream::document doc2;
-  doc2 << "_id" << bsoncxx::oid("507f1f77bcf86cd799439012") << "Contact"
-       << "user2@example.com";
+  doc2 << "_id" << bsoncxx::oid("507f1f77bcf86cd799439012") << "Resource"
+       << resource << "City" << city << "Contact" << "user2@example.com";
   mockDocs.push_back(doc2.extract());
 
-  ON_CALL(*mockDbManager,
-          findCollection(0, "Subscribers", expectedQuery, ::testing::_))
-      .WillByDefault(::testing::DoAll(::testing::SetArgReferee<3>(mockDocs),
-                                      ::testing::Return()));
+  bsoncxx::builder::stream::document doc3;
+  doc3 << "_id" << bsoncxx::oid("507f1f77bcf86cd799439013") << "Resource"
+       << "Food" << "City" << city << "Contact" << "user3@example.com";
+  mockDocs.push_back(doc3.extract());
+
+  EXPECT_CALL(*mockDbManager, scanCollection("Subscribers", ::testing::_))
+      .WillOnce(
+          [&](const std::string&,
+              const std::function<void(const bsoncxx::document::view&)>&
+                  visitor) {
+            for (const auto& doc : mockDocs) {
+              visitor(doc.view());
+            }
+          });
+  EXPECT_CALL(*mockDbManager, findCollection(::testing::_, ::testing::_,
+                                             ::testing::_, ::testing::_))
+      .Times(0);
 
+  subscriptionManager->loadSubscribers();
   std::map<std::string, std::string> subscribers =
       subscriptionManager->getSubscribers(resource, city);
 
@@ -99,3 +115,166 @@ TEST_F(SubscriptionManagerUnitTests, GetSubscribers) {
   EXPECT_EQ(subscribers["507f1f77bcf86cd799439011"], "user1@example.com");
   EXPECT_EQ(subscribers["507f1f77bcf86cd799439012"], "user2@example.com");
 }
+
+TEST_F(SubscriptionManagerUnitTests, GetSubscribersIsNotCappedAtOnePage) {
+  std::vector<bsoncxx::document::value> mockDocs;
+  for (int i = 0; i < 50; ++i) {
+    bsoncxx::builder::stream::document doc;
+    doc << "_id" << bsoncxx::oid() << "Resource" << "shelter" << "City"
+        << "Boston" << "Contact"
+        << "user" + std::to_string(i) + "@example.com";
+    mockDocs.push_back(doc.extract());
+  }
+  ON_CALL(*mockDbManager, scanCollection("Subscribers", ::testing::_))
+      .WillByDefault(
+          [&](const std::string&,
+              const std::function<void(const bsoncxx::document::view&)>&
+                  visitor) {
+            for (const auto& doc : mockDocs) {
+              visitor(doc.view());
+            }
+          });
+
+  subscriptionManager->loadSubscribers();
+
+  EXPECT_EQ(subscriptionManager->getSubscribers("shelter", "Boston").size(),
+            50);
+}
+
+TEST_F(SubscriptionManagerUnitTests, AddAndDeleteKeepIndexInSync) {
+  ON_CALL(*mockDbManager, insertResource("Subscribers", ::testing::_))
+      .WillByDefault(::testing::Return("mock_id_1"));
+  ON_CALL(*mockDbManager, deleteResource("Subscribers", "mock_id_1", ""))
+      .WillByDefault(::testing::Return(true));
+
+  subscriptionManager->addSubscriber(
+      {{"Resource", "*"}, {"City", "Chicago"}, {"Contact", "a@example.com"}});
+
+  auto matched = subscriptionManager->getSubscribers("food", "Chicago");
+  ASSERT_EQ(matched.size(), 1);
+  EXPECT_EQ(matched["mock_id_1"], "a@example.com");
+  EXPECT_TRUE(subscriptionManager->getSubscribers("food", "Boston").empty());
+
+  subscriptionManager->deleteSubscriber("mock_id_1");
+
+  EXPECT_TRUE(subscriptionManager->getSubscribers("food", "Chicago").empty());
+}
+
+TEST_F(SubscriptionManagerUnitTests, NotifySubscribersOnlyWritesOutboxEvent) {
+  EXPECT_CALL(*mockDbManager,
+              insertDocument("NotificationOutbox", ::testing::_))
+      .WillOnce(::testing::Return("507f1f77bcf86cd799439011"));
+
+  subscriptionManager->notifySubscribers("food", "Boston");
+}
+
+TEST_F(SubscriptionManagerUnitTests, NotifySubscribersSurvivesOutboxFailure) {
+  EXPECT_CALL(*mockDbManager,
+              insertDocument("NotificationOutbox", ::testing::_))
+      .WillOnce(::testing::Throw(std::runtime_error("connection refused")));
+
+  EXPECT_NO_THROW(subscriptionManager->notifySubscribers("food", "Boston"));
+}
+
+TEST_F(SubscriptionManagerUnitTests, ReconcileCatchesUpARestoredIndex) {
+  bsoncxx::builder::stream::document kept;
+  kept << "_id" << bsoncxx::oid("507f1f77bcf86cd799439011") << "Resource"
+       << "shelter" << "City" << "Boston" << "Contact" << "kept@example.com"
+       << "Delivery" << "hourly";
+  bsoncxx::builder::stream::document deleted;
+  deleted << "_id" << bsoncxx::oid("507f1f77bcf86cd799439012") << "Resource"
+          << "shelter" << "City" << "Boston" << "Contact"
+          << "deleted@example.com";
+  subscriptionManager->refreshSubscriber(kept.view());
+  subscriptionManager->refreshSubscriber(deleted.view());
+
+  std::vector<bsoncxx::document::value> saved;
+  subscriptionManager->forEachSubscriber(
+      [&saved](const bsoncxx::document::view& document) {
+        saved.emplace_back(document);
+      });
+  ASSERT_EQ(saved.size(), 2);
+  int hourly = 0;
+  for (const auto& document : saved) {
+    auto delivery = document.view()["Delivery"];
+    if (delivery && delivery.get_utf8().value.to_string() == "hourly") {
+      hourly++;
+    }
+  }
+  EXPECT_EQ(hourly, 1);
+
+  bsoncxx::builder::stream::document added;
+  added << "_id" << bsoncxx::oid("507f1f77bcf86cd799439013") << "Resource"
+        << "shelter" << "City" << "Boston" << "Contact" << "added@example.com";
+  std::vector<bsoncxx::document::value> stored;
+  stored.push_back(kept.extract());
+  stored.push_back(added.extract());
+  EXPECT_CALL(*mockDbManager, scanCollection("Subscribers", ::testing::_))
+      .WillOnce(
+          [&](const std::string&,
+              const std::function<void(const bsoncxx::document::view&)>&
+                  visitor) {
+            for (const auto& doc : stored) {
+              visitor(doc.view());
+            }
+          });
+
+  subscriptionManager->reconcileSubscribers();
+
+  auto subscribers = subscriptionManager->getSubscribers("shelter", "Boston");
+  EXPECT_EQ(subscribers.size(), 2);
+  EXPECT_EQ(subscribers["507f1f77bcf86cd799439011"], "kept@example.com");
+  EXPECT_EQ(subscribers["507f1f77bcf86cd799439013"], "added@example.com");
+}
+
+TEST_F(SubscriptionManagerUnitTests, LeavesDeliveriesWhoseLeaseRunsOut) {
+  // A one-second lease, half a second per delivery, and no webhook calls
+  // allowed, so every delivery tried is deferred unsent. Without the
+  // dispatcher running, deliveries are sent one at a time.
+  setenv("GITGUD_OUTBOX_LEASE_SECONDS", "1", 1);
+  setenv("GITGUD_DELIVERY_DEADLINE_MS", "500", 1);
+  setenv("GITGUD_WEBHOOK_MAX_PER_HOST", "0", 1);
+  SubscriptionManager manager(*mockDbManager);
+  unsetenv("GITGUD_OUTBOX_LEASE_SECONDS");
+  unsetenv("GITGUD_DELIVERY_DEADLINE_MS");
+  unsetenv("GITGUD_WEBHOOK_MAX_PER_HOST");
+
+  using bsoncxx::builder::basic::kvp;
+  using bsoncxx::builder::basic::make_document;
+  auto delivery = [](const char* id) {
+    return std::optional<bsoncxx::document::value>(make_document(
+        kvp("_id", bsoncxx::oid(id)), kvp("SubscriberId", "sub1"),
+        kvp("Contact", "https://hooks.example.org/x")));
+  };
+  int claimed = 0;
+  EXPECT_CALL(*mockDbManager,
+              findOneAndUpdate("NotificationOutbox", ::testing::_,
+                               ::testing::_))
+      .WillRepeatedly(
+          [&](const std::string&, const bsoncxx::document::view& filter,
+              const bsoncxx::document::view&) {
+            if (filter["Kind"].get_utf8().value == "delivery" &&
+                claimed < 2) {
+              return delivery(claimed++ == 0 ? "507f1f77bcf86cd799439011"
+                                             : "507f1f77bcf86cd799439012");
+            }
+            return std::optional<bsoncxx::document::value>();
+          });
+  // Recording the first outcome takes long enough for the lease to run out
+  // before the second delivery would finish.
+  std::vector<std::string> recorded;
+  EXPECT_CALL(*mockDbManager, updateDocument("NotificationOutbox",
+                                             ::testing::_, ::testing::_,
+                                             false))
+      .WillOnce([&](const std::string&, const bsoncxx::document::view& filter,
+                    const bsoncxx::document::view&, bool) {
+        recorded.push_back(filter["_id"].get_oid().value.to_string());
+        EXPECT_TRUE(filter["LeaseUntil"]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(800));
+        return true;
+      });
+
+  manager.flushNotifications();
+
+  EXPECT_EQ(recorded, std::vector<std::string>{"507f1f77bcf86cd799439011"});
+}
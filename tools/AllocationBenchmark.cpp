@@ -0,0 +1,188 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Counts heap allocations per request on the write path, from the raw body
+ * to the BSON document handed to the driver. Global operator new is
+ * replaced with a counting version, and the database is replaced with one
+ * that builds the insert document but does not send it anywhere.
+ *
+ * Rows:
+ *   parse/from_json  - the previous parse: bsoncxx::from_json and a walk
+ *                      copying every field out with get_utf8();
+ *   parse/scanner    - RequestBody, including its copy of the body;
+ *   add<Service>     - RequestBody plus the service's add path, including
+ *                      validation, createDBContent and the BSON build;
+ *   +arena           - the same, inside a RequestArena::Scope as the routes
+ *                      run it, so the parsed fields come from the arena.
+ *
+ * Usage: GitGudAllocationBenchmark [--iterations N]
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/json.hpp>
+
+#include "Counseling.h"
+#include "DatabaseManager.h"
+#include "Food.h"
+#include "Healthcare.h"
+#include "Outreach.h"
+#include "RequestArena.h"
+#include "RequestBody.h"
+#include "Shelter.h"
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> allocatedBytes{0};
+
+/**
+ * @brief Builds the insert document like the real DatabaseManager, without a
+ * server.
+ */
+class OfflineDatabaseManager : public DatabaseManager {
+ public:
+  OfflineDatabaseManager() : DatabaseManager("", true) {}
+
+  std::string insertResource(
+      const std::string& collectionName,
+      const std::vector<std::pair<std::string, std::string>>& keyValues)
+      override {
+    auto document = createDocument(keyValues);
+    return document.view().length() > 0 ? "507f191e810c19729de860ea" : "";
+  }
+};
+
+struct Count {
+  double allocations = 0;
+  double bytes = 0;
+};
+
+Count measure(int iterations, const std::function<void()>& request) {
+  request();
+  size_t startCount = allocations.load();
+  size_t startBytes = allocatedBytes.load();
+  for (int i = 0; i < iterations; ++i) {
+    request();
+  }
+  Count count;
+  count.allocations =
+      static_cast<double>(allocations.load() - startCount) / iterations;
+  count.bytes =
+      static_cast<double>(allocatedBytes.load() - startBytes) / iterations;
+  return count;
+}
+
+const char kShelterBody[] = R"({"Name": "Grace Community Shelter",
+  "City": "New York", "Address": "123 Amsterdam Ave",
+  "Description": "Emergency beds, meals and laundry.",
+  "ContactInfo": "(212) 555-0147", "HoursOfOperation": "24/7",
+  "ORG": "NGO", "TargetUser": "HML", "Capacity": "120",
+  "CurrentUse": "87"})";
+
+const char kFoodBody[] = R"({"Name": "Harlem Food Pantry", "City": "New York",
+  "Address": "55 W 125th St", "Description": "Canned goods and produce",
+  "ContactInfo": "(212) 555-0199", "HoursOfOperation": "9-17",
+  "TargetUser": "All", "Quantity": "300", "ExpirationDate": "2025-01-31"})";
+
+const char kHealthcareBody[] = R"({"Name": "Community Clinic",
+  "City": "New York", "Address": "10 Main St", "Description": "Primary care",
+  "ContactInfo": "(212) 555-0100", "HoursOfOperation": "8-20",
+  "eligibilityCriteria": "All Ages"})";
+
+const char kOutreachBody[] = R"({"Name": "Street Outreach", "City": "New York",
+  "Address": "1 Broadway", "Description": "Mobile support team",
+  "ContactInfo": "(212) 555-0111", "HoursOfOperation": "18-02",
+  "TargetAudience": "HML"})";
+
+const char kCounselingBody[] = R"({"Name": "Open Door Counseling",
+  "counselorName": "Dr. Rivera", "City": "New York", "Address": "2 Park Ave",
+  "Description": "Individual and group sessions",
+  "ContactInfo": "(212) 555-0122", "HoursOfOperation": "10-18"})";
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+  int iterations = 10000;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = std::atoi(argv[++i]);
+    }
+  }
+
+  OfflineDatabaseManager dbManager;
+  Shelter shelter(dbManager, "Shelter");
+  Food food(dbManager, "Food");
+  Healthcare healthcare(dbManager, "Healthcare");
+  Outreach outreach(dbManager, "Outreach");
+  Counseling counseling(dbManager, "Counseling");
+  const std::string token = "Bearer eyJhbGciOiJIUzI1NiJ9.benchmark.token";
+  const std::string shelterBody = kShelterBody;
+
+  const std::vector<std::pair<std::string, std::function<void()>>> rows = {
+      {"parse/from_json",
+       [&] {
+         std::vector<std::pair<std::string, std::string>> fields;
+         auto document = bsoncxx::from_json(shelterBody);
+         for (auto element : document.view()) {
+           fields.emplace_back(element.key().to_string(),
+                               element.get_utf8().value.to_string());
+         }
+       }},
+      {"parse/scanner", [&] { RequestBody body(shelterBody); }},
+      {"parse/scanner+arena",
+       [&] {
+         RequestArena::Scope arena;
+         RequestBody body(shelterBody);
+       }},
+      {"addShelter",
+       [&] { shelter.addShelter(RequestBody(shelterBody), token); }},
+      {"addShelter+arena",
+       [&] {
+         RequestArena::Scope arena;
+         shelter.addShelter(RequestBody(shelterBody), token);
+       }},
+      {"addFood", [&] { food.addFood(RequestBody(kFoodBody), token); }},
+      {"addHealthcareService",
+       [&] {
+         healthcare.addHealthcareService(RequestBody(kHealthcareBody), token);
+       }},
+      {"addOutreachService",
+       [&] {
+         outreach.addOutreachService(RequestBody(kOutreachBody), token);
+       }},
+      {"addCounselor",
+       [&] {
+         counseling.addCounselor(RequestBody(kCounselingBody), token);
+       }},
+  };
+
+  std::printf("%-24s %14s %14s\n", "stage", "allocs/req", "bytes/req");
+  for (const auto& [name, request] : rows) {
+    Count count = measure(iterations, request);
+    std::printf("%-24s %14.1f %14.0f\n", name.c_str(), count.allocations,
+                count.bytes);
+  }
+  return 0;
+}
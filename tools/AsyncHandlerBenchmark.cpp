@@ -0,0 +1,197 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Measures how many slow requests the server can keep in flight when the
+ * handlers run on Crow's workers and when they are deferred to the handler
+ * executor. The database is replaced with one that sleeps for --latency-ms
+ * on every query, standing in for a slow Mongo round trip, and each request
+ * runs Shelter::searchShelterAll against it.
+ *
+ *   inline   - the handler runs on one of --workers threads, as a plain
+ *              Crow route does; each worker is blocked for the whole query;
+ *   deferred - the workers only hand the request to an AsyncExecutor with
+ *              --handler-threads threads, as RouteController::dispatchAsync
+ *              does, and the response is completed from there.
+ *
+ * Clients are closed-loop: each of --concurrency clients sends its next
+ * request as soon as the previous response arrives, until --requests have
+ * completed. Prints requests/s and p50/p99 latency per mode and
+ * concurrency.
+ *
+ * Usage: GitGudAsyncHandlerBenchmark [--requests N] [--latency-ms L]
+ *            [--workers W] [--handler-threads T]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "AsyncExecutor.h"
+#include "DatabaseManager.h"
+#include "Shelter.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Answers every query with no documents after a fixed delay.
+ */
+class SlowDatabaseManager : public DatabaseManager {
+ public:
+  explicit SlowDatabaseManager(std::chrono::milliseconds latency)
+      : DatabaseManager("", true), latency(latency) {}
+
+  void findCollection(
+      int start, const std::string& collectionName,
+      const std::vector<std::pair<std::string, std::string>>& keyValues,
+      std::vector<bsoncxx::document::value>& result) override {
+    std::this_thread::sleep_for(latency);
+    result.clear();
+  }
+
+ private:
+  std::chrono::milliseconds latency;
+};
+
+struct Measurement {
+  double requestsPerSecond = 0;
+  double p50Ms = 0;
+  double p99Ms = 0;
+};
+
+/**
+ * @brief Drives closed-loop clients against a server. serve(done) must
+ * handle one request and eventually call done() from any thread.
+ */
+class LoadGenerator {
+ public:
+  using Server = std::function<void(std::function<void()>)>;
+
+  LoadGenerator(Server server, int requests)
+      : server(std::move(server)), remaining(requests) {
+    latencies.reserve(requests);
+  }
+
+  Measurement run(int concurrency) {
+    int total = remaining.load();
+    auto start = Clock::now();
+    for (int i = 0; i < concurrency; ++i) {
+      next();
+    }
+    finished.get_future().wait();
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    Measurement result;
+    result.requestsPerSecond = total / seconds;
+    result.p50Ms = latencies[latencies.size() / 2];
+    result.p99Ms = latencies[std::min(latencies.size() - 1,
+                                      latencies.size() * 99 / 100)];
+    return result;
+  }
+
+ private:
+  Server server;
+  std::atomic<int> remaining;
+  std::atomic<int> inFlight{0};
+  std::mutex latencyMutex;
+  std::vector<double> latencies;
+  std::promise<void> finished;
+
+  void next() {
+    if (remaining.fetch_sub(1) <= 0) {
+      return;
+    }
+    inFlight.fetch_add(1);
+    auto begin = Clock::now();
+    server([this, begin] {
+      {
+        std::lock_guard<std::mutex> lock(latencyMutex);
+        latencies.push_back(
+            std::chrono::duration<double, std::milli>(Clock::now() - begin)
+                .count());
+      }
+      next();
+      if (inFlight.fetch_sub(1) == 1 && remaining.load() <= 0) {
+        finished.set_value();
+      }
+    });
+  }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int requests = 4000;
+  int latencyMs = 20;
+  int workers = 4;
+  int handlerThreads = 64;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+      requests = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--latency-ms") == 0 && i + 1 < argc) {
+      latencyMs = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+      workers = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--handler-threads") == 0 &&
+               i + 1 < argc) {
+      handlerThreads = std::atoi(argv[++i]);
+    }
+  }
+
+  SlowDatabaseManager dbManager{std::chrono::milliseconds(latencyMs)};
+  Shelter shelter(dbManager, "ShelterBenchmark");
+  auto handle = [&shelter] { return shelter.searchShelterAll(); };
+
+  std::printf("%-9s %12s %14s %10s %10s\n", "mode", "concurrency",
+              "requests/s", "p50 ms", "p99 ms");
+  for (int concurrency : {16, 128, 1024}) {
+    size_t queue = static_cast<size_t>(concurrency) + 1;
+    {
+      AsyncExecutor crowWorkers(workers, queue);
+      LoadGenerator load(
+          [&](std::function<void()> done) {
+            crowWorkers.post([&handle, done] {
+              handle();
+              done();
+            });
+          },
+          requests);
+      Measurement result = load.run(concurrency);
+      std::printf("%-9s %12d %14.0f %10.1f %10.1f\n", "inline", concurrency,
+                  result.requestsPerSecond, result.p50Ms, result.p99Ms);
+    }
+    {
+      AsyncExecutor crowWorkers(workers, queue);
+      AsyncExecutor handlerExecutor(handlerThreads, queue);
+      LoadGenerator load(
+          [&](std::function<void()> done) {
+            crowWorkers.post([&handlerExecutor, &handle, done] {
+              handlerExecutor.post([&handle, done] {
+                handle();
+                done();
+              });
+            });
+          },
+          requests);
+      Measurement result = load.run(concurrency);
+      std::printf("%-9s %12d %14.0f %10.1f %10.1f\n", "deferred",
+                  concurrency, result.requestsPerSecond, result.p50Ms,
+                  result.p99Ms);
+    }
+  }
+  return 0;
+}
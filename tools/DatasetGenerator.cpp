@@ -0,0 +1,469 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Bulk-loads a synthetic, deterministic dataset into a local MongoDB so that
+ * findCollection, getSubscribers and findUserByEmail can be benchmarked at
+ * realistic scale.
+ *
+ * Every batch is generated from its own RNG seeded by (seed, collection,
+ * batch index), so the output only depends on the command line and not on
+ * how the worker threads get scheduled.
+ */
+
+#include <bcrypt/bcrypt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <mongocxx/client.hpp>
+#include <mongocxx/instance.hpp>
+#include <mongocxx/options/insert.hpp>
+#include <mongocxx/pool.hpp>
+#include <mongocxx/uri.hpp>
+
+using bsoncxx::builder::basic::kvp;
+
+namespace {
+
+struct Options {
+  std::string uri = "mongodb://localhost:27017";
+  std::string database = "GitGud";
+  uint64_t seed = 4156;
+  int64_t resourcesPerService = 2000000;
+  int64_t users = 100000;
+  int64_t subscribers = 500000;
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  int batchSize = 1000;
+  int bcryptCost = 4;
+  bool drop = false;
+};
+
+const std::vector<std::string> kCities = {
+    "New York",     "Los Angeles",   "Chicago",      "Houston",
+    "Phoenix",      "Philadelphia",  "San Antonio",  "San Diego",
+    "Dallas",       "San Jose",      "Austin",       "Jacksonville",
+    "Fort Worth",   "Columbus",      "Charlotte",    "San Francisco",
+    "Indianapolis", "Seattle",       "Denver",       "Washington",
+    "Boston",       "El Paso",       "Nashville",    "Detroit",
+    "Oklahoma City", "Portland",     "Las Vegas",    "Memphis",
+    "Louisville",   "Baltimore",     "Milwaukee",    "Albuquerque",
+    "Tucson",       "Fresno",        "Sacramento",   "Kansas City",
+    "Mesa",         "Atlanta",       "Omaha",        "Colorado Springs",
+    "Raleigh",      "Long Beach",    "Virginia Beach", "Miami",
+    "Oakland",      "Minneapolis",   "Tulsa",        "Bakersfield",
+    "Wichita",      "Arlington"};
+
+const std::vector<std::string> kStreets = {
+    "Broadway", "Main St",   "Oak Ave",     "Maple St",   "Cedar Rd",
+    "Elm St",   "Pine Ave",  "Washington Blvd", "Lake Dr", "Hill St",
+    "Park Ave", "River Rd",  "Church St",   "Market St",  "Union Sq"};
+
+const std::vector<std::string> kNameWords = {
+    "Hope",    "Harbor",   "Bridge",   "Community", "Unity",  "Haven",
+    "Beacon",  "Mercy",    "Grace",    "Pathways",  "Compass", "Anchor",
+    "Open Door", "Second Chance", "New Start", "Good Neighbor", "Lighthouse",
+    "Crossroads", "Safe Place", "Helping Hands"};
+
+const std::vector<std::string> kTargetUsers = {"HML", "RFG", "VET", "SUB"};
+const std::vector<std::string> kOrgs = {"NGO", "VOL", "CLN", "GOV"};
+const std::vector<std::string> kRoles = {"HML", "RFG", "VET", "SUB",
+                                         "NGO", "VOL", "CLN", "GOV"};
+const std::vector<std::string> kResources = {"shelter", "food", "healthcare",
+                                             "outreach", "counseling"};
+const std::vector<std::string> kHours = {"24/7", "9 AM - 5 PM",
+                                         "8 AM - 8 PM", "Mon-Fri 10 AM - 4 PM",
+                                         "Weekends 12 PM - 6 PM"};
+
+/**
+ * @brief splitmix64 step, used to derive independent per-batch seeds.
+ */
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * @brief FNV-1a; std::hash is not stable across standard libraries.
+ */
+uint64_t fnv1a(const std::string &text) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : text) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Samples city indices from a Zipf distribution so that a few large
+ * cities receive most of the resources and subscribers.
+ */
+class ZipfCities {
+ public:
+  explicit ZipfCities(double exponent) {
+    double total = 0;
+    for (size_t i = 0; i < kCities.size(); ++i) {
+      total += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+      cdf.push_back(total);
+    }
+    for (auto &value : cdf) {
+      value /= total;
+    }
+  }
+
+  const std::string &sample(std::mt19937_64 &rng) const {
+    double u = static_cast<double>(rng() >> 11) * 0x1.0p-53;
+    size_t index = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    return kCities[std::min(index, kCities.size() - 1)];
+  }
+
+ private:
+  std::vector<double> cdf;
+};
+
+const ZipfCities &cities() {
+  static ZipfCities instance(1.1);
+  return instance;
+}
+
+template <typename T>
+const T &pick(const std::vector<T> &values, std::mt19937_64 &rng) {
+  return values[rng() % values.size()];
+}
+
+// std::uniform_*_distribution differ between standard libraries, so ranges
+// are mapped by hand to keep datasets identical on Linux and macOS.
+int64_t between(std::mt19937_64 &rng, int64_t low, int64_t high) {
+  uint64_t span = static_cast<uint64_t>(high - low + 1);
+  return low + static_cast<int64_t>(rng() % span);
+}
+
+std::string number(std::mt19937_64 &rng, int low, int high) {
+  return std::to_string(between(rng, low, high));
+}
+
+std::string address(std::mt19937_64 &rng) {
+  std::string house = number(rng, 1, 9999);
+  return house + " " + pick(kStreets, rng);
+}
+
+std::string phone(std::mt19937_64 &rng) {
+  std::string area = number(rng, 200, 999);
+  std::string exchange = number(rng, 200, 999);
+  return area + "-" + exchange + "-" + number(rng, 1000, 9999);
+}
+
+std::string orgName(std::mt19937_64 &rng) {
+  std::string first = pick(kNameWords, rng);
+  return first + " " + pick(kNameWords, rng);
+}
+
+std::string date(std::mt19937_64 &rng) {
+  std::string month = number(rng, 10, 12);
+  return "2025-" + month + "-" + number(rng, 10, 28);
+}
+
+std::string authToken(std::mt19937_64 &rng) {
+  return "Bearer generated-org-" + number(rng, 1, 5000);
+}
+
+using DocumentFactory =
+    std::function<bsoncxx::document::value(int64_t, std::mt19937_64 &)>;
+
+// Fields are appended one statement at a time: the order in which function
+// arguments are evaluated is unspecified, which would make the RNG draws
+// compiler-dependent.
+bsoncxx::document::value makeShelter(int64_t, std::mt19937_64 &rng) {
+  bsoncxx::builder::basic::document doc;
+  doc.append(kvp("Name", orgName(rng) + " Shelter"));
+  doc.append(kvp("City", cities().sample(rng)));
+  doc.append(kvp("Address", address(rng)));
+  doc.append(kvp("Description", "Emergency and transitional beds"));
+  doc.append(kvp("ContactInfo", phone(rng)));
+  doc.append(kvp("HoursOfOperation", pick(kHours, rng)));
+  doc.append(kvp("ORG", pick(kOrgs, rng)));
+  doc.append(kvp("TargetUser", pick(kTargetUsers, rng)));
+  int64_t capacity = between(rng, 10, 500);
+  int64_t current = between(rng, 0, capacity);
+  doc.append(kvp("Capacity", std::to_string(capacity)));
+  doc.append(kvp("CurrentUse", std::to_string(current)));
+  doc.append(kvp("authToken", authToken(rng)));
+  return doc.extract();
+}
+
+bsoncxx::document::value makeFood(int64_t, std::mt19937_64 &rng) {
+  bsoncxx::builder::basic::document doc;
+  doc.append(kvp("Name", orgName(rng) + " Pantry"));
+  doc.append(kvp("City", cities().sample(rng)));
+  doc.append(kvp("Address", address(rng)));
+  doc.append(kvp("Description", "Canned goods"));
+  doc.append(kvp("ContactInfo", phone(rng)));
+  doc.append(kvp("HoursOfOperation", pick(kHours, rng)));
+  doc.append(kvp("TargetUser", pick(kTargetUsers, rng)));
+  doc.append(kvp("Quantity", number(rng, 1, 1000)));
+  doc.append(kvp("ExpirationDate", date(rng)));
+  doc.append(kvp("authToken", authToken(rng)));
+  return doc.extract();
+}
+
+bsoncxx::document::value makeHealthcare(int64_t, std::mt19937_64 &rng) {
+  bsoncxx::builder::basic::document doc;
+  doc.append(kvp("Name", orgName(rng) + " Clinic"));
+  doc.append(kvp("City", cities().sample(rng)));
+  doc.append(kvp("Address", address(rng)));
+  doc.append(kvp("Description", "General Checkup"));
+  doc.append(kvp("ContactInfo", phone(rng)));
+  doc.append(kvp("HoursOfOperation", pick(kHours, rng)));
+  doc.append(kvp("eligibilityCriteria", pick(kTargetUsers, rng)));
+  doc.append(kvp("authToken", authToken(rng)));
+  return doc.extract();
+}
+
+bsoncxx::document::value makeOutreach(int64_t, std::mt19937_64 &rng) {
+  bsoncxx::builder::basic::document doc;
+  doc.append(kvp("Name", orgName(rng) + " Outreach"));
+  doc.append(kvp("City", cities().sample(rng)));
+  doc.append(kvp("Address", address(rng)));
+  doc.append(kvp("Description", "Street outreach and case management"));
+  doc.append(kvp("ContactInfo", phone(rng)));
+  doc.append(kvp("HoursOfOperation", pick(kHours, rng)));
+  doc.append(kvp("TargetAudience", pick(kTargetUsers, rng)));
+  doc.append(kvp("authToken", authToken(rng)));
+  return doc.extract();
+}
+
+bsoncxx::document::value makeCounseling(int64_t, std::mt19937_64 &rng) {
+  bsoncxx::builder::basic::document doc;
+  doc.append(kvp("Name", orgName(rng) + " Counseling"));
+  doc.append(kvp("counselorName", "Counselor " + number(rng, 1, 100000)));
+  doc.append(kvp("City", cities().sample(rng)));
+  doc.append(kvp("Address", address(rng)));
+  doc.append(kvp("Description", "Individual and group therapy"));
+  doc.append(kvp("ContactInfo", phone(rng)));
+  doc.append(kvp("HoursOfOperation", pick(kHours, rng)));
+  doc.append(kvp("authToken", authToken(rng)));
+  return doc.extract();
+}
+
+bsoncxx::document::value makeSubscriber(int64_t, std::mt19937_64 &rng) {
+  bsoncxx::builder::basic::document doc;
+  doc.append(kvp("Resource", pick(kResources, rng)));
+  doc.append(kvp("City", cities().sample(rng)));
+  if (rng() % 5 == 0) {
+    doc.append(kvp("Contact", "https://hooks.example.org/gitgud/" +
+                                  number(rng, 1, 1000000)));
+  } else {
+    doc.append(kvp("Contact", "subscriber" + number(rng, 1, 100000000) +
+                                  "@example.org"));
+  }
+  return doc.extract();
+}
+
+/**
+ * @brief Builds a bcrypt salt from the RNG instead of /dev/urandom so that
+ * password hashes are reproducible for a given seed.
+ */
+std::string deterministicSalt(std::mt19937_64 &rng, int cost) {
+  static const char kAlphabet[] =
+      "./ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+  char prefix[8];
+  std::snprintf(prefix, sizeof(prefix), "$2a$%02d$", cost);
+  std::string salt(prefix);
+  for (int i = 0; i < 21; ++i) {
+    salt += kAlphabet[rng() % 64];
+  }
+  // Only 128 of the 132 encoded bits are used; keep the unused ones zero.
+  salt += kAlphabet[(rng() % 4) * 16];
+  return salt;
+}
+
+/**
+ * @brief Users get the password "Passw0rd<index>" so that login benchmarks
+ * can authenticate as any generated user.
+ */
+DocumentFactory userFactory(int cost) {
+  return [cost](int64_t index, std::mt19937_64 &rng) {
+    std::string password = "Passw0rd" + std::to_string(index);
+    std::string salt = deterministicSalt(rng, cost);
+    char hash[BCRYPT_HASHSIZE];
+    if (bcrypt_hashpw(password.c_str(), salt.c_str(), hash) != 0) {
+      throw std::runtime_error("bcrypt_hashpw failed for user " +
+                               std::to_string(index));
+    }
+    bsoncxx::builder::basic::document doc;
+    doc.append(kvp("email", "user" + std::to_string(index) + "@gitgud.test"));
+    doc.append(kvp("passwordHash", std::string(hash)));
+    doc.append(kvp("role", pick(kRoles, rng)));
+    doc.append(kvp("createdAt", std::to_string(1730000000 + index)));
+    return doc.extract();
+  };
+}
+
+/**
+ * @brief Generates `count` documents for one collection and writes them with
+ * unordered insert_many calls spread across the worker threads.
+ */
+void load(mongocxx::pool &pool, const Options &options,
+          const std::string &collectionName, int64_t count,
+          const DocumentFactory &factory) {
+  if (count <= 0) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  int64_t batches = (count + options.batchSize - 1) / options.batchSize;
+  uint64_t collectionSeed =
+      mix(options.seed ^ fnv1a(collectionName));
+  std::atomic<int64_t> nextBatch{0};
+  std::atomic<int64_t> written{0};
+
+  if (options.drop) {
+    auto client = pool.acquire();
+    (*client)[options.database][collectionName].drop();
+  }
+
+  auto worker = [&]() {
+    auto client = pool.acquire();
+    auto collection = (*client)[options.database][collectionName];
+    mongocxx::options::insert insertOptions;
+    insertOptions.ordered(false);
+
+    std::vector<bsoncxx::document::value> docs;
+    docs.reserve(options.batchSize);
+    for (int64_t batch = nextBatch++; batch < batches; batch = nextBatch++) {
+      std::mt19937_64 rng(mix(collectionSeed + static_cast<uint64_t>(batch)));
+      int64_t first = batch * options.batchSize;
+      int64_t last = std::min(count, first + options.batchSize);
+      docs.clear();
+      for (int64_t i = first; i < last; ++i) {
+        docs.push_back(factory(i, rng));
+      }
+      collection.insert_many(docs, insertOptions);
+      written += static_cast<int64_t>(docs.size());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < std::max(1, options.threads); ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::cout << collectionName << ": " << written.load() << " documents in "
+            << seconds << "s (" << static_cast<int64_t>(written / seconds)
+            << " docs/s)" << std::endl;
+}
+
+void usage() {
+  std::cout
+      << "Usage: GitGudDatasetGenerator [options]\n"
+         "  --uri <uri>              MongoDB URI (mongodb://localhost:27017)\n"
+         "  --db <name>              Database name (GitGud)\n"
+         "  --seed <n>               RNG seed (4156)\n"
+         "  --resources <n>          Documents per resource service (2000000)\n"
+         "  --users <n>              Users with bcrypt hashes (100000)\n"
+         "  --subscribers <n>        Subscribers (500000)\n"
+         "  --threads <n>            Writer threads (hardware concurrency)\n"
+         "  --batch <n>              Documents per insert_many (1000)\n"
+         "  --bcrypt-cost <n>        bcrypt work factor for users (4)\n"
+         "  --drop                   Drop target collections first\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto next = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("Missing value for " + arg);
+      }
+      return argv[++i];
+    };
+    if (arg == "--uri") {
+      options.uri = next();
+    } else if (arg == "--db") {
+      options.database = next();
+    } else if (arg == "--seed") {
+      options.seed = std::stoull(next());
+    } else if (arg == "--resources") {
+      options.resourcesPerService = std::stoll(next());
+    } else if (arg == "--users") {
+      options.users = std::stoll(next());
+    } else if (arg == "--subscribers") {
+      options.subscribers = std::stoll(next());
+    } else if (arg == "--threads") {
+      options.threads = std::stoi(next());
+    } else if (arg == "--batch") {
+      options.batchSize = std::max(1, std::stoi(next()));
+    } else if (arg == "--bcrypt-cost") {
+      options.bcryptCost = std::min(31, std::max(4, std::stoi(next())));
+    } else if (arg == "--drop") {
+      options.drop = true;
+    } else {
+      usage();
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+/**
+ *  Generates the dataset into the collections used by main.cpp
+ */
+int main(int argc, char *argv[]) {
+  Options options;
+  try {
+    if (!parseOptions(argc, argv, options)) {
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    usage();
+    return 1;
+  }
+
+  mongocxx::instance instance{};
+  std::string poolUri = options.uri;
+  if (poolUri.find('?') != std::string::npos) {
+    poolUri += "&";
+  } else {
+    poolUri += (poolUri.back() == '/') ? "?" : "/?";
+  }
+  poolUri += "maxPoolSize=" + std::to_string(std::max(1, options.threads));
+  mongocxx::pool pool{mongocxx::uri{poolUri}};
+
+  load(pool, options, "ShelterService", options.resourcesPerService,
+       makeShelter);
+  load(pool, options, "Food", options.resourcesPerService, makeFood);
+  load(pool, options, "HealthcareService", options.resourcesPerService,
+       makeHealthcare);
+  load(pool, options, "OutreachService", options.resourcesPerService,
+       makeOutreach);
+  load(pool, options, "CounselingService", options.resourcesPerService,
+       makeCounseling);
+  load(pool, options, "Subscribers", options.subscribers, makeSubscriber);
+  load(pool, options, "Users", options.users,
+       userFactory(options.bcryptCost));
+  return 0;
+}
@@ -0,0 +1,136 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Measures insertResource throughput under concurrent inserts against a
+ * local MongoDB, with and without group commit. --threads writers each
+ * insert shelter-sized documents into a scratch collection, first with
+ * one insert_one per call and then with InsertBatcher collecting inserts
+ * for --window-us microseconds or up to --max-batch documents. Prints
+ * inserts/s, p50/p99 latency per insert and the average batch size. The
+ * scratch collection is dropped afterwards.
+ *
+ * Usage: GitGudInsertBatchBenchmark [--uri URI] [--threads T]
+ *            [--inserts N] [--window-us W] [--max-batch B]
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <mongocxx/instance.hpp>
+
+#include "DatabaseManager.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char kCollection[] = "InsertBatchBenchmark";
+
+struct Measurement {
+  double insertsPerSecond = 0;
+  double p50Us = 0;
+  double p99Us = 0;
+};
+
+std::vector<std::pair<std::string, std::string>> shelter(int thread, int i) {
+  return {{"Name", "Shelter " + std::to_string(thread) + "-" +
+                       std::to_string(i)},
+          {"City", "New York"},
+          {"Address", "123 Amsterdam Ave"},
+          {"Description", "Emergency beds, meals and laundry."},
+          {"ContactInfo", "(212) 555-0147"},
+          {"HoursOfOperation", "24/7"},
+          {"ORG", "NGO"},
+          {"TargetUser", "HML"},
+          {"Capacity", "120"},
+          {"CurrentUse", "87"}};
+}
+
+Measurement run(DatabaseManager& dbManager, int threads, int inserts) {
+  std::vector<std::vector<double>> latencies(threads);
+  std::vector<std::thread> writers;
+  auto start = Clock::now();
+  for (int t = 0; t < threads; ++t) {
+    writers.emplace_back([&, t] {
+      for (int i = t; i < inserts; i += threads) {
+        auto document = shelter(t, i);
+        auto begin = Clock::now();
+        dbManager.insertResource(kCollection, document);
+        latencies[t].push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - begin)
+                .count());
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> all;
+  for (auto& mine : latencies) {
+    all.insert(all.end(), mine.begin(), mine.end());
+  }
+  std::sort(all.begin(), all.end());
+  Measurement result;
+  result.insertsPerSecond = inserts / seconds;
+  result.p50Us = all[all.size() / 2];
+  result.p99Us = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string uri = "mongodb://localhost:27017";
+  int threads = 64;
+  int inserts = 20000;
+  int windowUs = 500;
+  int maxBatch = 64;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--uri") == 0 && i + 1 < argc) {
+      uri = argv[++i];
+    } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--inserts") == 0 && i + 1 < argc) {
+      inserts = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--window-us") == 0 && i + 1 < argc) {
+      windowUs = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+      maxBatch = std::atoi(argv[++i]);
+    }
+  }
+  threads = std::max(1, threads);
+
+  mongocxx::instance instance{};
+  std::printf("%-9s %8s %12s %10s %10s %10s\n", "mode", "threads",
+              "inserts/s", "p50 us", "p99 us", "batch");
+  {
+    DatabaseManager dbManager(uri);
+    Measurement result = run(dbManager, threads, inserts);
+    std::printf("%-9s %8d %12.0f %10.1f %10.1f %10d\n", "single", threads,
+                result.insertsPerSecond, result.p50Us, result.p99Us, 1);
+  }
+  {
+    DatabaseManager dbManager(uri);
+    dbManager.enableInsertBatching(std::chrono::microseconds(windowUs),
+                                   maxBatch);
+    Measurement result = run(dbManager, threads, inserts);
+    InsertBatcher::Stats stats = dbManager.insertBatchStats();
+    std::printf("%-9s %8d %12.0f %10.1f %10.1f %10.1f\n", "batched",
+                threads, result.insertsPerSecond, result.p50Us, result.p99Us,
+                stats.batches == 0 ? 0.0
+                                   : static_cast<double>(stats.documents) /
+                                         static_cast<double>(stats.batches));
+    dbManager.deleteCollection(kCollection);
+  }
+  return 0;
+}
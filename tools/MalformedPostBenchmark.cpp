@@ -0,0 +1,151 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Measures what a flood of malformed POST bodies costs the shelter service.
+ * Every body is rejected during validation, so the database is never used.
+ *
+ * Two paths are compared on the same bodies and the same validation code:
+ *   result     - Shelter::addShelter, which returns an Error value, and the
+ *                route's ok() check;
+ *   exceptions - the previous control flow: the validation failure is thrown
+ *                as std::invalid_argument, caught and turned into an
+ *                "Error: ..." string that the route then searches for
+ *                "Error".
+ * Each path is run with 1 thread and with --threads threads, because the
+ * cost of unwinding grows when many threads throw at once.
+ *
+ * Usage: GitGudMalformedPostBenchmark [--requests N] [--threads T]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "DatabaseManager.h"
+#include "Shelter.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::vector<std::string> kMalformedBodies = {
+    R"({"Name": "temp", "City": "New York")",
+    R"({"Name": "temp", "Unexpected": "x"})",
+    R"({"Name": "temp", "City": "New York", "Capacity": "100"})",
+    R"({"Name": "temp", "City": "New York", "Address": "temp",
+        "Description": "NULL", "ContactInfo": "66664566565",
+        "HoursOfOperation": "2024-01-11", "ORG": "NGO", "TargetUser": "HML",
+        "Capacity": "10", "CurrentUse": "50"})",
+    R"({"Name": "temp", "Capacity": 100})",
+};
+
+// Returns true if the request was rejected, as the route would see it.
+using Path = std::function<bool(Shelter&, const RequestBody&)>;
+
+bool viaResult(Shelter& shelter, const RequestBody& body) {
+  auto result = shelter.addShelter(body, "token");
+  return !result.ok();
+}
+
+bool viaExceptions(Shelter& shelter, const RequestBody& body) {
+  std::string response;
+  try {
+    Shelter::Fields fields;
+    auto checked = shelter.checkInputFormat(body, "token", fields);
+    if (!checked.ok()) {
+      throw std::invalid_argument(checked.error().message);
+    }
+    response = checked.value();
+  } catch (const std::exception& e) {
+    response = "Error: " + std::string(e.what());
+  }
+  return response.find("Error") != std::string::npos;
+}
+
+struct Measurement {
+  double requestsPerSecond = 0;
+  double p50Us = 0;
+  double p99Us = 0;
+};
+
+Measurement run(const Path& path, int threads, int requests) {
+  std::vector<std::vector<double>> latencies(threads);
+  std::atomic<int> rejected{0};
+  std::vector<std::thread> workers;
+  auto start = Clock::now();
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      DatabaseManager dbManager("", true);
+      Shelter shelter(dbManager, "ShelterBenchmark");
+      std::vector<RequestBody> bodies(kMalformedBodies.begin(),
+                                      kMalformedBodies.end());
+      auto& mine = latencies[t];
+      mine.reserve(requests / threads + 1);
+      for (int i = t; i < requests; i += threads) {
+        auto begin = Clock::now();
+        if (path(shelter, bodies[i % bodies.size()])) {
+          rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        mine.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - begin)
+                .count());
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  if (rejected.load() != requests) {
+    std::fprintf(stderr, "expected every request to be rejected\n");
+    std::exit(1);
+  }
+
+  std::vector<double> all;
+  for (auto& mine : latencies) {
+    all.insert(all.end(), mine.begin(), mine.end());
+  }
+  std::sort(all.begin(), all.end());
+  Measurement result;
+  result.requestsPerSecond = requests / seconds;
+  result.p50Us = all[all.size() / 2];
+  result.p99Us = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int requests = 200000;
+  int threads = static_cast<int>(std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+      requests = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = std::atoi(argv[++i]);
+    }
+  }
+  threads = std::max(1, threads);
+
+  std::printf("%-11s %8s %14s %10s %10s\n", "path", "threads", "requests/s",
+              "p50 us", "p99 us");
+  for (int count : {1, threads}) {
+    for (const auto& [name, path] : std::vector<std::pair<std::string, Path>>{
+             {"result", viaResult}, {"exceptions", viaExceptions}}) {
+      Measurement result = run(path, count, requests);
+      std::printf("%-11s %8d %14.0f %10.2f %10.2f\n", name.c_str(), count,
+                  result.requestsPerSecond, result.p50Us, result.p99Us);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Compares the two ways a request body can be ingested: the old path, which
+ * builds a BSON document with bsoncxx::from_json and walks it with
+ * get_utf8(), and RequestBody, which scans the JSON text directly into
+ * (key, value) pairs. Reports throughput and per-request latency
+ * percentiles for a realistic shelter body and for bodies with large
+ * free-text fields.
+ *
+ * Usage: GitGudRequestBodyBenchmark [--iterations N]
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/json.hpp>
+
+#include "RequestBody.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Fields = std::vector<std::pair<std::string, std::string>>;
+
+struct Result {
+  double megabytesPerSecond = 0;
+  double p50Us = 0;
+  double p99Us = 0;
+};
+
+std::string shelterBody() {
+  return R"({
+    "ORG": "Grace Community Shelter",
+    "User": "HML",
+    "location": "123 Amsterdam Ave, New York, NY 10027",
+    "City": "New York",
+    "Capacity": "120",
+    "CurrentUse": "87",
+    "description": "Emergency beds, meals and laundry. Walk-ins welcome.",
+    "Contact": "(212) 555-0147"
+  })";
+}
+
+std::string largeBody(size_t descriptionBytes) {
+  std::string description;
+  description.reserve(descriptionBytes);
+  const std::string sentence =
+      "Open daily for families and veterans, caf\\u00e9 on site. ";
+  while (description.size() < descriptionBytes) {
+    description += sentence;
+  }
+  return R"({"ORG": "Citywide Outreach", "City": "Chicago", "description": ")" +
+         description + R"(", "Contact": "outreach@example.org"})";
+}
+
+Fields viaBson(const std::string& body) {
+  Fields fields;
+  auto document = bsoncxx::from_json(body);
+  for (auto element : document.view()) {
+    fields.emplace_back(element.key().to_string(),
+                        element.get_utf8().value.to_string());
+  }
+  return fields;
+}
+
+Fields viaScanner(const std::string& body) {
+  RequestBody parsed(body);
+  if (!parsed.valid()) {
+    std::fprintf(stderr, "scan failed: %s\n", parsed.error().c_str());
+    std::exit(1);
+  }
+  return Fields(parsed.fields().begin(), parsed.fields().end());
+}
+
+Result measure(const std::string& body, int iterations,
+               const std::function<Fields(const std::string&)>& ingest) {
+  std::vector<double> latencies;
+  latencies.reserve(iterations);
+  size_t checksum = 0;
+  for (int i = 0; i < iterations / 10 + 1; ++i) {
+    checksum += ingest(body).size();
+  }
+  auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    auto begin = Clock::now();
+    checksum += ingest(body).size();
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(Clock::now() - begin)
+            .count());
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  if (checksum == 0) {
+    std::printf("(empty result)\n");
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  Result result;
+  result.megabytesPerSecond =
+      static_cast<double>(body.size()) * iterations / seconds / 1e6;
+  result.p50Us = latencies[latencies.size() / 2];
+  result.p99Us = latencies[std::min(latencies.size() - 1,
+                                    latencies.size() * 99 / 100)];
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = 20000;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = std::atoi(argv[++i]);
+    }
+  }
+
+  const std::vector<std::pair<std::string, std::string>> cases = {
+      {"shelter", shelterBody()},
+      {"16 KiB", largeBody(16 * 1024)},
+      {"1 MiB", largeBody(1024 * 1024)},
+  };
+
+  std::printf("%-8s %10s %-10s %10s %10s %10s\n", "body", "bytes", "path",
+              "MB/s", "p50 us", "p99 us");
+  for (const auto& [name, body] : cases) {
+    if (viaBson(body) != viaScanner(body)) {
+      std::fprintf(stderr, "%s: paths disagree\n", name.c_str());
+      return 1;
+    }
+    int runs = std::max(10, iterations / static_cast<int>(
+                                             1 + body.size() / 4096));
+    for (const auto& [path, ingest] :
+         std::vector<std::pair<std::string,
+                               std::function<Fields(const std::string&)>>>{
+             {"bson", viaBson}, {"scanner", viaScanner}}) {
+      Result result = measure(body, runs, ingest);
+      std::printf("%-8s %10zu %-10s %10.1f %10.2f %10.2f\n", name.c_str(),
+                  body.size(), path.c_str(), result.megabytesPerSecond,
+                  result.p50Us, result.p99Us);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,449 @@
+// Copyright 2024 COMSW4156-Git-Gud
+
+/*
+ * Runs a steady mixed workload against a running GitGud server for hours and
+ * samples the server process over time: resident memory, open file
+ * descriptors, thread count, MongoDB connection count and request latency
+ * percentiles. At the end every series is checked for monotonic growth, which
+ * is what a leak looks like over a long run.
+ *
+ * Exit code is 0 when no drift was detected, 2 when at least one series kept
+ * growing, so the harness can gate nightly runs.
+ */
+
+#include <curl/curl.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <mongocxx/client.hpp>
+#include <mongocxx/instance.hpp>
+#include <mongocxx/uri.hpp>
+
+namespace {
+
+struct Options {
+  std::string url = "http://localhost:8080";
+  std::string mongoUri = "mongodb://localhost:27017";
+  std::string readToken;
+  std::string writeToken;
+  std::string csvPath = "soak.csv";
+  int pid = 0;
+  int concurrency = 16;
+  int64_t durationSeconds = 4 * 3600;
+  int64_t intervalSeconds = 60;
+  double writeRatio = 0.1;
+  double loginRatio = 0.05;
+};
+
+struct Sample {
+  double elapsedSeconds = 0;
+  double rssKb = 0;
+  double openFds = 0;
+  double threads = 0;
+  double mongoConnections = 0;
+  double p50Ms = 0;
+  double p99Ms = 0;
+  double requestsPerSecond = 0;
+  double errorRate = 0;
+};
+
+/**
+ * @brief Collects request latencies between two samples.
+ */
+class LatencyRecorder {
+ public:
+  void record(double millis, bool ok) {
+    std::lock_guard<std::mutex> lock(mutex);
+    latencies.push_back(millis);
+    if (!ok) {
+      ++errors;
+    }
+  }
+
+  /**
+   * @brief Returns (p50, p99, count, errors) and starts a new interval.
+   */
+  std::tuple<double, double, size_t, size_t> drain() {
+    std::vector<double> current;
+    size_t failed;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      current.swap(latencies);
+      failed = errors;
+      errors = 0;
+    }
+    if (current.empty()) {
+      return {0, 0, 0, failed};
+    }
+    std::sort(current.begin(), current.end());
+    auto at = [&](double q) {
+      return current[std::min(current.size() - 1,
+                              static_cast<size_t>(q * current.size()))];
+    };
+    return {at(0.50), at(0.99), current.size(), failed};
+  }
+
+ private:
+  std::mutex mutex;
+  std::vector<double> latencies;
+  size_t errors = 0;
+};
+
+/**
+ * @brief Reads a "Key:   value kB" style entry from /proc/<pid>/status.
+ */
+double procStatusValue(int pid, const std::string &key) {
+  std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, key.size() + 1, key + ":") == 0) {
+      std::istringstream fields(line.substr(key.size() + 1));
+      double value = 0;
+      fields >> value;
+      return value;
+    }
+  }
+  return -1;
+}
+
+double openFileDescriptors(int pid) {
+  std::string path = "/proc/" + std::to_string(pid) + "/fd";
+  DIR *dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return -1;
+  }
+  double count = 0;
+  while (struct dirent *entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      ++count;
+    }
+  }
+  closedir(dir);
+  return count;
+}
+
+double mongoConnections(mongocxx::client &client) {
+  try {
+    using bsoncxx::builder::basic::kvp;
+    auto status = client["admin"].run_command(
+        bsoncxx::builder::basic::make_document(kvp("serverStatus", 1)));
+    auto current = status.view()["connections"]["current"];
+    if (current.type() == bsoncxx::type::k_int32) {
+      return current.get_int32().value;
+    }
+    return static_cast<double>(current.get_int64().value);
+  } catch (const std::exception &e) {
+    std::cerr << "serverStatus failed: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+size_t discardBody(char *, size_t size, size_t count, void *) {
+  return size * count;
+}
+
+const std::vector<std::string> kReadRoutes = {
+    "/resources/shelter/getAll", "/resources/food/getAll",
+    "/resources/healthcare/getAll", "/resources/outreach/getAll",
+    "/resources/counseling/getAll"};
+
+std::string foodBody(std::mt19937_64 &rng) {
+  return R"({"Name":"Soak Pantry )" + std::to_string(rng() % 100000) +
+         R"(","City":"Soak City","Address":"1 Main St",)"
+         R"("Description":"Canned goods","ContactInfo":"555-0100",)"
+         R"("HoursOfOperation":"24/7","TargetUser":"HML",)"
+         R"("Quantity":"10","ExpirationDate":"2030-01-01"})";
+}
+
+/**
+ * @brief One worker: keeps a single curl handle (so the harness itself does
+ * not leak connections) and issues requests until `stop` is set.
+ */
+void runWorker(const Options &options, int index, std::atomic<bool> &stop,
+               LatencyRecorder &recorder) {
+  CURL *curl = curl_easy_init();
+  if (curl == nullptr) {
+    std::cerr << "curl_easy_init failed" << std::endl;
+    return;
+  }
+  std::mt19937_64 rng(4156 + index);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+  while (!stop) {
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 30000L);
+    curl_slist *headers = nullptr;
+    std::string body;
+
+    double draw = coin(rng);
+    std::string url;
+    if (draw < options.loginRatio) {
+      // Users generated by GitGudDatasetGenerator.
+      std::string user = std::to_string(rng() % 1000);
+      url = options.url + "/auth/login";
+      body = R"({"email":"user)" + user +
+             R"(@gitgud.test","password":"Passw0rd)" + user + R"("})";
+    } else if (draw < options.loginRatio + options.writeRatio) {
+      url = options.url + "/resources/food/add";
+      body = foodBody(rng);
+      headers = curl_slist_append(
+          headers, ("Authorization: Bearer " + options.writeToken).c_str());
+    } else {
+      url = options.url + kReadRoutes[rng() % kReadRoutes.size()] +
+            "?start=" + std::to_string((rng() % 50) * 20);
+      headers = curl_slist_append(
+          headers, ("Authorization: Bearer " + options.readToken).c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (!body.empty()) {
+      headers = curl_slist_append(headers, "Content-Type: application/json");
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    auto start = std::chrono::steady_clock::now();
+    CURLcode res = curl_easy_perform(curl);
+    double millis = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    long status = 0;  // NOLINT(runtime/int)
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    recorder.record(millis, res == CURLE_OK && status < 500);
+    curl_slist_free_all(headers);
+  }
+  curl_easy_cleanup(curl);
+}
+
+/**
+ * @brief Mann-Kendall trend statistic normalised to [-1, 1]. Values near 1
+ * mean almost every later sample is larger than every earlier one.
+ */
+double kendallTau(const std::vector<double> &series) {
+  if (series.size() < 2) {
+    return 0;
+  }
+  double s = 0;
+  for (size_t i = 0; i < series.size(); ++i) {
+    for (size_t j = i + 1; j < series.size(); ++j) {
+      if (series[j] > series[i]) {
+        ++s;
+      } else if (series[j] < series[i]) {
+        --s;
+      }
+    }
+  }
+  double pairs = series.size() * (series.size() - 1) / 2.0;
+  return s / pairs;
+}
+
+/**
+ * @brief Flags a series whose trend is consistently upwards and whose last
+ * quarter grew by more than `minGrowth` relative to its first quarter. The
+ * first sample is skipped since it still includes warm-up.
+ */
+bool isDrifting(const std::string &name, const std::vector<double> &raw,
+                double minGrowth) {
+  std::vector<double> series;
+  for (size_t i = 1; i < raw.size(); ++i) {
+    if (raw[i] >= 0) {
+      series.push_back(raw[i]);
+    }
+  }
+  if (series.size() < 8) {
+    std::cout << name << ": not enough samples for drift detection"
+              << std::endl;
+    return false;
+  }
+  size_t quarter = series.size() / 4;
+  double head = 0;
+  double tail = 0;
+  for (size_t i = 0; i < quarter; ++i) {
+    head += series[i];
+    tail += series[series.size() - 1 - i];
+  }
+  head /= quarter;
+  tail /= quarter;
+  double growth = head > 0 ? (tail - head) / head : 0;
+  double tau = kendallTau(series);
+  bool drifting = tau > 0.6 && growth > minGrowth;
+  std::cout << name << ": first-quarter mean " << head
+            << ", last-quarter mean " << tail << ", growth " << growth * 100
+            << "%, trend " << tau << (drifting ? "  <-- DRIFT" : "")
+            << std::endl;
+  return drifting;
+}
+
+void usage() {
+  std::cout
+      << "Usage: GitGudSoakTest --pid <GitGud pid> --read-token <jwt> "
+         "--write-token <jwt> [options]\n"
+         "  --url <url>              Server URL (http://localhost:8080)\n"
+         "  --mongo-uri <uri>        MongoDB URI (mongodb://localhost:27017)\n"
+         "  --duration <seconds>     Run time (14400)\n"
+         "  --interval <seconds>     Sampling interval (60)\n"
+         "  --concurrency <n>        Client threads (16)\n"
+         "  --write-ratio <0..1>     Share of add requests (0.1)\n"
+         "  --login-ratio <0..1>     Share of login requests (0.05)\n"
+         "  --csv <path>             Sample output (soak.csv)\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      usage();
+      return false;
+    }
+    std::string value = argv[++i];
+    if (arg == "--url") {
+      options.url = value;
+    } else if (arg == "--mongo-uri") {
+      options.mongoUri = value;
+    } else if (arg == "--pid") {
+      options.pid = std::stoi(value);
+    } else if (arg == "--read-token") {
+      options.readToken = value;
+    } else if (arg == "--write-token") {
+      options.writeToken = value;
+    } else if (arg == "--duration") {
+      options.durationSeconds = std::stoll(value);
+    } else if (arg == "--interval") {
+      options.intervalSeconds = std::max<int64_t>(1, std::stoll(value));
+    } else if (arg == "--concurrency") {
+      options.concurrency = std::max(1, std::stoi(value));
+    } else if (arg == "--write-ratio") {
+      options.writeRatio = std::stod(value);
+    } else if (arg == "--login-ratio") {
+      options.loginRatio = std::stod(value);
+    } else if (arg == "--csv") {
+      options.csvPath = value;
+    } else {
+      usage();
+      return false;
+    }
+  }
+  if (options.pid <= 0) {
+    usage();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+/**
+ *  Drives the workload, samples the server and reports drift
+ */
+int main(int argc, char *argv[]) {
+  Options options;
+  try {
+    if (!parseOptions(argc, argv, options)) {
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    usage();
+    return 1;
+  }
+
+  curl_global_init(CURL_GLOBAL_ALL);
+  mongocxx::instance instance{};
+  mongocxx::client mongo{mongocxx::uri{options.mongoUri}};
+
+  std::atomic<bool> stop{false};
+  LatencyRecorder recorder;
+  std::vector<std::thread> workers;
+  for (int i = 0; i < options.concurrency; ++i) {
+    workers.emplace_back(runWorker, std::cref(options), i, std::ref(stop),
+                         std::ref(recorder));
+  }
+
+  std::ofstream csv(options.csvPath);
+  csv << "elapsed_s,rss_kb,open_fds,threads,mongo_connections,p50_ms,p99_ms,"
+         "rps,error_rate\n";
+  std::vector<Sample> samples;
+  auto begin = std::chrono::steady_clock::now();
+  auto deadline = begin + std::chrono::seconds(options.durationSeconds);
+  auto next = begin;
+
+  while (std::chrono::steady_clock::now() < deadline) {
+    next += std::chrono::seconds(options.intervalSeconds);
+    std::this_thread::sleep_until(std::min(next, deadline));
+
+    auto [p50, p99, count, errors] = recorder.drain();
+    Sample sample;
+    sample.elapsedSeconds = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - begin)
+                                .count();
+    sample.rssKb = procStatusValue(options.pid, "VmRSS");
+    sample.threads = procStatusValue(options.pid, "Threads");
+    sample.openFds = openFileDescriptors(options.pid);
+    sample.mongoConnections = mongoConnections(mongo);
+    sample.p50Ms = p50;
+    sample.p99Ms = p99;
+    sample.requestsPerSecond =
+        static_cast<double>(count) / options.intervalSeconds;
+    sample.errorRate = count > 0 ? static_cast<double>(errors) / count : 0;
+    samples.push_back(sample);
+
+    if (sample.rssKb < 0) {
+      std::cerr << "Process " << options.pid << " is gone." << std::endl;
+      break;
+    }
+    csv << sample.elapsedSeconds << "," << sample.rssKb << ","
+        << sample.openFds << "," << sample.threads << ","
+        << sample.mongoConnections << "," << sample.p50Ms << ","
+        << sample.p99Ms << "," << sample.requestsPerSecond << ","
+        << sample.errorRate << std::endl;
+    std::cout << "[" << static_cast<int64_t>(sample.elapsedSeconds)
+              << "s] rss=" << sample.rssKb << "kB fds=" << sample.openFds
+              << " threads=" << sample.threads
+              << " mongo=" << sample.mongoConnections << " p50=" << p50
+              << "ms p99=" << p99 << "ms rps=" << sample.requestsPerSecond
+              << std::endl;
+  }
+
+  stop = true;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  curl_global_cleanup();
+
+  auto column = [&](double Sample::*field) {
+    std::vector<double> values;
+    for (const auto &sample : samples) {
+      values.push_back(sample.*field);
+    }
+    return values;
+  };
+
+  std::cout << "\nDrift report" << std::endl;
+  bool drift = false;
+  drift |= isDrifting("RSS", column(&Sample::rssKb), 0.05);
+  drift |= isDrifting("Open file descriptors", column(&Sample::openFds), 0.05);
+  drift |= isDrifting("Threads", column(&Sample::threads), 0.05);
+  drift |= isDrifting("Mongo connections", column(&Sample::mongoConnections),
+                      0.05);
+  drift |= isDrifting("p99 latency", column(&Sample::p99Ms), 0.25);
+  return drift ? 2 : 0;
+}